@@ -413,7 +413,7 @@ pub async fn init_wallet(
 
     // wallet should be encrypted from the beginning, so we must require a password to be provided by the user
     let (wallet_backend, transaction_backend, output_manager_backend, contacts_backend, key_manager_backend) =
-        initialize_sqlite_database_backends(db_path, arg_password, config.wallet.db_connection_pool_size)?;
+        initialize_sqlite_database_backends(db_path, arg_password, config.wallet.db_profile())?;
 
     let wallet_db = WalletDatabase::new(wallet_backend);
     let output_db = OutputManagerDatabase::new(output_manager_backend.clone());
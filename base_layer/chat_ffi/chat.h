@@ -10,6 +10,8 @@
 
 struct ApplicationConfig;
 
+struct Arc_Runtime;
+
 struct ChatByteVector;
 
 struct ChatClient;
@@ -32,6 +34,12 @@ struct TariAddress;
 
 struct TransportConfig;
 
+/**
+ * A tokio runtime that can be shared by several chat clients and wallets, see `tari_runtime_create` in the wallet
+ * FFI
+ */
+typedef struct Arc_Runtime TariRuntime;
+
 typedef void (*CallbackContactStatusChange)(struct ContactsLivenessData*);
 
 typedef void (*CallbackMessageReceived)(struct Message*);
@@ -58,6 +66,9 @@ extern "C" {
  * client receives a confirmation of message delivery.
  * `callback_read_confirmation_received` - A callback function pointer. This is called when the
  * client receives a confirmation of message read.
+ * `tari_address` - The TariAddress of the chat client
+ * `runtime` - An optional TariRuntime to run the client on, shared with other chat clients or wallets. If null the
+ * client creates a runtime of its own.
  *
  * ## Returns
  * `*mut ChatClient` - Returns a pointer to a ChatClient, note that it returns ptr::null_mut()
@@ -72,6 +83,7 @@ struct ChatClient *create_chat_client(struct ApplicationConfig *config,
                                       CallbackDeliveryConfirmationReceived callback_delivery_confirmation_received,
                                       CallbackReadConfirmationReceived callback_read_confirmation_received,
                                       struct TariAddress *tari_address,
+                                      TariRuntime *runtime,
                                       int *error_out);
 
 /**
@@ -89,6 +101,9 @@ struct ChatClient *create_chat_client(struct ApplicationConfig *config,
  * client receives a confirmation of message delivery.
  * `callback_read_confirmation_received` - A callback function pointer. This is called when the
  * client receives a confirmation of message read.
+ * `tari_address` - The TariAddress of the chat client
+ * `runtime` - An optional TariRuntime to run the client on, shared with other chat clients or wallets. If null the
+ * client creates a runtime of its own.
  *
  * ## Returns
  * `*mut ChatClient` - Returns a pointer to a ChatClient, note that it returns ptr::null_mut()
@@ -104,6 +119,7 @@ struct ChatClient *sideload_chat_client(struct ApplicationConfig *config,
                                         CallbackDeliveryConfirmationReceived callback_delivery_confirmation_received,
                                         CallbackReadConfirmationReceived callback_read_confirmation_received,
                                         struct TariAddress *tari_address,
+                                        TariRuntime *runtime,
                                         int *error_out);
 
 /**
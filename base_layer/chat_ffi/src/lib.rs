@@ -22,7 +22,7 @@
 
 #![recursion_limit = "1024"]
 
-use std::ptr;
+use std::{ptr, sync::Arc};
 
 use callback_handler::CallbackContactStatusChange;
 use libc::c_int;
@@ -66,9 +66,13 @@ mod consts {
     include!(concat!(env!("OUT_DIR"), "/consts.rs"));
 }
 
+/// A tokio runtime that can be shared by several chat clients and wallets, see `tari_runtime_create` in the wallet
+/// FFI
+pub type TariRuntime = Arc<Runtime>;
+
 pub struct ChatClient {
     client: Client,
-    runtime: Runtime,
+    runtime: Arc<Runtime>,
 }
 
 /// Creates a Chat Client
@@ -84,6 +88,9 @@ pub struct ChatClient {
 /// client receives a confirmation of message delivery.
 /// `callback_read_confirmation_received` - A callback function pointer. This is called when the
 /// client receives a confirmation of message read.
+/// `tari_address` - The TariAddress of the chat client
+/// `runtime` - An optional TariRuntime to run the client on, shared with other chat clients or wallets. If null the
+/// client creates a runtime of its own.
 ///
 /// ## Returns
 /// `*mut ChatClient` - Returns a pointer to a ChatClient, note that it returns ptr::null_mut()
@@ -99,6 +106,7 @@ pub unsafe extern "C" fn create_chat_client(
     callback_delivery_confirmation_received: CallbackDeliveryConfirmationReceived,
     callback_read_confirmation_received: CallbackReadConfirmationReceived,
     tari_address: *mut TariAddress,
+    runtime: *mut TariRuntime,
     error_out: *mut c_int,
 ) -> *mut ChatClient {
     let mut error = 0;
@@ -141,12 +149,15 @@ pub unsafe extern "C" fn create_chat_client(
         },
     };
 
-    let runtime = match Runtime::new() {
-        Ok(r) => r,
-        Err(e) => {
-            error = LibChatError::from(InterfaceError::TokioError(e.to_string())).code;
-            ptr::swap(error_out, &mut error as *mut c_int);
-            return ptr::null_mut();
+    let runtime = match runtime.as_ref() {
+        Some(runtime) => runtime.clone(),
+        None => match Runtime::new() {
+            Ok(r) => Arc::new(r),
+            Err(e) => {
+                error = LibChatError::from(InterfaceError::TokioError(e.to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
         },
     };
     let user_agent = format!("tari/chat_ffi/{}", env!("CARGO_PKG_VERSION"));
@@ -197,6 +208,9 @@ pub unsafe extern "C" fn create_chat_client(
 /// client receives a confirmation of message delivery.
 /// `callback_read_confirmation_received` - A callback function pointer. This is called when the
 /// client receives a confirmation of message read.
+/// `tari_address` - The TariAddress of the chat client
+/// `runtime` - An optional TariRuntime to run the client on, shared with other chat clients or wallets. If null the
+/// client creates a runtime of its own.
 ///
 /// ## Returns
 /// `*mut ChatClient` - Returns a pointer to a ChatClient, note that it returns ptr::null_mut()
@@ -213,6 +227,7 @@ pub unsafe extern "C" fn sideload_chat_client(
     callback_delivery_confirmation_received: CallbackDeliveryConfirmationReceived,
     callback_read_confirmation_received: CallbackReadConfirmationReceived,
     tari_address: *mut TariAddress,
+    runtime: *mut TariRuntime,
     error_out: *mut c_int,
 ) -> *mut ChatClient {
     let mut error = 0;
@@ -237,12 +252,15 @@ pub unsafe extern "C" fn sideload_chat_client(
         consts::APP_VERSION
     );
 
-    let runtime = match Runtime::new() {
-        Ok(r) => r,
-        Err(e) => {
-            error = LibChatError::from(InterfaceError::TokioError(e.to_string())).code;
-            ptr::swap(error_out, &mut error as *mut c_int);
-            return ptr::null_mut();
+    let runtime = match runtime.as_ref() {
+        Some(runtime) => runtime.clone(),
+        None => match Runtime::new() {
+            Ok(r) => Arc::new(r),
+            Err(e) => {
+                error = LibChatError::from(InterfaceError::TokioError(e.to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
         },
     };
 
@@ -665,7 +665,7 @@ where TBackend: KeyManagerBackend<PublicKey> + 'static
                         return self
                             .device_diffie_hellman(ledger, branch, index, public_key)
                             .await
-                            .map(diffie_hellman_stealth_domain_hasher);
+                            .map(|dh| diffie_hellman_stealth_domain_hasher(&dh));
                     }
                 }
             }
@@ -673,7 +673,38 @@ where TBackend: KeyManagerBackend<PublicKey> + 'static
 
         let secret_key = self.get_private_key(secret_key_id).await?;
         let dh = CommsDHKE::new(&secret_key, public_key);
-        Ok(diffie_hellman_stealth_domain_hasher(dh))
+        Ok(diffie_hellman_stealth_domain_hasher(&dh))
+    }
+
+    pub async fn get_diffie_hellman_shared_secrets_with_stealth_hashers(
+        &self,
+        secret_key_id: &TariKeyId,
+        public_keys: &[PublicKey],
+    ) -> Result<Vec<(CommsDHKE, DomainSeparatedHash<Blake2b<U64>>)>, TransactionError> {
+        if let WalletType::Ledger(_) = &self.wallet_type {
+            if let KeyId::Managed { branch, .. } = secret_key_id {
+                if branch == &TransactionKeyManagerBranch::SenderOffsetLedger.get_branch_key() {
+                    // The private key lives on the device, so each shared secret needs its own round trip
+                    let mut results = Vec::with_capacity(public_keys.len());
+                    for public_key in public_keys {
+                        let dh = self.get_diffie_hellman_shared_secret(secret_key_id, public_key).await?;
+                        let hasher = diffie_hellman_stealth_domain_hasher(&dh);
+                        results.push((dh, hasher));
+                    }
+                    return Ok(results);
+                }
+            }
+        }
+
+        let secret_key = self.get_private_key(secret_key_id).await?;
+        Ok(public_keys
+            .iter()
+            .map(|public_key| {
+                let dh = CommsDHKE::new(&secret_key, public_key);
+                let hasher = diffie_hellman_stealth_domain_hasher(&dh);
+                (dh, hasher)
+            })
+            .collect())
     }
 
     #[allow(unused_variables)] // conditionally compiled paths
@@ -175,6 +175,14 @@ pub trait TransactionKeyManagerInterface: KeyManagerInterface<PublicKey> {
         public_key: &PublicKey,
     ) -> Result<DomainSeparatedHash<Blake2b<U64>>, TransactionError>;
 
+    /// Computes the Diffie-Hellman shared secret of `secret_key_id` with each of `public_keys`, in order, together with
+    /// the stealth address domain hasher derived from it. The private key is only resolved once for the whole batch.
+    async fn get_diffie_hellman_shared_secrets_with_stealth_hashers(
+        &self,
+        secret_key_id: &TariKeyId,
+        public_keys: &[PublicKey],
+    ) -> Result<Vec<(CommsDHKE, DomainSeparatedHash<Blake2b<U64>>)>, TransactionError>;
+
     async fn import_add_offset_to_private_key(
         &self,
         secret_key_id: &TariKeyId,
@@ -331,7 +339,7 @@ mod test {
     use tari_common_types::types::{PrivateKey, PublicKey};
     use tari_crypto::keys::{PublicKey as PK, SecretKey as SK};
 
-    use crate::transactions::key_manager::TariKeyId;
+    use crate::transactions::key_manager::{create_memory_db_key_manager, TariKeyId, TransactionKeyManagerInterface};
 
     fn random_string(len: usize) -> String {
         iter::repeat(())
@@ -364,4 +372,31 @@ mod test {
         assert_eq!(imported_key_id, TariKeyId::from_str(&imported_key_id_str).unwrap());
         assert_eq!(zero_key_id, TariKeyId::from_str(&zero_key_id_str).unwrap());
     }
+
+    #[tokio::test]
+    async fn it_batches_diffie_hellman_shared_secrets() {
+        let key_manager = create_memory_db_key_manager().unwrap();
+        let (view_key_id, _) = key_manager.get_view_key().await.unwrap();
+        let public_keys = (0..3)
+            .map(|_| PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng)))
+            .collect::<Vec<_>>();
+
+        let batch = key_manager
+            .get_diffie_hellman_shared_secrets_with_stealth_hashers(&view_key_id, &public_keys)
+            .await
+            .unwrap();
+        assert_eq!(batch.len(), public_keys.len());
+        for (public_key, (shared_secret, hasher)) in public_keys.iter().zip(batch) {
+            let expected_secret = key_manager
+                .get_diffie_hellman_shared_secret(&view_key_id, public_key)
+                .await
+                .unwrap();
+            let expected_hasher = key_manager
+                .get_diffie_hellman_stealth_domain_hasher(&view_key_id, public_key)
+                .await
+                .unwrap();
+            assert_eq!(shared_secret.as_bytes(), expected_secret.as_bytes());
+            assert_eq!(hasher.as_ref(), expected_hasher.as_ref());
+        }
+    }
 }
@@ -259,6 +259,18 @@ where TBackend: KeyManagerBackend<PublicKey> + 'static
             .await
     }
 
+    async fn get_diffie_hellman_shared_secrets_with_stealth_hashers(
+        &self,
+        secret_key_id: &TariKeyId,
+        public_keys: &[PublicKey],
+    ) -> Result<Vec<(CommsDHKE, DomainSeparatedHash<Blake2b<U64>>)>, TransactionError> {
+        self.transaction_key_manager_inner
+            .read()
+            .await
+            .get_diffie_hellman_shared_secrets_with_stealth_hashers(secret_key_id, public_keys)
+            .await
+    }
+
     async fn import_add_offset_to_private_key(
         &self,
         secret_key_id: &TariKeyId,
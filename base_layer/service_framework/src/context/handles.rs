@@ -86,7 +86,11 @@ impl ServiceInitializerContext {
         Fut: Future + Send + 'static,
         Fut::Output: Send,
     {
-        task::spawn(self.wait_ready().then(f))
+        let complete = self.inner.new_complete_trigger();
+        task::spawn(async move {
+            let _complete = complete;
+            self.wait_ready().then(f).await
+        })
     }
 
     /// Spawn a task once handles are ready. The resolved handles are passed into this closure.
@@ -97,7 +101,9 @@ impl ServiceInitializerContext {
         Fut: Future + Send + 'static,
         Fut::Output: Send + 'static,
     {
+        let complete = self.inner.new_complete_trigger();
         task::spawn(async move {
+            let _complete = complete;
             let shutdown_signal = self.get_shutdown_signal();
             self.ready_signal.await;
             let fut = f(self.inner);
@@ -148,6 +154,7 @@ macro_rules! acquire_lock {
 #[derive(Clone)]
 pub struct ServiceHandles {
     handles: Arc<Mutex<HashMap<TypeId, Box<dyn Any + Send>>>>,
+    complete_signals: Arc<Mutex<Vec<ShutdownSignal>>>,
     shutdown_signal: ShutdownSignal,
 }
 
@@ -156,6 +163,7 @@ impl ServiceHandles {
     pub(crate) fn new(shutdown_signal: ShutdownSignal) -> Self {
         Self {
             handles: Default::default(),
+            complete_signals: Default::default(),
             shutdown_signal,
         }
     }
@@ -204,6 +212,19 @@ impl ServiceHandles {
     pub fn get_shutdown_signal(&self) -> ShutdownSignal {
         self.shutdown_signal.clone()
     }
+
+    /// Returns a signal for every task spawned through the `ServiceInitializerContext` of this stack, each of which is
+    /// triggered once its task has finished
+    pub fn get_complete_signals(&self) -> Vec<ShutdownSignal> {
+        acquire_lock!(self.complete_signals).clone()
+    }
+
+    /// Registers the signal of a new trigger, which a spawned task holds until it finishes
+    fn new_complete_trigger(&self) -> Shutdown {
+        let trigger = Shutdown::new();
+        acquire_lock!(self.complete_signals).push(trigger.to_signal());
+        trigger
+    }
 }
 
 #[cfg(test)]
@@ -118,6 +118,24 @@ mod test {
         assert!(handles.is_ok());
     }
 
+    #[tokio::test]
+    async fn it_signals_when_spawned_tasks_complete() {
+        let mut shutdown = Shutdown::new();
+        let handles = StackBuilder::new(shutdown.to_signal())
+            .add_initializer(|context: ServiceInitializerContext| {
+                context.spawn_until_shutdown(|_| future::pending::<()>());
+                Ok(())
+            })
+            .build()
+            .await
+            .unwrap();
+
+        let complete_signals = handles.get_complete_signals();
+        assert_eq!(complete_signals.len(), 1);
+        shutdown.trigger();
+        future::join_all(complete_signals).await;
+    }
+
     #[derive(Clone)]
     struct DummyServiceHandle(usize);
     struct DummyInitializer {
@@ -0,0 +1,2 @@
+DROP INDEX IF EXISTS outputs_status_value_index;
+DROP INDEX IF EXISTS outputs_status_mined_height_index;
@@ -0,0 +1,4 @@
+-- Supports keyset pagination of outputs filtered by status and sorted by value or mined height. The rowid (`id`) is
+-- implicitly part of every SQLite index, so these also cover the `(sort_key, id)` tie breaker.
+CREATE INDEX outputs_status_value_index ON outputs (status, value);
+CREATE INDEX outputs_status_mined_height_index ON outputs (status, mined_height);
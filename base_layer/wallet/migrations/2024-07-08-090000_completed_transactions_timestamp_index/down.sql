@@ -0,0 +1 @@
+DROP INDEX IF EXISTS completed_transactions_timestamp_index;
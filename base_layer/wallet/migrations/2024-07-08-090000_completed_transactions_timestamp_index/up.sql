@@ -0,0 +1,3 @@
+-- Supports paging through the transaction history in `(timestamp, tx_id)` order, e.g. for exports. `tx_id` is a
+-- `BIGINT PRIMARY KEY` rather than a rowid alias, so it is listed explicitly as the tie breaker.
+CREATE INDEX completed_transactions_timestamp_index ON completed_transactions (timestamp, tx_id);
@@ -32,6 +32,7 @@ use tari_common::{
     configuration::{serializers, Network, StringList},
     SubConfigPath,
 };
+use tari_common_sqlite::connection_options::SqlitePerformanceProfile;
 use tari_common_types::grpc_authentication::GrpcAuthentication;
 use tari_comms::multiaddr::Multiaddr;
 use tari_p2p::P2pConfig;
@@ -76,6 +77,9 @@ pub struct WalletConfig {
     pub db_file: PathBuf,
     /// The main wallet db sqlite database backend connection pool size for concurrent reads
     pub db_connection_pool_size: usize,
+    /// The sqlite pragmas (mmap and cache size, synchronous level, temp store and WAL checkpointing) for the main
+    /// wallet db
+    pub db_performance_profile: SqlitePerformanceProfile,
     /// The main wallet password
     #[serde(deserialize_with = "deserialize_safe_password_option")]
     pub password: Option<SafePassword>,
@@ -142,6 +146,7 @@ impl Default for WalletConfig {
             config_dir: PathBuf::from_str("config/wallet").unwrap(),
             db_file: PathBuf::from_str("db/console_wallet.db").unwrap(),
             db_connection_pool_size: 16, // Note: Do not reduce this default number
+            db_performance_profile: SqlitePerformanceProfile::default(),
             password: None,
             contacts_auto_ping_interval: Duration::from_secs(30),
             contacts_online_ping_window: 30,
@@ -183,6 +188,14 @@ impl WalletConfig {
         }
         self.p2p.set_base_path(base_path);
     }
+
+    /// The performance profile of the main wallet db, including the configured connection pool size
+    pub fn db_profile(&self) -> SqlitePerformanceProfile {
+        SqlitePerformanceProfile {
+            pool_size: self.db_connection_pool_size,
+            ..self.db_performance_profile.clone()
+        }
+    }
 }
 
 #[derive(Debug, EnumString, PartialEq, Clone, Copy, Serialize, Deserialize)]
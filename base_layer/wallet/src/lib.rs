@@ -21,6 +21,7 @@ pub mod transaction_service;
 pub use tari_common_types::types::WalletHasher;
 pub mod util;
 pub mod wallet;
+pub mod wallet_host;
 
 pub use operation_id::OperationId;
 
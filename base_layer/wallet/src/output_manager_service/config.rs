@@ -22,6 +22,8 @@
 
 use serde::{Deserialize, Serialize};
 
+use crate::output_manager_service::utxo_compaction::UtxoCompactionPolicy;
+
 #[derive(Clone, Debug, Serialize, Deserialize)]
 #[serde(deny_unknown_fields)]
 pub struct OutputManagerServiceConfig {
@@ -37,6 +39,13 @@ pub struct OutputManagerServiceConfig {
     pub num_confirmations_required: u64,
     /// The number of batches the unconfirmed outputs will be divided into before being queried from the base node
     pub tx_validator_batch_size: usize,
+    /// The maximum number of batches that can be queried from the base node at the same time during TXO validation.
+    /// Each batch in flight uses its own RPC session, up to the size of the base node RPC pool.
+    pub tx_validator_max_concurrent_batches: usize,
+    /// When a new block is detected, only revalidate outputs that may have changed since the last validated tip: those
+    /// with pending spends, and those mined within `num_confirmations_required` blocks of that tip. All outputs are
+    /// still revalidated when validation is requested explicitly or the last validated tip is reorged out.
+    pub incremental_txo_validation: bool,
     /// Wallets currently will choose the best outputs as inputs when spending, however since a lurking base node can
     /// generate a transaction graph of inputs to outputs with relative ease, a wallet may reveal its transaction
     /// history by including a (non-stealth address) one-sided payment.
@@ -45,6 +54,8 @@ pub struct OutputManagerServiceConfig {
     pub autoignore_onesided_utxos: bool,
     /// The number of seconds that have to pass for the wallet to run revalidation of invalid UTXOs on startup.
     pub num_of_seconds_to_revalidate_invalid_utxos: u64,
+    /// The initial policy of the background UTXO compaction task, disabled by default
+    pub utxo_compaction: UtxoCompactionPolicy,
 }
 
 impl Default for OutputManagerServiceConfig {
@@ -55,8 +66,11 @@ impl Default for OutputManagerServiceConfig {
             event_channel_size: 250,
             num_confirmations_required: 3,
             tx_validator_batch_size: 100,
+            tx_validator_max_concurrent_batches: 4,
+            incremental_txo_validation: true,
             autoignore_onesided_utxos: false,
             num_of_seconds_to_revalidate_invalid_utxos: 60 * 60 * 24 * 3,
+            utxo_compaction: UtxoCompactionPolicy::default(),
         }
     }
 }
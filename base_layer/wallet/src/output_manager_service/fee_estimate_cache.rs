@@ -0,0 +1,158 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::collections::HashMap;
+
+use tari_core::transactions::tari_amount::MicroMinotari;
+
+use crate::output_manager_service::{
+    input_selection::{UtxoSelectionFilter, UtxoSelectionMode},
+    UtxoSelectionCriteria,
+    UtxoSelectionOrdering,
+};
+
+/// The maximum number of estimates kept for a single generation of the spendable outputs
+const FEE_ESTIMATE_CACHE_CAPACITY: usize = 1024;
+
+/// The parameters a fee estimate depends on. Amounts are bucketed, so estimates for amounts that only differ in their
+/// least significant digits share an entry.
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+pub(crate) struct FeeEstimateKey {
+    amount_bucket: u64,
+    fee_per_gram: u64,
+    num_kernels: usize,
+    num_outputs: usize,
+    tip_height: Option<u64>,
+    mode: UtxoSelectionMode,
+    ordering: UtxoSelectionOrdering,
+    min_dust: u64,
+    excluding_onesided: bool,
+}
+
+impl FeeEstimateKey {
+    /// Returns the key for an estimate, or None if the selection criteria name specific outputs, which are not worth
+    /// caching.
+    pub fn new(
+        amount: MicroMinotari,
+        selection_criteria: &UtxoSelectionCriteria,
+        fee_per_gram: MicroMinotari,
+        num_kernels: usize,
+        num_outputs: usize,
+        tip_height: Option<u64>,
+    ) -> Option<Self> {
+        if !matches!(selection_criteria.filter, UtxoSelectionFilter::Standard) ||
+            !selection_criteria.excluding.is_empty()
+        {
+            return None;
+        }
+        Some(Self {
+            amount_bucket: amount_bucket(amount.as_u64()),
+            fee_per_gram: fee_per_gram.as_u64(),
+            num_kernels,
+            num_outputs,
+            tip_height,
+            mode: selection_criteria.mode,
+            ordering: selection_criteria.ordering,
+            min_dust: selection_criteria.min_dust,
+            excluding_onesided: selection_criteria.excluding_onesided,
+        })
+    }
+
+    /// The amount the estimate for this key is made for, the upper bound of the amount bucket
+    pub fn amount(&self) -> MicroMinotari {
+        MicroMinotari::from(self.amount_bucket)
+    }
+}
+
+/// Fee estimates for the current generation of the spendable outputs. The cache is emptied as soon as it is used with
+/// a newer generation, so an estimate is only reused while the outputs it was selected from are unchanged.
+#[derive(Debug, Default)]
+pub(crate) struct FeeEstimateCache {
+    generation: u64,
+    estimates: HashMap<FeeEstimateKey, MicroMinotari>,
+}
+
+impl FeeEstimateCache {
+    pub fn get(&mut self, generation: u64, key: &FeeEstimateKey) -> Option<MicroMinotari> {
+        self.set_generation(generation);
+        self.estimates.get(key).copied()
+    }
+
+    pub fn insert(&mut self, generation: u64, key: FeeEstimateKey, fee: MicroMinotari) {
+        self.set_generation(generation);
+        if self.estimates.len() >= FEE_ESTIMATE_CACHE_CAPACITY {
+            self.estimates.clear();
+        }
+        self.estimates.insert(key, fee);
+    }
+
+    fn set_generation(&mut self, generation: u64) {
+        if self.generation != generation {
+            self.estimates.clear();
+            self.generation = generation;
+        }
+    }
+}
+
+/// Rounds an amount up to three significant digits
+fn amount_bucket(amount: u64) -> u64 {
+    let digits = amount.checked_ilog10().unwrap_or(0);
+    if digits < 3 {
+        return amount;
+    }
+    let step = 10u64.pow(digits - 2);
+    amount.div_ceil(step).saturating_mul(step)
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn it_buckets_amounts_to_three_significant_digits() {
+        assert_eq!(amount_bucket(0), 0);
+        assert_eq!(amount_bucket(999), 999);
+        assert_eq!(amount_bucket(1000), 1000);
+        assert_eq!(amount_bucket(1001), 1010);
+        assert_eq!(amount_bucket(123_456), 124_000);
+        assert_eq!(amount_bucket(124_000), 124_000);
+        assert_eq!(amount_bucket(u64::MAX), u64::MAX);
+    }
+
+    #[test]
+    fn it_only_caches_estimates_for_the_current_generation() {
+        let criteria = UtxoSelectionCriteria::default();
+        let key = FeeEstimateKey::new(123_456.into(), &criteria, 5.into(), 1, 1, Some(10)).unwrap();
+        let same_bucket = FeeEstimateKey::new(123_999.into(), &criteria, 5.into(), 1, 1, Some(10)).unwrap();
+        let mut cache = FeeEstimateCache::default();
+        cache.insert(1, key.clone(), 100.into());
+        assert_eq!(cache.get(1, &same_bucket), Some(100.into()));
+        assert_eq!(cache.get(2, &key), None);
+        assert_eq!(cache.get(1, &key), None);
+    }
+
+    #[test]
+    fn it_does_not_cache_specific_outputs() {
+        let criteria = UtxoSelectionCriteria::specific(vec![]);
+        assert!(FeeEstimateKey::new(1000.into(), &criteria, 5.into(), 1, 1, None).is_none());
+    }
+}
@@ -30,6 +30,7 @@ use tari_common_types::{
 use tari_core::{
     covenants::Covenant,
     transactions::{
+        key_manager::TariKeyId,
         tari_amount::MicroMinotari,
         transaction_components::{OutputFeatures, Transaction, TransactionOutput, WalletOutput, WalletOutputBuilder},
         transaction_protocol::{sender::TransactionSenderMessage, TransactionMetadata},
@@ -58,6 +59,8 @@ pub enum OutputManagerRequest {
     AddOutput((Box<WalletOutput>, Option<SpendingPriority>)),
     AddOutputWithTxId((TxId, Box<WalletOutput>, Option<SpendingPriority>)),
     AddUnvalidatedOutput((TxId, Box<WalletOutput>, Option<SpendingPriority>)),
+    AddUnvalidatedOutputs(Vec<(TxId, WalletOutput)>),
+    RemoveOutputs(Vec<Commitment>),
     UpdateOutputMetadataSignature(Box<TransactionOutput>),
     GetRecipientTransaction(TransactionSenderMessage),
     ConfirmPendingTransaction(TxId),
@@ -98,6 +101,12 @@ pub enum OutputManagerRequest {
         fee_per_gram: MicroMinotari,
         selection_criteria: UtxoSelectionCriteria,
     },
+    CreateTransactionWithOutputs {
+        tx_id: TxId,
+        outputs: Vec<(WalletOutput, TariKeyId)>,
+        fee_per_gram: MicroMinotari,
+        selection_criteria: UtxoSelectionCriteria,
+    },
     CancelTransaction(TxId),
     GetSpentOutputs,
     GetUnspentOutputs,
@@ -146,6 +155,8 @@ impl fmt::Display for OutputManagerRequest {
             AddUnvalidatedOutput((t, v, _)) => {
                 write!(f, "AddUnvalidatedOutput ({}: {})", t, v.value)
             },
+            AddUnvalidatedOutputs(v) => write!(f, "AddUnvalidatedOutputs ({} outputs)", v.len()),
+            RemoveOutputs(v) => write!(f, "RemoveOutputs ({} outputs)", v.len()),
             UpdateOutputMetadataSignature(v) => write!(
                 f,
                 "UpdateOutputMetadataSignature ({}, {}, {}, {}, {})",
@@ -215,6 +226,9 @@ impl fmt::Display for OutputManagerRequest {
                 write!(f, "CreateOutputWithFeatures({}, {})", value, features,)
             },
             CreatePayToSelfWithOutputs { .. } => write!(f, "CreatePayToSelfWithOutputs"),
+            CreateTransactionWithOutputs { tx_id, outputs, .. } => {
+                write!(f, "CreateTransactionWithOutputs({}, {} outputs)", tx_id, outputs.len())
+            },
             ReinstateCancelledInboundTx(_) => write!(f, "ReinstateCancelledInboundTx"),
             CreateClaimShaAtomicSwapTransaction(output, pre_image, fee_per_gram) => write!(
                 f,
@@ -237,6 +251,8 @@ impl fmt::Display for OutputManagerRequest {
 pub enum OutputManagerResponse {
     Balance(Balance),
     OutputAdded,
+    OutputsAdded(Vec<bool>),
+    OutputsRemoved,
     ConvertedToTransactionOutput(Box<TransactionOutput>),
     OutputMetadataSignatureUpdated,
     RecipientTransactionGenerated(ReceiverTransactionProtocol),
@@ -275,6 +291,10 @@ pub enum OutputManagerResponse {
         transaction: Box<Transaction>,
         tx_id: TxId,
     },
+    TransactionWithOutputsCreated {
+        transaction: Box<Transaction>,
+        fee: MicroMinotari,
+    },
     ReinstatedCancelledInboundTx,
     ClaimHtlcTransaction((TxId, MicroMinotari, MicroMinotari, Transaction)),
     OutputInfoByTxId(OutputInfoByTxId),
@@ -400,6 +420,35 @@ impl OutputManagerHandle {
         }
     }
 
+    /// Adds a batch of unvalidated outputs in one database transaction. Returns whether each output was added, outputs
+    /// that are already in the wallet are skipped.
+    pub async fn add_unvalidated_outputs(
+        &mut self,
+        outputs: Vec<(TxId, WalletOutput)>,
+    ) -> Result<Vec<bool>, OutputManagerError> {
+        match self
+            .handle
+            .call(OutputManagerRequest::AddUnvalidatedOutputs(outputs))
+            .await??
+        {
+            OutputManagerResponse::OutputsAdded(added) => Ok(added),
+            _ => Err(OutputManagerError::UnexpectedApiResponse),
+        }
+    }
+
+    /// Removes the outputs with the given commitments from the wallet, whatever their status. Commitments that are not
+    /// in the wallet are ignored.
+    pub async fn remove_outputs(&mut self, commitments: Vec<Commitment>) -> Result<(), OutputManagerError> {
+        match self
+            .handle
+            .call(OutputManagerRequest::RemoveOutputs(commitments))
+            .await??
+        {
+            OutputManagerResponse::OutputsRemoved => Ok(()),
+            _ => Err(OutputManagerError::UnexpectedApiResponse),
+        }
+    }
+
     pub async fn create_output_with_features(
         &mut self,
         value: MicroMinotari,
@@ -758,6 +807,30 @@ impl OutputManagerHandle {
         }
     }
 
+    /// Create a transaction containing the provided signed outputs, funded from this wallet's unspent outputs.
+    /// Returns the finalized transaction and its fee.
+    pub async fn create_transaction_with_outputs(
+        &mut self,
+        tx_id: TxId,
+        outputs: Vec<(WalletOutput, TariKeyId)>,
+        fee_per_gram: MicroMinotari,
+        selection_criteria: UtxoSelectionCriteria,
+    ) -> Result<(Transaction, MicroMinotari), OutputManagerError> {
+        match self
+            .handle
+            .call(OutputManagerRequest::CreateTransactionWithOutputs {
+                tx_id,
+                outputs,
+                fee_per_gram,
+                selection_criteria,
+            })
+            .await??
+        {
+            OutputManagerResponse::TransactionWithOutputsCreated { transaction, fee } => Ok((*transaction, fee)),
+            _ => Err(OutputManagerError::UnexpectedApiResponse),
+        }
+    }
+
     #[allow(clippy::mutable_key_type)]
     pub async fn encumber_aggregate_utxo(
         &mut self,
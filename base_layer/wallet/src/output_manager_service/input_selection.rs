@@ -27,7 +27,7 @@ use std::{
 
 use tari_common_types::types::Commitment;
 
-#[derive(Debug, Copy, Clone, Default, Eq, PartialEq)]
+#[derive(Debug, Copy, Clone, Default, Eq, PartialEq, Hash)]
 pub enum UtxoSelectionMode {
     #[default]
     Safe,
@@ -80,7 +80,7 @@ impl Display for UtxoSelectionCriteria {
 }
 
 /// UTXO selection ordering
-#[derive(Default, Debug, Clone, Copy, PartialEq, Eq)]
+#[derive(Default, Debug, Clone, Copy, PartialEq, Eq, Hash)]
 pub enum UtxoSelectionOrdering {
     /// The Default ordering is heuristic and depends on the requested value and the value of the available UTXOs.
     /// If the requested value is larger than the largest available UTXO, we select LargerFirst as inputs, otherwise
@@ -130,3 +130,101 @@ impl Display for UtxoSelectionFilter {
         }
     }
 }
+
+/// The maximum number of branches explored by `select_without_change` before it settles for the best selection found
+const BRANCH_AND_BOUND_MAX_TRIES: usize = 100_000;
+
+/// Branch and bound search for a subset of `effective_values`, which must be sorted from largest to smallest, whose sum
+/// is at least `target` and exceeds it by no more than `tolerance`. When the excess is within the cost of a change
+/// output, the transaction can be built without one. The selection with the fewest inputs is preferred, and then the
+/// one with the smallest excess. Returns the indexes of the selected values, or `None` if no such subset was found.
+pub(crate) fn select_without_change(
+    effective_values: &[u64],
+    target: u64,
+    tolerance: u64,
+    max_inputs: usize,
+) -> Option<Vec<usize>> {
+    let upper_bound = target.saturating_add(tolerance);
+    // remaining[i] is the sum of all the values from index i onwards
+    let mut remaining = vec![0u64; effective_values.len() + 1];
+    for (i, value) in effective_values.iter().enumerate().rev() {
+        remaining[i] = remaining[i + 1].saturating_add(*value);
+    }
+
+    let mut best: Option<(Vec<usize>, u64)> = None;
+    let mut selected = Vec::new();
+    let mut sum = 0u64;
+    let mut index = 0;
+    for _ in 0..BRANCH_AND_BOUND_MAX_TRIES {
+        let mut backtrack = sum.saturating_add(remaining[index]) < target || sum > upper_bound;
+        if !backtrack && sum >= target {
+            let excess = sum - target;
+            let is_better = best.as_ref().map_or(true, |(best_selected, best_excess)| {
+                selected.len() < best_selected.len() || (selected.len() == best_selected.len() && excess < *best_excess)
+            });
+            if is_better {
+                best = Some((selected.clone(), excess));
+            }
+            backtrack = true;
+        }
+        if !backtrack {
+            // Adding another input cannot beat a selection that already has fewer inputs
+            let cannot_improve = best
+                .as_ref()
+                .map_or(false, |(best_selected, _)| selected.len() >= best_selected.len());
+            backtrack = index >= effective_values.len() || selected.len() >= max_inputs || cannot_improve;
+        }
+
+        if backtrack {
+            // Undo the last inclusion and explore the branch that excludes it
+            match selected.pop() {
+                Some(last) => {
+                    sum -= effective_values[last];
+                    index = last + 1;
+                },
+                None => break,
+            }
+        } else {
+            selected.push(index);
+            sum += effective_values[index];
+            index += 1;
+        }
+    }
+
+    best.map(|(selected, _)| selected)
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn it_finds_an_exact_match() {
+        let values = [50, 40, 30, 20, 10];
+        let selected = select_without_change(&values, 70, 0, 10).unwrap();
+        assert_eq!(selected.iter().map(|i| values[*i]).sum::<u64>(), 70);
+        assert_eq!(selected.len(), 2);
+    }
+
+    #[test]
+    fn it_prefers_fewer_inputs() {
+        let values = [60, 25, 20, 15, 10, 5];
+        // 60 + 5 and 25 + 20 + 15 + 5 are both in range, the first needs fewer inputs
+        let selected = select_without_change(&values, 64, 2, 10).unwrap();
+        assert_eq!(selected, vec![0, 5]);
+    }
+
+    #[test]
+    fn it_keeps_the_excess_within_tolerance() {
+        let values = [100, 90];
+        assert!(select_without_change(&values, 50, 10, 10).is_none());
+        assert_eq!(select_without_change(&values, 85, 10, 10).unwrap(), vec![1]);
+    }
+
+    #[test]
+    fn it_respects_the_input_limit() {
+        let values = [10, 10, 10, 10];
+        assert!(select_without_change(&values, 40, 0, 3).is_none());
+        assert_eq!(select_without_change(&values, 40, 0, 4).unwrap().len(), 4);
+    }
+}
@@ -24,6 +24,7 @@ pub mod config;
 pub mod error;
 pub mod handle;
 
+mod fee_estimate_cache;
 mod input_selection;
 pub use input_selection::{UtxoSelectionCriteria, UtxoSelectionFilter, UtxoSelectionOrdering};
 
@@ -32,6 +33,7 @@ pub mod resources;
 pub mod service;
 pub mod storage;
 mod tasks;
+pub mod utxo_compaction;
 
 use std::marker::PhantomData;
 
@@ -22,4 +22,110 @@
 
 mod standard_outputs_recoverer;
 
+use std::{future::Future, thread};
+
 pub(crate) use standard_outputs_recoverer::StandardUtxoRecoverer;
+use tokio::task;
+
+use crate::output_manager_service::error::OutputManagerError;
+
+/// Blocks smaller than this are not worth splitting across workers
+const MIN_OUTPUTS_PER_WORKER: usize = 8;
+
+/// Splits `items` into contiguous chunks, one per available core, without splitting below `MIN_OUTPUTS_PER_WORKER`
+/// items per chunk. Concatenating the chunks gives back the original order.
+pub(crate) fn partition_for_workers<T>(items: Vec<T>) -> Vec<Vec<T>> {
+    let num_workers = thread::available_parallelism().map(|n| n.get()).unwrap_or(1);
+    let chunk_size = items.len().div_ceil(num_workers).max(MIN_OUTPUTS_PER_WORKER);
+    let mut chunks = Vec::with_capacity(items.len().div_ceil(chunk_size));
+    let mut items = items.into_iter().peekable();
+    while items.peek().is_some() {
+        chunks.push(items.by_ref().take(chunk_size).collect());
+    }
+    chunks
+}
+
+/// Runs `f` on every item in `items` across a pool of worker tasks and returns the `Some` results in the order of
+/// `items`, regardless of which worker finished first.
+pub(crate) async fn parallel_filter_map<T, R, F, Fut>(items: Vec<T>, f: F) -> Result<Vec<R>, OutputManagerError>
+where
+    T: Send + 'static,
+    R: Send + 'static,
+    F: Fn(T) -> Fut + Clone + Send + 'static,
+    Fut: Future<Output = Result<Option<R>, OutputManagerError>> + Send + 'static,
+{
+    parallel_chunk_map(items, move |chunk| {
+        let f = f.clone();
+        async move {
+            let mut results = Vec::new();
+            for item in chunk {
+                if let Some(result) = f(item).await? {
+                    results.push(result);
+                }
+            }
+            Ok(results)
+        }
+    })
+    .await
+}
+
+/// Splits `items` into one chunk per worker task and runs `f` on each chunk, so that work that can be shared across
+/// items is done once per chunk. The results of all chunks are concatenated in the order of `items`.
+pub(crate) async fn parallel_chunk_map<T, R, F, Fut>(items: Vec<T>, f: F) -> Result<Vec<R>, OutputManagerError>
+where
+    T: Send + 'static,
+    R: Send + 'static,
+    F: Fn(Vec<T>) -> Fut,
+    Fut: Future<Output = Result<Vec<R>, OutputManagerError>> + Send + 'static,
+{
+    let handles = partition_for_workers(items)
+        .into_iter()
+        .map(|chunk| task::spawn(f(chunk)))
+        .collect::<Vec<_>>();
+
+    let mut results = Vec::new();
+    for handle in handles {
+        let chunk_results = handle
+            .await
+            .map_err(|e| OutputManagerError::ServiceError(format!("Output recovery worker failed: {}", e)))??;
+        results.extend(chunk_results);
+    }
+    Ok(results)
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn it_partitions_in_order() {
+        let items = (0..1000).collect::<Vec<_>>();
+        let chunks = partition_for_workers(items.clone());
+        assert!(chunks.iter().all(|c| !c.is_empty()));
+        assert_eq!(chunks.into_iter().flatten().collect::<Vec<_>>(), items);
+
+        let chunks = partition_for_workers((0..MIN_OUTPUTS_PER_WORKER - 1).collect::<Vec<_>>());
+        assert_eq!(chunks.len(), 1);
+        assert!(partition_for_workers(Vec::<u8>::new()).is_empty());
+    }
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn it_keeps_the_input_order() {
+        let items = (0..1000u64).collect::<Vec<_>>();
+        let results = parallel_filter_map(items, |i| async move { Ok((i % 3 == 0).then_some(i)) })
+            .await
+            .unwrap();
+        assert_eq!(results, (0..1000u64).filter(|i| i % 3 == 0).collect::<Vec<_>>());
+    }
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn it_keeps_the_chunk_order() {
+        let items = (0..1000u64).collect::<Vec<_>>();
+        let results = parallel_chunk_map(items.clone(), |chunk| async move {
+            Ok(chunk.into_iter().map(|i| i * 2).collect())
+        })
+        .await
+        .unwrap();
+        assert_eq!(results, items.iter().map(|i| i * 2).collect::<Vec<_>>());
+    }
+}
@@ -20,7 +20,7 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-use std::time::Instant;
+use std::{sync::Arc, time::Instant};
 
 use log::*;
 use tari_common_types::{
@@ -46,6 +46,7 @@ use tari_utilities::hex::Hex;
 use crate::output_manager_service::{
     error::{OutputManagerError, OutputManagerStorageError},
     handle::RecoveredOutput,
+    recovery::parallel_filter_map,
     storage::{
         database::{OutputManagerBackend, OutputManagerDatabase},
         models::{DbWalletOutput, KnownOneSidedPaymentScript},
@@ -70,7 +71,8 @@ where
     }
 
     /// Attempt to rewind all of the given transaction outputs into key_manager outputs. If they can be rewound then add
-    /// them to the database and increment the key manager index
+    /// them to the database and increment the key manager index. Rewinding is spread across a pool of workers, the
+    /// recovered outputs are returned in the same order as `outputs`.
     pub async fn scan_and_recover_outputs(
         &mut self,
         outputs: Vec<TransactionOutput>,
@@ -78,52 +80,16 @@ where
         let start = Instant::now();
         let outputs_length = outputs.len();
 
-        let known_scripts = self.db.get_all_known_one_sided_payment_scripts()?;
-
-        let mut rewound_outputs: Vec<(WalletOutput, bool, FixedHash)> = Vec::new();
-        let push_pub_key_script = script!(PushPubKey(Box::default()));
-        for output in outputs {
-            let known_script_index = known_scripts.iter().position(|s| s.script == output.script);
-            if output.script != script!(Nop) &&
-                known_script_index.is_none() &&
-                !output.script.pattern_match(&push_pub_key_script)
-            {
-                continue;
-            }
-
-            let (spending_key, committed_value, payment_id) = match self.attempt_output_recovery(&output).await? {
-                Some(recovered) => recovered,
-                None => continue,
-            };
-            let (input_data, script_key) = match self
-                .find_script_key(&output.script, &spending_key, known_script_index, &known_scripts)
-                .await?
-            {
-                Some((input_data, script_key)) => (input_data, script_key),
-                None => continue,
-            };
-
-            let hash = output.hash();
-            let uo = WalletOutput::new_with_rangeproof(
-                output.version,
-                committed_value,
-                spending_key,
-                output.features,
-                output.script,
-                input_data,
-                script_key,
-                output.sender_offset_public_key,
-                output.metadata_signature,
-                0,
-                output.covenant,
-                output.encrypted_data,
-                output.minimum_value_promise,
-                output.proof.clone(),
-                payment_id,
-            );
-
-            rewound_outputs.push((uo, known_script_index.is_some(), hash));
-        }
+        let known_scripts = Arc::new(self.db.get_all_known_one_sided_payment_scripts()?);
+        let master_key_manager = self.master_key_manager.clone();
+        let db = self.db.clone();
+        let rewound_outputs = parallel_filter_map(outputs, move |output| {
+            let master_key_manager = master_key_manager.clone();
+            let db = db.clone();
+            let known_scripts = known_scripts.clone();
+            async move { Self::rewind_output(&master_key_manager, &db, output, &known_scripts).await }
+        })
+        .await?;
 
         let rewind_time = start.elapsed();
         trace!(
@@ -133,8 +99,8 @@ where
             rewind_time.as_millis(),
         );
 
-        let mut rewound_outputs_with_tx_id: Vec<RecoveredOutput> = Vec::new();
-        for (output, has_known_script, hash) in &mut rewound_outputs {
+        let mut db_outputs = Vec::with_capacity(rewound_outputs.len());
+        for (output, has_known_script, _) in &rewound_outputs {
             let db_output = DbWalletOutput::from_wallet_output(
                 output.clone(),
                 &self.master_key_manager,
@@ -144,22 +110,20 @@ where
                 None,
             )
             .await?;
-            let tx_id = TxId::new_random();
-            let output_hex = db_output.commitment.to_hex();
-            if let Err(e) = self.db.add_unspent_output_with_tx_id(tx_id, db_output) {
-                match e {
-                    OutputManagerStorageError::DuplicateOutput => {
-                        continue;
-                    },
-                    _ => return Err(OutputManagerError::from(e)),
-                }
-            }
+            db_outputs.push((TxId::new_random(), db_output));
+        }
+        let keys = db_outputs
+            .iter()
+            .map(|(tx_id, o)| (*tx_id, o.commitment.to_hex()))
+            .collect::<Vec<_>>();
+        // All the outputs are written in one database transaction, outputs that are already known are skipped
+        let added = self.db.add_unspent_outputs_with_tx_id(db_outputs)?;
 
-            rewound_outputs_with_tx_id.push(RecoveredOutput {
-                output: output.clone(),
-                tx_id,
-                hash: *hash,
-            });
+        let mut rewound_outputs_with_tx_id: Vec<RecoveredOutput> = Vec::new();
+        for (((output, _, hash), (tx_id, output_hex)), added) in rewound_outputs.into_iter().zip(keys).zip(added) {
+            if !added {
+                continue;
+            }
             trace!(
                 target: LOG_TARGET,
                 "Output {} with value {} with {} recovered",
@@ -167,6 +131,7 @@ where
                 output.value,
                 output.features,
             );
+            rewound_outputs_with_tx_id.push(RecoveredOutput { output, tx_id, hash });
         }
 
         Ok(rewound_outputs_with_tx_id)
@@ -194,8 +159,64 @@ where
         }
     }
 
+    /// Attempts to rewind a single output, returning `None` if it does not belong to this wallet
+    async fn rewind_output(
+        master_key_manager: &TKeyManagerInterface,
+        db: &OutputManagerDatabase<TBackend>,
+        output: TransactionOutput,
+        known_scripts: &[KnownOneSidedPaymentScript],
+    ) -> Result<Option<(WalletOutput, bool, FixedHash)>, OutputManagerError> {
+        let push_pub_key_script = script!(PushPubKey(Box::default()));
+        let known_script_index = known_scripts.iter().position(|s| s.script == output.script);
+        if output.script != script!(Nop) &&
+            known_script_index.is_none() &&
+            !output.script.pattern_match(&push_pub_key_script)
+        {
+            return Ok(None);
+        }
+
+        let (spending_key, committed_value, payment_id) =
+            match Self::attempt_output_recovery(master_key_manager, db, &output).await? {
+                Some(recovered) => recovered,
+                None => return Ok(None),
+            };
+        let (input_data, script_key) = match Self::find_script_key(
+            master_key_manager,
+            &output.script,
+            &spending_key,
+            known_script_index,
+            known_scripts,
+        )
+        .await?
+        {
+            Some((input_data, script_key)) => (input_data, script_key),
+            None => return Ok(None),
+        };
+
+        let hash = output.hash();
+        let uo = WalletOutput::new_with_rangeproof(
+            output.version,
+            committed_value,
+            spending_key,
+            output.features,
+            output.script,
+            input_data,
+            script_key,
+            output.sender_offset_public_key,
+            output.metadata_signature,
+            0,
+            output.covenant,
+            output.encrypted_data,
+            output.minimum_value_promise,
+            output.proof.clone(),
+            payment_id,
+        );
+
+        Ok(Some((uo, known_script_index.is_some(), hash)))
+    }
+
     async fn find_script_key(
-        &self,
+        master_key_manager: &TKeyManagerInterface,
         script: &TariScript,
         spending_key: &TariKeyId,
         known_script_index: Option<usize>,
@@ -211,9 +232,9 @@ where
                 }
             } else {
                 let private_key = PrivateKey::random(&mut rand::thread_rng());
-                self.master_key_manager.import_key(private_key).await?
+                master_key_manager.import_key(private_key).await?
             };
-            let public_key = self.master_key_manager.get_public_key_at_key_id(&key).await?;
+            let public_key = master_key_manager.get_public_key_at_key_id(&key).await?;
             (inputs!(public_key), key)
         } else {
             // This is a known script so lets fill in the details
@@ -225,8 +246,7 @@ where
             } else {
                 // this is push public key script, so lets see if we know the public key
                 if let Some(Opcode::PushPubKey(public_key)) = script.opcode(0) {
-                    let result = self
-                        .master_key_manager
+                    let result = master_key_manager
                         .find_script_key_id_from_spend_key_id(spending_key, Some(public_key))
                         .await?;
                     if let Some(script_key_id) = result {
@@ -246,23 +266,23 @@ where
     }
 
     async fn attempt_output_recovery(
-        &self,
+        master_key_manager: &TKeyManagerInterface,
+        db: &OutputManagerDatabase<TBackend>,
         output: &TransactionOutput,
     ) -> Result<Option<(TariKeyId, MicroMinotari, PaymentId)>, OutputManagerError> {
         // lets first check if the output exists in the db, if it does we dont have to try recovery as we already know
         // about the output.
-        match self.db.fetch_by_commitment(output.commitment().clone()) {
+        match db.fetch_by_commitment(output.commitment().clone()) {
             Ok(_) => return Ok(None),
             Err(OutputManagerStorageError::ValueNotFound) => {},
             Err(e) => return Err(e.into()),
         };
-        let (key, committed_value, payment_id) =
-            match self.master_key_manager.try_output_key_recovery(output, None).await {
-                Ok(value) => value,
-                // Key manager errors here are actual errors and should not be suppressed.
-                Err(TransactionError::KeyManagerError(e)) => return Err(TransactionError::KeyManagerError(e).into()),
-                Err(_) => return Ok(None),
-            };
+        let (key, committed_value, payment_id) = match master_key_manager.try_output_key_recovery(output, None).await {
+            Ok(value) => value,
+            // Key manager errors here are actual errors and should not be suppressed.
+            Err(TransactionError::KeyManagerError(e)) => return Err(TransactionError::KeyManagerError(e).into()),
+            Err(_) => return Ok(None),
+        };
 
         Ok(Some((key, committed_value, payment_id)))
     }
@@ -20,7 +20,7 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-use std::{collections::HashMap, convert::TryInto, fmt, sync::Arc};
+use std::{cmp::Reverse, collections::HashMap, convert::TryInto, fmt, sync::Arc};
 
 use blake2::Blake2b;
 use diesel::result::{DatabaseErrorKind, Error as DieselError};
@@ -63,7 +63,11 @@ use tari_core::{
             WalletOutput,
             WalletOutputBuilder,
         },
-        transaction_protocol::{sender::TransactionSenderMessage, TransactionMetadata},
+        transaction_protocol::{
+            sender::TransactionSenderMessage,
+            transaction_initializer::SenderTransactionInitializer,
+            TransactionMetadata,
+        },
         CryptoFactories,
         ReceiverTransactionProtocol,
         SenderTransactionProtocol,
@@ -91,6 +95,7 @@ use crate::{
     output_manager_service::{
         config::OutputManagerServiceConfig,
         error::{OutputManagerError, OutputManagerProtocolError, OutputManagerStorageError},
+        fee_estimate_cache::{FeeEstimateCache, FeeEstimateKey},
         handle::{
             OutputManagerEvent,
             OutputManagerEventSender,
@@ -98,8 +103,8 @@ use crate::{
             OutputManagerResponse,
             RecoveredOutput,
         },
-        input_selection::UtxoSelectionCriteria,
-        recovery::StandardUtxoRecoverer,
+        input_selection::{select_without_change, UtxoSelectionCriteria, UtxoSelectionOrdering},
+        recovery::{parallel_chunk_map, StandardUtxoRecoverer},
         resources::OutputManagerResources,
         storage::{
             database::{OutputBackendQuery, OutputManagerBackend, OutputManagerDatabase},
@@ -107,7 +112,7 @@ use crate::{
             OutputSource,
             OutputStatus,
         },
-        tasks::TxoValidationTask,
+        tasks::{TxoValidationMode, TxoValidationTask, ValidatedTip},
         TRANSACTION_INPUTS_LIMIT,
     },
 };
@@ -125,6 +130,9 @@ pub struct OutputManagerService<TBackend, TWalletConnectivity, TKeyManagerInterf
     base_node_service: BaseNodeServiceHandle,
     last_seen_tip_height: Option<u64>,
     validation_in_progress: Arc<Mutex<()>>,
+    last_validated_tip: Arc<std::sync::Mutex<Option<ValidatedTip>>>,
+    fee_estimate_cache: FeeEstimateCache,
+    one_sided_scan_keys: Option<Arc<OneSidedScanKeys>>,
 }
 
 impl<TBackend, TWalletConnectivity, TKeyManagerInterface>
@@ -166,6 +174,9 @@ where
             base_node_service,
             last_seen_tip_height: None,
             validation_in_progress: Arc::new(Mutex::new(())),
+            last_validated_tip: Arc::new(std::sync::Mutex::new(None)),
+            fee_estimate_cache: FeeEstimateCache::default(),
+            one_sided_scan_keys: None,
         })
     }
 
@@ -263,6 +274,13 @@ where
                 .add_unvalidated_output(tx_id, *uo, spend_priority)
                 .await
                 .map(|_| OutputManagerResponse::OutputAdded),
+            OutputManagerRequest::AddUnvalidatedOutputs(outputs) => self
+                .add_unvalidated_outputs(outputs)
+                .await
+                .map(OutputManagerResponse::OutputsAdded),
+            OutputManagerRequest::RemoveOutputs(commitments) => self
+                .remove_outputs(commitments)
+                .map(|_| OutputManagerResponse::OutputsRemoved),
             OutputManagerRequest::UpdateOutputMetadataSignature(uo) => self
                 .update_output_metadata_signature(*uo)
                 .map(|_| OutputManagerResponse::OutputMetadataSignatureUpdated),
@@ -346,9 +364,9 @@ where
                 let outputs = self.fetch_unspent_outputs()?;
                 Ok(OutputManagerResponse::UnspentOutputs(outputs))
             },
-            OutputManagerRequest::ValidateUtxos => {
-                self.validate_outputs().map(OutputManagerResponse::TxoValidationStarted)
-            },
+            OutputManagerRequest::ValidateUtxos => self
+                .validate_outputs(TxoValidationMode::Full)
+                .map(OutputManagerResponse::TxoValidationStarted),
             OutputManagerRequest::RevalidateTxos => self
                 .revalidate_outputs()
                 .map(OutputManagerResponse::TxoValidationStarted),
@@ -438,6 +456,20 @@ where
                     tx_id,
                 })
             },
+            OutputManagerRequest::CreateTransactionWithOutputs {
+                tx_id,
+                outputs,
+                fee_per_gram,
+                selection_criteria,
+            } => {
+                let (transaction, fee) = self
+                    .create_transaction_with_outputs(tx_id, outputs, selection_criteria, fee_per_gram)
+                    .await?;
+                Ok(OutputManagerResponse::TransactionWithOutputsCreated {
+                    transaction: Box::new(transaction),
+                    fee,
+                })
+            },
             OutputManagerRequest::CreateClaimShaAtomicSwapTransaction(output_hash, pre_image, fee_per_gram) => {
                 self.claim_sha_atomic_swap_with_hash(output_hash, pre_image, fee_per_gram)
                     .await
@@ -502,7 +534,7 @@ where
             },
             BaseNodeEvent::NewBlockDetected(_hash, height) => {
                 self.last_seen_tip_height = Some(height);
-                let _id = self.validate_outputs().map_err(|e| {
+                let _id = self.validate_outputs(TxoValidationMode::Incremental).map_err(|e| {
                     warn!(target: LOG_TARGET, "Error validating  txos: {:?}", e);
                     e
                 });
@@ -510,7 +542,7 @@ where
         }
     }
 
-    fn validate_outputs(&mut self) -> Result<u64, OutputManagerError> {
+    fn validate_outputs(&mut self, mode: TxoValidationMode) -> Result<u64, OutputManagerError> {
         let current_base_node = self
             .resources
             .connectivity
@@ -523,6 +555,8 @@ where
             self.resources.connectivity.clone(),
             self.resources.event_publisher.clone(),
             self.resources.config.clone(),
+            mode,
+            self.last_validated_tip.clone(),
         );
 
         let mut shutdown = self.resources.shutdown_signal.clone();
@@ -611,7 +645,7 @@ where
 
     fn revalidate_outputs(&mut self) -> Result<u64, OutputManagerError> {
         self.resources.db.set_outputs_to_be_revalidated()?;
-        self.validate_outputs()
+        self.validate_outputs(TxoValidationMode::Full)
     }
 
     /// Add a key manager recoverable output to the outputs table and mark it as `Unspent`.
@@ -672,7 +706,52 @@ where
         self.resources.db.add_unvalidated_output(tx_id, output)?;
 
         // Because we added new outputs, let try to trigger a validation for them
-        self.validate_outputs()?;
+        self.validate_outputs(TxoValidationMode::Incremental)?;
+        Ok(())
+    }
+
+    /// Add a batch of key manager outputs to the outputs table in the same state as `add_unvalidated_output`, all in
+    /// one database transaction. Outputs that are already in the wallet are skipped, the result indicates for each
+    /// output whether it was added.
+    pub async fn add_unvalidated_outputs(
+        &mut self,
+        outputs: Vec<(TxId, WalletOutput)>,
+    ) -> Result<Vec<bool>, OutputManagerError> {
+        debug!(
+            target: LOG_TARGET,
+            "Add {} unvalidated outputs to Output Manager",
+            outputs.len()
+        );
+        let mut db_outputs = Vec::with_capacity(outputs.len());
+        for (tx_id, output) in outputs {
+            let output = DbWalletOutput::from_wallet_output(
+                output,
+                &self.resources.key_manager,
+                None,
+                OutputSource::default(),
+                Some(tx_id),
+                None,
+            )
+            .await?;
+            db_outputs.push((tx_id, output));
+        }
+        let added = self.resources.db.add_unspent_outputs_with_tx_id(db_outputs)?;
+
+        if added.iter().any(|added| *added) {
+            self.validate_outputs(TxoValidationMode::Incremental)?;
+        }
+        Ok(added)
+    }
+
+    fn remove_outputs(&mut self, commitments: Vec<Commitment>) -> Result<(), OutputManagerError> {
+        debug!(
+            target: LOG_TARGET,
+            "Remove {} outputs from Output Manager",
+            commitments.len()
+        );
+        for commitment in commitments {
+            self.resources.db.remove_output_by_commitment(commitment)?;
+        }
         Ok(())
     }
 
@@ -827,7 +906,8 @@ where
     }
 
     /// Get a fee estimate for an amount of MicroMinotari, at a specified fee per gram and given number of kernels and
-    /// outputs.
+    /// outputs. Estimates are cached until the spendable outputs change, so repeated estimates in between, e.g. while
+    /// an amount is being typed, do not repeat the input selection.
     async fn fee_estimate(
         &mut self,
         amount: MicroMinotari,
@@ -844,34 +924,63 @@ where
             num_kernels,
             num_outputs
         );
-        // We assume that default OutputFeatures and PushPubKey TariScript is used
-        let features_and_scripts_byte_size = self
-            .resources
-            .consensus_constants
-            .transaction_weight_params()
-            .round_up_features_and_scripts_size(
-                OutputFeatures::default()
-                    .get_serialized_size()
-                    .map_err(|e| OutputManagerError::ConversionError(e.to_string()))? +
-                    TariScript::default()
-                        .get_serialized_size()
-                        .map_err(|e| OutputManagerError::ConversionError(e.to_string()))? +
-                    Covenant::new()
-                        .get_serialized_size()
-                        .map_err(|e| OutputManagerError::ConversionError(e.to_string()))?,
-            );
+        // Read the generation first, so an estimate made while the outputs change is never stored against the newer
+        // generation
+        let generation = self.resources.db.spendable_outputs_generation();
+        let tip_height = self
+            .base_node_service
+            .get_chain_metadata()
+            .await?
+            .map(|m| m.best_block_height());
+        let cache_key = FeeEstimateKey::new(
+            amount,
+            &selection_criteria,
+            fee_per_gram,
+            num_kernels,
+            num_outputs,
+            tip_height,
+        );
+        if let Some(key) = &cache_key {
+            if let Some(fee) = self.fee_estimate_cache.get(generation, key) {
+                trace!(target: LOG_TARGET, "Fee estimate {} served from cache", fee);
+                return Ok(fee);
+            }
+        }
 
-        let utxo_selection = match self
-            .select_utxos(
-                amount,
-                selection_criteria,
-                fee_per_gram,
-                num_outputs,
-                features_and_scripts_byte_size * num_outputs,
+        // Estimate for the top of the amount bucket, so the cached fee also covers the larger amounts in it
+        let estimate_amount = cache_key.as_ref().map_or(amount, |k| k.amount());
+        let mut result = self
+            .fee_estimate_from_selection(estimate_amount, selection_criteria.clone(), fee_per_gram, num_outputs)
+            .await;
+        // Without a change output the excess of the inputs is paid as fee, so that fee shrinks as the amount grows and
+        // is not an upper bound for the smaller amounts in the bucket. Only estimates that use change are cached.
+        let cacheable = matches!(result, Ok((_, true)));
+        if !cacheable &&
+            estimate_amount != amount &&
+            matches!(
+                result,
+                Ok(_) | Err(OutputManagerError::FundsPending | OutputManagerError::NotEnoughFunds)
             )
-            .await
         {
-            Ok(v) => Ok(v),
+            // The top of the bucket may also not be affordable even though the amount itself is. Either way the
+            // estimate for the amount itself only holds for this amount, so it is not cached.
+            result = self
+                .fee_estimate_from_selection(amount, selection_criteria, fee_per_gram, num_outputs)
+                .await;
+            if let Ok((fee, _)) = result {
+                debug!(target: LOG_TARGET, "Fee calculated: {}", fee);
+                return Ok(fee);
+            }
+        }
+
+        match result {
+            Ok((fee, _)) => {
+                if let Some(key) = cache_key.filter(|_| cacheable) {
+                    self.fee_estimate_cache.insert(generation, key, fee);
+                }
+                debug!(target: LOG_TARGET, "Fee calculated: {}", fee);
+                Ok(fee)
+            },
             Err(OutputManagerError::FundsPending | OutputManagerError::NotEnoughFunds) => {
                 debug!(
                     target: LOG_TARGET,
@@ -892,17 +1001,54 @@ where
                             .map_err(|e| OutputManagerError::ConversionError(e.to_string()))?,
                 );
                 let fee = fee_calc.calculate(fee_per_gram, 1, 1, num_outputs, default_features_and_scripts_size);
-                return Ok(Fee::normalize(fee));
+                Ok(Fee::normalize(fee))
             },
             Err(e) => Err(e),
-        }?;
+        }
+    }
 
-        debug!(target: LOG_TARGET, "{} utxos selected.", utxo_selection.utxos.len());
+    /// Estimate the fee of a transaction for `amount` from the inputs that would currently be selected for it, along
+    /// with whether that selection needs a change output
+    async fn fee_estimate_from_selection(
+        &mut self,
+        amount: MicroMinotari,
+        selection_criteria: UtxoSelectionCriteria,
+        fee_per_gram: MicroMinotari,
+        num_outputs: usize,
+    ) -> Result<(MicroMinotari, bool), OutputManagerError> {
+        // We assume that default OutputFeatures and PushPubKey TariScript is used
+        let features_and_scripts_byte_size = self
+            .resources
+            .consensus_constants
+            .transaction_weight_params()
+            .round_up_features_and_scripts_size(
+                OutputFeatures::default()
+                    .get_serialized_size()
+                    .map_err(|e| OutputManagerError::ConversionError(e.to_string()))? +
+                    TariScript::default()
+                        .get_serialized_size()
+                        .map_err(|e| OutputManagerError::ConversionError(e.to_string()))? +
+                    Covenant::new()
+                        .get_serialized_size()
+                        .map_err(|e| OutputManagerError::ConversionError(e.to_string()))?,
+            );
 
-        let fee = Fee::normalize(utxo_selection.as_final_fee());
+        let utxo_selection = self
+            .select_utxos(
+                amount,
+                selection_criteria,
+                fee_per_gram,
+                num_outputs,
+                features_and_scripts_byte_size * num_outputs,
+            )
+            .await?;
+
+        debug!(target: LOG_TARGET, "{} utxos selected.", utxo_selection.utxos.len());
 
-        debug!(target: LOG_TARGET, "Fee calculated: {}", fee);
-        Ok(fee)
+        Ok((
+            Fee::normalize(utxo_selection.as_final_fee()),
+            utxo_selection.requires_change_output(),
+        ))
     }
 
     /// Prepare a Sender Transaction Protocol for the amount and fee_per_gram specified. If required a change output
@@ -1031,7 +1177,6 @@ where
         Ok(stp)
     }
 
-    #[allow(clippy::too_many_lines)]
     async fn create_pay_to_self_containing_outputs(
         &mut self,
         outputs: Vec<WalletOutputBuilder>,
@@ -1040,65 +1185,26 @@ where
     ) -> Result<(TxId, Transaction), OutputManagerError> {
         let total_value = outputs.iter().map(|o| o.value()).sum();
         let nop_script = script![Nop];
-        let weighting = self.resources.consensus_constants.transaction_weight_params();
         let mut features_and_scripts_byte_size = 0;
         for output in &outputs {
-            let (features, covenant, script) = (
-                output
-                    .features()
-                    .get_serialized_size()
-                    .map_err(|e| OutputManagerError::ServiceError(e.to_string()))?,
-                output
-                    .covenant()
-                    .get_serialized_size()
-                    .map_err(|e| OutputManagerError::ServiceError(e.to_string()))?,
-                output
-                    .script()
-                    .unwrap_or(&nop_script)
-                    .get_serialized_size()
-                    .map_err(|e| OutputManagerError::ServiceError(e.to_string()))?,
-            );
-
-            features_and_scripts_byte_size += weighting.round_up_features_and_scripts_size(features + covenant + script)
+            features_and_scripts_byte_size += self.features_and_scripts_byte_size(
+                output.features(),
+                output.covenant(),
+                output.script().unwrap_or(&nop_script),
+            )?;
         }
 
-        let input_selection = self
-            .select_utxos(
+        // Create builder with no recipients (other than ourselves)
+        let (input_selection, mut builder) = self
+            .fund_outputs(
                 total_value,
-                selection_criteria,
-                fee_per_gram,
                 outputs.len(),
                 features_and_scripts_byte_size,
+                selection_criteria,
+                fee_per_gram,
             )
             .await?;
 
-        // Create builder with no recipients (other than ourselves)
-        let mut builder = SenderTransactionProtocol::builder(
-            self.resources.consensus_constants.clone(),
-            self.resources.key_manager.clone(),
-        );
-        builder
-            .with_lock_height(0)
-            .with_fee_per_gram(fee_per_gram)
-            .with_prevent_fee_gt_amount(false)
-            .with_kernel_features(KernelFeatures::empty());
-
-        for uo in input_selection.iter() {
-            builder.with_input(uo.wallet_output.clone()).await?;
-        }
-
-        if input_selection.requires_change_output() {
-            let (change_spending_key_id, _, change_script_key_id, change_script_public_key) =
-                self.resources.key_manager.get_next_spend_and_script_key_ids().await?;
-            builder.with_change_data(
-                script!(PushPubKey(Box::new(change_script_public_key))),
-                ExecutionStack::default(),
-                change_script_key_id,
-                change_spending_key_id,
-                Covenant::default(),
-            );
-        }
-
         let mut db_outputs = vec![];
         for mut wallet_output in outputs {
             let (sender_offset_key_id, _) = self
@@ -1133,8 +1239,147 @@ where
             .await
             .map_err(|e| OutputManagerError::BuildError(e.message))?;
         let tx_id = stp.get_tx_id()?;
-        if let Some(wallet_output) = stp.get_change_output()? {
-            db_outputs.push(
+        db_outputs.extend(self.change_output_for_storage(&stp, tx_id).await?);
+
+        self.resources
+            .db
+            .encumber_outputs(tx_id, input_selection.into_selected(), db_outputs)?;
+        stp.finalize(&self.resources.key_manager).await?;
+
+        Ok((tx_id, stp.into_transaction()?))
+    }
+
+    /// Create a transaction paying to a set of outputs that have already been built and signed by this wallet, such
+    /// as one-sided outputs to several recipients. The inputs are shared and at most one change output is added.
+    async fn create_transaction_with_outputs(
+        &mut self,
+        tx_id: TxId,
+        outputs: Vec<(WalletOutput, TariKeyId)>,
+        selection_criteria: UtxoSelectionCriteria,
+        fee_per_gram: MicroMinotari,
+    ) -> Result<(Transaction, MicroMinotari), OutputManagerError> {
+        let total_value = outputs.iter().map(|(o, _)| o.value).sum();
+        let mut features_and_scripts_byte_size = 0;
+        for (output, _) in &outputs {
+            features_and_scripts_byte_size +=
+                self.features_and_scripts_byte_size(&output.features, &output.covenant, &output.script)?;
+        }
+
+        let (input_selection, mut builder) = self
+            .fund_outputs(
+                total_value,
+                outputs.len(),
+                features_and_scripts_byte_size,
+                selection_criteria,
+                fee_per_gram,
+            )
+            .await?;
+        builder.with_tx_id(tx_id);
+        for (output, sender_offset_key_id) in outputs {
+            builder
+                .with_output(output, sender_offset_key_id)
+                .await
+                .map_err(|e| OutputManagerError::BuildError(e.to_string()))?;
+        }
+
+        let mut stp = builder
+            .build()
+            .await
+            .map_err(|e| OutputManagerError::BuildError(e.message))?;
+        // Only the change output belongs to this wallet
+        let change_output = self.change_output_for_storage(&stp, tx_id).await?.into_iter().collect();
+
+        self.resources
+            .db
+            .encumber_outputs(tx_id, input_selection.into_selected(), change_output)?;
+        self.confirm_encumberance(tx_id)?;
+        let fee = stp.get_fee_amount()?;
+        stp.finalize(&self.resources.key_manager).await?;
+
+        Ok((stp.into_transaction()?, fee))
+    }
+
+    /// The size of an output's features, covenant and script, rounded up as it is for the fee calculation
+    fn features_and_scripts_byte_size(
+        &self,
+        features: &OutputFeatures,
+        covenant: &Covenant,
+        script: &TariScript,
+    ) -> Result<usize, OutputManagerError> {
+        let size = features
+            .get_serialized_size()
+            .map_err(|e| OutputManagerError::ServiceError(e.to_string()))? +
+            covenant
+                .get_serialized_size()
+                .map_err(|e| OutputManagerError::ServiceError(e.to_string()))? +
+            script
+                .get_serialized_size()
+                .map_err(|e| OutputManagerError::ServiceError(e.to_string()))?;
+        Ok(self
+            .resources
+            .consensus_constants
+            .transaction_weight_params()
+            .round_up_features_and_scripts_size(size))
+    }
+
+    /// Selects the inputs that fund `num_outputs` outputs of this wallet worth `total_value`, and returns a builder
+    /// that spends them, with change data added when the selection needs a change output. The caller adds the
+    /// outputs.
+    async fn fund_outputs(
+        &mut self,
+        total_value: MicroMinotari,
+        num_outputs: usize,
+        features_and_scripts_byte_size: usize,
+        selection_criteria: UtxoSelectionCriteria,
+        fee_per_gram: MicroMinotari,
+    ) -> Result<(UtxoSelection, SenderTransactionInitializer<TKeyManagerInterface>), OutputManagerError> {
+        let input_selection = self
+            .select_utxos(
+                total_value,
+                selection_criteria,
+                fee_per_gram,
+                num_outputs,
+                features_and_scripts_byte_size,
+            )
+            .await?;
+
+        let mut builder = SenderTransactionProtocol::builder(
+            self.resources.consensus_constants.clone(),
+            self.resources.key_manager.clone(),
+        );
+        builder
+            .with_lock_height(0)
+            .with_fee_per_gram(fee_per_gram)
+            .with_prevent_fee_gt_amount(false)
+            .with_kernel_features(KernelFeatures::empty());
+
+        for uo in input_selection.iter() {
+            builder.with_input(uo.wallet_output.clone()).await?;
+        }
+
+        if input_selection.requires_change_output() {
+            let (change_spending_key_id, _, change_script_key_id, change_script_public_key) =
+                self.resources.key_manager.get_next_spend_and_script_key_ids().await?;
+            builder.with_change_data(
+                script!(PushPubKey(Box::new(change_script_public_key))),
+                ExecutionStack::default(),
+                change_script_key_id,
+                change_spending_key_id,
+                Covenant::default(),
+            );
+        }
+
+        Ok((input_selection, builder))
+    }
+
+    /// The change output of a built sender protocol, if it has one, ready to be stored with the transaction
+    async fn change_output_for_storage(
+        &self,
+        stp: &SenderTransactionProtocol,
+        tx_id: TxId,
+    ) -> Result<Option<DbWalletOutput>, OutputManagerError> {
+        match stp.get_change_output()? {
+            Some(wallet_output) => Ok(Some(
                 DbWalletOutput::from_wallet_output(
                     wallet_output,
                     &self.resources.key_manager,
@@ -1144,15 +1389,9 @@ where
                     None,
                 )
                 .await?,
-            );
+            )),
+            None => Ok(None),
         }
-
-        self.resources
-            .db
-            .encumber_outputs(tx_id, input_selection.into_selected(), db_outputs)?;
-        stp.finalize(&self.resources.key_manager).await?;
-
-        Ok((tx_id, stp.into_transaction()?))
     }
 
     /// Create a partial transaction in order to prepare output
@@ -1616,6 +1855,68 @@ where
         Ok(())
     }
 
+    /// Looks for a set of UTXOs that pays `amount` plus the fee without needing a change output, using as few inputs
+    /// as possible. Any excess is smaller than the cost of a change output and is added to the fee by the transaction
+    /// builder.
+    fn select_utxos_without_change(
+        fee_calc: &Fee,
+        uo: &[DbWalletOutput],
+        amount: MicroMinotari,
+        fee_per_gram: MicroMinotari,
+        num_outputs: usize,
+        total_output_features_and_scripts_byte_size: usize,
+        change_features_and_scripts_size: usize,
+    ) -> Option<UtxoSelection> {
+        // Outputs that must be spent first are left to the standard selection
+        if uo.iter().any(|o| o.spending_priority != SpendingPriority::Normal) {
+            return None;
+        }
+
+        // The fee grows linearly with the number of inputs, so each UTXO contributes its value less the fee of
+        // spending it
+        let input_fee = fee_calc.calculate(fee_per_gram, 0, 1, 0, 0);
+        let base_fee = fee_calc.calculate(
+            fee_per_gram,
+            1,
+            0,
+            num_outputs,
+            total_output_features_and_scripts_byte_size,
+        );
+        let change_fee = fee_calc.calculate(fee_per_gram, 0, 0, 1, change_features_and_scripts_size);
+        let mut candidates = uo
+            .iter()
+            .filter(|o| o.wallet_output.value > input_fee)
+            .map(|o| (o.wallet_output.value - input_fee, o))
+            .collect::<Vec<_>>();
+        candidates.sort_by_key(|(effective_value, _)| Reverse(*effective_value));
+        let effective_values = candidates.iter().map(|(v, _)| v.as_u64()).collect::<Vec<_>>();
+
+        let selected = select_without_change(
+            &effective_values,
+            (amount + base_fee).as_u64(),
+            change_fee.as_u64(),
+            TRANSACTION_INPUTS_LIMIT as usize,
+        )?;
+        let utxos = selected.iter().map(|i| candidates[*i].1.clone()).collect::<Vec<_>>();
+        let total_value = utxos.iter().map(|o| o.wallet_output.value).sum::<MicroMinotari>();
+        // The excess goes to the miner, so the fee actually paid is everything that is not sent
+        let fee_without_change = total_value - amount;
+        let fee_with_change = fee_calc.calculate(
+            fee_per_gram,
+            1,
+            utxos.len(),
+            num_outputs + 1,
+            total_output_features_and_scripts_byte_size + change_features_and_scripts_size,
+        );
+        Some(UtxoSelection {
+            utxos,
+            requires_change_output: false,
+            total_value,
+            fee_without_change,
+            fee_with_change,
+        })
+    }
+
     /// Select which unspent transaction outputs to use to send a transaction of the specified amount. Use the specified
     /// selection strategy to choose the outputs. It also determines if a change output is required.
     #[allow(clippy::too_many_lines)]
@@ -1693,6 +1994,28 @@ where
 
         trace!(target: LOG_TARGET, "We found {} UTXOs to select from", uo_len);
 
+        if selection_criteria.filter.is_standard() && selection_criteria.ordering == UtxoSelectionOrdering::Default {
+            if let Some(selection) = Self::select_utxos_without_change(
+                &fee_calc,
+                &uo,
+                amount,
+                fee_per_gram,
+                num_outputs,
+                total_output_features_and_scripts_byte_size,
+                default_features_and_scripts_size,
+            ) {
+                trace!(
+                    target: LOG_TARGET,
+                    "select_utxos profile - selection without change: {} outputs from {}, {} ms (at {} ms)",
+                    selection.utxos.len(),
+                    uo_len,
+                    start_new.elapsed().as_millis(),
+                    start.elapsed().as_millis(),
+                );
+                return Ok(selection);
+            }
+        }
+
         let mut requires_change_output = false;
         let mut utxos_total_value = MicroMinotari::from(0);
         let mut fee_without_change = MicroMinotari::from(0);
@@ -2634,6 +2957,7 @@ where
     /// Persist a one-sided payment script for a Comms Public/Private key. These are the scripts that this wallet knows
     /// to look for when scanning for one-sided payments
     fn add_known_script(&mut self, known_script: KnownOneSidedPaymentScript) -> Result<(), OutputManagerError> {
+        self.one_sided_scan_keys = None;
         debug!(target: LOG_TARGET, "Adding new script to output manager service");
         // It is not a problem if the script has already been persisted
         match self.resources.db.add_known_script(known_script) {
@@ -2657,75 +2981,100 @@ where
         &mut self,
         outputs: Vec<TransactionOutput>,
     ) -> Result<Vec<RecoveredOutput>, OutputManagerError> {
-        let mut known_keys = Vec::new();
+        // Only outputs locked to a single public key can be one-sided payments
+        let outputs = outputs
+            .into_iter()
+            .filter(|output| matches!(output.script.as_slice(), [Opcode::PushPubKey(_)]))
+            .collect::<Vec<_>>();
+        if outputs.is_empty() {
+            return Ok(Vec::new());
+        }
+
+        let scan_keys = self.get_one_sided_scan_keys().await?;
+        let key_manager = self.resources.key_manager.clone();
+        let scanned_outputs = parallel_chunk_map(outputs, move |chunk| {
+            Self::scan_outputs_chunk_for_one_sided_payments(key_manager.clone(), scan_keys.clone(), chunk)
+        })
+        .await?;
+
+        self.import_onesided_outputs(scanned_outputs).await
+    }
+
+    /// Returns the keys one-sided payments are matched against, looking them up only after they have changed
+    async fn get_one_sided_scan_keys(&mut self) -> Result<Arc<OneSidedScanKeys>, OutputManagerError> {
+        if let Some(scan_keys) = &self.one_sided_scan_keys {
+            return Ok(scan_keys.clone());
+        }
+
+        let mut known_keys = HashMap::new();
         let known_scripts = self.resources.db.get_all_known_one_sided_payment_scripts()?;
         for known_script in known_scripts {
-            known_keys.push((
-                self.resources
-                    .key_manager
-                    .get_public_key_at_key_id(&known_script.script_key_id)
-                    .await?,
-                known_script.script_key_id.clone(),
-            ));
+            let public_key = self
+                .resources
+                .key_manager
+                .get_public_key_at_key_id(&known_script.script_key_id)
+                .await?;
+            known_keys.insert(public_key, known_script.script_key_id);
         }
-
         let (wallet_sk, wallet_pk) = self.resources.key_manager.get_spend_key().await?;
         let (wallet_view_key, _) = self.resources.key_manager.get_view_key().await?;
 
-        let mut scanned_outputs = vec![];
-
-        for output in outputs {
-            if let [Opcode::PushPubKey(scanned_pk)] = output.script.as_slice() {
-                if let Some(matched_key) = known_keys.iter().find(|x| &x.0 == scanned_pk.as_ref()) {
-                    let shared_secret = self
-                        .resources
-                        .key_manager
-                        .get_diffie_hellman_shared_secret(&wallet_view_key, &output.sender_offset_public_key)
-                        .await?;
-                    scanned_outputs.push((
-                        output.clone(),
-                        OutputSource::OneSided,
-                        matched_key.1.clone(),
-                        shared_secret,
-                    ));
-                }
-                // it is not some known key, so lets try and see if this is a stealth tx for us
-                else {
-                    let stealth_address_hasher = self
-                        .resources
-                        .key_manager
-                        .get_diffie_hellman_stealth_domain_hasher(&wallet_view_key, &output.sender_offset_public_key)
-                        .await?;
-                    let script_spending_key = stealth_address_script_spending_key(&stealth_address_hasher, &wallet_pk);
-                    if &script_spending_key != scanned_pk.as_ref() {
-                        continue;
-                    }
+        let scan_keys = Arc::new(OneSidedScanKeys {
+            known_keys,
+            wallet_sk,
+            wallet_pk,
+            wallet_view_key,
+        });
+        self.one_sided_scan_keys = Some(scan_keys.clone());
+        Ok(scan_keys)
+    }
 
-                    // Compute the stealth address offset
-                    let stealth_address_offset = PrivateKey::from_uniform_bytes(stealth_address_hasher.as_ref())
-                        .expect("'DomainSeparatedHash<Blake2b<U64>>' has correct size");
-                    let stealth_key = self
-                        .resources
-                        .key_manager
-                        .import_add_offset_to_private_key(&wallet_sk, stealth_address_offset)
-                        .await?;
-
-                    let shared_secret = self
-                        .resources
-                        .key_manager
-                        .get_diffie_hellman_shared_secret(&wallet_view_key, &output.sender_offset_public_key)
-                        .await?;
-                    scanned_outputs.push((
-                        output.clone(),
-                        OutputSource::StealthOneSided,
-                        stealth_key,
-                        shared_secret,
-                    ));
-                }
+    /// Checks whether each output is a one-sided or stealth one-sided payment to this wallet. The Diffie-Hellman shared
+    /// secrets of the whole chunk are computed in a single call to the key manager, and each one is used both to
+    /// derive the stealth address and to decrypt the output.
+    async fn scan_outputs_chunk_for_one_sided_payments(
+        key_manager: TKeyManagerInterface,
+        scan_keys: Arc<OneSidedScanKeys>,
+        outputs: Vec<TransactionOutput>,
+    ) -> Result<Vec<(TransactionOutput, OutputSource, TariKeyId, CommsDHKE)>, OutputManagerError> {
+        let sender_offset_public_keys = outputs
+            .iter()
+            .map(|output| output.sender_offset_public_key.clone())
+            .collect::<Vec<_>>();
+        let shared_secrets = key_manager
+            .get_diffie_hellman_shared_secrets_with_stealth_hashers(
+                &scan_keys.wallet_view_key,
+                &sender_offset_public_keys,
+            )
+            .await?;
+
+        let mut scanned_outputs = Vec::new();
+        for (output, (shared_secret, stealth_address_hasher)) in outputs.into_iter().zip(shared_secrets) {
+            let scanned_pk = match output.script.as_slice() {
+                [Opcode::PushPubKey(scanned_pk)] => scanned_pk.clone(),
+                _ => continue,
+            };
+            if let Some(script_key_id) = scan_keys.known_keys.get(scanned_pk.as_ref()) {
+                scanned_outputs.push((output, OutputSource::OneSided, script_key_id.clone(), shared_secret));
+                continue;
             }
-        }
 
-        self.import_onesided_outputs(scanned_outputs).await
+            // it is not some known key, so lets try and see if this is a stealth tx for us
+            let script_spending_key =
+                stealth_address_script_spending_key(&stealth_address_hasher, &scan_keys.wallet_pk);
+            if &script_spending_key != scanned_pk.as_ref() {
+                continue;
+            }
+
+            // Compute the stealth address offset
+            let stealth_address_offset = PrivateKey::from_uniform_bytes(stealth_address_hasher.as_ref())
+                .expect("'DomainSeparatedHash<Blake2b<U64>>' has correct size");
+            let stealth_key = key_manager
+                .import_add_offset_to_private_key(&scan_keys.wallet_sk, stealth_address_offset)
+                .await?;
+            scanned_outputs.push((output, OutputSource::StealthOneSided, stealth_key, shared_secret));
+        }
+        Ok(scanned_outputs)
     }
 
     // Import scanned outputs into the wallet
@@ -2734,6 +3083,7 @@ where
         scanned_outputs: Vec<(TransactionOutput, OutputSource, TariKeyId, CommsDHKE)>,
     ) -> Result<Vec<RecoveredOutput>, OutputManagerError> {
         let mut rewound_outputs = Vec::with_capacity(scanned_outputs.len());
+        let mut db_outputs = Vec::with_capacity(scanned_outputs.len());
 
         for (output, output_source, script_private_key, shared_secret) in scanned_outputs {
             let encryption_key = shared_secret_to_output_encryption_key(&shared_secret)?;
@@ -2775,37 +3125,41 @@ where
                         None,
                     )
                     .await?;
-
-                    match self.resources.db.add_unspent_output_with_tx_id(tx_id, db_output) {
-                        Ok(_) => {
-                            trace!(
-                                target: LOG_TARGET,
-                                "One-sided payment Output {} with value {} recovered",
-                                output.commitment.to_hex(),
-                                committed_value,
-                            );
-
-                            rewound_outputs.push(RecoveredOutput {
-                                output: rewound_output,
-                                tx_id,
-                                hash,
-                            })
-                        },
-                        Err(OutputManagerStorageError::DuplicateOutput) => {
-                            warn!(
-                                target: LOG_TARGET,
-                                "Attempt to add scanned output {} that already exists. Ignoring the output.",
-                                output.commitment.to_hex()
-                            );
-                        },
-                        Err(err) => {
-                            return Err(err.into());
-                        },
-                    }
+                    db_outputs.push((tx_id, db_output));
+                    rewound_outputs.push(RecoveredOutput {
+                        output: rewound_output,
+                        tx_id,
+                        hash,
+                    });
                 }
             }
         }
 
+        // All the outputs are written in one database transaction, outputs that are already known are skipped
+        let added = self.resources.db.add_unspent_outputs_with_tx_id(db_outputs)?;
+        let rewound_outputs = rewound_outputs
+            .into_iter()
+            .zip(added)
+            .filter_map(|(recovered, added)| {
+                if added {
+                    trace!(
+                        target: LOG_TARGET,
+                        "One-sided payment Output with hash {} with value {} recovered",
+                        recovered.hash.to_hex(),
+                        recovered.output.value,
+                    );
+                    Some(recovered)
+                } else {
+                    warn!(
+                        target: LOG_TARGET,
+                        "Attempt to add scanned output with hash {} that already exists. Ignoring the output.",
+                        recovered.hash.to_hex()
+                    );
+                    None
+                }
+            })
+            .collect();
+
         Ok(rewound_outputs)
     }
 
@@ -2858,6 +3212,15 @@ impl fmt::Display for Balance {
     }
 }
 
+/// The wallet keys one-sided payments are matched against
+struct OneSidedScanKeys {
+    /// The public keys of the known one-sided payment scripts, mapped to their script key ids
+    known_keys: HashMap<PublicKey, TariKeyId>,
+    wallet_sk: TariKeyId,
+    wallet_pk: PublicKey,
+    wallet_view_key: TariKeyId,
+}
+
 #[derive(Debug, Clone)]
 struct UtxoSelection {
     utxos: Vec<DbWalletOutput>,
@@ -12,7 +12,7 @@ use crate::output_manager_service::{
     input_selection::UtxoSelectionCriteria,
     service::Balance,
     storage::{
-        database::{DbKey, DbValue, OutputBackendQuery, WriteOperation},
+        database::{DbKey, DbValue, OutputBackendQuery, OutputsPage, WriteOperation},
         models::DbWalletOutput,
         sqlite_db::{ReceivedOutputInfoForBatch, SpentOutputInfoForBatch},
     },
@@ -31,6 +31,12 @@ pub trait OutputManagerBackend: Send + Sync + Clone {
     fn fetch_sorted_unspent_outputs(&self) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError>;
     /// Retrieve outputs that have been mined but not spent yet (have not been deleted)
     fn fetch_mined_unspent_outputs(&self) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError>;
+    /// Retrieve the mined but not yet spent outputs that can still change state: those with a pending or unconfirmed
+    /// spend, and those mined after `settled_height`
+    fn fetch_unsettled_mined_unspent_outputs(
+        &self,
+        settled_height: u64,
+    ) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError>;
     /// Retrieve outputs that are invalid
     fn fetch_invalid_outputs(&self, timestamp: i64) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError>;
     /// Retrieve outputs that have not been found or confirmed in the block chain yet
@@ -84,6 +90,12 @@ pub trait OutputManagerBackend: Send + Sync + Clone {
     fn reinstate_cancelled_inbound_output(&self, tx_id: TxId) -> Result<(), OutputManagerStorageError>;
     /// Return the available, time locked, pending incoming and pending outgoing balance
     fn get_balance(&self, tip: Option<u64>) -> Result<Balance, OutputManagerStorageError>;
+    /// Add unspent outputs, each with its own TxId, in a single database transaction. Outputs that are already in the
+    /// database are skipped, the result indicates for each output whether it was added.
+    fn add_unspent_outputs_with_tx_id(
+        &self,
+        outputs: Vec<(TxId, DbWalletOutput)>,
+    ) -> Result<Vec<bool>, OutputManagerStorageError>;
     /// Import unvalidated output
     fn add_unvalidated_output(&self, output: DbWalletOutput, tx_id: TxId) -> Result<(), OutputManagerStorageError>;
     fn fetch_unspent_outputs_for_spending(
@@ -92,6 +104,10 @@ pub trait OutputManagerBackend: Send + Sync + Clone {
         amount: u64,
         current_tip_height: Option<u64>,
     ) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError>;
+    /// A counter that changes whenever the set of outputs available for spending may have changed
+    fn spendable_outputs_generation(&self) -> u64;
     fn fetch_outputs_by_tx_id(&self, tx_id: TxId) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError>;
     fn fetch_outputs_by_query(&self, q: OutputBackendQuery) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError>;
+    /// Same as `fetch_outputs_by_query`, but also returns the keyset cursor of the last row to resume from
+    fn fetch_outputs_page_by_query(&self, q: OutputBackendQuery) -> Result<OutputsPage, OutputManagerStorageError>;
 }
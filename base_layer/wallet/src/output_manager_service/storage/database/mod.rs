@@ -66,6 +66,9 @@ pub struct OutputBackendQuery {
     pub value_min: Option<(i64, bool)>,
     pub value_max: Option<(i64, bool)>,
     pub sorting: Vec<(&'static str, SortDirection)>,
+    /// If set, resume after this position instead of skipping `pagination.0` rows. Only the first sort key is used
+    /// together with the row id as a tie breaker.
+    pub cursor: Option<OutputQueryCursor>,
 }
 
 impl Default for OutputBackendQuery {
@@ -78,10 +81,27 @@ impl Default for OutputBackendQuery {
             value_min: None,
             value_max: None,
             sorting: vec![],
+            cursor: None,
         }
     }
 }
 
+/// A keyset pagination position, i.e. the `(sort_key, id)` pair of the last row that was returned. `sort_key` is
+/// `None` when the output has no value for the sort column (e.g. an unmined output sorted by `mined_height`).
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct OutputQueryCursor {
+    pub sort_key: Option<i64>,
+    pub id: i32,
+}
+
+/// A page of outputs returned by a keyset query, with the cursor to pass in to fetch the following page. The cursor is
+/// `None` when the page was empty.
+#[derive(Debug, Clone)]
+pub struct OutputsPage {
+    pub outputs: Vec<DbWalletOutput>,
+    pub next_cursor: Option<OutputQueryCursor>,
+}
+
 #[derive(Debug, Clone, PartialEq)]
 pub enum DbKey {
     SpentOutput(String),
@@ -157,6 +177,15 @@ where T: OutputManagerBackend + 'static
         Ok(())
     }
 
+    /// Add a batch of unspent outputs in one database transaction, duplicate outputs are skipped. Returns whether each
+    /// output was added.
+    pub fn add_unspent_outputs_with_tx_id(
+        &self,
+        outputs: Vec<(TxId, DbWalletOutput)>,
+    ) -> Result<Vec<bool>, OutputManagerStorageError> {
+        self.db.add_unspent_outputs_with_tx_id(outputs)
+    }
+
     pub fn add_unvalidated_output(&self, tx_id: TxId, output: DbWalletOutput) -> Result<(), OutputManagerStorageError> {
         self.db.add_unvalidated_output(output, tx_id)?;
 
@@ -249,6 +278,12 @@ where T: OutputManagerBackend + 'static
         Ok(utxos)
     }
 
+    /// Returns a counter that changes whenever the set of outputs available for spending may have changed, so that
+    /// results derived from them can be cached until it does.
+    pub fn spendable_outputs_generation(&self) -> u64 {
+        self.db.spendable_outputs_generation()
+    }
+
     pub fn fetch_spent_outputs(&self) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
         let uo = match self.db.fetch(&DbKey::SpentOutputs) {
             Ok(None) => log_error(
@@ -278,6 +313,14 @@ where T: OutputManagerBackend + 'static
         Ok(utxos)
     }
 
+    pub fn fetch_unsettled_mined_unspent_outputs(
+        &self,
+        settled_height: u64,
+    ) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
+        let utxos = self.db.fetch_unsettled_mined_unspent_outputs(settled_height)?;
+        Ok(utxos)
+    }
+
     pub fn fetch_invalid_outputs(&self, timestamp: i64) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
         let utxos = self.db.fetch_invalid_outputs(timestamp)?;
         Ok(utxos)
@@ -437,6 +480,10 @@ where T: OutputManagerBackend + 'static
     ) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
         self.db.fetch_outputs_by_query(q)
     }
+
+    pub fn fetch_outputs_page_by_query(&self, q: OutputBackendQuery) -> Result<OutputsPage, OutputManagerStorageError> {
+        self.db.fetch_outputs_page_by_query(q)
+    }
 }
 
 fn unexpected_result<T>(req: DbKey, res: DbValue) -> Result<T, OutputManagerStorageError> {
@@ -24,6 +24,7 @@ pub mod database;
 pub mod models;
 pub mod output_source;
 pub mod output_status;
+pub mod spendable_index;
 
 // converting between unsigned and signed is okay here as we do it both ways
 #[allow(clippy::cast_possible_wrap)]
@@ -0,0 +1,201 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::cmp::{max, Reverse};
+
+use tari_common_types::types::Commitment;
+use tari_core::transactions::transaction_components::OutputType;
+
+use crate::output_manager_service::{
+    input_selection::UtxoSelectionMode,
+    storage::{models::DbWalletOutput, OutputSource},
+    UtxoSelectionCriteria,
+    UtxoSelectionFilter,
+    UtxoSelectionOrdering,
+    TRANSACTION_INPUTS_LIMIT,
+};
+
+/// An in-memory index of the `Unspent` outputs of the wallet, used to select outputs for spending without querying the
+/// database. Outputs that can be spent at the indexed tip height are kept sorted by value, time locked outputs are kept
+/// sorted by the height at which they unlock and are moved over as the tip advances.
+#[derive(Debug, Clone, Default)]
+pub struct SpendableOutputIndex {
+    tip_height: u64,
+    spendable: Vec<DbWalletOutput>,
+    time_locked: Vec<DbWalletOutput>,
+}
+
+impl SpendableOutputIndex {
+    pub fn new(outputs: Vec<DbWalletOutput>, tip_height: u64) -> Self {
+        let (mut spendable, mut time_locked): (Vec<_>, Vec<_>) =
+            outputs.into_iter().partition(|o| unlock_height(o) <= tip_height);
+        spendable.sort_by_key(|o| o.wallet_output.value);
+        time_locked.sort_by_key(unlock_height);
+        Self {
+            tip_height,
+            spendable,
+            time_locked,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.spendable.len() + self.time_locked.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Moves outputs between the spendable and time locked partitions so that they reflect `tip_height`
+    pub fn set_tip_height(&mut self, tip_height: u64) {
+        if tip_height > self.tip_height {
+            let num_unlocked = self.time_locked.partition_point(|o| unlock_height(o) <= tip_height);
+            for output in self.time_locked.drain(..num_unlocked) {
+                let pos = self
+                    .spendable
+                    .partition_point(|o| o.wallet_output.value <= output.wallet_output.value);
+                self.spendable.insert(pos, output);
+            }
+        } else if tip_height < self.tip_height {
+            // A reorg, this is rare so the partitions are simply rebuilt
+            let (spendable, locked): (Vec<_>, Vec<_>) =
+                self.spendable.drain(..).partition(|o| unlock_height(o) <= tip_height);
+            self.spendable = spendable;
+            self.time_locked.extend(locked);
+            self.time_locked.sort_by_key(unlock_height);
+        }
+        self.tip_height = tip_height;
+    }
+
+    /// Removes outputs that are no longer `Unspent`
+    pub fn remove(&mut self, commitments: &[Commitment]) {
+        self.spendable.retain(|o| !commitments.contains(&o.commitment));
+        self.time_locked.retain(|o| !commitments.contains(&o.commitment));
+    }
+
+    /// Adds an `Unspent` output that is not indexed yet to the partition it belongs in at the indexed tip height
+    fn insert(&mut self, output: DbWalletOutput) {
+        let height = unlock_height(&output);
+        if height <= self.tip_height {
+            let pos = self
+                .spendable
+                .partition_point(|o| o.wallet_output.value <= output.wallet_output.value);
+            self.spendable.insert(pos, output);
+        } else {
+            let pos = self.time_locked.partition_point(|o| unlock_height(o) <= height);
+            self.time_locked.insert(pos, output);
+        }
+    }
+
+    /// Brings the entries for `commitments` up to date after they changed in the database, where `unspent` holds the
+    /// ones among them that are now `Unspent`. Returns whether the indexed outputs changed.
+    pub fn update(&mut self, commitments: &[Commitment], unspent: Vec<DbWalletOutput>) -> bool {
+        let len = self.len();
+        self.remove(commitments);
+        let changed = self.len() != len || !unspent.is_empty();
+        for output in unspent {
+            self.insert(output);
+        }
+        changed
+    }
+
+    /// Returns the outputs that `OutputSql::fetch_unspent_outputs_for_spending` would return for the same arguments:
+    /// filtered by the selection criteria, sorted by spending priority and then by value in the order given by the
+    /// criteria, and limited to `TRANSACTION_INPUTS_LIMIT` outputs.
+    pub fn select(
+        &mut self,
+        selection_criteria: &UtxoSelectionCriteria,
+        amount: u64,
+        tip_height: Option<u64>,
+    ) -> Vec<DbWalletOutput> {
+        // Without a tip height no output is considered time locked. The partitions are left at the last known tip
+        // height in that case, so that alternating between a known and an unknown tip does not repartition the index.
+        let time_locked = match tip_height {
+            Some(tip_height) => {
+                self.set_tip_height(tip_height);
+                // Safe mode only considers outputs that are not time locked
+                match selection_criteria.mode {
+                    UtxoSelectionMode::Safe => &[][..],
+                    _ => &self.time_locked[..],
+                }
+            },
+            None => &self.time_locked[..],
+        };
+
+        let descending = match selection_criteria.ordering {
+            UtxoSelectionOrdering::SmallestFirst => false,
+            UtxoSelectionOrdering::LargestFirst => true,
+            // Reduce the number of inputs if the amount is larger than the largest output, otherwise use the smaller
+            // outputs to make up the amount
+            UtxoSelectionOrdering::Default => self
+                .spendable
+                .last()
+                .into_iter()
+                .chain(time_locked)
+                .map(|o| o.wallet_output.value.as_u64())
+                .max()
+                .map_or(false, |largest| amount > largest),
+        };
+
+        let mut selected = self
+            .spendable
+            .iter()
+            .chain(time_locked)
+            .filter(|o| o.wallet_output.value.as_u64() > selection_criteria.min_dust)
+            .filter(|o| match &selection_criteria.filter {
+                UtxoSelectionFilter::Standard => {
+                    matches!(
+                        o.wallet_output.features.output_type,
+                        OutputType::Standard | OutputType::Coinbase
+                    ) && !(selection_criteria.excluding_onesided && o.source == OutputSource::OneSided)
+                },
+                UtxoSelectionFilter::SpecificOutputs { commitments } => {
+                    commitments.is_empty() || commitments.contains(&o.commitment)
+                },
+            })
+            .filter(|o| !selection_criteria.excluding.contains(&o.commitment))
+            .collect::<Vec<_>>();
+
+        // The spendable partition is already sorted by value, so this is close to linear
+        if descending {
+            selected.sort_by_key(|o| (Reverse(priority(o)), Reverse(o.wallet_output.value)));
+        } else {
+            selected.sort_by_key(|o| (Reverse(priority(o)), o.wallet_output.value));
+        }
+        selected
+            .into_iter()
+            .take(TRANSACTION_INPUTS_LIMIT as usize)
+            .cloned()
+            .collect()
+    }
+}
+
+fn unlock_height(output: &DbWalletOutput) -> u64 {
+    max(
+        output.wallet_output.features.maturity,
+        output.wallet_output.script_lock_height,
+    )
+}
+
+fn priority(output: &DbWalletOutput) -> i32 {
+    i32::from(output.spending_priority.clone())
+}
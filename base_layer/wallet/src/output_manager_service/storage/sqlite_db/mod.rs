@@ -20,7 +20,15 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-use std::{convert::TryFrom, str::FromStr};
+use std::{
+    convert::TryFrom,
+    str::FromStr,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc,
+        Mutex,
+    },
+};
 
 use chrono::{NaiveDateTime, Utc};
 use derivative::Derivative;
@@ -51,8 +59,17 @@ use crate::{
         error::OutputManagerStorageError,
         service::Balance,
         storage::{
-            database::{DbKey, DbKeyValuePair, DbValue, OutputBackendQuery, OutputManagerBackend, WriteOperation},
+            database::{
+                DbKey,
+                DbKeyValuePair,
+                DbValue,
+                OutputBackendQuery,
+                OutputManagerBackend,
+                OutputsPage,
+                WriteOperation,
+            },
             models::{DbWalletOutput, KnownOneSidedPaymentScript},
+            spendable_index::SpendableOutputIndex,
             OutputStatus,
         },
         UtxoSelectionCriteria,
@@ -66,14 +83,46 @@ mod output_sql;
 const LOG_TARGET: &str = "wallet::output_manager_service::database::wallet";
 
 /// A Sqlite backend for the Output Manager Service. The Backend is accessed via a connection pool to the Sqlite file.
+/// The `Unspent` outputs are also kept in an in-memory index that is used to select outputs for spending, it is built
+/// on first use and updated with the outputs each write touches. Bulk changes that cannot be tracked that way drop it
+/// instead. Every change to the spendable outputs also bumps the spendable outputs generation, which lets callers cache
+/// results derived from the spendable outputs.
 #[derive(Clone)]
 pub struct OutputManagerSqliteDatabase {
     database_connection: WalletDbConnection,
+    spendable_index: Arc<Mutex<Option<SpendableOutputIndex>>>,
+    spendable_generation: Arc<AtomicU64>,
 }
 
 impl OutputManagerSqliteDatabase {
     pub fn new(database_connection: WalletDbConnection) -> Self {
-        Self { database_connection }
+        Self {
+            database_connection,
+            spendable_index: Arc::new(Mutex::new(None)),
+            spendable_generation: Arc::new(AtomicU64::new(0)),
+        }
+    }
+
+    /// The returned guard drops the spendable output index when it goes out of scope. Methods that change outputs
+    /// take it before anything else, so the index is only dropped once their changes are committed and can never be
+    /// rebuilt from a state that predates them.
+    fn invalidate_spendable_index_on_drop(&self) -> InvalidateSpendableIndex {
+        InvalidateSpendableIndex {
+            index: self.spendable_index.clone(),
+            generation: self.spendable_generation.clone(),
+        }
+    }
+
+    /// The returned guard updates the spendable output index with the current state of the `touched` outputs when it
+    /// goes out of scope, so like `invalidate_spendable_index_on_drop` it only reads them once the changes of the
+    /// method that took it are committed.
+    fn update_spendable_index_on_drop(&self, touched: TouchedOutputs) -> UpdateSpendableIndex {
+        UpdateSpendableIndex {
+            database_connection: self.database_connection.clone(),
+            index: self.spendable_index.clone(),
+            generation: self.spendable_generation.clone(),
+            touched,
+        }
     }
 
     fn insert(
@@ -171,56 +220,36 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
             },
             DbKey::OutputsByTxIdAndStatus(tx_id, status) => {
                 let outputs = OutputSql::find_by_tx_id_and_status(*tx_id, *status, &mut conn)?;
+                drop(conn);
 
-                Some(DbValue::AnyOutputs(
-                    outputs
-                        .iter()
-                        .map(|o| o.clone().to_db_wallet_output())
-                        .collect::<Result<Vec<_>, _>>()?,
-                ))
+                Some(DbValue::AnyOutputs(OutputSql::to_db_wallet_outputs(outputs)?))
             },
             DbKey::UnspentOutputs => {
                 let outputs = OutputSql::index_status(
                     vec![OutputStatus::Unspent, OutputStatus::UnspentMinedUnconfirmed],
                     &mut conn,
                 )?;
+                drop(conn);
 
-                Some(DbValue::UnspentOutputs(
-                    outputs
-                        .iter()
-                        .map(|o| o.clone().to_db_wallet_output())
-                        .collect::<Result<Vec<_>, _>>()?,
-                ))
+                Some(DbValue::UnspentOutputs(OutputSql::to_db_wallet_outputs(outputs)?))
             },
             DbKey::SpentOutputs => {
                 let outputs = OutputSql::index_status(vec![OutputStatus::Spent], &mut conn)?;
+                drop(conn);
 
-                Some(DbValue::SpentOutputs(
-                    outputs
-                        .iter()
-                        .map(|o| o.clone().to_db_wallet_output())
-                        .collect::<Result<Vec<_>, _>>()?,
-                ))
+                Some(DbValue::SpentOutputs(OutputSql::to_db_wallet_outputs(outputs)?))
             },
             DbKey::TimeLockedUnspentOutputs(tip) => {
                 let outputs = OutputSql::index_time_locked(*tip, &mut conn)?;
+                drop(conn);
 
-                Some(DbValue::UnspentOutputs(
-                    outputs
-                        .iter()
-                        .map(|o| o.clone().to_db_wallet_output())
-                        .collect::<Result<Vec<_>, _>>()?,
-                ))
+                Some(DbValue::UnspentOutputs(OutputSql::to_db_wallet_outputs(outputs)?))
             },
             DbKey::InvalidOutputs => {
                 let outputs = OutputSql::index_status(vec![OutputStatus::Invalid], &mut conn)?;
+                drop(conn);
 
-                Some(DbValue::InvalidOutputs(
-                    outputs
-                        .iter()
-                        .map(|o| o.clone().to_db_wallet_output())
-                        .collect::<Result<Vec<_>, _>>()?,
-                ))
+                Some(DbValue::InvalidOutputs(OutputSql::to_db_wallet_outputs(outputs)?))
             },
             DbKey::KnownOneSidedPaymentScripts => {
                 let known_one_sided_payment_scripts = KnownOneSidedPaymentScriptSql::index(&mut conn)?;
@@ -250,21 +279,17 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     fn fetch_with_features(&self, output_type: OutputType) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
         let mut conn = self.database_connection.get_pooled_connection()?;
         let outputs = OutputSql::index_by_output_type(output_type, &mut conn)?;
+        drop(conn);
 
-        outputs
-            .iter()
-            .map(|o| o.clone().to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        OutputSql::to_db_wallet_outputs(outputs)
     }
 
     fn fetch_sorted_unspent_outputs(&self) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
         let mut conn = self.database_connection.get_pooled_connection()?;
         let outputs = OutputSql::index_unspent(&mut conn)?;
+        drop(conn);
 
-        outputs
-            .into_iter()
-            .map(|o| o.to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        OutputSql::to_db_wallet_outputs(outputs)
     }
 
     fn fetch_mined_unspent_outputs(&self) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
@@ -272,6 +297,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
         let outputs = OutputSql::index_marked_deleted_in_block_is_null(&mut conn)?;
+        drop(conn);
 
         if start.elapsed().as_millis() > 0 {
             trace!(
@@ -283,10 +309,30 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
             );
         }
 
-        outputs
-            .into_iter()
-            .map(|o| o.to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        OutputSql::to_db_wallet_outputs(outputs)
+    }
+
+    fn fetch_unsettled_mined_unspent_outputs(
+        &self,
+        settled_height: u64,
+    ) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
+        let start = Instant::now();
+        let mut conn = self.database_connection.get_pooled_connection()?;
+        let acquire_lock = start.elapsed();
+        let outputs = OutputSql::index_unsettled_marked_deleted_in_block_is_null(settled_height, &mut conn)?;
+        drop(conn);
+
+        if start.elapsed().as_millis() > 0 {
+            trace!(
+                target: LOG_TARGET,
+                "sqlite profile - fetch_unsettled_mined_unspent_outputs: lock {} + db_op {} = {} ms",
+                acquire_lock.as_millis(),
+                (start.elapsed() - acquire_lock).as_millis(),
+                start.elapsed().as_millis()
+            );
+        }
+
+        OutputSql::to_db_wallet_outputs(outputs)
     }
 
     fn fetch_invalid_outputs(&self, timestamp: i64) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
@@ -294,6 +340,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
         let outputs = OutputSql::index_invalid(&NaiveDateTime::from_timestamp_opt(timestamp, 0).unwrap(), &mut conn)?;
+        drop(conn);
 
         if start.elapsed().as_millis() > 0 {
             trace!(
@@ -305,10 +352,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
             );
         }
 
-        outputs
-            .into_iter()
-            .map(|o| o.to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        OutputSql::to_db_wallet_outputs(outputs)
     }
 
     fn fetch_unspent_mined_unconfirmed_outputs(&self) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
@@ -316,6 +360,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
         let outputs = OutputSql::index_unconfirmed(&mut conn)?;
+        drop(conn);
 
         if start.elapsed().as_millis() > 0 {
             trace!(
@@ -327,13 +372,17 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
             );
         }
 
-        outputs
-            .into_iter()
-            .map(|o| o.to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        OutputSql::to_db_wallet_outputs(outputs)
     }
 
     fn write(&self, op: WriteOperation) -> Result<Option<DbValue>, OutputManagerStorageError> {
+        // Inserted outputs are never `Unspent`, so only a removal can change the spendable outputs
+        let _update_index = match &op {
+            WriteOperation::Remove(DbKey::AnyOutputByCommitment(commitment)) => {
+                Some(self.update_spendable_index_on_drop(TouchedOutputs::Commitments(vec![commitment.clone()])))
+            },
+            _ => None,
+        };
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -400,6 +449,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
             ],
             &mut conn,
         )?;
+        drop(conn);
 
         if start.elapsed().as_millis() > 0 {
             trace!(
@@ -410,10 +460,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
                 start.elapsed().as_millis()
             );
         }
-        outputs
-            .iter()
-            .map(|o| o.clone().to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        OutputSql::to_db_wallet_outputs(outputs)
     }
 
     // Perform a batch update of the received outputs; this is more efficient than updating each output individually.
@@ -421,11 +468,12 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
         &self,
         updates: Vec<ReceivedOutputInfoForBatch>,
     ) -> Result<(), OutputManagerStorageError> {
+        let commitments: Vec<Commitment> = updates.iter().map(|update| update.commitment.clone()).collect();
+        let _update_index = self.update_spendable_index_on_drop(TouchedOutputs::Commitments(commitments.clone()));
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
 
-        let commitments: Vec<Commitment> = updates.iter().map(|update| update.commitment.clone()).collect();
         if !OutputSql::verify_outputs_exist(&commitments, &mut conn)? {
             return Err(OutputManagerStorageError::ValuesNotFound);
         }
@@ -504,6 +552,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     }
 
     fn set_outputs_to_unmined_and_invalid(&self, hashes: Vec<FixedHash>) -> Result<(), OutputManagerStorageError> {
+        let _invalidate_index = self.invalidate_spendable_index_on_drop();
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -535,6 +584,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     }
 
     fn set_outputs_to_be_revalidated(&self) -> Result<(), OutputManagerStorageError> {
+        let _invalidate_index = self.invalidate_spendable_index_on_drop();
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -632,11 +682,12 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
 
     // Perform a batch update of the spent outputs; this is more efficient than updating each output individually.
     fn mark_outputs_as_spent(&self, updates: Vec<SpentOutputInfoForBatch>) -> Result<(), OutputManagerStorageError> {
+        let commitments: Vec<Commitment> = updates.iter().map(|update| update.commitment.clone()).collect();
+        let _update_index = self.update_spendable_index_on_drop(TouchedOutputs::Commitments(commitments.clone()));
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
 
-        let commitments: Vec<Commitment> = updates.iter().map(|update| update.commitment.clone()).collect();
         if !OutputSql::verify_outputs_exist(&commitments, &mut conn)? {
             return Err(OutputManagerStorageError::ValuesNotFound);
         }
@@ -706,6 +757,8 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     }
 
     fn mark_outputs_as_unspent(&self, hashes: Vec<(FixedHash, bool)>) -> Result<(), OutputManagerStorageError> {
+        let _update_index =
+            self.update_spendable_index_on_drop(TouchedOutputs::Hashes(hashes.iter().map(|(hash, _)| *hash).collect()));
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -815,6 +868,13 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
             )?;
             new_output.commit(&mut conn)?;
         }
+        // The index is rebuilt with its lock held before a connection is taken, so the connection is released first
+        drop(conn);
+        if let Some(index) = acquire_lock!(self.spendable_index).as_mut() {
+            let commitments = outputs_to_send.iter().map(|o| o.commitment.clone()).collect::<Vec<_>>();
+            index.remove(&commitments);
+        }
+        self.spendable_generation.fetch_add(1, Ordering::AcqRel);
         if start.elapsed().as_millis() > 0 {
             trace!(
                 target: LOG_TARGET,
@@ -865,6 +925,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     }
 
     fn clear_short_term_encumberances(&self) -> Result<(), OutputManagerStorageError> {
+        let _invalidate_index = self.invalidate_spendable_index_on_drop();
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -962,6 +1023,8 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     }
 
     fn cancel_pending_transaction(&self, tx_id: TxId) -> Result<(), OutputManagerStorageError> {
+        // Cancelled outbound outputs no longer reference the transaction afterwards, so they cannot be read back by it
+        let _invalidate_index = self.invalidate_spendable_index_on_drop();
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -1033,6 +1096,8 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     // This is typically used by a receiver after the finalized transaction has been broadcast/returned by the sender
     // as the sender has to finalize the signature that was partially constructed by the receiver
     fn update_output_metadata_signature(&self, output: &TransactionOutput) -> Result<(), OutputManagerStorageError> {
+        let _update_index =
+            self.update_spendable_index_on_drop(TouchedOutputs::Commitments(vec![output.commitment.clone()]));
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -1067,6 +1132,7 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
     }
 
     fn revalidate_unspent_output(&self, commitment: &Commitment) -> Result<(), OutputManagerStorageError> {
+        let _update_index = self.update_spendable_index_on_drop(TouchedOutputs::Commitments(vec![commitment.clone()]));
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
         let acquire_lock = start.elapsed();
@@ -1099,6 +1165,42 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
         Ok(())
     }
 
+    fn add_unspent_outputs_with_tx_id(
+        &self,
+        outputs: Vec<(TxId, DbWalletOutput)>,
+    ) -> Result<Vec<bool>, OutputManagerStorageError> {
+        let start = Instant::now();
+        let mut conn = self.database_connection.get_pooled_connection()?;
+        let acquire_lock = start.elapsed();
+        let num_outputs = outputs.len();
+
+        let added = conn.transaction::<_, OutputManagerStorageError, _>(|conn| {
+            outputs
+                .into_iter()
+                .map(|(tx_id, output)| {
+                    if OutputSql::find_by_commitment_and_cancelled(&output.commitment.to_vec(), false, conn).is_ok() {
+                        return Ok(false);
+                    }
+                    NewOutputSql::new(output, Some(OutputStatus::UnspentMinedUnconfirmed), Some(tx_id))?
+                        .commit(conn)?;
+                    Ok(true)
+                })
+                .collect()
+        })?;
+        if start.elapsed().as_millis() > 0 {
+            trace!(
+                target: LOG_TARGET,
+                "sqlite profile - add_unspent_outputs_with_tx_id ({} outputs): lock {} + db_op {} = {} ms",
+                num_outputs,
+                acquire_lock.as_millis(),
+                (start.elapsed() - acquire_lock).as_millis(),
+                start.elapsed().as_millis()
+            );
+        }
+
+        Ok(added)
+    }
+
     fn reinstate_cancelled_inbound_output(&self, tx_id: TxId) -> Result<(), OutputManagerStorageError> {
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
@@ -1146,7 +1248,8 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
         Ok(())
     }
 
-    /// Retrieves UTXOs than can be spent, sorted by priority, then value from smallest to largest.
+    /// Retrieves UTXOs than can be spent, sorted by priority, then value from smallest to largest. The selection is
+    /// made from the in-memory spendable output index, which is loaded from the database when it is not available.
     fn fetch_unspent_outputs_for_spending(
         &self,
         selection_criteria: &UtxoSelectionCriteria,
@@ -1154,32 +1257,44 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
         tip_height: Option<u64>,
     ) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
         let start = Instant::now();
-        let mut conn = self.database_connection.get_pooled_connection()?;
+        // The index lock is held while the index is rebuilt, so a concurrent change can only drop it after the rebuild
+        let mut spendable_index = acquire_lock!(self.spendable_index);
         let acquire_lock = start.elapsed();
 
-        let outputs = OutputSql::fetch_unspent_outputs_for_spending(selection_criteria, amount, tip_height, &mut conn)?;
+        let rebuilt = spendable_index.is_none();
+        if rebuilt {
+            let mut conn = self.database_connection.get_pooled_connection()?;
+            let outputs = OutputSql::index_unspent(&mut conn)?;
+            drop(conn);
+            let outputs = OutputSql::to_db_wallet_outputs(outputs)?;
+            *spendable_index = Some(SpendableOutputIndex::new(outputs, tip_height.unwrap_or_default()));
+        }
+        let outputs = spendable_index
+            .as_mut()
+            .map(|index| index.select(selection_criteria, amount, tip_height))
+            .unwrap_or_default();
 
         trace!(
             target: LOG_TARGET,
-            "sqlite profile - fetch_unspent_outputs_for_spending: lock {} + db_op {} = {} ms",
+            "sqlite profile - fetch_unspent_outputs_for_spending (index rebuilt: {}): lock {} + db_op {} = {} ms",
+            rebuilt,
             acquire_lock.as_millis(),
             (start.elapsed() - acquire_lock).as_millis(),
             start.elapsed().as_millis()
         );
-        outputs
-            .iter()
-            .map(|o| o.clone().to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        Ok(outputs)
+    }
+
+    fn spendable_outputs_generation(&self) -> u64 {
+        self.spendable_generation.load(Ordering::Acquire)
     }
 
     fn fetch_outputs_by_tx_id(&self, tx_id: TxId) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
         let mut conn = self.database_connection.get_pooled_connection()?;
         let outputs = OutputSql::find_by_tx_id(tx_id, &mut conn)?;
+        drop(conn);
 
-        outputs
-            .iter()
-            .map(|o| o.clone().to_db_wallet_output())
-            .collect::<Result<Vec<_>, _>>()
+        OutputSql::to_db_wallet_outputs(outputs)
     }
 
     fn fetch_outputs_by_query(&self, q: OutputBackendQuery) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
@@ -1199,6 +1314,41 @@ impl OutputManagerBackend for OutputManagerSqliteDatabase {
             })
             .collect())
     }
+
+    fn fetch_outputs_page_by_query(&self, q: OutputBackendQuery) -> Result<OutputsPage, OutputManagerStorageError> {
+        let start = Instant::now();
+        let mut conn = self.database_connection.get_pooled_connection()?;
+        let acquire_lock = start.elapsed();
+
+        let sort_key = q.sorting.first().map(|(k, _)| *k).unwrap_or("id");
+        let outputs = OutputSql::fetch_outputs_by_query(q, &mut conn)?;
+        let next_cursor = outputs.last().map(|o| o.query_cursor(sort_key));
+
+        trace!(
+            target: LOG_TARGET,
+            "sqlite profile - fetch_outputs_page_by_query: lock {} + db_op {} = {} ms",
+            acquire_lock.as_millis(),
+            (start.elapsed() - acquire_lock).as_millis(),
+            start.elapsed().as_millis()
+        );
+        Ok(OutputsPage {
+            outputs: outputs
+                .into_iter()
+                .filter_map(|x| {
+                    x.to_db_wallet_output()
+                        .map_err(|e| {
+                            error!(
+                                target: LOG_TARGET,
+                                "failed to convert `OutputSql` to `DbWalletOutput`: {:#?}", e
+                            );
+                            e
+                        })
+                        .ok()
+                })
+                .collect(),
+            next_cursor,
+        })
+    }
 }
 
 /// These are the fields to be set for the received outputs batch mode update
@@ -1431,6 +1581,91 @@ impl KnownOneSidedPaymentScriptSql {
     }
 }
 
+/// Drops the spendable output index of an `OutputManagerSqliteDatabase` and bumps its spendable outputs generation
+/// when dropped
+struct InvalidateSpendableIndex {
+    index: Arc<Mutex<Option<SpendableOutputIndex>>>,
+    generation: Arc<AtomicU64>,
+}
+
+impl Drop for InvalidateSpendableIndex {
+    fn drop(&mut self) {
+        *acquire_lock!(self.index) = None;
+        self.generation.fetch_add(1, Ordering::AcqRel);
+    }
+}
+
+/// The outputs a write changes, identified in whichever way the write identifies them
+enum TouchedOutputs {
+    Commitments(Vec<Commitment>),
+    Hashes(Vec<FixedHash>),
+}
+
+/// Updates the spendable output index of an `OutputManagerSqliteDatabase` with the current state of the touched
+/// outputs when dropped, and bumps its spendable outputs generation unless the index is loaded and did not change. The
+/// index is dropped if the touched outputs cannot be read back.
+struct UpdateSpendableIndex {
+    database_connection: WalletDbConnection,
+    index: Arc<Mutex<Option<SpendableOutputIndex>>>,
+    generation: Arc<AtomicU64>,
+    touched: TouchedOutputs,
+}
+
+impl UpdateSpendableIndex {
+    /// Returns the commitments of the touched outputs, along with the ones among them that are `Unspent`
+    fn fetch_touched(&self) -> Result<(Vec<Commitment>, Vec<DbWalletOutput>), OutputManagerStorageError> {
+        let mut conn = self.database_connection.get_pooled_connection()?;
+        let (mut commitments, outputs) = match &self.touched {
+            // Removed outputs are not read back, so their commitments are kept as given
+            TouchedOutputs::Commitments(commitments) => (
+                commitments.clone(),
+                OutputSql::find_by_commitments(commitments.iter().map(|c| c.as_bytes()).collect(), &mut conn)?,
+            ),
+            TouchedOutputs::Hashes(hashes) => (
+                Vec::new(),
+                OutputSql::find_by_hashes(hashes.iter().map(|h| h.as_slice()).collect(), &mut conn)?,
+            ),
+        };
+        drop(conn);
+
+        let mut unspent = Vec::new();
+        for output in outputs {
+            if OutputStatus::try_from(output.status)? == OutputStatus::Unspent {
+                let output = output.to_db_wallet_output()?;
+                commitments.push(output.commitment.clone());
+                unspent.push(output);
+            } else {
+                commitments.push(Commitment::from_vec(&output.commitment)?);
+            }
+        }
+        Ok((commitments, unspent))
+    }
+}
+
+impl Drop for UpdateSpendableIndex {
+    fn drop(&mut self) {
+        // The index lock is held while the outputs are read back, so the index cannot be rebuilt in the meantime
+        let mut index = acquire_lock!(self.index);
+        if let Some(spendable) = index.as_mut() {
+            match self.fetch_touched() {
+                Ok((commitments, unspent)) => {
+                    if !spendable.update(&commitments, unspent) {
+                        return;
+                    }
+                },
+                Err(e) => {
+                    warn!(
+                        target: LOG_TARGET,
+                        "Could not update the spendable output index, it will be rebuilt: {}", e
+                    );
+                    *index = None;
+                },
+            }
+        }
+        self.generation.fetch_add(1, Ordering::AcqRel);
+    }
+}
+
 #[cfg(test)]
 mod test {
 
@@ -54,20 +54,17 @@ use tari_utilities::hex::Hex;
 use crate::{
     output_manager_service::{
         error::OutputManagerStorageError,
-        input_selection::{UtxoSelectionCriteria, UtxoSelectionMode},
         service::Balance,
         storage::{
-            database::{OutputBackendQuery, SortDirection},
+            database::{OutputBackendQuery, OutputQueryCursor, SortDirection},
             models::{DbWalletOutput, SpendingPriority},
             sqlite_db::{UpdateOutput, UpdateOutputSql},
             OutputSource,
             OutputStatus,
         },
-        UtxoSelectionFilter,
-        UtxoSelectionOrdering,
-        TRANSACTION_INPUTS_LIMIT,
     },
     schema::outputs,
+    util::parallel::try_par_map,
 };
 
 const LOG_TARGET: &str = "wallet::output_manager_service::database::wallet";
@@ -139,8 +136,11 @@ impl OutputSql {
             .filter(outputs::script_lock_height.le(q.tip_height))
             .filter(outputs::maturity.le(q.tip_height));
 
-        if let Some((offset, limit)) = q.pagination {
-            query = query.offset(offset).limit(limit);
+        // NOTE: with a cursor the offset is implied by the cursor position, so only the page size is used
+        match (q.pagination, q.cursor) {
+            (Some((_, limit)), Some(_)) => query = query.limit(limit),
+            (Some((offset, limit)), None) => query = query.offset(offset).limit(limit),
+            (None, _) => {},
         }
 
         // filtering by OutputStatus
@@ -180,100 +180,71 @@ impl OutputSql {
         }
 
         use SortDirection::{Asc, Desc};
-        Ok(q.sorting
-            .into_iter()
-            .fold(query, |query, s| match s {
-                ("value", d) => match d {
-                    Asc => query.then_order_by(outputs::value.asc()),
-                    Desc => query.then_order_by(outputs::value.desc()),
+        let (primary_key, primary_direction) = q.sorting.first().copied().unwrap_or(("id", Asc));
+
+        // keyset pagination: resume strictly after `(sort_key, id)` in the requested direction. NULLs sort first in
+        // SQLite, so for `mined_height` unmined outputs come before all mined outputs when ascending and after them
+        // when descending.
+        if let Some(cursor) = q.cursor {
+            let id = cursor.id;
+            query = match (primary_key, primary_direction, cursor.sort_key) {
+                ("value", Asc, Some(k)) => {
+                    query.filter(outputs::value.gt(k).or(outputs::value.eq(k).and(outputs::id.gt(id))))
                 },
-                ("mined_height", d) => match d {
-                    Asc => query.then_order_by(outputs::mined_height.asc()),
-                    Desc => query.then_order_by(outputs::mined_height.desc()),
+                ("value", Desc, Some(k)) => {
+                    query.filter(outputs::value.lt(k).or(outputs::value.eq(k).and(outputs::id.lt(id))))
                 },
-                _ => query,
-            })
-            .load(conn)?)
-    }
-
-    /// Retrieves UTXOs than can be spent, sorted by priority, then value from smallest to largest.
-    #[allow(clippy::cast_sign_loss)]
-    pub fn fetch_unspent_outputs_for_spending(
-        selection_criteria: &UtxoSelectionCriteria,
-        amount: u64,
-        tip_height: Option<u64>,
-        conn: &mut SqliteConnection,
-    ) -> Result<Vec<OutputSql>, OutputManagerStorageError> {
-        let i64_tip_height = tip_height.and_then(|h| i64::try_from(h).ok()).unwrap_or(i64::MAX);
-        let i64_value = i64::try_from(selection_criteria.min_dust).unwrap_or(i64::MAX);
-
-        let mut query = outputs::table
-            .into_boxed()
-            .filter(outputs::status.eq(OutputStatus::Unspent as i32))
-            .filter(outputs::value.gt(i64_value))
-            .order_by(outputs::spending_priority.desc());
-
-        // NOTE: Safe mode presets `script_lock_height` and `maturity` filters for all queries
-        if selection_criteria.mode == UtxoSelectionMode::Safe {
-            query = query
-                .filter(outputs::script_lock_height.le(i64_tip_height))
-                .filter(outputs::maturity.le(i64_tip_height));
-        };
-
-        match &selection_criteria.filter {
-            UtxoSelectionFilter::Standard => {
-                query = query.filter(
-                    outputs::output_type
-                        .eq(i32::from(OutputType::Standard.as_byte()))
-                        .or(outputs::output_type.eq(i32::from(OutputType::Coinbase.as_byte()))),
-                );
+                ("mined_height", Asc, Some(k)) => query.filter(
+                    outputs::mined_height
+                        .gt(k)
+                        .or(outputs::mined_height.eq(k).and(outputs::id.gt(id))),
+                ),
+                ("mined_height", Asc, None) => query.filter(
+                    outputs::mined_height
+                        .is_not_null()
+                        .or(outputs::mined_height.is_null().and(outputs::id.gt(id))),
+                ),
+                ("mined_height", Desc, Some(k)) => query.filter(
+                    outputs::mined_height
+                        .lt(k)
+                        .or(outputs::mined_height.is_null())
+                        .or(outputs::mined_height.eq(k).and(outputs::id.lt(id))),
+                ),
+                ("mined_height", Desc, None) => query.filter(outputs::mined_height.is_null().and(outputs::id.lt(id))),
+                (_, Asc, _) => query.filter(outputs::id.gt(id)),
+                (_, Desc, _) => query.filter(outputs::id.lt(id)),
+            };
+        }
 
-                if selection_criteria.excluding_onesided {
-                    query = query.filter(outputs::source.ne(OutputSource::OneSided as i32));
-                }
+        let query = q.sorting.into_iter().fold(query, |query, s| match s {
+            ("value", d) => match d {
+                Asc => query.then_order_by(outputs::value.asc()),
+                Desc => query.then_order_by(outputs::value.desc()),
             },
-
-            UtxoSelectionFilter::SpecificOutputs { commitments } => {
-                query = match commitments.len() {
-                    0 => query,
-                    1 => query.filter(outputs::commitment.eq(commitments[0].to_vec())),
-                    _ => query.filter(
-                        outputs::commitment.eq_any::<Vec<Vec<u8>>>(commitments.iter().map(|c| c.to_vec()).collect()),
-                    ),
-                };
+            ("mined_height", d) => match d {
+                Asc => query.then_order_by(outputs::mined_height.asc()),
+                Desc => query.then_order_by(outputs::mined_height.desc()),
             },
-        }
+            _ => query,
+        });
 
-        for exclude in &selection_criteria.excluding {
-            query = query.filter(outputs::commitment.ne(exclude.as_bytes()));
-        }
-
-        query = match selection_criteria.ordering {
-            UtxoSelectionOrdering::SmallestFirst => query.then_order_by(outputs::value.asc()),
-            UtxoSelectionOrdering::LargestFirst => query.then_order_by(outputs::value.desc()),
-            UtxoSelectionOrdering::Default => {
-                // NOTE: keeping filtering by `script_lock_height` and `maturity` for all modes
-                // lets get the max value for all utxos
-                let max: Option<i64> = outputs::table
-                    .filter(outputs::status.eq(OutputStatus::Unspent as i32))
-                    .filter(outputs::script_lock_height.le(i64_tip_height))
-                    .filter(outputs::maturity.le(i64_tip_height))
-                    .order(outputs::value.desc())
-                    .select(outputs::value)
-                    .first(conn)
-                    .optional()?;
-
-                match max {
-                    // Want to reduce the number of inputs to reduce fees
-                    Some(max) if amount > max as u64 => query.then_order_by(outputs::value.desc()),
-
-                    // Use the smaller utxos to make up this transaction.
-                    _ => query.then_order_by(outputs::value.asc()),
-                }
-            },
+        // the row id is the final tie breaker so that pages are stable between calls
+        let query = match primary_direction {
+            Asc => query.then_order_by(outputs::id.asc()),
+            Desc => query.then_order_by(outputs::id.desc()),
         };
 
-        Ok(query.limit(i64::from(TRANSACTION_INPUTS_LIMIT)).load(conn)?)
+        Ok(query.load(conn)?)
+    }
+
+    /// Returns the keyset pagination position of this row for the given sort column
+    pub fn query_cursor(&self, sort_key: &str) -> OutputQueryCursor {
+        let sort_key = match sort_key {
+            "value" => Some(self.value),
+            "mined_height" => self.mined_height,
+            _ => Some(i64::from(self.id)),
+        };
+        OutputQueryCursor { sort_key, id: self.id }
     }
 
     /// Return all unspent outputs that have a maturity above the provided chain tip
@@ -329,6 +300,32 @@ impl OutputSql {
             .load(conn)?)
     }
 
+    /// Same as `index_marked_deleted_in_block_is_null`, but leaves out `Unspent` outputs mined at or below
+    /// `settled_height`
+    pub fn index_unsettled_marked_deleted_in_block_is_null(
+        settled_height: u64,
+        conn: &mut SqliteConnection,
+    ) -> Result<Vec<OutputSql>, OutputManagerStorageError> {
+        Ok(outputs::table
+            .filter(
+                outputs::marked_deleted_in_block
+                    .is_null()
+                    .or(outputs::status.eq(OutputStatus::SpentMinedUnconfirmed as i32)),
+            )
+            .filter(
+                outputs::mined_in_block
+                    .is_not_null()
+                    .and(outputs::mined_height.is_not_null()),
+            )
+            .filter(
+                outputs::status
+                    .ne(OutputStatus::Unspent as i32)
+                    .or(outputs::mined_height.gt(settled_height as i64)),
+            )
+            .order(outputs::id.asc())
+            .load(conn)?)
+    }
+
     pub fn index_invalid(
         timestamp: &NaiveDateTime,
         conn: &mut SqliteConnection,
@@ -533,6 +530,22 @@ impl OutputSql {
             .first::<OutputSql>(conn)?)
     }
 
+    pub fn find_by_commitments(
+        commitments: Vec<&[u8]>,
+        conn: &mut SqliteConnection,
+    ) -> Result<Vec<OutputSql>, OutputManagerStorageError> {
+        Ok(outputs::table
+            .filter(outputs::commitment.eq_any(commitments))
+            .load(conn)?)
+    }
+
+    pub fn find_by_hashes(
+        hashes: Vec<&[u8]>,
+        conn: &mut SqliteConnection,
+    ) -> Result<Vec<OutputSql>, OutputManagerStorageError> {
+        Ok(outputs::table.filter(outputs::hash.eq_any(hashes)).load(conn)?)
+    }
+
     pub fn find_by_commitments_excluding_status(
         commitments: Vec<&[u8]>,
         status: OutputStatus,
@@ -657,6 +670,11 @@ impl OutputSql {
         OutputSql::find(&self.spending_key, conn)
     }
 
+    /// Converts a batch of rows with `to_db_wallet_output`, spread across the available cores
+    pub fn to_db_wallet_outputs(outputs: Vec<OutputSql>) -> Result<Vec<DbWalletOutput>, OutputManagerStorageError> {
+        try_par_map(outputs, OutputSql::to_db_wallet_output)
+    }
+
     #[allow(clippy::too_many_lines)]
     pub fn to_db_wallet_output(self) -> Result<DbWalletOutput, OutputManagerStorageError> {
         let features: OutputFeatures =
@@ -22,4 +22,4 @@
 
 mod txo_validation_task;
 
-pub use txo_validation_task::TxoValidationTask;
+pub use txo_validation_task::{TxoValidationMode, TxoValidationTask, ValidatedTip};
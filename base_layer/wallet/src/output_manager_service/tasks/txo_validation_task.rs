@@ -22,13 +22,18 @@
 use std::{
     collections::HashMap,
     convert::{TryFrom, TryInto},
-    sync::Arc,
+    sync::{Arc, Mutex},
+    time::Duration as StdDuration,
 };
 
 use chrono::{Duration, Utc};
+use futures::{stream, StreamExt};
 use log::*;
 use tari_common_types::types::{BlockHash, FixedHash};
-use tari_comms::{peer_manager::Peer, protocol::rpc::RpcError::RequestFailed};
+use tari_comms::{
+    peer_manager::Peer,
+    protocol::rpc::{RpcClientLease, RpcError::RequestFailed},
+};
 use tari_core::{
     base_node::rpc::BaseNodeWalletRpcClient,
     blocks::BlockHeader,
@@ -53,6 +58,22 @@ use crate::{
 };
 
 const LOG_TARGET: &str = "wallet::output_service::txo_validation_task";
+/// How long to wait for each additional RPC session used to query batches concurrently
+const BATCH_CLIENT_TIMEOUT: StdDuration = StdDuration::from_secs(10);
+
+/// Whether a validation run rechecks every mined output, or only those that may have changed since the last run
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TxoValidationMode {
+    Full,
+    Incremental,
+}
+
+/// The chain tip that the last successful validation run was performed against
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ValidatedTip {
+    pub height: u64,
+    pub hash: BlockHash,
+}
 
 pub struct TxoValidationTask<TBackend, TWalletConnectivity> {
     operation_id: u64,
@@ -61,6 +82,8 @@ pub struct TxoValidationTask<TBackend, TWalletConnectivity> {
     connectivity: TWalletConnectivity,
     event_publisher: OutputManagerEventSender,
     config: OutputManagerServiceConfig,
+    mode: TxoValidationMode,
+    last_validated_tip: Arc<Mutex<Option<ValidatedTip>>>,
 }
 
 struct MinedOutputInfo {
@@ -81,6 +104,8 @@ where
         connectivity: TWalletConnectivity,
         event_publisher: OutputManagerEventSender,
         config: OutputManagerServiceConfig,
+        mode: TxoValidationMode,
+        last_validated_tip: Arc<Mutex<Option<ValidatedTip>>>,
     ) -> Self {
         Self {
             operation_id,
@@ -89,6 +114,8 @@ where
             connectivity,
             event_publisher,
             config,
+            mode,
+            last_validated_tip,
         }
     }
 
@@ -113,12 +140,19 @@ where
 
         let last_mined_header = self.check_for_reorgs(&mut base_node_client).await?;
 
-        self.update_unconfirmed_outputs(&mut base_node_client).await?;
+        let settled_height = self.get_settled_height(&mut base_node_client).await?;
+        let tip = self.get_tip(&mut base_node_client).await?;
+
+        let batch_clients = self.obtain_batch_clients(base_node_client).await;
 
-        self.update_spent_outputs(&mut base_node_client, last_mined_header)
+        self.update_unconfirmed_outputs(&batch_clients).await?;
+
+        self.update_spent_outputs(&batch_clients, last_mined_header, settled_height)
             .await?;
 
-        self.update_invalid_outputs(&mut base_node_client).await?;
+        self.update_invalid_outputs(&batch_clients).await?;
+
+        *acquire_lock!(self.last_validated_tip) = Some(tip);
 
         self.publish_event(OutputManagerEvent::TxoValidationSuccess(self.operation_id));
         debug!(
@@ -128,9 +162,105 @@ where
         Ok(self.operation_id)
     }
 
+    /// In incremental mode, returns the height at or below which unspent outputs are considered settled and do not
+    /// need to be checked again. Returns None, which means every output is checked, when running a full validation,
+    /// when no validation has completed yet, or when the previously validated tip has been reorged out.
+    async fn get_settled_height(
+        &mut self,
+        client: &mut BaseNodeWalletRpcClient,
+    ) -> Result<Option<u64>, OutputManagerProtocolError> {
+        if self.mode == TxoValidationMode::Full || !self.config.incremental_txo_validation {
+            return Ok(None);
+        }
+        let last_validated_tip = match *acquire_lock!(self.last_validated_tip) {
+            Some(tip) => tip,
+            None => return Ok(None),
+        };
+        let block_at_height = self
+            .get_base_node_block_at_height(last_validated_tip.height, client)
+            .await
+            .for_protocol(self.operation_id)?;
+        if block_at_height != Some(last_validated_tip.hash) {
+            info!(
+                target: LOG_TARGET,
+                "Previously validated tip {} has been reorged out, validating all outputs (Operation ID: {})",
+                last_validated_tip.height,
+                self.operation_id
+            );
+            return Ok(None);
+        }
+        let settled_height = last_validated_tip
+            .height
+            .saturating_sub(self.config.num_confirmations_required);
+        debug!(
+            target: LOG_TARGET,
+            "Only validating outputs mined after height {} or with pending spends (Operation ID: {})",
+            settled_height,
+            self.operation_id
+        );
+        Ok(Some(settled_height))
+    }
+
+    async fn get_tip(&self, client: &mut BaseNodeWalletRpcClient) -> Result<ValidatedTip, OutputManagerProtocolError> {
+        let metadata = client
+            .get_tip_info()
+            .await
+            .for_protocol(self.operation_id)?
+            .metadata
+            .ok_or_else(|| {
+                OutputManagerProtocolError::new(
+                    self.operation_id,
+                    OutputManagerError::InconsistentBaseNodeDataError("Base node sent no chain metadata"),
+                )
+            })?;
+        let hash = metadata.best_block_hash.try_into().map_err(|_| {
+            OutputManagerProtocolError::new(
+                self.operation_id,
+                OutputManagerError::InconsistentBaseNodeDataError("Base node sent malformed hash"),
+            )
+        })?;
+        Ok(ValidatedTip {
+            height: metadata.best_block_height,
+            hash,
+        })
+    }
+
+    /// Leases up to `tx_validator_max_concurrent_batches` distinct RPC sessions from the base node client pool, so
+    /// that batches can be in flight at the same time. Once the pool hands out a session that is already leased, no
+    /// further sessions can be obtained and the batches share the sessions that were.
+    async fn obtain_batch_clients(
+        &mut self,
+        client: RpcClientLease<BaseNodeWalletRpcClient>,
+    ) -> Vec<RpcClientLease<BaseNodeWalletRpcClient>> {
+        let max_clients = self.config.tx_validator_max_concurrent_batches.max(1);
+        let mut clients = Vec::with_capacity(max_clients);
+        clients.push(client);
+        while clients.len() < max_clients {
+            match self
+                .connectivity
+                .obtain_base_node_wallet_rpc_client_timeout(BATCH_CLIENT_TIMEOUT)
+                .await
+            {
+                Some(client) => {
+                    if !push_distinct_session(&mut clients, client) {
+                        break;
+                    }
+                },
+                None => break,
+            }
+        }
+        debug!(
+            target: LOG_TARGET,
+            "Querying up to {} batches concurrently (Operation ID: {})",
+            clients.len(),
+            self.operation_id
+        );
+        clients
+    }
+
     async fn update_invalid_outputs(
         &self,
-        wallet_client: &mut BaseNodeWalletRpcClient,
+        clients: &[RpcClientLease<BaseNodeWalletRpcClient>],
     ) -> Result<(), OutputManagerProtocolError> {
         let invalid_outputs = self
             .db
@@ -148,11 +278,14 @@ where
             )
             .for_protocol(self.operation_id)?;
 
-        for batch in invalid_outputs.chunks(self.config.tx_validator_batch_size) {
-            let (mined, unmined, tip_height) = self
-                .query_base_node_for_outputs(batch, wallet_client)
-                .await
-                .for_protocol(self.operation_id)?;
+        let mut responses = stream::iter(invalid_outputs.chunks(self.config.tx_validator_batch_size).enumerate())
+            .map(|(i, batch)| {
+                let mut client = clients[i % clients.len()].clone();
+                async move { self.query_base_node_for_outputs(batch, &mut client).await }
+            })
+            .buffered(clients.len());
+        while let Some(response) = responses.next().await {
+            let (mined, unmined, tip_height) = response.for_protocol(self.operation_id)?;
             debug!(
                 target: LOG_TARGET,
                 "Base node returned {} outputs as mined and {} outputs as unmined (Operation ID: {})",
@@ -199,29 +332,41 @@ where
     #[allow(clippy::too_many_lines)]
     async fn update_spent_outputs(
         &self,
-        wallet_client: &mut BaseNodeWalletRpcClient,
+        clients: &[RpcClientLease<BaseNodeWalletRpcClient>],
         last_mined_header_hash: Option<BlockHash>,
+        settled_height: Option<u64>,
     ) -> Result<(), OutputManagerProtocolError> {
-        let mined_outputs = self.db.fetch_mined_unspent_outputs().for_protocol(self.operation_id)?;
+        let mined_outputs = match settled_height {
+            Some(height) => self.db.fetch_unsettled_mined_unspent_outputs(height),
+            None => self.db.fetch_mined_unspent_outputs(),
+        }
+        .for_protocol(self.operation_id)?;
         if mined_outputs.is_empty() {
             return Ok(());
         }
 
-        for batch in mined_outputs.chunks(self.config.tx_validator_batch_size) {
-            debug!(
-                target: LOG_TARGET,
-                "Asking base node for status of {} commitments (Operation ID: {})",
-                batch.len(),
-                self.operation_id
-            );
-
-            let response = wallet_client
-                .query_deleted(QueryDeletedRequest {
-                    chain_must_include_header: last_mined_header_hash.map(|v| v.to_vec()).unwrap_or_default(),
-                    hashes: batch.iter().map(|o| o.hash.to_vec()).collect(),
-                })
-                .await
-                .for_protocol(self.operation_id)?;
+        let mut responses = stream::iter(mined_outputs.chunks(self.config.tx_validator_batch_size).enumerate())
+            .map(|(i, batch)| {
+                let mut client = clients[i % clients.len()].clone();
+                async move {
+                    debug!(
+                        target: LOG_TARGET,
+                        "Asking base node for status of {} commitments (Operation ID: {})",
+                        batch.len(),
+                        self.operation_id
+                    );
+                    let response = client
+                        .query_deleted(QueryDeletedRequest {
+                            chain_must_include_header: last_mined_header_hash.map(|v| v.to_vec()).unwrap_or_default(),
+                            hashes: batch.iter().map(|o| o.hash.to_vec()).collect(),
+                        })
+                        .await;
+                    (batch, response)
+                }
+            })
+            .buffered(clients.len());
+        while let Some((batch, response)) = responses.next().await {
+            let response = response.for_protocol(self.operation_id)?;
 
             if response.data.len() != batch.len() {
                 return Err(OutputManagerProtocolError::new(
@@ -300,22 +445,31 @@ where
 
     async fn update_unconfirmed_outputs(
         &self,
-        wallet_client: &mut BaseNodeWalletRpcClient,
+        clients: &[RpcClientLease<BaseNodeWalletRpcClient>],
     ) -> Result<(), OutputManagerProtocolError> {
         let unconfirmed_outputs = self.db.fetch_unconfirmed_outputs().for_protocol(self.operation_id)?;
 
-        for batch in unconfirmed_outputs.chunks(self.config.tx_validator_batch_size) {
-            debug!(
-                target: LOG_TARGET,
-                "Asking base node for location of {} unconfirmed outputs by hash (Operation ID: {})",
-                batch.len(),
-                self.operation_id
-            );
-
-            let (mined, unmined, tip_height) = self
-                .query_base_node_for_outputs(batch, wallet_client)
-                .await
-                .for_protocol(self.operation_id)?;
+        // Batches are queried concurrently, but the results are applied in batch order
+        let mut responses = stream::iter(
+            unconfirmed_outputs
+                .chunks(self.config.tx_validator_batch_size)
+                .enumerate(),
+        )
+        .map(|(i, batch)| {
+            let mut client = clients[i % clients.len()].clone();
+            async move {
+                debug!(
+                    target: LOG_TARGET,
+                    "Asking base node for location of {} unconfirmed outputs by hash (Operation ID: {})",
+                    batch.len(),
+                    self.operation_id
+                );
+                self.query_base_node_for_outputs(batch, &mut client).await
+            }
+        })
+        .buffered(clients.len());
+        while let Some(response) = responses.next().await {
+            let (mined, unmined, tip_height) = response.for_protocol(self.operation_id)?;
             debug!(
                 target: LOG_TARGET,
                 "Base node returned {} outputs as mined and {} outputs as unmined (Operation ID: {})",
@@ -592,3 +746,29 @@ where
         }
     }
 }
+
+/// Adds `client` to `clients` unless it is a lease of a session that is already in there, since batches sent on the
+/// same session are queried one after the other. Returns whether it was added.
+fn push_distinct_session<T>(clients: &mut Vec<RpcClientLease<T>>, client: RpcClientLease<T>) -> bool {
+    if clients.iter().any(|c| c.is_same_session(&client)) {
+        return false;
+    }
+    clients.push(client);
+    true
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn it_only_keeps_distinct_sessions() {
+        let session1 = RpcClientLease::new(());
+        let session2 = RpcClientLease::new(());
+        let mut clients = vec![session1.clone()];
+        assert!(!push_distinct_session(&mut clients, session1.clone()));
+        assert!(push_distinct_session(&mut clients, session2.clone()));
+        assert!(!push_distinct_session(&mut clients, session2));
+        assert_eq!(clients.len(), 2);
+    }
+}
@@ -0,0 +1,558 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::{collections::VecDeque, convert::TryFrom, time::Duration};
+
+use log::*;
+use serde::{Deserialize, Serialize};
+use tari_common_types::types::Commitment;
+use tari_core::{
+    borsh::SerializedSize,
+    transactions::{
+        fee::Fee,
+        tari_amount::MicroMinotari,
+        transaction_components::OutputFeatures,
+        weight::TransactionWeight,
+    },
+};
+use tari_script::TariScript;
+use tari_shutdown::ShutdownSignal;
+use tokio::time::{self, Instant, MissedTickBehavior};
+
+use crate::{
+    output_manager_service::{handle::OutputManagerHandle, storage::models::DbWalletOutput},
+    transaction_service::handle::TransactionServiceHandle,
+    util::watch::Watch,
+};
+
+const LOG_TARGET: &str = "wallet::output_manager_service::utxo_compaction";
+/// How often the unspent output set is inspected
+const COMPACTION_TICK_INTERVAL: Duration = Duration::from_secs(60);
+/// The longest wait after consecutive failed compaction attempts, the wait doubles from one tick up to this
+const MAX_COMPACTION_BACKOFF: Duration = Duration::from_secs(60 * 60);
+/// The number of mempool fee buckets requested from the base node; only the next block is used
+const FEE_STATS_BLOCK_COUNT: usize = 1;
+/// The number of decades tracked by `UtxoValueHistogram`; the last bucket holds every value of 10^15 uT and up
+const HISTOGRAM_BUCKETS: usize = 16;
+
+/// Controls the background UTXO compaction performed by the wallet. When enabled, dust outputs are joined while the
+/// mempool fee for the next block is at or below `max_fee_per_gram`, and large outputs are split to keep
+/// `target_split_count` outputs of roughly `target_split_value` available for parallel sends. Every compaction
+/// transaction is paid for out of `fee_budget`, which is replenished every `budget_period_secs`.
+#[derive(Clone, Debug, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(deny_unknown_fields)]
+pub struct UtxoCompactionPolicy {
+    /// Enables the compaction task
+    pub enabled: bool,
+    /// Outputs with a value below this, in micro MinoTari, are dust
+    pub dust_threshold: u64,
+    /// The number of dust outputs that must be present before they are joined
+    pub min_dust_outputs: usize,
+    /// The maximum number of dust outputs joined in a single transaction
+    pub max_inputs_per_join: usize,
+    /// Compaction only happens while the next block's minimum mempool fee per gram is at or below this value
+    pub max_fee_per_gram: u64,
+    /// The total fee, in micro MinoTari, that compaction may spend in each budget period
+    pub fee_budget: u64,
+    /// The length of the fee budget period in seconds
+    pub budget_period_secs: u64,
+    /// The minimum number of seconds between two compaction transactions
+    pub min_interval_secs: u64,
+    /// The number of outputs of roughly `target_split_value` to keep available, 0 disables splitting
+    pub target_split_count: usize,
+    /// The value, in micro MinoTari, of the outputs in the split pool
+    pub target_split_value: u64,
+}
+
+impl Default for UtxoCompactionPolicy {
+    fn default() -> Self {
+        Self {
+            enabled: false,
+            dust_threshold: 10_000,
+            min_dust_outputs: 50,
+            max_inputs_per_join: 200,
+            max_fee_per_gram: 5,
+            fee_budget: 100_000,
+            budget_period_secs: 60 * 60 * 24,
+            min_interval_secs: 60 * 10,
+            target_split_count: 0,
+            target_split_value: 0,
+        }
+    }
+}
+
+impl UtxoCompactionPolicy {
+    /// Checks that the policy cannot make no progress or undo its own work, e.g. by splitting outputs into dust
+    pub fn validate(&self) -> Result<(), String> {
+        if self.max_inputs_per_join < 2 {
+            return Err("max_inputs_per_join must be at least 2".to_string());
+        }
+        if self.min_dust_outputs < 2 {
+            return Err("min_dust_outputs must be at least 2".to_string());
+        }
+        if self.budget_period_secs == 0 {
+            return Err("budget_period_secs must be greater than 0".to_string());
+        }
+        if self.target_split_count > 0 && self.target_split_value / 2 <= self.dust_threshold {
+            return Err("target_split_value must be more than twice the dust_threshold".to_string());
+        }
+        Ok(())
+    }
+
+    /// Outputs counted towards the split pool are worth between half and twice the target value
+    fn is_in_split_pool(&self, value: MicroMinotari) -> bool {
+        value.as_u64() >= self.target_split_value / 2 && value.as_u64() < self.target_split_value.saturating_mul(2)
+    }
+}
+
+/// The number and total value of unspent outputs per decade of value in micro MinoTari
+#[derive(Clone, Debug, Default, PartialEq, Eq)]
+pub struct UtxoValueHistogram {
+    pub counts: [usize; HISTOGRAM_BUCKETS],
+    pub values: [u64; HISTOGRAM_BUCKETS],
+}
+
+impl UtxoValueHistogram {
+    pub fn new(values: impl IntoIterator<Item = MicroMinotari>) -> Self {
+        let mut histogram = Self::default();
+        for value in values {
+            let bucket = (value.as_u64().checked_ilog10().unwrap_or(0) as usize).min(HISTOGRAM_BUCKETS - 1);
+            histogram.counts[bucket] += 1;
+            histogram.values[bucket] = histogram.values[bucket].saturating_add(value.as_u64());
+        }
+        histogram
+    }
+
+    pub fn total_count(&self) -> usize {
+        self.counts.iter().sum()
+    }
+}
+
+/// A compaction transaction chosen by `plan_compaction`
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub enum CompactionAction {
+    Join { commitments: Vec<Commitment> },
+    Split { commitment: Commitment, split_count: usize },
+}
+
+/// Chooses the next compaction transaction for a set of unspent `(commitment, value)` outputs, if any is needed.
+/// Joining dust takes priority over topping up the split pool. The most valuable dust is joined first, as the smallest
+/// outputs are the ones most likely to cost more in fees than they are worth. `split_fee` gives an upper bound on the
+/// fee of splitting one output into the given number of outputs plus the change, which a split must leave room for.
+pub fn plan_compaction(
+    policy: &UtxoCompactionPolicy,
+    outputs: &[(Commitment, MicroMinotari)],
+    split_fee: impl Fn(usize) -> MicroMinotari,
+) -> Option<CompactionAction> {
+    let mut dust = outputs
+        .iter()
+        .filter(|(_, value)| value.as_u64() < policy.dust_threshold)
+        .collect::<Vec<_>>();
+    if dust.len() >= policy.min_dust_outputs.max(2) {
+        dust.sort_by(|(_, a), (_, b)| b.cmp(a));
+        let commitments = dust
+            .into_iter()
+            .take(policy.max_inputs_per_join.max(2))
+            .map(|(commitment, _)| commitment.clone())
+            .collect();
+        return Some(CompactionAction::Join { commitments });
+    }
+
+    if policy.target_split_count == 0 || policy.target_split_value == 0 {
+        return None;
+    }
+    let pool_size = outputs
+        .iter()
+        .filter(|(_, value)| policy.is_in_split_pool(*value))
+        .count();
+    let deficit = policy.target_split_count.saturating_sub(pool_size);
+    if deficit < 2 {
+        return None;
+    }
+    // Split the smallest output that can fill the whole deficit, otherwise the largest output that can be split at
+    // all. Every split output is worth exactly the target value, so it lands in the pool, and the rest of the value
+    // stays in a single change output that also pays the fee.
+    let required = |split_count: usize| {
+        policy
+            .target_split_value
+            .saturating_mul(u64::try_from(split_count).unwrap_or(u64::MAX))
+            .saturating_add(split_fee(split_count).as_u64())
+    };
+    let mut candidates = outputs
+        .iter()
+        .filter(|(_, value)| value.as_u64() > required(2))
+        .collect::<Vec<_>>();
+    candidates.sort_by_key(|(_, value)| *value);
+    let (commitment, value) = candidates
+        .iter()
+        .find(|(_, value)| value.as_u64() > required(deficit))
+        .or_else(|| candidates.last())?;
+    let mut split_count = usize::try_from(value.as_u64() / policy.target_split_value)
+        .unwrap_or(usize::MAX)
+        .min(deficit);
+    while value.as_u64() <= required(split_count) {
+        split_count -= 1;
+    }
+    Some(CompactionAction::Split {
+        commitment: commitment.clone(),
+        split_count,
+    })
+}
+
+/// Periodically compacts the wallet's unspent outputs according to the current `UtxoCompactionPolicy`
+pub struct UtxoCompactionTask {
+    output_manager_service: OutputManagerHandle,
+    transaction_service: TransactionServiceHandle,
+    policy: Watch<UtxoCompactionPolicy>,
+    spent_fees: VecDeque<(Instant, MicroMinotari)>,
+    last_action: Option<Instant>,
+    consecutive_failures: u32,
+    retry_at: Option<Instant>,
+}
+
+impl UtxoCompactionTask {
+    pub fn new(
+        output_manager_service: OutputManagerHandle,
+        transaction_service: TransactionServiceHandle,
+        policy: Watch<UtxoCompactionPolicy>,
+    ) -> Self {
+        Self {
+            output_manager_service,
+            transaction_service,
+            policy,
+            spent_fees: VecDeque::new(),
+            last_action: None,
+            consecutive_failures: 0,
+            retry_at: None,
+        }
+    }
+
+    pub async fn run(mut self, mut shutdown_signal: ShutdownSignal) {
+        let mut interval = time::interval(COMPACTION_TICK_INTERVAL);
+        interval.set_missed_tick_behavior(MissedTickBehavior::Delay);
+        let mut policy_updates = self.policy.get_receiver();
+        loop {
+            tokio::select! {
+                _ = interval.tick() => {},
+                Ok(_) = policy_updates.changed() => {
+                    debug!(target: LOG_TARGET, "UTXO compaction policy updated: {:?}", *policy_updates.borrow());
+                    // The new policy may not run into whatever made the last attempts fail
+                    self.consecutive_failures = 0;
+                    self.retry_at = None;
+                },
+                _ = shutdown_signal.wait() => {
+                    info!(target: LOG_TARGET, "UTXO compaction task shutting down because of the shutdown signal");
+                    return;
+                },
+            }
+            let policy = self.policy.borrow().clone();
+            if !policy.enabled {
+                continue;
+            }
+            if self.retry_at.is_some_and(|retry_at| Instant::now() < retry_at) {
+                continue;
+            }
+            match self.compact(&policy).await {
+                Ok(()) => {
+                    self.consecutive_failures = 0;
+                    self.retry_at = None;
+                },
+                Err(e) => {
+                    let backoff = COMPACTION_TICK_INTERVAL
+                        .saturating_mul(2u32.saturating_pow(self.consecutive_failures))
+                        .min(MAX_COMPACTION_BACKOFF);
+                    self.consecutive_failures = self.consecutive_failures.saturating_add(1);
+                    self.retry_at = Some(Instant::now() + backoff);
+                    warn!(
+                        target: LOG_TARGET,
+                        "UTXO compaction failed ({} times in a row), retrying in {:.0?}: {}",
+                        self.consecutive_failures,
+                        backoff,
+                        e
+                    );
+                },
+            }
+        }
+    }
+
+    async fn compact(&mut self, policy: &UtxoCompactionPolicy) -> Result<(), String> {
+        let now = Instant::now();
+        if self
+            .last_action
+            .is_some_and(|last| now.duration_since(last) < Duration::from_secs(policy.min_interval_secs))
+        {
+            return Ok(());
+        }
+        let budget_period = Duration::from_secs(policy.budget_period_secs);
+        while self
+            .spent_fees
+            .front()
+            .is_some_and(|(at, _)| now.duration_since(*at) >= budget_period)
+        {
+            self.spent_fees.pop_front();
+        }
+        let spent = self.spent_fees.iter().map(|(_, fee)| *fee).sum::<MicroMinotari>();
+        let remaining_budget = MicroMinotari(policy.fee_budget.saturating_sub(spent.as_u64()));
+
+        let outputs = self
+            .output_manager_service
+            .get_unspent_outputs()
+            .await
+            .map_err(|e| e.to_string())?
+            .into_iter()
+            .map(|o: DbWalletOutput| (o.commitment, o.wallet_output.value))
+            .collect::<Vec<_>>();
+        let histogram = UtxoValueHistogram::new(outputs.iter().map(|(_, value)| *value));
+        debug!(
+            target: LOG_TARGET,
+            "{} unspent outputs, counts per decade: {:?}, fee budget remaining: {}",
+            histogram.total_count(),
+            histogram.counts,
+            remaining_budget
+        );
+
+        // Compaction only happens at a fee per gram of at most `max_fee_per_gram`, so splits are planned with it
+        let fee_calc = Fee::new(TransactionWeight::latest());
+        let features_and_scripts_size = fee_calc.weighting().round_up_features_and_scripts_size(
+            OutputFeatures::default()
+                .get_serialized_size()
+                .map_err(|e| e.to_string())? +
+                TariScript::default().get_serialized_size().map_err(|e| e.to_string())?,
+        );
+        let max_fee_per_gram = MicroMinotari(policy.max_fee_per_gram.max(1));
+        let split_fee = |split_count: usize| {
+            fee_calc.calculate(
+                max_fee_per_gram,
+                1,
+                1,
+                split_count + 1,
+                features_and_scripts_size * (split_count + 1),
+            )
+        };
+        let action = match plan_compaction(policy, &outputs, split_fee) {
+            Some(action) => action,
+            None => return Ok(()),
+        };
+
+        let fee_per_gram = self
+            .transaction_service
+            .get_fee_per_gram_stats_per_block(FEE_STATS_BLOCK_COUNT)
+            .await
+            .map_err(|e| e.to_string())?
+            .stats
+            .first()
+            .map(|stat| stat.min_fee_per_gram.max(MicroMinotari(1)))
+            .unwrap_or(MicroMinotari(1));
+        if fee_per_gram.as_u64() > policy.max_fee_per_gram {
+            debug!(
+                target: LOG_TARGET,
+                "Postponing UTXO compaction, the mempool fee per gram {} is above {}",
+                fee_per_gram,
+                policy.max_fee_per_gram
+            );
+            return Ok(());
+        }
+
+        let (expected_fee, result) = match action {
+            CompactionAction::Join { commitments } => {
+                let (_, fee) = self
+                    .output_manager_service
+                    .preview_coin_join_with_commitments(commitments.clone(), fee_per_gram)
+                    .await
+                    .map_err(|e| e.to_string())?;
+                if fee > remaining_budget {
+                    debug!(target: LOG_TARGET, "Joining dust needs a fee of {}, over the remaining budget", fee);
+                    return Ok(());
+                }
+                let num_inputs = commitments.len();
+                let result = self
+                    .output_manager_service
+                    .create_coin_join(commitments, fee_per_gram)
+                    .await
+                    .map(|tx| (tx, format!("Compaction: joined {} dust outputs", num_inputs)));
+                (fee, result)
+            },
+            CompactionAction::Split {
+                commitment,
+                split_count,
+            } => {
+                // The split has the same shape as an even split into one more output, the change
+                let (_, fee) = self
+                    .output_manager_service
+                    .preview_coin_split_with_commitments_no_amount(
+                        vec![commitment.clone()],
+                        split_count + 1,
+                        fee_per_gram,
+                    )
+                    .await
+                    .map_err(|e| e.to_string())?;
+                if fee > remaining_budget {
+                    debug!(target: LOG_TARGET, "Splitting needs a fee of {}, over the remaining budget", fee);
+                    return Ok(());
+                }
+                let result = self
+                    .output_manager_service
+                    .create_coin_split(
+                        vec![commitment],
+                        MicroMinotari(policy.target_split_value),
+                        split_count,
+                        fee_per_gram,
+                    )
+                    .await
+                    .map(|tx| (tx, format!("Compaction: split into {} outputs", split_count)));
+                (fee, result)
+            },
+        };
+        let ((tx_id, tx, amount), message) = result.map_err(|e| e.to_string())?;
+        let fee = tx.body.get_total_fee().unwrap_or(expected_fee);
+        self.transaction_service
+            .submit_transaction(tx_id, tx, amount, message)
+            .await
+            .map_err(|e| e.to_string())?;
+        info!(target: LOG_TARGET, "Submitted UTXO compaction transaction {} with a fee of {}", tx_id, fee);
+        self.spent_fees.push_back((now, fee));
+        self.last_action = Some(now);
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use tari_common_types::types::PrivateKey;
+    use tari_core::transactions::CryptoFactories;
+    use tari_crypto::{commitment::HomomorphicCommitmentFactory, keys::SecretKey};
+
+    use super::*;
+
+    fn utxos(values: &[u64]) -> Vec<(Commitment, MicroMinotari)> {
+        let factories = CryptoFactories::default();
+        values
+            .iter()
+            .map(|v| {
+                let k = PrivateKey::random(&mut rand::thread_rng());
+                (factories.commitment.commit_value(&k, *v), MicroMinotari(*v))
+            })
+            .collect()
+    }
+
+    /// A flat fee per output, which makes the split counts in the tests easy to follow
+    fn split_fee(split_count: usize) -> MicroMinotari {
+        MicroMinotari(100 * (split_count as u64 + 1))
+    }
+
+    fn policy() -> UtxoCompactionPolicy {
+        UtxoCompactionPolicy {
+            enabled: true,
+            dust_threshold: 1_000,
+            min_dust_outputs: 3,
+            max_inputs_per_join: 2,
+            target_split_count: 4,
+            target_split_value: 10_000,
+            ..Default::default()
+        }
+    }
+
+    #[test]
+    fn it_joins_the_most_valuable_dust_first() {
+        let outputs = utxos(&[100, 900, 500, 50_000]);
+        let action = plan_compaction(&policy(), &outputs, split_fee).unwrap();
+        assert_eq!(action, CompactionAction::Join {
+            commitments: vec![outputs[1].0.clone(), outputs[2].0.clone()]
+        });
+
+        // Too little dust to be worth joining, so the split pool is topped up instead
+        let outputs = outputs[1..].to_vec();
+        assert!(matches!(
+            plan_compaction(&policy(), &outputs, split_fee),
+            Some(CompactionAction::Split { .. })
+        ));
+    }
+
+    #[test]
+    fn it_tops_up_the_split_pool() {
+        // One output is already in the pool, the smallest output that can fill the deficit of 3 is split
+        let outputs = utxos(&[12_000, 25_000, 35_000, 1_000_000]);
+        assert_eq!(
+            plan_compaction(&policy(), &outputs, split_fee),
+            Some(CompactionAction::Split {
+                commitment: outputs[2].0.clone(),
+                split_count: 3,
+            })
+        );
+
+        // Without an output that can fill the deficit, the largest one is split as far as it goes
+        let outputs = utxos(&[25_000]);
+        assert_eq!(
+            plan_compaction(&policy(), &outputs, split_fee),
+            Some(CompactionAction::Split {
+                commitment: outputs[0].0.clone(),
+                split_count: 2,
+            })
+        );
+
+        // An output far above the pool is split into the whole deficit, the rest of it stays in the change
+        let outputs = utxos(&[10_000, 1_000_000_000_000]);
+        assert_eq!(
+            plan_compaction(&policy(), &outputs, split_fee),
+            Some(CompactionAction::Split {
+                commitment: outputs[1].0.clone(),
+                split_count: 3,
+            })
+        );
+
+        // An output just over twice the target cannot pay the fee of a split into two
+        let outputs = utxos(&[20_001, 20_300]);
+        assert_eq!(plan_compaction(&policy(), &outputs, split_fee), None);
+
+        // An output that cannot pay the fee of a split into three is split into two
+        let outputs = utxos(&[30_100]);
+        assert_eq!(
+            plan_compaction(&policy(), &outputs, split_fee),
+            Some(CompactionAction::Split {
+                commitment: outputs[0].0.clone(),
+                split_count: 2,
+            })
+        );
+
+        // A full pool needs no split
+        let outputs = utxos(&[10_000, 12_000, 15_000, 19_000, 1_000_000]);
+        assert_eq!(plan_compaction(&policy(), &outputs, split_fee), None);
+    }
+
+    #[test]
+    fn it_rejects_policies_that_split_into_dust() {
+        assert!(policy().validate().is_ok());
+        let policy = UtxoCompactionPolicy {
+            target_split_value: 2_000,
+            ..policy()
+        };
+        assert!(policy.validate().is_err());
+    }
+
+    #[test]
+    fn it_buckets_values_by_decade() {
+        let histogram = UtxoValueHistogram::new([0, 9, 10, 999, 1_000].into_iter().map(MicroMinotari));
+        assert_eq!(histogram.counts[..4], [2, 1, 1, 1]);
+        assert_eq!(histogram.values[..4], [9, 10, 999, 1_000]);
+        assert_eq!(histogram.total_count(), 5);
+    }
+}
@@ -49,6 +49,13 @@ pub trait WalletBackend: Send + Sync + Clone {
 
     fn get_scanned_blocks(&self) -> Result<Vec<ScannedBlock>, WalletStorageError>;
     fn save_scanned_block(&self, scanned_block: ScannedBlock) -> Result<(), WalletStorageError>;
+    /// Save a batch of scanned blocks and clear the scanned block history from before `clear_before_height`, excluding
+    /// blocks that contained recovered outputs, in a single database transaction
+    fn save_scanned_blocks(
+        &self,
+        scanned_blocks: Vec<ScannedBlock>,
+        clear_before_height: u64,
+    ) -> Result<(), WalletStorageError>;
     fn clear_scanned_blocks(&self) -> Result<(), WalletStorageError>;
     /// Clear scanned blocks from the givne height and higher
     fn clear_scanned_blocks_from_and_higher(&self, height: u64) -> Result<(), WalletStorageError>;
@@ -348,6 +355,15 @@ where T: WalletBackend + 'static
         Ok(())
     }
 
+    pub fn save_scanned_blocks(
+        &self,
+        scanned_blocks: Vec<ScannedBlock>,
+        clear_before_height: u64,
+    ) -> Result<(), WalletStorageError> {
+        self.db.save_scanned_blocks(scanned_blocks, clear_before_height)?;
+        Ok(())
+    }
+
     pub fn clear_scanned_blocks(&self) -> Result<(), WalletStorageError> {
         self.db.clear_scanned_blocks()?;
         Ok(())
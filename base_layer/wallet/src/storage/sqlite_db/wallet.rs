@@ -563,6 +563,20 @@ impl WalletBackend for WalletSqliteDatabase {
         ScannedBlockSql::from(scanned_block).commit(&mut conn)
     }
 
+    fn save_scanned_blocks(
+        &self,
+        scanned_blocks: Vec<ScannedBlock>,
+        clear_before_height: u64,
+    ) -> Result<(), WalletStorageError> {
+        let mut conn = self.database_connection.get_pooled_connection()?;
+        conn.transaction::<_, WalletStorageError, _>(|conn| {
+            for scanned_block in scanned_blocks {
+                ScannedBlockSql::from(scanned_block).commit(conn)?;
+            }
+            ScannedBlockSql::clear_before_height(clear_before_height, true, conn)
+        })
+    }
+
     fn clear_scanned_blocks(&self) -> Result<(), WalletStorageError> {
         let mut conn = self.database_connection.get_pooled_connection()?;
         ScannedBlockSql::clear_all(&mut conn)
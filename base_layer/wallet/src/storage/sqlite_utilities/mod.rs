@@ -25,6 +25,7 @@ use std::{fs::File, ops::DerefMut, path::Path, time::Duration};
 use diesel_migrations::{EmbeddedMigrations, MigrationHarness};
 use fs2::FileExt;
 use log::*;
+pub use tari_common_sqlite::connection_options::{SqlitePerformanceProfile, SqliteSynchronous, SqliteTempStore};
 use tari_common_sqlite::sqlite_connection_pool::SqliteConnectionPool;
 use tari_contacts::contacts_service::storage::sqlite_db::ContactsServiceSqliteDatabase;
 use tari_key_manager::key_manager_service::storage::sqlite_db::KeyManagerSqliteDatabase;
@@ -48,6 +49,16 @@ const LOG_TARGET: &str = "wallet::storage:sqlite_utilities";
 pub fn run_migration_and_create_sqlite_connection<P: AsRef<Path>>(
     db_path: P,
     sqlite_pool_size: usize,
+) -> Result<WalletDbConnection, WalletStorageError> {
+    run_migration_and_create_sqlite_connection_with_profile(db_path, SqlitePerformanceProfile {
+        pool_size: sqlite_pool_size,
+        ..Default::default()
+    })
+}
+
+pub fn run_migration_and_create_sqlite_connection_with_profile<P: AsRef<Path>>(
+    db_path: P,
+    profile: SqlitePerformanceProfile,
 ) -> Result<WalletDbConnection, WalletStorageError> {
     let file_lock = acquire_exclusive_file_lock(db_path.as_ref())?;
 
@@ -58,11 +69,12 @@ pub fn run_migration_and_create_sqlite_connection<P: AsRef<Path>>(
 
     let mut pool = SqliteConnectionPool::new(
         String::from(path_str),
-        sqlite_pool_size,
+        profile.pool_size,
         true,
         true,
         Duration::from_secs(60),
-    );
+    )
+    .with_performance_profile(profile);
     pool.create_pool()?;
     let mut connection = pool.get_pooled_connection()?;
 
@@ -131,7 +143,7 @@ pub fn acquire_exclusive_file_lock(db_path: &Path) -> Result<File, WalletStorage
 pub fn initialize_sqlite_database_backends<P: AsRef<Path>>(
     db_path: P,
     passphrase: SafePassword,
-    sqlite_pool_size: usize,
+    sqlite_profile: SqlitePerformanceProfile,
 ) -> Result<
     (
         WalletSqliteDatabase,
@@ -142,7 +154,7 @@ pub fn initialize_sqlite_database_backends<P: AsRef<Path>>(
     ),
     WalletStorageError,
 > {
-    let connection = run_migration_and_create_sqlite_connection(db_path, sqlite_pool_size).map_err(|e| {
+    let connection = run_migration_and_create_sqlite_connection_with_profile(db_path, sqlite_profile).map_err(|e| {
         error!(
             target: LOG_TARGET,
             "Error creating Sqlite Connection in Wallet: {:?}", e
@@ -164,6 +176,63 @@ pub fn initialize_sqlite_database_backends<P: AsRef<Path>>(
     ))
 }
 
+/// Opens the backends of an existing wallet database for reading only. No migrations are run and the exclusive file
+/// lock is not taken, so the database can be read while another process has the wallet open. The database must have
+/// been created, and migrated to this version, by a full wallet.
+#[allow(clippy::type_complexity)]
+pub fn open_sqlite_database_backends_readonly<P: AsRef<Path>>(
+    db_path: P,
+    passphrase: SafePassword,
+    sqlite_profile: SqlitePerformanceProfile,
+) -> Result<
+    (
+        WalletSqliteDatabase,
+        TransactionServiceSqliteDatabase,
+        OutputManagerSqliteDatabase,
+    ),
+    WalletStorageError,
+> {
+    if !db_path.as_ref().is_file() {
+        return Err(WalletStorageError::DbPathDoesNotExist);
+    }
+    let path_str = db_path
+        .as_ref()
+        .to_str()
+        .ok_or(WalletStorageError::InvalidUnicodePath)?;
+
+    let mut pool = SqliteConnectionPool::new(
+        String::from(path_str),
+        sqlite_profile.pool_size,
+        true,
+        true,
+        Duration::from_secs(60),
+    )
+    .with_performance_profile(sqlite_profile);
+    pool.create_pool()?;
+    {
+        let mut connection = pool.get_pooled_connection()?;
+        const MIGRATIONS: EmbeddedMigrations = embed_migrations!("./migrations");
+        let has_pending_migrations = connection.has_pending_migration(MIGRATIONS).map_err(|err| {
+            WalletStorageError::DatabaseMigrationError(format!("Could not read the database migrations {}", err))
+        })?;
+        if has_pending_migrations {
+            return Err(WalletStorageError::DatabaseMigrationError(
+                "The database has pending migrations and must be opened by a full wallet first".to_string(),
+            ));
+        }
+        // The wallet backend would set up encryption for a database that was never used by a wallet
+        if WalletSettingSql::get(&DbKey::MasterSeed, connection.deref_mut())?.is_none() {
+            return Err(WalletStorageError::ValueNotFound(DbKey::MasterSeed));
+        }
+    }
+    let connection = WalletDbConnection::new(pool, None);
+
+    let wallet_backend = WalletSqliteDatabase::new(connection.clone(), passphrase)?;
+    let transaction_backend = TransactionServiceSqliteDatabase::new(connection.clone(), wallet_backend.cipher());
+    let output_manager_backend = OutputManagerSqliteDatabase::new(connection);
+    Ok((wallet_backend, transaction_backend, output_manager_backend))
+}
+
 pub fn get_last_version<P: AsRef<Path>>(db_path: P) -> Result<Option<String>, WalletStorageError> {
     let path_str = db_path
         .as_ref()
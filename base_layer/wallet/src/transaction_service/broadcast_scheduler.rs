@@ -0,0 +1,592 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::{
+    collections::{HashMap, VecDeque},
+    convert::TryFrom,
+    sync::{
+        atomic::{AtomicUsize, Ordering},
+        Arc,
+    },
+    time::Duration,
+};
+
+use futures::{future, future::BoxFuture, stream::FuturesUnordered, FutureExt, StreamExt};
+use log::*;
+use tari_common_types::{transaction::TxId, types::Signature};
+use tari_comms::protocol::rpc::{RpcError, RpcStatus, RpcStatusCode};
+use tari_core::{
+    base_node::{
+        proto::wallet_rpc::{TxQueryBatchResponse, TxQueryResponse, TxSubmissionResponse},
+        rpc::BaseNodeWalletRpcClient,
+    },
+    proto::{
+        base_node::Signatures as SignaturesProto,
+        types::{Signature as SignatureProto, Transaction as TransactionProto},
+    },
+};
+use tari_shutdown::ShutdownSignal;
+use tokio::{
+    sync::{mpsc, oneshot},
+    time::sleep,
+};
+
+use crate::{
+    connectivity_service::WalletConnectivityInterface,
+    transaction_service::{config::TransactionServiceConfig, error::TransactionServiceError},
+};
+
+const LOG_TARGET: &str = "wallet::transaction_service::broadcast_scheduler";
+/// The number of attempts after which a request the base node answers with not found is no longer retried
+const MAX_NOT_FOUND_ATTEMPTS: u32 = 3;
+
+/// A snapshot of the work of the broadcast scheduler
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct BroadcastQueueStats {
+    /// The submissions and status queries waiting for a batch
+    pub queued: usize,
+    /// The submissions and status queries in batches that are being sent, or backing off after a failed attempt
+    pub in_flight: usize,
+    /// The number of batches that are being sent, or backing off after a failed attempt
+    pub batches_in_flight: usize,
+}
+
+#[derive(Default)]
+struct BroadcastQueueCounters {
+    queued: AtomicUsize,
+    in_flight: AtomicUsize,
+    batches_in_flight: AtomicUsize,
+}
+
+struct Submission {
+    tx_id: TxId,
+    transaction: TransactionProto,
+    reply: oneshot::Sender<Result<TxSubmissionResponse, TransactionServiceError>>,
+    attempts: u32,
+}
+
+struct Query {
+    tx_id: TxId,
+    signature: Signature,
+    reply: oneshot::Sender<Result<TxQueryResponse, TransactionServiceError>>,
+    attempts: u32,
+}
+
+/// A submission or status query waiting for its reply
+trait PendingRequest {
+    /// The number of failed attempts at sending the request
+    fn attempts(&self) -> u32;
+
+    /// Whether the protocol that made the request is no longer waiting for the reply
+    fn is_abandoned(&self) -> bool;
+
+    /// Resolves when the protocol that made the request stops waiting for the reply
+    fn abandoned(&mut self) -> BoxFuture<'_, ()>;
+}
+
+impl PendingRequest for Submission {
+    fn attempts(&self) -> u32 {
+        self.attempts
+    }
+
+    fn is_abandoned(&self) -> bool {
+        self.reply.is_closed()
+    }
+
+    fn abandoned(&mut self) -> BoxFuture<'_, ()> {
+        self.reply.closed().boxed()
+    }
+}
+
+impl PendingRequest for Query {
+    fn attempts(&self) -> u32 {
+        self.attempts
+    }
+
+    fn is_abandoned(&self) -> bool {
+        self.reply.is_closed()
+    }
+
+    fn abandoned(&mut self) -> BoxFuture<'_, ()> {
+        self.reply.closed().boxed()
+    }
+}
+
+/// A batch that has been sent, with the requests that failed and should be retried after a backoff
+enum SentBatch {
+    Submissions { batch_size: usize, retry: Vec<Submission> },
+    Queries { batch_size: usize, retry: Vec<Query> },
+}
+
+/// The failed requests of a batch whose backoff has elapsed
+enum BackedOffBatch {
+    Submissions(Vec<Submission>),
+    Queries(Vec<Query>),
+}
+
+enum BroadcastRequest {
+    Submit(Submission),
+    Query(Query),
+}
+
+/// Sends the transaction submissions and status queries of all the broadcast protocols to the base node in batches,
+/// rather than every protocol running its own submit and query loop. Status queries are answered by one
+/// `transaction_batch_query` call per batch. The base node has no batch submission call, so the submissions of a batch
+/// are sent one after the other on a single RPC session. At most `max_broadcast_batches_in_flight` batches are sent at
+/// a time. A request is sent on its own when nothing of its kind is being sent; otherwise requests wait until they
+/// fill a batch or the batches being sent complete, so that a wallet restarting hundreds of broadcast protocols after
+/// an outage sends a handful of batches rather than hundreds of calls.
+///
+/// Requests whose call fails are put back at the front of the queue after an exponential backoff, which ends early
+/// if their protocols stop waiting, and do not hold up other work while they back off. A bad request, or a request
+/// the base node still answers with not found after `MAX_NOT_FOUND_ATTEMPTS` attempts, is not retried and its error
+/// is returned to the protocol.
+#[derive(Clone)]
+pub struct TransactionBroadcastScheduler {
+    sender: mpsc::UnboundedSender<BroadcastRequest>,
+    counters: Arc<BroadcastQueueCounters>,
+}
+
+impl TransactionBroadcastScheduler {
+    /// Starts the scheduler, which runs until the shutdown signal is triggered
+    pub fn spawn<TWalletConnectivity>(
+        connectivity: TWalletConnectivity,
+        config: &TransactionServiceConfig,
+        shutdown_signal: ShutdownSignal,
+    ) -> Self
+    where
+        TWalletConnectivity: WalletConnectivityInterface,
+    {
+        let (sender, receiver) = mpsc::unbounded_channel();
+        let counters = Arc::new(BroadcastQueueCounters::default());
+        let runner = BroadcastSchedulerRunner {
+            connectivity,
+            receiver,
+            counters: counters.clone(),
+            submissions: VecDeque::new(),
+            queries: VecDeque::new(),
+            submission_batches_in_flight: 0,
+            query_batches_in_flight: 0,
+            max_submission_batch_size: config.max_tx_submission_batch_size.max(1),
+            max_query_batch_size: config.max_tx_query_batch_size.max(1),
+            max_batches_in_flight: config.max_broadcast_batches_in_flight.max(1),
+            initial_backoff: config.broadcast_retry_backoff,
+            max_backoff: config.max_broadcast_retry_backoff,
+            shutdown_signal,
+        };
+        tokio::spawn(runner.run());
+        Self { sender, counters }
+    }
+
+    /// Submits a transaction to the mempool of the base node, returning the response of the base node
+    pub async fn submit_transaction(
+        &self,
+        tx_id: TxId,
+        transaction: TransactionProto,
+    ) -> Result<TxSubmissionResponse, TransactionServiceError> {
+        let (reply, reply_rx) = oneshot::channel();
+        self.enqueue(BroadcastRequest::Submit(Submission {
+            tx_id,
+            transaction,
+            reply,
+            attempts: 0,
+        }))?;
+        reply_rx.await.map_err(|_| TransactionServiceError::Shutdown)?
+    }
+
+    /// Queries the location of a transaction, identified by its first kernel signature, on the base node
+    pub async fn query_transaction(
+        &self,
+        tx_id: TxId,
+        signature: Signature,
+    ) -> Result<TxQueryResponse, TransactionServiceError> {
+        let (reply, reply_rx) = oneshot::channel();
+        self.enqueue(BroadcastRequest::Query(Query {
+            tx_id,
+            signature,
+            reply,
+            attempts: 0,
+        }))?;
+        reply_rx.await.map_err(|_| TransactionServiceError::Shutdown)?
+    }
+
+    pub fn stats(&self) -> BroadcastQueueStats {
+        BroadcastQueueStats {
+            queued: self.counters.queued.load(Ordering::Relaxed),
+            in_flight: self.counters.in_flight.load(Ordering::Relaxed),
+            batches_in_flight: self.counters.batches_in_flight.load(Ordering::Relaxed),
+        }
+    }
+
+    fn enqueue(&self, request: BroadcastRequest) -> Result<(), TransactionServiceError> {
+        self.counters.queued.fetch_add(1, Ordering::Relaxed);
+        self.sender.send(request).map_err(|_| {
+            self.counters.queued.fetch_sub(1, Ordering::Relaxed);
+            TransactionServiceError::Shutdown
+        })
+    }
+}
+
+struct BroadcastSchedulerRunner<TWalletConnectivity> {
+    connectivity: TWalletConnectivity,
+    receiver: mpsc::UnboundedReceiver<BroadcastRequest>,
+    counters: Arc<BroadcastQueueCounters>,
+    submissions: VecDeque<Submission>,
+    queries: VecDeque<Query>,
+    submission_batches_in_flight: usize,
+    query_batches_in_flight: usize,
+    max_submission_batch_size: usize,
+    max_query_batch_size: usize,
+    max_batches_in_flight: usize,
+    initial_backoff: Duration,
+    max_backoff: Duration,
+    shutdown_signal: ShutdownSignal,
+}
+
+impl<TWalletConnectivity> BroadcastSchedulerRunner<TWalletConnectivity>
+where TWalletConnectivity: WalletConnectivityInterface
+{
+    async fn run(mut self) {
+        let mut batches = FuturesUnordered::<BoxFuture<'static, SentBatch>>::new();
+        let mut backing_off = FuturesUnordered::<BoxFuture<'static, BackedOffBatch>>::new();
+        loop {
+            self.dispatch_batches(&mut batches);
+            tokio::select! {
+                request = self.receiver.recv() => {
+                    match request {
+                        Some(BroadcastRequest::Submit(submission)) => self.submissions.push_back(submission),
+                        Some(BroadcastRequest::Query(query)) => self.queries.push_back(query),
+                        None => break,
+                    }
+                },
+                Some(sent) = batches.next() => self.complete_batch(sent, &mut backing_off),
+                Some(backed_off) = backing_off.next() => self.requeue(backed_off),
+                _ = self.shutdown_signal.wait() => {
+                    info!(target: LOG_TARGET, "Transaction broadcast scheduler shutting down because it received the shutdown signal");
+                    break;
+                },
+            }
+        }
+    }
+
+    /// Starts as many batches as the in flight limit allows, submissions first so that new transactions reach the
+    /// mempool before the status of older ones is checked
+    fn dispatch_batches(&mut self, batches: &mut FuturesUnordered<BoxFuture<'static, SentBatch>>) {
+        while batches.len() < self.max_batches_in_flight {
+            let batch = if let Some(batch) = self.take_batch_of_submissions() {
+                let batch_size = batch.len();
+                self.submission_batches_in_flight += 1;
+                send_submissions(self.connectivity.clone(), batch)
+                    .map(move |retry| SentBatch::Submissions { batch_size, retry })
+                    .boxed()
+            } else if let Some(batch) = self.take_batch_of_queries() {
+                let batch_size = batch.len();
+                self.query_batches_in_flight += 1;
+                send_queries(self.connectivity.clone(), batch)
+                    .map(move |retry| SentBatch::Queries { batch_size, retry })
+                    .boxed()
+            } else {
+                break;
+            };
+            batches.push(batch);
+            self.counters.batches_in_flight.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// Sets the failed requests of a sent batch aside until their backoff has elapsed. The batch no longer counts
+    /// towards the batches being sent, so new work is dispatched while it backs off.
+    fn complete_batch(
+        &mut self,
+        sent: SentBatch,
+        backing_off: &mut FuturesUnordered<BoxFuture<'static, BackedOffBatch>>,
+    ) {
+        let (batch_size, num_retries) = match sent {
+            SentBatch::Submissions { batch_size, retry } => {
+                self.submission_batches_in_flight -= 1;
+                let num_retries = retry.len();
+                if !retry.is_empty() {
+                    let backoff = self.backoff(&retry);
+                    backing_off.push(back_off(retry, backoff).map(BackedOffBatch::Submissions).boxed());
+                }
+                (batch_size, num_retries)
+            },
+            SentBatch::Queries { batch_size, retry } => {
+                self.query_batches_in_flight -= 1;
+                let num_retries = retry.len();
+                if !retry.is_empty() {
+                    let backoff = self.backoff(&retry);
+                    backing_off.push(back_off(retry, backoff).map(BackedOffBatch::Queries).boxed());
+                }
+                (batch_size, num_retries)
+            },
+        };
+        self.counters
+            .in_flight
+            .fetch_sub(batch_size - num_retries, Ordering::Relaxed);
+        if num_retries == 0 {
+            self.counters.batches_in_flight.fetch_sub(1, Ordering::Relaxed);
+        }
+    }
+
+    /// Puts the requests of a batch that has backed off back at the front of their queue
+    fn requeue(&mut self, backed_off: BackedOffBatch) {
+        let batch_size = match backed_off {
+            BackedOffBatch::Submissions(batch) => requeue_batch(&mut self.submissions, batch, &self.counters),
+            BackedOffBatch::Queries(batch) => requeue_batch(&mut self.queries, batch, &self.counters),
+        };
+        self.counters.in_flight.fetch_sub(batch_size, Ordering::Relaxed);
+        self.counters.batches_in_flight.fetch_sub(1, Ordering::Relaxed);
+    }
+
+    /// The backoff doubles with every failed attempt of the request that has failed most often
+    fn backoff<T: PendingRequest>(&self, batch: &[T]) -> Duration {
+        let attempts = batch.iter().map(PendingRequest::attempts).max().unwrap_or(1);
+        let factor = 2u32.checked_pow(attempts.saturating_sub(1)).unwrap_or(u32::MAX);
+        self.initial_backoff.saturating_mul(factor).min(self.max_backoff)
+    }
+
+    fn take_batch_of_submissions(&mut self) -> Option<Vec<Submission>> {
+        if self.submissions.len() < self.max_submission_batch_size && self.submission_batches_in_flight > 0 {
+            return None;
+        }
+        let batch = take_batch(&mut self.submissions, self.max_submission_batch_size, &self.counters);
+        (!batch.is_empty()).then_some(batch)
+    }
+
+    fn take_batch_of_queries(&mut self) -> Option<Vec<Query>> {
+        if self.queries.len() < self.max_query_batch_size && self.query_batches_in_flight > 0 {
+            return None;
+        }
+        let batch = take_batch(&mut self.queries, self.max_query_batch_size, &self.counters);
+        (!batch.is_empty()).then_some(batch)
+    }
+}
+
+/// Takes up to `max_size` requests off the queue, dropping the ones whose protocol is no longer waiting
+fn take_batch<T: PendingRequest>(
+    queue: &mut VecDeque<T>,
+    max_size: usize,
+    counters: &BroadcastQueueCounters,
+) -> Vec<T> {
+    let mut batch = Vec::with_capacity(max_size.min(queue.len()));
+    while batch.len() < max_size {
+        let request = match queue.pop_front() {
+            Some(request) => request,
+            None => break,
+        };
+        counters.queued.fetch_sub(1, Ordering::Relaxed);
+        if !request.is_abandoned() {
+            batch.push(request);
+        }
+    }
+    counters.in_flight.fetch_add(batch.len(), Ordering::Relaxed);
+    batch
+}
+
+/// Puts the requests that are still awaited back at the front of the queue, in their original order. Returns the size
+/// of the batch.
+fn requeue_batch<T: PendingRequest>(
+    queue: &mut VecDeque<T>,
+    batch: Vec<T>,
+    counters: &BroadcastQueueCounters,
+) -> usize {
+    let batch_size = batch.len();
+    for request in batch.into_iter().rev() {
+        if !request.is_abandoned() {
+            queue.push_front(request);
+            counters.queued.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+    batch_size
+}
+
+/// Waits out the backoff of a failed batch, or until none of its protocols are waiting any more
+async fn back_off<T: PendingRequest>(mut batch: Vec<T>, backoff: Duration) -> Vec<T> {
+    {
+        let all_abandoned = future::join_all(batch.iter_mut().map(PendingRequest::abandoned));
+        tokio::select! {
+            _ = sleep(backoff) => {},
+            _ = all_abandoned => {},
+        }
+    }
+    batch
+}
+
+/// The status of a failed call that is not worth retrying: a bad request, or a not found answer after
+/// `MAX_NOT_FOUND_ATTEMPTS` attempts
+fn rejection_status(error: &RpcError, attempts: u32) -> Option<&RpcStatus> {
+    match error {
+        RpcError::RequestFailed(status) => match status.as_status_code() {
+            RpcStatusCode::BadRequest => Some(status),
+            RpcStatusCode::NotFound if attempts >= MAX_NOT_FOUND_ATTEMPTS => Some(status),
+            _ => None,
+        },
+        _ => None,
+    }
+}
+
+/// Sends the submissions of a batch and returns the ones that failed and should be retried
+async fn send_submissions<TWalletConnectivity: WalletConnectivityInterface>(
+    mut connectivity: TWalletConnectivity,
+    batch: Vec<Submission>,
+) -> Vec<Submission> {
+    let mut client = match connectivity.obtain_base_node_wallet_rpc_client().await {
+        Some(client) => BaseNodeWalletRpcClient::clone(&client),
+        None => return Vec::new(),
+    };
+    debug!(
+        target: LOG_TARGET,
+        "Submitting a batch of {} transactions to the base node",
+        batch.len()
+    );
+    let mut retry = Vec::new();
+    for mut submission in batch {
+        if submission.is_abandoned() {
+            continue;
+        }
+        match client.submit_transaction(submission.transaction.clone()).await {
+            Ok(response) => {
+                let response =
+                    TxSubmissionResponse::try_from(response).map_err(TransactionServiceError::InvalidMessageError);
+                let _ = submission.reply.send(response);
+            },
+            Err(e) => {
+                submission.attempts += 1;
+                if let Some(status) = rejection_status(&e, submission.attempts) {
+                    warn!(
+                        target: LOG_TARGET,
+                        "Submit Transaction RPC Call to Base Node for TxId: {} will not be retried: {}",
+                        submission.tx_id,
+                        status
+                    );
+                    let _ = submission
+                        .reply
+                        .send(Err(RpcError::RequestFailed(status.clone()).into()));
+                } else {
+                    debug!(
+                        target: LOG_TARGET,
+                        "Submit Transaction RPC Call to Base Node failed for TxId: {}: {}", submission.tx_id, e
+                    );
+                    retry.push(submission);
+                }
+            },
+        }
+    }
+    if !retry.is_empty() {
+        warn!(
+            target: LOG_TARGET,
+            "{} transaction submissions failed and will be retried",
+            retry.len()
+        );
+    }
+    retry
+}
+
+/// Sends the status queries of a batch and returns them if they failed and should be retried
+async fn send_queries<TWalletConnectivity: WalletConnectivityInterface>(
+    mut connectivity: TWalletConnectivity,
+    mut batch: Vec<Query>,
+) -> Vec<Query> {
+    batch.retain(|q| !q.is_abandoned());
+    if batch.is_empty() {
+        return batch;
+    }
+    let mut client = match connectivity.obtain_base_node_wallet_rpc_client().await {
+        Some(client) => BaseNodeWalletRpcClient::clone(&client),
+        None => return Vec::new(),
+    };
+    let e = match query_batch(&mut client, &mut batch).await {
+        Ok(()) => return Vec::new(),
+        Err(e) => e,
+    };
+    warn!(
+        target: LOG_TARGET,
+        "Transaction Query RPC Call to Base Node failed for {} transactions: {}",
+        batch.len(),
+        e
+    );
+    let mut retry = Vec::with_capacity(batch.len());
+    for mut query in batch {
+        query.attempts += 1;
+        match rejection_status(&e, query.attempts) {
+            Some(status) => {
+                let _ = query.reply.send(Err(RpcError::RequestFailed(status.clone()).into()));
+            },
+            None => retry.push(query),
+        }
+    }
+    retry
+}
+
+/// Answers every query of the batch with one RPC call, or leaves the batch as it is if the call fails
+async fn query_batch(client: &mut BaseNodeWalletRpcClient, batch: &mut Vec<Query>) -> Result<(), RpcError> {
+    if let [query] = batch.as_slice() {
+        // A batch of one uses the single transaction query, which carries no tip information it does not need
+        let response = client.transaction_query(query.signature.clone().into()).await?;
+        let response = TxQueryResponse::try_from(response).map_err(TransactionServiceError::InvalidMessageError);
+        if let Some(query) = batch.pop() {
+            let _ = query.reply.send(response);
+        }
+        return Ok(());
+    }
+
+    debug!(
+        target: LOG_TARGET,
+        "Querying the status of a batch of {} transactions on the base node",
+        batch.len()
+    );
+    let batch_response = client
+        .transaction_batch_query(SignaturesProto {
+            sigs: batch
+                .iter()
+                .map(|q| SignatureProto::from(q.signature.clone()))
+                .collect(),
+        })
+        .await?;
+    let mut responses = HashMap::with_capacity(batch_response.responses.len());
+    for response in batch_response.responses {
+        match TxQueryBatchResponse::try_from(response) {
+            Ok(response) => {
+                responses.insert(response.signature.clone(), response);
+            },
+            Err(e) => warn!(target: LOG_TARGET, "Could not convert proto TxQueryBatchResponse: {}", e),
+        }
+    }
+    for query in batch.drain(..) {
+        let response = match responses.get(&query.signature) {
+            Some(response) => Ok(TxQueryResponse {
+                location: response.location.clone(),
+                best_block_hash: response.best_block_hash,
+                confirmations: response.confirmations,
+                is_synced: batch_response.is_synced,
+                best_block_height: response.best_block_height,
+                mined_timestamp: response.mined_timestamp,
+            }),
+            None => Err(TransactionServiceError::InvalidMessageError(format!(
+                "Base node did not report the status of TxId: {}",
+                query.tx_id
+            ))),
+        };
+        let _ = query.reply.send(response);
+    }
+    Ok(())
+}
@@ -60,6 +60,17 @@ pub struct TransactionServiceConfig {
     pub num_confirmations_required: u64,
     /// The number of batches the unconfirmed transactions will be divided into before being queried from the base node
     pub max_tx_query_batch_size: usize,
+    /// The maximum number of transactions the broadcast scheduler submits to the base node in one batch
+    pub max_tx_submission_batch_size: usize,
+    /// The maximum number of submission or status query batches the broadcast scheduler sends at a time. Batches
+    /// backing off after a failure are not counted.
+    pub max_broadcast_batches_in_flight: usize,
+    /// The delay before a failed broadcast batch is retried, doubled on every further failure of the batch
+    #[serde(with = "serializers::seconds")]
+    pub broadcast_retry_backoff: Duration,
+    /// The longest delay before a failed broadcast batch is retried
+    #[serde(with = "serializers::seconds")]
+    pub max_broadcast_retry_backoff: Duration,
     /// This option specifies the transaction routing mechanism as being directly between wallets, making use of store
     /// and forward or using any combination of these.
     pub transaction_routing_mechanism: TransactionRoutingMechanism,
@@ -69,6 +80,9 @@ pub struct TransactionServiceConfig {
     /// This is the timeout period that will be used to re-submit transactions not found in the mempool
     #[serde(with = "serializers::seconds")]
     pub transaction_mempool_resubmission_window: Duration,
+    /// Only allow one-sided sends, refusing to start interactive transactions that need the recipient to reply to this
+    /// wallet's network identity
+    pub one_sided_only: bool,
 }
 
 impl Default for TransactionServiceConfig {
@@ -84,9 +98,14 @@ impl Default for TransactionServiceConfig {
             pending_transaction_cancellation_timeout: Duration::from_secs(259_200), // 3 Days
             num_confirmations_required: 3,
             max_tx_query_batch_size: 20,
+            max_tx_submission_batch_size: 20,
+            max_broadcast_batches_in_flight: 4,
+            broadcast_retry_backoff: Duration::from_secs(2),
+            max_broadcast_retry_backoff: Duration::from_secs(120),
             transaction_routing_mechanism: TransactionRoutingMechanism::default(),
             transaction_event_channel_size: 1000,
             transaction_mempool_resubmission_window: Duration::from_secs(600),
+            one_sided_only: false,
         }
     }
 }
@@ -60,6 +60,11 @@ pub enum TransactionServiceError {
     InvalidNetwork,
     #[error("One-sided transaction error: `{0}`")]
     OneSidedTransactionError(String),
+    #[error("Only some of the batch transactions were sent ({sent:?}): `{error}`")]
+    BatchPartiallySent {
+        sent: Vec<TxId>,
+        error: Box<TransactionServiceError>,
+    },
     #[error("Transaction Protocol Error: `{0}`")]
     TransactionProtocolError(#[from] TransactionProtocolError),
     #[error("The message being processed is not recognized by the Transaction Manager")]
@@ -193,6 +198,8 @@ pub enum TransactionServiceError {
     Oversized,
     #[error("Transaction has invalid address: `{0}`")]
     InvalidAddress(String),
+    #[error("Interactive transactions are disabled for this wallet, send a one-sided transaction instead")]
+    InteractiveTransactionsDisabled,
 }
 
 impl From<RangeProofError> for TransactionServiceError {
@@ -62,18 +62,28 @@ use tower::Service;
 use crate::{
     output_manager_service::UtxoSelectionCriteria,
     transaction_service::{
+        broadcast_scheduler::BroadcastQueueStats,
         error::TransactionServiceError,
         storage::models::{
             CompletedTransaction,
             InboundTransaction,
             OutboundTransaction,
             TxCancellationReason,
+            UtxoImport,
             WalletTransaction,
         },
     },
     OperationId,
 };
 
+/// A single payment in a batch of one-sided payments
+#[derive(Debug, Clone)]
+pub struct PaymentRecipient {
+    pub destination: TariAddress,
+    pub amount: MicroMinotari,
+    pub payment_id: PaymentId,
+}
+
 /// API Request enum
 #[allow(clippy::large_enum_variant)]
 #[derive(Clone)]
@@ -84,6 +94,12 @@ pub enum TransactionServiceRequest {
     GetCancelledPendingInboundTransactions,
     GetCancelledPendingOutboundTransactions,
     GetCancelledCompletedTransactions,
+    GetCompletedTransactionsPage {
+        from_time: Option<NaiveDateTime>,
+        to_time: Option<NaiveDateTime>,
+        after: Option<(NaiveDateTime, TxId)>,
+        limit: usize,
+    },
     GetCompletedTransaction(TxId),
     GetAnyTransaction(TxId),
     ImportTransaction(WalletTransaction),
@@ -168,6 +184,12 @@ pub enum TransactionServiceRequest {
         message: String,
         payment_id: PaymentId,
     },
+    SendOneSidedToStealthAddressBatch {
+        recipients: Vec<PaymentRecipient>,
+        selection_criteria: UtxoSelectionCriteria,
+        fee_per_gram: MicroMinotari,
+        message: String,
+    },
     SendShaAtomicSwapTransaction(TariAddress, MicroMinotari, UtxoSelectionCriteria, MicroMinotari, String),
     CancelTransaction(TxId),
     ImportUtxoWithStatus {
@@ -181,11 +203,13 @@ pub enum TransactionServiceRequest {
         scanned_output: TransactionOutput,
         payment_id: PaymentId,
     },
+    ImportUtxosWithStatus(Vec<UtxoImport>),
     SubmitTransactionToSelf(TxId, Transaction, MicroMinotari, MicroMinotari, String),
     SetLowPowerMode,
     SetNormalPowerMode,
     RestartTransactionProtocols,
     RestartBroadcastProtocols,
+    GetBroadcastQueueStats,
     GetNumConfirmationsRequired,
     SetNumConfirmationsRequired(u64),
     ValidateTransactions,
@@ -207,6 +231,16 @@ impl fmt::Display for TransactionServiceRequest {
             Self::GetCancelledPendingInboundTransactions => write!(f, "GetCancelledPendingInboundTransactions"),
             Self::GetCancelledPendingOutboundTransactions => write!(f, "GetCancelledPendingOutboundTransactions"),
             Self::GetCancelledCompletedTransactions => write!(f, "GetCancelledCompletedTransactions"),
+            Self::GetCompletedTransactionsPage {
+                from_time,
+                to_time,
+                after,
+                limit,
+            } => write!(
+                f,
+                "GetCompletedTransactionsPage (from: {:?}, to: {:?}, after: {:?}, limit: {})",
+                from_time, to_time, after, limit
+            ),
             Self::GetCompletedTransaction(t) => write!(f, "GetCompletedTransaction({})", t),
             Self::SendTransaction {
                 destination,
@@ -323,6 +357,14 @@ impl fmt::Display for TransactionServiceRequest {
                 "SendOneSidedToStealthAddressTransaction (to {}, {}, {})",
                 destination, amount, message
             ),
+            Self::SendOneSidedToStealthAddressBatch {
+                recipients, message, ..
+            } => write!(
+                f,
+                "SendOneSidedToStealthAddressBatch ({} recipients, {})",
+                recipients.len(),
+                message
+            ),
             Self::SendShaAtomicSwapTransaction(k, _, v, _, msg) => {
                 write!(f, "SendShaAtomicSwapTransaction (to {}, {}, {})", k, v, msg)
             },
@@ -342,11 +384,13 @@ impl fmt::Display for TransactionServiceRequest {
                  {:?}, mined at: {:?}",
                 amount, source_address, message, import_status, tx_id, current_height, mined_timestamp
             ),
+            Self::ImportUtxosWithStatus(imports) => write!(f, "ImportUtxosWithStatus ({} outputs)", imports.len()),
             Self::SubmitTransactionToSelf(tx_id, _, _, _, _) => write!(f, "SubmitTransaction ({})", tx_id),
             Self::SetLowPowerMode => write!(f, "SetLowPowerMode "),
             Self::SetNormalPowerMode => write!(f, "SetNormalPowerMode"),
             Self::RestartTransactionProtocols => write!(f, "RestartTransactionProtocols"),
             Self::RestartBroadcastProtocols => write!(f, "RestartBroadcastProtocols"),
+            Self::GetBroadcastQueueStats => write!(f, "GetBroadcastQueueStats"),
             Self::GetNumConfirmationsRequired => write!(f, "GetNumConfirmationsRequired"),
             Self::SetNumConfirmationsRequired(_) => write!(f, "SetNumConfirmationsRequired"),
             Self::GetAnyTransaction(t) => write!(f, "GetAnyTransaction({})", t),
@@ -366,6 +410,7 @@ impl fmt::Display for TransactionServiceRequest {
 #[derive(Debug)]
 pub enum TransactionServiceResponse {
     TransactionSent(TxId),
+    BatchTransactionsSent(Vec<TxId>),
     TransactionSentWithOutputHash(TxId, FixedHash),
     EncumberAggregateUtxo(TxId, Box<Transaction>, Box<PublicKey>, Box<PublicKey>, Box<PublicKey>),
     UnspentOutputs(Vec<TransactionOutput>),
@@ -382,13 +427,16 @@ pub enum TransactionServiceResponse {
     PendingInboundTransactions(HashMap<TxId, InboundTransaction>),
     PendingOutboundTransactions(HashMap<TxId, OutboundTransaction>),
     CompletedTransactions(HashMap<TxId, CompletedTransaction>),
+    CompletedTransactionsPage(Vec<CompletedTransaction>),
     CompletedTransaction(Box<CompletedTransaction>),
     BaseNodePublicKeySet,
     UtxoImported(TxId),
+    UtxosImported(Vec<bool>),
     TransactionSubmitted,
     LowPowerModeSet,
     NormalPowerModeSet,
     ProtocolsRestarted,
+    BroadcastQueueStats(BroadcastQueueStats),
     AnyTransaction(Box<Option<WalletTransaction>>),
     NumConfirmationsRequired(u64),
     NumConfirmationsSet,
@@ -846,6 +894,31 @@ impl TransactionServiceHandle {
         }
     }
 
+    /// Pays several recipients with one-sided stealth outputs. The recipients are grouped into as few transactions as
+    /// possible, each sharing its inputs and a single change output. Returns the ids of the transactions sent. If only
+    /// some of them could be sent, `TransactionServiceError::BatchPartiallySent` holds the ids of those that were.
+    pub async fn send_one_sided_to_stealth_address_batch(
+        &mut self,
+        recipients: Vec<PaymentRecipient>,
+        selection_criteria: UtxoSelectionCriteria,
+        fee_per_gram: MicroMinotari,
+        message: String,
+    ) -> Result<Vec<TxId>, TransactionServiceError> {
+        match self
+            .handle
+            .call(TransactionServiceRequest::SendOneSidedToStealthAddressBatch {
+                recipients,
+                selection_criteria,
+                fee_per_gram,
+                message,
+            })
+            .await??
+        {
+            TransactionServiceResponse::BatchTransactionsSent(tx_ids) => Ok(tx_ids),
+            _ => Err(TransactionServiceError::UnexpectedApiResponse),
+        }
+    }
+
     pub async fn cancel_transaction(&mut self, tx_id: TxId) -> Result<(), TransactionServiceError> {
         match self
             .handle
@@ -935,6 +1008,31 @@ impl TransactionServiceHandle {
         }
     }
 
+    /// Returns up to `limit` completed transactions, cancelled or not, with a timestamp in `[from_time, to_time)` in
+    /// `(timestamp, tx_id)` order. Pass the timestamp and id of the last transaction returned as `after` to get the
+    /// next page.
+    pub async fn get_completed_transactions_page(
+        &mut self,
+        from_time: Option<NaiveDateTime>,
+        to_time: Option<NaiveDateTime>,
+        after: Option<(NaiveDateTime, TxId)>,
+        limit: usize,
+    ) -> Result<Vec<CompletedTransaction>, TransactionServiceError> {
+        match self
+            .handle
+            .call(TransactionServiceRequest::GetCompletedTransactionsPage {
+                from_time,
+                to_time,
+                after,
+                limit,
+            })
+            .await??
+        {
+            TransactionServiceResponse::CompletedTransactionsPage(c) => Ok(c),
+            _ => Err(TransactionServiceError::UnexpectedApiResponse),
+        }
+    }
+
     pub async fn get_completed_transaction(
         &mut self,
         tx_id: TxId,
@@ -1006,6 +1104,22 @@ impl TransactionServiceHandle {
         }
     }
 
+    /// Imports a batch of scanned outputs as faux transactions in a single database transaction. Returns whether each
+    /// output was imported, outputs that were imported before are skipped.
+    pub async fn import_utxos_with_status(
+        &mut self,
+        imports: Vec<UtxoImport>,
+    ) -> Result<Vec<bool>, TransactionServiceError> {
+        match self
+            .handle
+            .call(TransactionServiceRequest::ImportUtxosWithStatus(imports))
+            .await??
+        {
+            TransactionServiceResponse::UtxosImported(added) => Ok(added),
+            _ => Err(TransactionServiceError::UnexpectedApiResponse),
+        }
+    }
+
     pub async fn submit_transaction(
         &mut self,
         tx_id: TxId,
@@ -1099,6 +1213,18 @@ impl TransactionServiceHandle {
         }
     }
 
+    /// Returns how many transaction submissions and status queries are waiting for, or in, a broadcast batch
+    pub async fn get_broadcast_queue_stats(&mut self) -> Result<BroadcastQueueStats, TransactionServiceError> {
+        match self
+            .handle
+            .call(TransactionServiceRequest::GetBroadcastQueueStats)
+            .await??
+        {
+            TransactionServiceResponse::BroadcastQueueStats(stats) => Ok(stats),
+            _ => Err(TransactionServiceError::UnexpectedApiResponse),
+        }
+    }
+
     pub async fn validate_transactions(&mut self) -> Result<OperationId, TransactionServiceError> {
         match self
             .handle
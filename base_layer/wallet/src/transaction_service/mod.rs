@@ -64,6 +64,7 @@ use crate::{
     },
 };
 
+pub mod broadcast_scheduler;
 pub mod config;
 pub mod error;
 pub mod handle;
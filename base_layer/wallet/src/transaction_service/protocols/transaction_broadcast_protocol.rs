@@ -21,7 +21,7 @@
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 use std::{
-    convert::{TryFrom, TryInto},
+    convert::TryInto,
     sync::Arc,
     time::{Duration, Instant},
 };
@@ -33,10 +33,7 @@ use tari_common_types::{
     types::Signature,
 };
 use tari_core::{
-    base_node::{
-        proto::wallet_rpc::{TxLocation, TxQueryResponse, TxSubmissionRejectionReason, TxSubmissionResponse},
-        rpc::BaseNodeWalletRpcClient,
-    },
+    base_node::proto::wallet_rpc::{TxLocation, TxSubmissionRejectionReason},
     transactions::{key_manager::TransactionKeyManagerInterface, transaction_components::Transaction},
 };
 use tari_utilities::hex::Hex;
@@ -95,13 +92,6 @@ where
 
         // Main protocol loop
         loop {
-            let mut client = self
-                .resources
-                .connectivity
-                .obtain_base_node_wallet_rpc_client()
-                .await
-                .ok_or_else(|| TransactionServiceProtocolError::new(self.tx_id, TransactionServiceError::Shutdown))?;
-
             let completed_tx = match self.resources.db.get_completed_transaction(self.tx_id) {
                 Ok(tx) => tx,
                 Err(e) => {
@@ -145,7 +135,7 @@ where
                             self.last_rejection = None;
                             continue;
                     },
-                    result = self.query_or_submit_transaction(completed_tx.clone(), &mut client).fuse() => {
+                    result = self.query_or_submit_transaction(completed_tx.clone()).fuse() => {
                         match self.mode {
                             TxBroadcastMode::TransactionSubmission => {
                                 if result? {
@@ -160,7 +150,6 @@ where
                             },
                         }
                         // Wait out the remainder of the delay before proceeding with next loop
-                        drop(client);
                         let delay = *timeout_update_receiver.borrow();
                         sleep(delay).await;
                         break;
@@ -181,34 +170,27 @@ where
         }
     }
 
-    /// Attempt to submit the transaction to the base node via RPC.
+    /// Attempt to submit the transaction to the base node via the broadcast scheduler.
     /// # Returns:
     /// `Ok(true)` => Transaction was successfully submitted to UnconfirmedPool
     /// `Ok(false)` => There was a problem with the RPC call and this should be retried
     /// `Err(_)` => The transaction was rejected by the base node and the protocol should end.
     #[allow(clippy::too_many_lines)]
-    async fn submit_transaction(
-        &mut self,
-        tx: Transaction,
-        client: &mut BaseNodeWalletRpcClient,
-    ) -> Result<bool, TransactionServiceProtocolError<TxId>> {
-        let response = match client
-            .submit_transaction(tx.clone().try_into().map_err(|e| {
-                TransactionServiceProtocolError::new(self.tx_id, TransactionServiceError::InvalidMessageError(e))
-            })?)
+    async fn submit_transaction(&mut self, tx: Transaction) -> Result<bool, TransactionServiceProtocolError<TxId>> {
+        let transaction = tx.clone().try_into().map_err(|e| {
+            TransactionServiceProtocolError::new(self.tx_id, TransactionServiceError::InvalidMessageError(e))
+        })?;
+        let response = match self
+            .resources
+            .broadcast_scheduler
+            .submit_transaction(self.tx_id, transaction)
             .await
         {
-            Ok(r) => match TxSubmissionResponse::try_from(r) {
-                Ok(r) => r,
-                Err(_) => {
-                    trace!(target: LOG_TARGET, "Could not convert proto TxSubmission Response");
-                    return Ok(false);
-                },
-            },
+            Ok(r) => r,
             Err(e) => {
                 info!(
                     target: LOG_TARGET,
-                    "Submit Transaction RPC Call to Base Node failed: {}", e
+                    "Submit Transaction to Base Node failed: {}", e
                 );
                 return Ok(false);
             },
@@ -301,29 +283,24 @@ where
         Ok(true)
     }
 
-    /// Attempt to query the location of the transaction from the base node via RPC.
+    /// Attempt to query the location of the transaction from the base node via the broadcast scheduler.
     /// # Returns:
     /// `Ok(true)` => Transaction was successfully mined and confirmed
     /// `Ok(false)` => There was a problem with the RPC call or the transaction is not mined but still in the mempool
     /// and this should be retried `Err(_)` => The transaction was rejected by the base node and the protocol should
     /// end.
-    async fn transaction_query(
-        &mut self,
-        signature: Signature,
-        client: &mut BaseNodeWalletRpcClient,
-    ) -> Result<bool, TransactionServiceProtocolError<TxId>> {
-        let response = match client.transaction_query(signature.into()).await {
-            Ok(r) => match TxQueryResponse::try_from(r) {
-                Ok(r) => r,
-                Err(_) => {
-                    trace!(target: LOG_TARGET, "Could not convert proto TxQueryResponse");
-                    return Ok(false);
-                },
-            },
+    async fn transaction_query(&mut self, signature: Signature) -> Result<bool, TransactionServiceProtocolError<TxId>> {
+        let response = match self
+            .resources
+            .broadcast_scheduler
+            .query_transaction(self.tx_id, signature)
+            .await
+        {
+            Ok(r) => r,
             Err(e) => {
                 info!(
                     target: LOG_TARGET,
-                    "Transaction Query RPC Call to Base Node failed: {}", e
+                    "Transaction Query to Base Node failed: {}", e
                 );
                 return Ok(false);
             },
@@ -400,7 +377,6 @@ where
     async fn query_or_submit_transaction(
         &mut self,
         completed_transaction: CompletedTransaction,
-        client: &mut BaseNodeWalletRpcClient,
     ) -> Result<bool, TransactionServiceProtocolError<TxId>> {
         let signature = completed_transaction
             .transaction
@@ -415,13 +391,13 @@ where
                 self.tx_id,
                 signature.clone().get_signature().to_hex(),
             );
-            self.submit_transaction(completed_transaction.transaction, client).await
+            self.submit_transaction(completed_transaction.transaction).await
         } else {
             info!(
                 target: LOG_TARGET,
                 "Querying Transaction (TxId: {}) status on Base Node", self.tx_id
             );
-            self.transaction_query(signature.clone(), client).await
+            self.transaction_query(signature.clone()).await
         }
     }
 
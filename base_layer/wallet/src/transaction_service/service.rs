@@ -64,6 +64,7 @@ use tari_core::{
             RangeProofType,
             Transaction,
             TransactionOutput,
+            WalletOutput,
             WalletOutputBuilder,
         },
         transaction_protocol::{
@@ -109,10 +110,12 @@ use crate::{
     },
     storage::database::{WalletBackend, WalletDatabase},
     transaction_service::{
+        broadcast_scheduler::TransactionBroadcastScheduler,
         config::TransactionServiceConfig,
         error::{TransactionServiceError, TransactionServiceProtocolError},
         handle::{
             FeePerGramStatsResponse,
+            PaymentRecipient,
             TransactionEvent,
             TransactionEventSender,
             TransactionServiceRequest,
@@ -130,6 +133,7 @@ use crate::{
             models::{
                 CompletedTransaction,
                 TxCancellationReason,
+                UtxoImport,
                 WalletTransaction::{Completed, PendingInbound, PendingOutbound},
             },
         },
@@ -147,6 +151,9 @@ use crate::{
 };
 
 const LOG_TARGET: &str = "wallet::transaction_service::service";
+/// The maximum number of recipient outputs in one transaction of a batch payment. Larger batches are split across
+/// several transactions to stay well within the transaction size limit.
+pub const ONE_SIDED_BATCH_MAX_OUTPUTS: usize = 250;
 
 /// TransactionService allows for the management of multiple inbound and outbound transaction protocols
 /// which are uniquely identified by a tx_id. The TransactionService generates and accepts the various protocol
@@ -262,6 +269,8 @@ where
         let (_view_key_id, view_key) = core_key_manager_service.get_view_key().await?;
         let tari_address =
             TariAddress::new_dual_address_with_default_features(view_key, node_identity.public_key().clone(), network);
+        let broadcast_scheduler =
+            TransactionBroadcastScheduler::spawn(connectivity.clone(), &config, shutdown_signal.clone());
         let resources = TransactionServiceResources {
             db: db.clone(),
             output_manager_service,
@@ -275,6 +284,7 @@ where
             config: config.clone(),
             shutdown_signal,
             consensus_manager: consensus_manager.clone(),
+            broadcast_scheduler,
         };
         let power_mode = PowerMode::default();
         let timeout = match power_mode {
@@ -667,6 +677,21 @@ where
                 )
                 .await
                 .map(TransactionServiceResponse::TransactionSent),
+            TransactionServiceRequest::SendOneSidedToStealthAddressBatch {
+                recipients,
+                selection_criteria,
+                fee_per_gram,
+                message,
+            } => self
+                .send_one_sided_to_stealth_address_batch(
+                    recipients,
+                    selection_criteria,
+                    fee_per_gram,
+                    message,
+                    transaction_broadcast_join_handles,
+                )
+                .await
+                .map(TransactionServiceResponse::BatchTransactionsSent),
             TransactionServiceRequest::BurnTari {
                 amount,
                 selection_criteria,
@@ -850,6 +875,15 @@ where
             TransactionServiceRequest::GetCompletedTransactions => Ok(
                 TransactionServiceResponse::CompletedTransactions(self.db.get_completed_transactions()?),
             ),
+            TransactionServiceRequest::GetCompletedTransactionsPage {
+                from_time,
+                to_time,
+                after,
+                limit,
+            } => Ok(TransactionServiceResponse::CompletedTransactionsPage(
+                self.db
+                    .get_completed_transactions_page(from_time, to_time, after, limit)?,
+            )),
             TransactionServiceRequest::GetCancelledPendingInboundTransactions => {
                 Ok(TransactionServiceResponse::PendingInboundTransactions(
                     self.db.get_cancelled_pending_inbound_transactions()?,
@@ -916,6 +950,9 @@ where
                 )
                 .await
                 .map(TransactionServiceResponse::UtxoImported),
+            TransactionServiceRequest::ImportUtxosWithStatus(imports) => self
+                .add_utxo_import_transactions_with_status(imports)
+                .map(TransactionServiceResponse::UtxosImported),
             TransactionServiceRequest::SubmitTransactionToSelf(tx_id, tx, fee, amount, message) => self
                 .submit_transaction_to_self(transaction_broadcast_join_handles, tx_id, tx, fee, amount, message)
                 .await
@@ -937,6 +974,9 @@ where
             TransactionServiceRequest::RestartBroadcastProtocols => self
                 .restart_broadcast_protocols(transaction_broadcast_join_handles)
                 .map(|_| TransactionServiceResponse::ProtocolsRestarted),
+            TransactionServiceRequest::GetBroadcastQueueStats => Ok(TransactionServiceResponse::BroadcastQueueStats(
+                self.resources.broadcast_scheduler.stats(),
+            )),
             TransactionServiceRequest::GetNumConfirmationsRequired => Ok(
                 TransactionServiceResponse::NumConfirmationsRequired(self.resources.config.num_confirmations_required),
             ),
@@ -1131,6 +1171,14 @@ where
 
             return Ok(());
         }
+        if self.resources.config.one_sided_only {
+            let _result = reply_channel
+                .send(Err(TransactionServiceError::InteractiveTransactionsDisabled))
+                .inspect_err(|_| {
+                    warn!(target: LOG_TARGET, "Failed to send service reply");
+                });
+            return Err(TransactionServiceError::InteractiveTransactionsDisabled);
+        }
 
         let (tx_reply_sender, tx_reply_receiver) = mpsc::channel(100);
         let (cancellation_sender, cancellation_receiver) = oneshot::channel();
@@ -2053,6 +2101,211 @@ where
         .await
     }
 
+    /// Pays several recipients with one-sided stealth outputs. Each transaction holds up to
+    /// `ONE_SIDED_BATCH_MAX_OUTPUTS` recipient outputs that share one input selection, one kernel and one change
+    /// output, so a large payout needs a handful of transactions instead of one per recipient.
+    ///
+    /// Every transaction is funded and signed before any of them is submitted, and the funded ones are cancelled if
+    /// one of them cannot be built, so either nothing is sent or the caller gets a
+    /// `TransactionServiceError::BatchPartiallySent` listing the transactions that did go out.
+    pub async fn send_one_sided_to_stealth_address_batch(
+        &mut self,
+        recipients: Vec<PaymentRecipient>,
+        selection_criteria: UtxoSelectionCriteria,
+        fee_per_gram: MicroMinotari,
+        message: String,
+        transaction_broadcast_join_handles: &mut FuturesUnordered<
+            JoinHandle<Result<TxId, TransactionServiceProtocolError<TxId>>>,
+        >,
+    ) -> Result<Vec<TxId>, TransactionServiceError> {
+        if recipients.is_empty() {
+            return Err(TransactionServiceError::OneSidedTransactionError(
+                "No recipients provided".to_string(),
+            ));
+        }
+        if recipients
+            .iter()
+            .any(|r| r.destination.network() != self.resources.tari_address.network())
+        {
+            return Err(TransactionServiceError::InvalidNetwork);
+        }
+        // The change of one transaction cannot fund the next, so specific outputs would be used up by the first one
+        if !selection_criteria.filter.is_standard() && recipients.len() > ONE_SIDED_BATCH_MAX_OUTPUTS {
+            return Err(TransactionServiceError::OneSidedTransactionError(format!(
+                "Specific outputs can only fund a batch of up to {} recipients",
+                ONE_SIDED_BATCH_MAX_OUTPUTS
+            )));
+        }
+
+        let mut funded = Vec::with_capacity(recipients.len().div_ceil(ONE_SIDED_BATCH_MAX_OUTPUTS));
+        for batch in recipients.chunks(ONE_SIDED_BATCH_MAX_OUTPUTS) {
+            match self
+                .fund_one_sided_batch(batch, fee_per_gram, selection_criteria.clone())
+                .await
+            {
+                Ok((tx_id, tx, fee)) => funded.push((tx_id, tx, fee, batch)),
+                Err(e) => {
+                    self.cancel_funded_batches(funded.iter().map(|(tx_id, ..)| *tx_id))
+                        .await;
+                    return Err(e);
+                },
+            }
+        }
+
+        let mut tx_ids = Vec::with_capacity(funded.len());
+        let mut funded = funded.into_iter();
+        while let Some((tx_id, tx, fee, batch)) = funded.next() {
+            info!(
+                target: LOG_TARGET,
+                "Finalized one-sided batch transaction TxId: {} paying {} recipients", tx_id, batch.len()
+            );
+            if let Err(e) = self
+                .submit_one_sided_batch(tx_id, tx, fee, batch, &message, transaction_broadcast_join_handles)
+                .await
+            {
+                self.cancel_funded_batches(std::iter::once(tx_id).chain(funded.map(|(tx_id, ..)| tx_id)))
+                    .await;
+                if tx_ids.is_empty() {
+                    return Err(e);
+                }
+                return Err(TransactionServiceError::BatchPartiallySent {
+                    sent: tx_ids,
+                    error: Box::new(e),
+                });
+            }
+            tx_ids.push(tx_id);
+        }
+
+        Ok(tx_ids)
+    }
+
+    /// Builds the one-sided outputs of `batch` and funds them in a single transaction
+    async fn fund_one_sided_batch(
+        &mut self,
+        batch: &[PaymentRecipient],
+        fee_per_gram: MicroMinotari,
+        selection_criteria: UtxoSelectionCriteria,
+    ) -> Result<(TxId, Transaction, MicroMinotari), TransactionServiceError> {
+        let tx_id = TxId::new_random();
+        let mut outputs = Vec::with_capacity(batch.len());
+        for recipient in batch {
+            outputs.push(self.create_stealth_output(recipient).await?);
+        }
+
+        let (tx, fee) = self
+            .resources
+            .output_manager_service
+            .create_transaction_with_outputs(tx_id, outputs, fee_per_gram, selection_criteria)
+            .await?;
+        Ok((tx_id, tx, fee))
+    }
+
+    /// Records a funded one-sided batch transaction and starts broadcasting it
+    async fn submit_one_sided_batch(
+        &mut self,
+        tx_id: TxId,
+        tx: Transaction,
+        fee: MicroMinotari,
+        batch: &[PaymentRecipient],
+        message: &str,
+        transaction_broadcast_join_handles: &mut FuturesUnordered<
+            JoinHandle<Result<TxId, TransactionServiceProtocolError<TxId>>>,
+        >,
+    ) -> Result<(), TransactionServiceError> {
+        // The history has room for a single destination, which is left empty when the transaction pays several
+        let destination = if batch.iter().all(|r| r.destination == batch[0].destination) {
+            batch[0].destination.clone()
+        } else {
+            TariAddress::default()
+        };
+        let amount = batch.iter().map(|r| r.amount).sum();
+        self.submit_transaction(
+            transaction_broadcast_join_handles,
+            CompletedTransaction::new(
+                tx_id,
+                self.resources.tari_address.clone(),
+                destination,
+                amount,
+                fee,
+                tx,
+                TransactionStatus::Completed,
+                message.to_string(),
+                Utc::now().naive_utc(),
+                TransactionDirection::Outbound,
+                None,
+                None,
+                None,
+            )?,
+        )
+        .await?;
+
+        let _result = self
+            .event_publisher
+            .send(Arc::new(TransactionEvent::TransactionCompletedImmediately(tx_id)));
+        Ok(())
+    }
+
+    /// Releases the inputs of batch transactions that were funded but will not be sent
+    async fn cancel_funded_batches<I: Iterator<Item = TxId>>(&mut self, tx_ids: I) {
+        for tx_id in tx_ids {
+            if let Err(e) = self.resources.output_manager_service.cancel_transaction(tx_id).await {
+                warn!(
+                    target: LOG_TARGET,
+                    "Could not cancel the outputs of unsent batch transaction TxId: {}: {}", tx_id, e
+                );
+            }
+        }
+    }
+
+    /// Builds and signs a one-sided output paying `recipient` at its stealth address. Returns the output together
+    /// with the sender offset key it was signed with.
+    async fn create_stealth_output(
+        &mut self,
+        recipient: &PaymentRecipient,
+    ) -> Result<(WalletOutput, TariKeyId), TransactionServiceError> {
+        let public_view_key =
+            recipient
+                .destination
+                .public_view_key()
+                .ok_or(TransactionServiceError::OneSidedTransactionError(
+                    "Missing public view key".to_string(),
+                ))?;
+        let key_manager = &self.resources.transaction_key_manager_service;
+        let (sender_offset_key_id, sender_offset_public_key) = key_manager
+            .get_next_key(TransactionKeyManagerBranch::SenderOffset.get_branch_key())
+            .await?;
+
+        let c = key_manager
+            .get_diffie_hellman_stealth_domain_hasher(&sender_offset_key_id, public_view_key)
+            .await?;
+        let script_spending_key = stealth_address_script_spending_key(&c, recipient.destination.public_spend_key());
+
+        let shared_secret = key_manager
+            .get_diffie_hellman_shared_secret(&sender_offset_key_id, public_view_key)
+            .await?;
+        let spending_key = shared_secret_to_output_spending_key(&shared_secret)?;
+        let encryption_key = key_manager
+            .import_key(shared_secret_to_output_encryption_key(&shared_secret)?)
+            .await?;
+        let spending_key_id = key_manager.import_key(spending_key).await?;
+
+        let output = WalletOutputBuilder::new(recipient.amount, spending_key_id)
+            .with_features(OutputFeatures::default())
+            .with_script(push_pubkey_script(&script_spending_key))
+            .encrypt_data_for_recovery(key_manager, Some(&encryption_key), recipient.payment_id.clone())
+            .await?
+            .with_input_data(Default::default())
+            .with_sender_offset_public_key(sender_offset_public_key)
+            .with_script_key(KeyId::Zero)
+            .with_minimum_value_promise(MicroMinotari::zero())
+            .sign_as_sender_and_receiver(key_manager, &sender_offset_key_id)
+            .await?
+            .try_build(key_manager)
+            .await?;
+
+        Ok((output, sender_offset_key_id))
+    }
+
     /// Creates a transaction to burn some Minotari. The optional _claim public key_ parameter is used in the challenge
     /// of the
     // corresponding optional _ownership proof_ return value. Burn commitments and ownership proofs will exclusively be
@@ -3379,6 +3632,32 @@ where
             scanned_output,
             payment_id,
         )?;
+        self.publish_utxo_import_event(tx_id, import_status);
+        Ok(tx_id)
+    }
+
+    /// Add a batch of completed transactions to the Transaction Manager to record directly importing spendable UTXOs.
+    /// All of them are written in one database transaction, imports that already exist are skipped.
+    pub fn add_utxo_import_transactions_with_status(
+        &mut self,
+        imports: Vec<UtxoImport>,
+    ) -> Result<Vec<bool>, TransactionServiceError> {
+        let statuses = imports
+            .iter()
+            .map(|import| (import.tx_id, import.import_status.clone()))
+            .collect::<Vec<_>>();
+        let added = self
+            .db
+            .add_utxo_import_transactions_with_status(imports, self.resources.tari_address.clone())?;
+        for ((tx_id, import_status), added) in statuses.into_iter().zip(added.iter()) {
+            if *added {
+                self.publish_utxo_import_event(tx_id, import_status);
+            }
+        }
+        Ok(added)
+    }
+
+    fn publish_utxo_import_event(&self, tx_id: TxId, import_status: ImportStatus) {
         let transaction_event = match import_status {
             ImportStatus::Imported => TransactionEvent::DetectedTransactionUnconfirmed {
                 tx_id,
@@ -3404,7 +3683,6 @@ where
             );
             e
         });
-        Ok(tx_id)
     }
 
     /// Submit a completed transaction to the Transaction Manager
@@ -3518,6 +3796,7 @@ pub struct TransactionServiceResources<TBackend, TWalletConnectivity, TKeyManage
     pub factories: CryptoFactories,
     pub config: TransactionServiceConfig,
     pub shutdown_signal: ShutdownSignal,
+    pub broadcast_scheduler: TransactionBroadcastScheduler,
 }
 
 #[derive(Default, Clone, Copy)]
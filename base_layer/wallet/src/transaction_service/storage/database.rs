@@ -48,6 +48,7 @@ use crate::transaction_service::{
             InboundTransaction,
             OutboundTransaction,
             TxCancellationReason,
+            UtxoImport,
             WalletTransaction,
         },
         sqlite_db::{InboundTransactionSenderInfo, UnconfirmedTransactionInfo},
@@ -81,6 +82,12 @@ pub trait TransactionBackend: Send + Sync + Clone {
     fn contains(&self, key: &DbKey) -> Result<bool, TransactionStorageError>;
     /// Modify the state the of the backend with a write operation
     fn write(&self, op: WriteOperation) -> Result<Option<DbValue>, TransactionStorageError>;
+    /// Insert a batch of completed transactions in a single database transaction. Transactions that already exist are
+    /// skipped, the result indicates for each transaction whether it was inserted.
+    fn insert_completed_transactions(
+        &self,
+        transactions: Vec<CompletedTransaction>,
+    ) -> Result<Vec<bool>, TransactionStorageError>;
     /// Check if a transaction exists in any of the collections
     fn transaction_exists(&self, tx_id: TxId) -> Result<bool, TransactionStorageError>;
     /// Update a previously completed transaction with new data
@@ -149,6 +156,15 @@ pub trait TransactionBackend: Send + Sync + Clone {
     ) -> Result<Vec<InboundTransactionSenderInfo>, TransactionStorageError>;
     fn fetch_imported_transactions(&self) -> Result<Vec<CompletedTransaction>, TransactionStorageError>;
     fn fetch_unconfirmed_detected_transactions(&self) -> Result<Vec<CompletedTransaction>, TransactionStorageError>;
+    /// Fetches one page of completed transactions, cancelled or not, with a timestamp in `[from_time, to_time)`, in
+    /// `(timestamp, tx_id)` order and starting after `after`
+    fn fetch_completed_transactions_page(
+        &self,
+        from_time: Option<NaiveDateTime>,
+        to_time: Option<NaiveDateTime>,
+        after: Option<(NaiveDateTime, TxId)>,
+        limit: usize,
+    ) -> Result<Vec<CompletedTransaction>, TransactionStorageError>;
     fn fetch_confirmed_detected_transactions_from_height(
         &self,
         height: u64,
@@ -593,6 +609,17 @@ where T: TransactionBackend + 'static
         self.get_completed_transactions_by_cancelled(false)
     }
 
+    pub fn get_completed_transactions_page(
+        &self,
+        from_time: Option<NaiveDateTime>,
+        to_time: Option<NaiveDateTime>,
+        after: Option<(NaiveDateTime, TxId)>,
+        limit: usize,
+    ) -> Result<Vec<CompletedTransaction>, TransactionStorageError> {
+        self.db
+            .fetch_completed_transactions_page(from_time, to_time, after, limit)
+    }
+
     pub fn get_cancelled_completed_transactions(
         &self,
     ) -> Result<HashMap<TxId, CompletedTransaction>, TransactionStorageError> {
@@ -697,38 +724,72 @@ where T: TransactionBackend + 'static
         scanned_output: TransactionOutput,
         payment_id: PaymentId,
     ) -> Result<(), TransactionStorageError> {
-        let payment_id = match payment_id {
+        let transaction = Self::utxo_import_transaction(
+            UtxoImport {
+                tx_id,
+                amount,
+                source_address,
+                message,
+                import_status,
+                current_height,
+                mined_timestamp,
+                scanned_output,
+                payment_id,
+            },
+            comms_address,
+        )?;
+
+        self.db
+            .write(WriteOperation::Insert(DbKeyValuePair::CompletedTransaction(
+                tx_id,
+                Box::new(transaction),
+            )))?;
+        Ok(())
+    }
+
+    /// Faux transactions added to the database with imported status, all in one database transaction. Imports that
+    /// are already in the database are skipped, the result indicates for each import whether it was added.
+    pub fn add_utxo_import_transactions_with_status(
+        &self,
+        imports: Vec<UtxoImport>,
+        comms_address: TariAddress,
+    ) -> Result<Vec<bool>, TransactionStorageError> {
+        let transactions = imports
+            .into_iter()
+            .map(|import| Self::utxo_import_transaction(import, comms_address.clone()))
+            .collect::<Result<Vec<_>, _>>()?;
+        self.db.insert_completed_transactions(transactions)
+    }
+
+    fn utxo_import_transaction(
+        import: UtxoImport,
+        comms_address: TariAddress,
+    ) -> Result<CompletedTransaction, TransactionStorageError> {
+        let payment_id = match import.payment_id {
             PaymentId::Empty => None,
             v => Some(v),
         };
-        let transaction = CompletedTransaction::new(
-            tx_id,
-            source_address,
+        CompletedTransaction::new(
+            import.tx_id,
+            import.source_address,
             comms_address,
-            amount,
+            import.amount,
             MicroMinotari::from(0),
             Transaction::new(
                 Vec::new(),
-                vec![scanned_output],
+                vec![import.scanned_output],
                 Vec::new(),
                 PrivateKey::default(),
                 PrivateKey::default(),
             ),
-            TransactionStatus::try_from(import_status)?,
-            message,
-            mined_timestamp.unwrap_or_else(|| Utc::now().naive_utc()),
+            TransactionStatus::try_from(import.import_status)?,
+            import.message,
+            import.mined_timestamp.unwrap_or_else(|| Utc::now().naive_utc()),
             TransactionDirection::Inbound,
-            current_height,
-            mined_timestamp,
+            import.current_height,
+            import.mined_timestamp,
             payment_id,
-        )?;
-
-        self.db
-            .write(WriteOperation::Insert(DbKeyValuePair::CompletedTransaction(
-                tx_id,
-                Box::new(transaction),
-            )))?;
-        Ok(())
+        )
     }
 
     pub fn increment_send_count(&self, tx_id: TxId) -> Result<(), TransactionStorageError> {
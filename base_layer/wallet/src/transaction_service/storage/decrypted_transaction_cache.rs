@@ -0,0 +1,263 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::{collections::HashMap, sync::Mutex};
+
+use tari_common_types::transaction::TxId;
+use tari_utilities::Hidden;
+
+/// The default number of decrypted transaction records kept in memory
+pub const DECRYPTED_TRANSACTION_CACHE_CAPACITY: usize = 256;
+
+/// The table an encrypted transaction record is stored in
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum TransactionTable {
+    Inbound,
+    Outbound,
+    Completed,
+}
+
+struct CachedDecryption {
+    ciphertext: Vec<u8>,
+    plaintext: Hidden<Vec<u8>>,
+    last_used: u64,
+}
+
+#[derive(Default)]
+struct CacheEntries {
+    entries: HashMap<(TransactionTable, TxId), CachedDecryption>,
+    clock: u64,
+}
+
+/// A bounded, least recently used cache of the decrypted protocol field of transaction records, so that reading the
+/// same transaction repeatedly does not pay for the authenticated decryption every time. An entry is only used if the
+/// stored ciphertext is unchanged, and the plaintext is zeroized when the entry is evicted or invalidated.
+pub struct DecryptedTransactionCache {
+    capacity: usize,
+    inner: Mutex<CacheEntries>,
+}
+
+impl DecryptedTransactionCache {
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            capacity,
+            inner: Mutex::new(CacheEntries::default()),
+        }
+    }
+
+    /// Returns the plaintext of `ciphertext`, from the cache if this exact ciphertext was decrypted before, otherwise
+    /// by calling `decrypt` and caching its result.
+    pub fn decrypt<F>(
+        &self,
+        table: TransactionTable,
+        tx_id: TxId,
+        ciphertext: &[u8],
+        decrypt: F,
+    ) -> Result<Vec<u8>, String>
+    where
+        F: FnOnce() -> Result<Vec<u8>, String>,
+    {
+        if self.capacity == 0 {
+            return decrypt();
+        }
+        {
+            let mut cache = acquire_lock!(self.inner);
+            cache.clock += 1;
+            let clock = cache.clock;
+            if let Some(entry) = cache.entries.get_mut(&(table, tx_id)) {
+                if entry.ciphertext == ciphertext {
+                    entry.last_used = clock;
+                    return Ok(entry.plaintext.reveal().clone());
+                }
+            }
+        }
+
+        let plaintext = decrypt()?;
+
+        let mut cache = acquire_lock!(self.inner);
+        if cache.entries.len() >= self.capacity && !cache.entries.contains_key(&(table, tx_id)) {
+            let least_recently_used = cache
+                .entries
+                .iter()
+                .min_by_key(|(_, entry)| entry.last_used)
+                .map(|(key, _)| *key);
+            if let Some(key) = least_recently_used {
+                cache.entries.remove(&key);
+            }
+        }
+        let last_used = cache.clock;
+        cache.entries.insert((table, tx_id), CachedDecryption {
+            ciphertext: ciphertext.to_vec(),
+            plaintext: Hidden::hide(plaintext.clone()),
+            last_used,
+        });
+        Ok(plaintext)
+    }
+
+    /// Drops the cached records of a transaction from every table, to be called whenever the transaction is written
+    pub fn invalidate(&self, tx_id: TxId) {
+        let mut cache = acquire_lock!(self.inner);
+        cache.entries.retain(|(_, id), _| *id != tx_id);
+    }
+
+    #[cfg(test)]
+    fn len(&self) -> usize {
+        acquire_lock!(self.inner).entries.len()
+    }
+}
+
+impl Default for DecryptedTransactionCache {
+    fn default() -> Self {
+        Self::new(DECRYPTED_TRANSACTION_CACHE_CAPACITY)
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use std::cell::Cell;
+
+    use super::*;
+
+    fn decrypt_counted<'a>(
+        calls: &'a Cell<usize>,
+        plaintext: &'a [u8],
+    ) -> impl FnOnce() -> Result<Vec<u8>, String> + 'a {
+        move || {
+            calls.set(calls.get() + 1);
+            Ok(plaintext.to_vec())
+        }
+    }
+
+    #[test]
+    fn it_reuses_a_decryption_of_the_same_ciphertext() {
+        let cache = DecryptedTransactionCache::new(4);
+        let calls = Cell::new(0);
+        for _ in 0..3 {
+            let plaintext = cache
+                .decrypt(
+                    TransactionTable::Completed,
+                    1u64.into(),
+                    b"cipher",
+                    decrypt_counted(&calls, b"plain"),
+                )
+                .unwrap();
+            assert_eq!(plaintext, b"plain");
+        }
+        assert_eq!(calls.get(), 1);
+
+        // A rewritten record has a new ciphertext and is decrypted again
+        let plaintext = cache
+            .decrypt(
+                TransactionTable::Completed,
+                1u64.into(),
+                b"cipher2",
+                decrypt_counted(&calls, b"plain2"),
+            )
+            .unwrap();
+        assert_eq!(plaintext, b"plain2");
+        assert_eq!(calls.get(), 2);
+
+        // The same transaction id in another table is a different record
+        cache
+            .decrypt(
+                TransactionTable::Inbound,
+                1u64.into(),
+                b"cipher2",
+                decrypt_counted(&calls, b"plain3"),
+            )
+            .unwrap();
+        assert_eq!(calls.get(), 3);
+
+        cache.invalidate(1u64.into());
+        assert_eq!(cache.len(), 0);
+    }
+
+    #[test]
+    fn it_evicts_the_least_recently_used_record() {
+        let cache = DecryptedTransactionCache::new(2);
+        let calls = Cell::new(0);
+        cache
+            .decrypt(
+                TransactionTable::Completed,
+                1u64.into(),
+                b"1",
+                decrypt_counted(&calls, b"1"),
+            )
+            .unwrap();
+        cache
+            .decrypt(
+                TransactionTable::Completed,
+                2u64.into(),
+                b"2",
+                decrypt_counted(&calls, b"2"),
+            )
+            .unwrap();
+        // Use 1 again, so that 2 is the least recently used when 3 is added
+        cache
+            .decrypt(
+                TransactionTable::Completed,
+                1u64.into(),
+                b"1",
+                decrypt_counted(&calls, b"1"),
+            )
+            .unwrap();
+        cache
+            .decrypt(
+                TransactionTable::Completed,
+                3u64.into(),
+                b"3",
+                decrypt_counted(&calls, b"3"),
+            )
+            .unwrap();
+        assert_eq!(calls.get(), 3);
+        assert_eq!(cache.len(), 2);
+
+        cache
+            .decrypt(
+                TransactionTable::Completed,
+                1u64.into(),
+                b"1",
+                decrypt_counted(&calls, b"1"),
+            )
+            .unwrap();
+        assert_eq!(calls.get(), 3);
+        cache
+            .decrypt(
+                TransactionTable::Completed,
+                2u64.into(),
+                b"2",
+                decrypt_counted(&calls, b"2"),
+            )
+            .unwrap();
+        assert_eq!(calls.get(), 4);
+    }
+
+    #[test]
+    fn it_does_not_cache_failed_decryptions() {
+        let cache = DecryptedTransactionCache::new(2);
+        let result = cache.decrypt(TransactionTable::Outbound, 1u64.into(), b"1", || {
+            Err("Decryption failed".to_string())
+        });
+        assert!(result.is_err());
+        assert_eq!(cache.len(), 0);
+    }
+}
@@ -21,6 +21,7 @@
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 pub mod database;
+mod decrypted_transaction_cache;
 // converting between unsigned and signed is okay here as we do it both ways
 #[allow(clippy::cast_possible_wrap)]
 pub mod models;
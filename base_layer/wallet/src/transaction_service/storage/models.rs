@@ -29,12 +29,12 @@ use chrono::NaiveDateTime;
 use serde::{Deserialize, Serialize};
 use tari_common_types::{
     tari_address::TariAddress,
-    transaction::{TransactionConversionError, TransactionDirection, TransactionStatus, TxId},
+    transaction::{ImportStatus, TransactionConversionError, TransactionDirection, TransactionStatus, TxId},
     types::{BlockHash, PrivateKey, Signature},
 };
 use tari_core::transactions::{
     tari_amount::MicroMinotari,
-    transaction_components::{encrypted_data::PaymentId, Transaction},
+    transaction_components::{encrypted_data::PaymentId, Transaction, TransactionOutput},
     ReceiverTransactionProtocol,
     SenderTransactionProtocol,
 };
@@ -308,6 +308,20 @@ impl From<InboundTransaction> for CompletedTransaction {
     }
 }
 
+/// A scanned output that is recorded in the wallet as a faux incoming transaction
+#[derive(Debug, Clone)]
+pub struct UtxoImport {
+    pub tx_id: TxId,
+    pub amount: MicroMinotari,
+    pub source_address: TariAddress,
+    pub message: String,
+    pub import_status: ImportStatus,
+    pub current_height: Option<u64>,
+    pub mined_timestamp: Option<NaiveDateTime>,
+    pub scanned_output: TransactionOutput,
+    pub payment_id: PaymentId,
+}
+
 #[derive(Debug, Serialize, Deserialize, Clone)]
 #[allow(clippy::large_enum_variant)]
 pub enum WalletTransaction {
@@ -21,7 +21,6 @@
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 use std::{
-    collections::HashMap,
     convert::{TryFrom, TryInto},
     sync::{Arc, RwLock},
 };
@@ -56,6 +55,7 @@ use crate::{
         error::{TransactionKeyError, TransactionStorageError},
         storage::{
             database::{DbKey, DbKeyValuePair, DbValue, TransactionBackend, WriteOperation},
+            decrypted_transaction_cache::{DecryptedTransactionCache, TransactionTable},
             models::{
                 CompletedTransaction,
                 InboundTransaction,
@@ -65,6 +65,7 @@ use crate::{
             },
         },
     },
+    util::parallel::try_par_map,
 };
 
 const LOG_TARGET: &str = "wallet::transaction_service::database::wallet";
@@ -74,6 +75,7 @@ const LOG_TARGET: &str = "wallet::transaction_service::database::wallet";
 pub struct TransactionServiceSqliteDatabase {
     database_connection: WalletDbConnection,
     cipher: Arc<RwLock<XChaCha20Poly1305>>,
+    decrypted_cache: Arc<DecryptedTransactionCache>,
 }
 
 impl TransactionServiceSqliteDatabase {
@@ -81,6 +83,7 @@ impl TransactionServiceSqliteDatabase {
         Self {
             database_connection,
             cipher: Arc::new(RwLock::new(cipher)),
+            decrypted_cache: Arc::new(DecryptedTransactionCache::default()),
         }
     }
 
@@ -122,6 +125,7 @@ impl TransactionServiceSqliteDatabase {
                 conn.transaction::<_, _, _>(|conn| match OutboundTransactionSql::find_by_cancelled(k, false, conn) {
                     Ok(v) => {
                         v.delete(conn)?;
+                        self.decrypted_cache.invalidate(k);
                         Ok(Some(DbValue::PendingOutboundTransaction(Box::new(
                             OutboundTransaction::try_from(v, &cipher)?,
                         ))))
@@ -136,6 +140,7 @@ impl TransactionServiceSqliteDatabase {
                 conn.transaction::<_, _, _>(|conn| match InboundTransactionSql::find_by_cancelled(k, false, conn) {
                     Ok(v) => {
                         v.delete(conn)?;
+                        self.decrypted_cache.invalidate(k);
                         Ok(Some(DbValue::PendingInboundTransaction(Box::new(
                             InboundTransaction::try_from(v, &cipher)?,
                         ))))
@@ -151,6 +156,7 @@ impl TransactionServiceSqliteDatabase {
                     |conn| match CompletedTransactionSql::find_by_cancelled(k, false, conn) {
                         Ok(v) => {
                             v.delete(conn)?;
+                            self.decrypted_cache.invalidate(k);
                             Ok(Some(DbValue::CompletedTransaction(Box::new(
                                 CompletedTransaction::try_from(v, &cipher)?,
                             ))))
@@ -172,6 +178,7 @@ impl TransactionServiceSqliteDatabase {
                 conn.transaction::<_, _, _>(|conn| match OutboundTransactionSql::find_by_cancelled(k, true, conn) {
                     Ok(v) => {
                         v.delete(conn)?;
+                        self.decrypted_cache.invalidate(k);
                         Ok(Some(DbValue::PendingOutboundTransaction(Box::new(
                             OutboundTransaction::try_from(v, &cipher)?,
                         ))))
@@ -186,6 +193,7 @@ impl TransactionServiceSqliteDatabase {
                 conn.transaction::<_, _, _>(|conn| match InboundTransactionSql::find_by_cancelled(k, true, conn) {
                     Ok(v) => {
                         v.delete(conn)?;
+                        self.decrypted_cache.invalidate(k);
                         Ok(Some(DbValue::PendingInboundTransaction(Box::new(
                             InboundTransaction::try_from(v, &cipher)?,
                         ))))
@@ -213,7 +221,7 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
             DbKey::PendingOutboundTransaction(t) => {
                 match OutboundTransactionSql::find_by_cancelled(*t, false, &mut conn) {
                     Ok(o) => Some(DbValue::PendingOutboundTransaction(Box::new(
-                        OutboundTransaction::try_from(o, &cipher)?,
+                        OutboundTransaction::try_from_cached(o, &cipher, &self.decrypted_cache)?,
                     ))),
                     Err(TransactionStorageError::DieselError(DieselError::NotFound)) => None,
                     Err(e) => return Err(e),
@@ -222,7 +230,7 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
             DbKey::PendingInboundTransaction(t) => match InboundTransactionSql::find_by_cancelled(*t, false, &mut conn)
             {
                 Ok(i) => Some(DbValue::PendingInboundTransaction(Box::new(
-                    InboundTransaction::try_from(i, &cipher)?,
+                    InboundTransaction::try_from_cached(i, &cipher, &self.decrypted_cache)?,
                 ))),
                 Err(TransactionStorageError::DieselError(DieselError::NotFound)) => None,
                 Err(e) => return Err(e),
@@ -238,7 +246,11 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
                 match OutboundTransactionSql::find(*t, &mut conn) {
                     Ok(o) => {
                         return Ok(Some(DbValue::WalletTransaction(Box::new(
-                            WalletTransaction::PendingOutbound(OutboundTransaction::try_from(o, &cipher)?),
+                            WalletTransaction::PendingOutbound(OutboundTransaction::try_from_cached(
+                                o,
+                                &cipher,
+                                &self.decrypted_cache,
+                            )?),
                         ))));
                     },
                     Err(TransactionStorageError::DieselError(DieselError::NotFound)) => (),
@@ -247,7 +259,11 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
                 match InboundTransactionSql::find(*t, &mut conn) {
                     Ok(i) => {
                         return Ok(Some(DbValue::WalletTransaction(Box::new(
-                            WalletTransaction::PendingInbound(InboundTransaction::try_from(i, &cipher)?),
+                            WalletTransaction::PendingInbound(InboundTransaction::try_from_cached(
+                                i,
+                                &cipher,
+                                &self.decrypted_cache,
+                            )?),
                         ))));
                     },
                     Err(TransactionStorageError::DieselError(DieselError::NotFound)) => (),
@@ -256,7 +272,11 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
                 match CompletedTransactionSql::find(*t, &mut conn) {
                     Ok(c) => {
                         return Ok(Some(DbValue::WalletTransaction(Box::new(
-                            WalletTransaction::Completed(CompletedTransaction::try_from(c, &cipher)?),
+                            WalletTransaction::Completed(CompletedTransaction::try_from_cached(
+                                c,
+                                &cipher,
+                                &self.decrypted_cache,
+                            )?),
                         ))));
                     },
                     Err(TransactionStorageError::DieselError(DieselError::NotFound)) => (),
@@ -266,75 +286,64 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
                 None
             },
             DbKey::PendingOutboundTransactions => {
-                let mut result = HashMap::new();
-                for o in OutboundTransactionSql::index_by_cancelled(&mut conn, false)? {
-                    result.insert(
-                        (o.tx_id as u64).into(),
-                        OutboundTransaction::try_from(o.clone(), &cipher)?,
-                    );
-                }
-
-                Some(DbValue::PendingOutboundTransactions(result))
+                let rows = OutboundTransactionSql::index_by_cancelled(&mut conn, false)?;
+                drop(conn);
+                // Bulk loads bypass the decrypted transaction cache rather than evict its working set
+                let cipher = &*cipher;
+                let transactions = try_par_map(rows, |o| OutboundTransaction::try_from(o, cipher))?;
+                Some(DbValue::PendingOutboundTransactions(
+                    transactions.into_iter().map(|tx| (tx.tx_id, tx)).collect(),
+                ))
             },
             DbKey::PendingInboundTransactions => {
-                let mut result = HashMap::new();
-                for i in InboundTransactionSql::index_by_cancelled(&mut conn, false)? {
-                    result.insert(
-                        (i.tx_id as u64).into(),
-                        InboundTransaction::try_from((i).clone(), &cipher)?,
-                    );
-                }
-
-                Some(DbValue::PendingInboundTransactions(result))
+                let rows = InboundTransactionSql::index_by_cancelled(&mut conn, false)?;
+                drop(conn);
+                let cipher = &*cipher;
+                let transactions = try_par_map(rows, |i| InboundTransaction::try_from(i, cipher))?;
+                Some(DbValue::PendingInboundTransactions(
+                    transactions.into_iter().map(|tx| (tx.tx_id, tx)).collect(),
+                ))
             },
             DbKey::CompletedTransactions => {
-                let mut result = HashMap::new();
-                for c in CompletedTransactionSql::index_by_cancelled(&mut conn, false)? {
-                    result.insert(
-                        (c.tx_id as u64).into(),
-                        CompletedTransaction::try_from((c).clone(), &cipher)?,
-                    );
-                }
-
-                Some(DbValue::CompletedTransactions(result))
+                let rows = CompletedTransactionSql::index_by_cancelled(&mut conn, false)?;
+                drop(conn);
+                let cipher = &*cipher;
+                let transactions = try_par_map(rows, |c| CompletedTransaction::try_from(c, cipher))?;
+                Some(DbValue::CompletedTransactions(
+                    transactions.into_iter().map(|tx| (tx.tx_id, tx)).collect(),
+                ))
             },
             DbKey::CancelledPendingOutboundTransactions => {
-                let mut result = HashMap::new();
-                for o in OutboundTransactionSql::index_by_cancelled(&mut conn, true)? {
-                    result.insert(
-                        (o.tx_id as u64).into(),
-                        OutboundTransaction::try_from((o).clone(), &cipher)?,
-                    );
-                }
-
-                Some(DbValue::PendingOutboundTransactions(result))
+                let rows = OutboundTransactionSql::index_by_cancelled(&mut conn, true)?;
+                drop(conn);
+                let cipher = &*cipher;
+                let transactions = try_par_map(rows, |o| OutboundTransaction::try_from(o, cipher))?;
+                Some(DbValue::PendingOutboundTransactions(
+                    transactions.into_iter().map(|tx| (tx.tx_id, tx)).collect(),
+                ))
             },
             DbKey::CancelledPendingInboundTransactions => {
-                let mut result = HashMap::new();
-                for i in InboundTransactionSql::index_by_cancelled(&mut conn, true)? {
-                    result.insert(
-                        (i.tx_id as u64).into(),
-                        InboundTransaction::try_from(i.clone(), &cipher)?,
-                    );
-                }
-
-                Some(DbValue::PendingInboundTransactions(result))
+                let rows = InboundTransactionSql::index_by_cancelled(&mut conn, true)?;
+                drop(conn);
+                let cipher = &*cipher;
+                let transactions = try_par_map(rows, |i| InboundTransaction::try_from(i, cipher))?;
+                Some(DbValue::PendingInboundTransactions(
+                    transactions.into_iter().map(|tx| (tx.tx_id, tx)).collect(),
+                ))
             },
             DbKey::CancelledCompletedTransactions => {
-                let mut result = HashMap::new();
-                for c in CompletedTransactionSql::index_by_cancelled(&mut conn, true)? {
-                    result.insert(
-                        (c.tx_id as u64).into(),
-                        CompletedTransaction::try_from((c).clone(), &cipher)?,
-                    );
-                }
-
-                Some(DbValue::CompletedTransactions(result))
+                let rows = CompletedTransactionSql::index_by_cancelled(&mut conn, true)?;
+                drop(conn);
+                let cipher = &*cipher;
+                let transactions = try_par_map(rows, |c| CompletedTransaction::try_from(c, cipher))?;
+                Some(DbValue::CompletedTransactions(
+                    transactions.into_iter().map(|tx| (tx.tx_id, tx)).collect(),
+                ))
             },
             DbKey::CancelledPendingOutboundTransaction(t) => {
                 match OutboundTransactionSql::find_by_cancelled(*t, true, &mut conn) {
                     Ok(o) => Some(DbValue::PendingOutboundTransaction(Box::new(
-                        OutboundTransaction::try_from(o, &cipher)?,
+                        OutboundTransaction::try_from_cached(o, &cipher, &self.decrypted_cache)?,
                     ))),
                     Err(TransactionStorageError::DieselError(DieselError::NotFound)) => None,
                     Err(e) => return Err(e),
@@ -343,7 +352,7 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
             DbKey::CancelledPendingInboundTransaction(t) => {
                 match InboundTransactionSql::find_by_cancelled(*t, true, &mut conn) {
                     Ok(i) => Some(DbValue::PendingInboundTransaction(Box::new(
-                        InboundTransaction::try_from(i, &cipher)?,
+                        InboundTransaction::try_from_cached(i, &cipher, &self.decrypted_cache)?,
                     ))),
                     Err(TransactionStorageError::DieselError(DieselError::NotFound)) => None,
                     Err(e) => return Err(e),
@@ -439,6 +448,43 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         result
     }
 
+    fn insert_completed_transactions(
+        &self,
+        transactions: Vec<CompletedTransaction>,
+    ) -> Result<Vec<bool>, TransactionStorageError> {
+        let start = Instant::now();
+        let mut conn = self.database_connection.get_pooled_connection()?;
+        let acquire_lock = start.elapsed();
+        let num_transactions = transactions.len();
+        let cipher = acquire_read_lock!(self.cipher);
+
+        let inserted = conn.transaction::<_, TransactionStorageError, _>(|conn| {
+            transactions
+                .into_iter()
+                .map(|transaction| {
+                    if CompletedTransactionSql::find_by_cancelled(transaction.tx_id, false, conn).is_ok() {
+                        return Ok(false);
+                    }
+                    self.decrypted_cache.invalidate(transaction.tx_id);
+                    CompletedTransactionSql::try_from(transaction, &cipher)?.commit(conn)?;
+                    Ok(true)
+                })
+                .collect()
+        })?;
+        if start.elapsed().as_millis() > 0 {
+            trace!(
+                target: LOG_TARGET,
+                "sqlite profile - insert_completed_transactions ({} transactions): lock {} + db_op {} = {} ms",
+                num_transactions,
+                acquire_lock.as_millis(),
+                (start.elapsed() - acquire_lock).as_millis(),
+                start.elapsed().as_millis()
+            );
+        }
+
+        Ok(inserted)
+    }
+
     fn transaction_exists(&self, tx_id: TxId) -> Result<bool, TransactionStorageError> {
         let start = Instant::now();
         let mut conn = self.database_connection.get_pooled_connection()?;
@@ -470,6 +516,7 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         let tx = CompletedTransactionSql::find_by_cancelled(tx_id, false, &mut conn)?;
 
         tx.delete(&mut conn)?;
+        self.decrypted_cache.invalidate(tx_id);
         let cipher = acquire_read_lock!(self.cipher);
         let completed_tx = CompletedTransactionSql::try_from(transaction, &cipher)?;
         completed_tx.commit(&mut conn)?;
@@ -495,7 +542,7 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         let cipher = acquire_read_lock!(self.cipher);
 
         if let Ok(outbound_tx_sql) = OutboundTransactionSql::find_by_cancelled(tx_id, false, &mut conn) {
-            let outbound_tx = OutboundTransaction::try_from(outbound_tx_sql, &cipher)?;
+            let outbound_tx = OutboundTransaction::try_from_cached(outbound_tx_sql, &cipher, &self.decrypted_cache)?;
             if start.elapsed().as_millis() > 0 {
                 trace!(
                     target: LOG_TARGET,
@@ -509,7 +556,7 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
             return Ok(outbound_tx.destination_address);
         }
         if let Ok(inbound_tx_sql) = InboundTransactionSql::find_by_cancelled(tx_id, false, &mut conn) {
-            let inbound_tx = InboundTransaction::try_from(inbound_tx_sql, &cipher)?;
+            let inbound_tx = InboundTransaction::try_from_cached(inbound_tx_sql, &cipher, &self.decrypted_cache)?;
             if start.elapsed().as_millis() > 0 {
                 trace!(
                     target: LOG_TARGET,
@@ -581,7 +628,10 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
 
         conn.transaction::<_, _, _>(|conn| {
             match OutboundTransactionSql::complete_outbound_transaction(tx_id, conn) {
-                Ok(_) => completed_tx_sql.commit(conn)?,
+                Ok(_) => {
+                    self.decrypted_cache.invalidate(tx_id);
+                    completed_tx_sql.commit(conn)?
+                },
                 Err(TransactionStorageError::DieselError(DieselError::NotFound)) => {
                     return Err(TransactionStorageError::ValueNotFound(
                         DbKey::PendingOutboundTransaction(tx_id),
@@ -622,7 +672,10 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
 
         conn.transaction::<_, _, _>(|conn| {
             match InboundTransactionSql::complete_inbound_transaction(tx_id, conn) {
-                Ok(_) => completed_tx_sql.commit(conn)?,
+                Ok(_) => {
+                    self.decrypted_cache.invalidate(tx_id);
+                    completed_tx_sql.commit(conn)?
+                },
                 Err(TransactionStorageError::DieselError(DieselError::NotFound)) => {
                     return Err(TransactionStorageError::ValueNotFound(
                         DbKey::PendingInboundTransaction(tx_id),
@@ -870,7 +923,11 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
             .first::<CompletedTransactionSql>(&mut conn)
             .optional()?;
         let result = match tx {
-            Some(tx) => Some(CompletedTransaction::try_from(tx, &cipher)?),
+            Some(tx) => Some(CompletedTransaction::try_from_cached(
+                tx,
+                &cipher,
+                &self.decrypted_cache,
+            )?),
             None => None,
         };
         if start.elapsed().as_millis() > 0 {
@@ -930,7 +987,11 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
 
         let mut result = vec![];
         for tx in txs {
-            result.push(CompletedTransaction::try_from(tx, &cipher)?);
+            result.push(CompletedTransaction::try_from_cached(
+                tx,
+                &cipher,
+                &self.decrypted_cache,
+            )?);
         }
         if start.elapsed().as_millis() > 0 {
             trace!(
@@ -1034,7 +1095,8 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         CompletedTransactionSql::index_by_status_and_cancelled(TransactionStatus::Imported, false, &mut conn)?
             .into_iter()
             .map(|ct: CompletedTransactionSql| {
-                CompletedTransaction::try_from(ct, &cipher).map_err(TransactionStorageError::from)
+                CompletedTransaction::try_from_cached(ct, &cipher, &self.decrypted_cache)
+                    .map_err(TransactionStorageError::from)
             })
             .collect::<Result<Vec<CompletedTransaction>, TransactionStorageError>>()
     }
@@ -1050,7 +1112,8 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         )?
         .into_iter()
         .map(|ct: CompletedTransactionSql| {
-            CompletedTransaction::try_from(ct, &cipher).map_err(TransactionStorageError::from)
+            CompletedTransaction::try_from_cached(ct, &cipher, &self.decrypted_cache)
+                .map_err(TransactionStorageError::from)
         })
         .collect::<Result<Vec<CompletedTransaction>, TransactionStorageError>>()?;
         let mut coinbases = CompletedTransactionSql::index_by_status_and_cancelled(
@@ -1060,7 +1123,8 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         )?
         .into_iter()
         .map(|ct: CompletedTransactionSql| {
-            CompletedTransaction::try_from(ct, &cipher).map_err(TransactionStorageError::from)
+            CompletedTransaction::try_from_cached(ct, &cipher, &self.decrypted_cache)
+                .map_err(TransactionStorageError::from)
         })
         .collect::<Result<Vec<CompletedTransaction>, TransactionStorageError>>()?;
         coinbases.append(&mut one_sided);
@@ -1082,12 +1146,35 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         )?
         .into_iter()
         .map(|ct: CompletedTransactionSql| {
-            CompletedTransaction::try_from(ct, &cipher).map_err(TransactionStorageError::from)
+            CompletedTransaction::try_from_cached(ct, &cipher, &self.decrypted_cache)
+                .map_err(TransactionStorageError::from)
         })
         .collect::<Result<Vec<CompletedTransaction>, TransactionStorageError>>()?;
         Ok(coinbases)
     }
 
+    fn fetch_completed_transactions_page(
+        &self,
+        from_time: Option<NaiveDateTime>,
+        to_time: Option<NaiveDateTime>,
+        after: Option<(NaiveDateTime, TxId)>,
+        limit: usize,
+    ) -> Result<Vec<CompletedTransaction>, TransactionStorageError> {
+        let mut conn = self.database_connection.get_pooled_connection()?;
+        let rows = CompletedTransactionSql::index_page_by_timestamp(
+            from_time,
+            to_time,
+            after.map(|(timestamp, tx_id)| (timestamp, tx_id.as_u64() as i64)),
+            limit as i64,
+            &mut conn,
+        )?;
+        drop(conn);
+        let cipher = acquire_read_lock!(self.cipher);
+        let cipher = &*cipher;
+        // Pages are read once, so they bypass the decrypted transaction cache rather than evict its working set
+        Ok(try_par_map(rows, |c| CompletedTransaction::try_from(c, cipher))?)
+    }
+
     fn fetch_confirmed_detected_transactions_from_height(
         &self,
         height: u64,
@@ -1103,7 +1190,8 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         )?
         .into_iter()
         .map(|ct: CompletedTransactionSql| {
-            CompletedTransaction::try_from(ct, &cipher).map_err(TransactionStorageError::from)
+            CompletedTransaction::try_from_cached(ct, &cipher, &self.decrypted_cache)
+                .map_err(TransactionStorageError::from)
         })
         .collect::<Result<Vec<CompletedTransaction>, TransactionStorageError>>()?;
         let mut coinbases = CompletedTransactionSql::index_by_status_and_cancelled_from_block_height(
@@ -1114,7 +1202,8 @@ impl TransactionBackend for TransactionServiceSqliteDatabase {
         )?
         .into_iter()
         .map(|ct: CompletedTransactionSql| {
-            CompletedTransaction::try_from(ct, &cipher).map_err(TransactionStorageError::from)
+            CompletedTransaction::try_from_cached(ct, &cipher, &self.decrypted_cache)
+                .map_err(TransactionStorageError::from)
         })
         .collect::<Result<Vec<CompletedTransaction>, TransactionStorageError>>()?;
         coinbases.append(&mut one_sided);
@@ -1390,9 +1479,37 @@ impl Encryptable<XChaCha20Poly1305> for InboundTransactionSql {
     }
 }
 
+impl InboundTransactionSql {
+    /// Decrypts the record like `decrypt`, reusing an earlier decryption of the same ciphertext if it is cached
+    fn decrypt_cached(mut self, cipher: &XChaCha20Poly1305, cache: &DecryptedTransactionCache) -> Result<Self, String> {
+        self.receiver_protocol = cache.decrypt(
+            TransactionTable::Inbound,
+            (self.tx_id as u64).into(),
+            &self.receiver_protocol,
+            || decrypt_bytes_integral_nonce(cipher, self.domain("receiver_protocol"), &self.receiver_protocol),
+        )?;
+
+        Ok(self)
+    }
+}
+
 impl InboundTransaction {
     fn try_from(i: InboundTransactionSql, cipher: &XChaCha20Poly1305) -> Result<Self, TransactionStorageError> {
-        let i = i.decrypt(cipher).map_err(TransactionStorageError::AeadError)?;
+        Self::from_decrypted(i.decrypt(cipher).map_err(TransactionStorageError::AeadError)?)
+    }
+
+    fn try_from_cached(
+        i: InboundTransactionSql,
+        cipher: &XChaCha20Poly1305,
+        cache: &DecryptedTransactionCache,
+    ) -> Result<Self, TransactionStorageError> {
+        Self::from_decrypted(
+            i.decrypt_cached(cipher, cache)
+                .map_err(TransactionStorageError::AeadError)?,
+        )
+    }
+
+    fn from_decrypted(i: InboundTransactionSql) -> Result<Self, TransactionStorageError> {
         Ok(Self {
             tx_id: (i.tx_id as u64).into(),
             source_address: TariAddress::from_bytes(&i.source_address).map_err(TransactionKeyError::Source)?,
@@ -1639,9 +1756,37 @@ impl Encryptable<XChaCha20Poly1305> for OutboundTransactionSql {
     }
 }
 
+impl OutboundTransactionSql {
+    /// Decrypts the record like `decrypt`, reusing an earlier decryption of the same ciphertext if it is cached
+    fn decrypt_cached(mut self, cipher: &XChaCha20Poly1305, cache: &DecryptedTransactionCache) -> Result<Self, String> {
+        self.sender_protocol = cache.decrypt(
+            TransactionTable::Outbound,
+            (self.tx_id as u64).into(),
+            &self.sender_protocol,
+            || decrypt_bytes_integral_nonce(cipher, self.domain("sender_protocol"), &self.sender_protocol),
+        )?;
+
+        Ok(self)
+    }
+}
+
 impl OutboundTransaction {
     fn try_from(o: OutboundTransactionSql, cipher: &XChaCha20Poly1305) -> Result<Self, TransactionStorageError> {
-        let mut o = o.decrypt(cipher).map_err(TransactionStorageError::AeadError)?;
+        Self::from_decrypted(o.decrypt(cipher).map_err(TransactionStorageError::AeadError)?)
+    }
+
+    fn try_from_cached(
+        o: OutboundTransactionSql,
+        cipher: &XChaCha20Poly1305,
+        cache: &DecryptedTransactionCache,
+    ) -> Result<Self, TransactionStorageError> {
+        Self::from_decrypted(
+            o.decrypt_cached(cipher, cache)
+                .map_err(TransactionStorageError::AeadError)?,
+        )
+    }
+
+    fn from_decrypted(mut o: OutboundTransactionSql) -> Result<Self, TransactionStorageError> {
         let outbound_tx = Self {
             tx_id: (o.tx_id as u64).into(),
             destination_address: TariAddress::from_bytes(&o.destination_address)
@@ -1765,6 +1910,40 @@ impl CompletedTransactionSql {
             .load::<CompletedTransactionSql>(conn)?)
     }
 
+    /// Returns up to `limit` transactions, cancelled or not, with a timestamp in `[from_time, to_time)`, ordered by
+    /// timestamp and transaction id and starting after the `(timestamp, tx_id)` of the last row of the previous page
+    pub fn index_page_by_timestamp(
+        from_time: Option<NaiveDateTime>,
+        to_time: Option<NaiveDateTime>,
+        after: Option<(NaiveDateTime, i64)>,
+        limit: i64,
+        conn: &mut SqliteConnection,
+    ) -> Result<Vec<CompletedTransactionSql>, TransactionStorageError> {
+        let mut query = completed_transactions::table.into_boxed();
+        if let Some(from_time) = from_time {
+            query = query.filter(completed_transactions::timestamp.ge(from_time));
+        }
+        if let Some(to_time) = to_time {
+            query = query.filter(completed_transactions::timestamp.lt(to_time));
+        }
+        if let Some((timestamp, tx_id)) = after {
+            query = query.filter(
+                completed_transactions::timestamp
+                    .gt(timestamp)
+                    .or(completed_transactions::timestamp
+                        .eq(timestamp)
+                        .and(completed_transactions::tx_id.gt(tx_id))),
+            );
+        }
+        Ok(query
+            .order_by((
+                completed_transactions::timestamp.asc(),
+                completed_transactions::tx_id.asc(),
+            ))
+            .limit(limit)
+            .load::<CompletedTransactionSql>(conn)?)
+    }
+
     pub fn find(tx_id: TxId, conn: &mut SqliteConnection) -> Result<CompletedTransactionSql, TransactionStorageError> {
         Ok(completed_transactions::table
             .filter(completed_transactions::tx_id.eq(tx_id.as_u64() as i64))
@@ -2024,6 +2203,20 @@ impl Encryptable<XChaCha20Poly1305> for CompletedTransactionSql {
     }
 }
 
+impl CompletedTransactionSql {
+    /// Decrypts the record like `decrypt`, reusing an earlier decryption of the same ciphertext if it is cached
+    fn decrypt_cached(mut self, cipher: &XChaCha20Poly1305, cache: &DecryptedTransactionCache) -> Result<Self, String> {
+        self.transaction_protocol = cache.decrypt(
+            TransactionTable::Completed,
+            (self.tx_id as u64).into(),
+            &self.transaction_protocol,
+            || decrypt_bytes_integral_nonce(cipher, self.domain("transaction_protocol"), &self.transaction_protocol),
+        )?;
+
+        Ok(self)
+    }
+}
+
 #[derive(Debug, Error)]
 pub enum CompletedTransactionConversionError {
     #[error("CompletedTransaction conversion failed by wrong direction: {0}")]
@@ -2045,9 +2238,24 @@ impl CompletedTransaction {
         c: CompletedTransactionSql,
         cipher: &XChaCha20Poly1305,
     ) -> Result<Self, CompletedTransactionConversionError> {
-        let mut c = c
-            .decrypt(cipher)
-            .map_err(CompletedTransactionConversionError::AeadError)?;
+        Self::from_decrypted(
+            c.decrypt(cipher)
+                .map_err(CompletedTransactionConversionError::AeadError)?,
+        )
+    }
+
+    fn try_from_cached(
+        c: CompletedTransactionSql,
+        cipher: &XChaCha20Poly1305,
+        cache: &DecryptedTransactionCache,
+    ) -> Result<Self, CompletedTransactionConversionError> {
+        Self::from_decrypted(
+            c.decrypt_cached(cipher, cache)
+                .map_err(CompletedTransactionConversionError::AeadError)?,
+        )
+    }
+
+    fn from_decrypted(mut c: CompletedTransactionSql) -> Result<Self, CompletedTransactionConversionError> {
         let transaction_signature = match PublicKey::from_vec(&c.transaction_signature_nonce) {
             Ok(public_nonce) => match PrivateKey::from_vec(&c.transaction_signature_key) {
                 Ok(signature) => Signature::new(public_nonce, signature),
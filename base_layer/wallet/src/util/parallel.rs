@@ -0,0 +1,93 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::{num::NonZeroUsize, panic, thread};
+
+/// The smallest number of items worth handing to a thread of its own. Below this the cost of spawning the thread
+/// outweighs the work done on it.
+const MIN_ITEMS_PER_THREAD: usize = 32;
+
+/// Maps `items` through the fallible `f`, spreading the work across the available cores. The order of the items is
+/// kept, and the first error encountered is returned. Small inputs are mapped on the calling thread.
+pub fn try_par_map<T, U, E, F>(items: Vec<T>, f: F) -> Result<Vec<U>, E>
+where
+    T: Send,
+    U: Send,
+    E: Send,
+    F: Fn(T) -> Result<U, E> + Sync,
+{
+    let num_threads = thread::available_parallelism()
+        .map(NonZeroUsize::get)
+        .unwrap_or(1)
+        .min(items.len() / MIN_ITEMS_PER_THREAD);
+    if num_threads <= 1 {
+        return items.into_iter().map(f).collect();
+    }
+
+    let num_items = items.len();
+    let chunk_size = (num_items + num_threads - 1) / num_threads;
+    let mut chunks = Vec::with_capacity(num_threads);
+    let mut items = items.into_iter();
+    loop {
+        let chunk = items.by_ref().take(chunk_size).collect::<Vec<_>>();
+        if chunk.is_empty() {
+            break;
+        }
+        chunks.push(chunk);
+    }
+
+    let f = &f;
+    thread::scope(|scope| {
+        let handles = chunks
+            .into_iter()
+            .map(|chunk| scope.spawn(move || chunk.into_iter().map(f).collect::<Result<Vec<_>, _>>()))
+            .collect::<Vec<_>>();
+        let mut results = Vec::with_capacity(num_items);
+        for handle in handles {
+            let mapped = handle.join().unwrap_or_else(|e| panic::resume_unwind(e))?;
+            results.extend(mapped);
+        }
+        Ok(results)
+    })
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn it_keeps_the_order_of_the_items() {
+        let items = (0..1000u32).collect::<Vec<_>>();
+        let mapped = try_par_map(items, |i| Ok::<_, ()>(i * 2)).unwrap();
+        assert_eq!(mapped, (0..1000u32).map(|i| i * 2).collect::<Vec<_>>());
+
+        let mapped = try_par_map(vec![3u32, 2, 1], |i| Ok::<_, ()>(i + 1)).unwrap();
+        assert_eq!(mapped, vec![4, 3, 2]);
+    }
+
+    #[test]
+    fn it_returns_an_error() {
+        let items = (0..1000u32).collect::<Vec<_>>();
+        let result = try_par_map(items, |i| if i == 500 { Err(i) } else { Ok(i) });
+        assert_eq!(result, Err(500));
+    }
+}
@@ -0,0 +1,229 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::{
+    convert::TryFrom,
+    fs::File,
+    io,
+    io::{BufReader, BufWriter, Read, Write},
+    path::Path,
+};
+
+use prost::Message;
+use tari_common::configuration::Network;
+use tari_common_types::types::BlockHash;
+use tari_core::proto::base_node::SyncUtxosByBlockResponse;
+
+use crate::utxo_scanner_service::error::UtxoScannerError;
+
+const SNAPSHOT_MAGIC: &[u8; 4] = b"TBOS";
+const SNAPSHOT_VERSION: u8 = 2;
+/// The largest encoded block record that will be read, so that a corrupt length cannot exhaust memory
+const MAX_RECORD_SIZE: usize = 64 * 1024 * 1024;
+
+/// Writes a block output snapshot: a header identifying the chain the snapshot was taken from by its network and
+/// genesis block hash, along with the tip height of that chain, followed by one length delimited
+/// `SyncUtxosByBlockResponse` per block, in height order. This is the same data a base node
+/// streams to a wallet during recovery, so a snapshot can be produced by recording that stream.
+pub struct BlockOutputSnapshotWriter {
+    writer: BufWriter<File>,
+}
+
+impl BlockOutputSnapshotWriter {
+    pub fn create<P: AsRef<Path>>(
+        path: P,
+        network: Network,
+        genesis_hash: &BlockHash,
+        tip_height: u64,
+    ) -> Result<Self, UtxoScannerError> {
+        let mut writer = BufWriter::new(File::create(path).map_err(snapshot_error)?);
+        writer.write_all(SNAPSHOT_MAGIC).map_err(snapshot_error)?;
+        writer.write_all(&[SNAPSHOT_VERSION]).map_err(snapshot_error)?;
+        writer.write_all(&[network.as_byte()]).map_err(snapshot_error)?;
+        writer.write_all(genesis_hash.as_slice()).map_err(snapshot_error)?;
+        writer.write_all(&tip_height.to_le_bytes()).map_err(snapshot_error)?;
+        Ok(Self { writer })
+    }
+
+    pub fn write_block(&mut self, block: &SyncUtxosByBlockResponse) -> Result<(), UtxoScannerError> {
+        let bytes = block.encode_length_delimited_to_vec();
+        self.writer.write_all(&bytes).map_err(snapshot_error)
+    }
+
+    pub fn finish(mut self) -> Result<(), UtxoScannerError> {
+        self.writer.flush().map_err(snapshot_error)
+    }
+}
+
+/// Reads a block output snapshot written by [BlockOutputSnapshotWriter] one block at a time, so that the size of the
+/// snapshot does not bound the memory used by a recovery.
+pub struct BlockOutputSnapshotReader {
+    reader: BufReader<File>,
+    network: Network,
+    genesis_hash: BlockHash,
+    tip_height: u64,
+    record: Vec<u8>,
+}
+
+impl BlockOutputSnapshotReader {
+    pub fn open<P: AsRef<Path>>(path: P) -> Result<Self, UtxoScannerError> {
+        let mut reader = BufReader::new(File::open(path).map_err(snapshot_error)?);
+        let mut header = [0u8; 5];
+        reader.read_exact(&mut header).map_err(snapshot_error)?;
+        if &header[..4] != SNAPSHOT_MAGIC {
+            return Err(UtxoScannerError::BlockOutputSnapshotError(
+                "Not a block output snapshot".to_string(),
+            ));
+        }
+        if header[4] != SNAPSHOT_VERSION {
+            return Err(UtxoScannerError::BlockOutputSnapshotError(format!(
+                "Unsupported block output snapshot version {}",
+                header[4]
+            )));
+        }
+        let mut network = [0u8; 1];
+        reader.read_exact(&mut network).map_err(snapshot_error)?;
+        let network = Network::try_from(network[0]).map_err(|_| {
+            UtxoScannerError::BlockOutputSnapshotError(format!("Unknown block output snapshot network {}", network[0]))
+        })?;
+        let mut genesis_hash = [0u8; BlockHash::byte_size()];
+        reader.read_exact(&mut genesis_hash).map_err(snapshot_error)?;
+        let mut tip_height = [0u8; 8];
+        reader.read_exact(&mut tip_height).map_err(snapshot_error)?;
+        Ok(Self {
+            reader,
+            network,
+            genesis_hash: BlockHash::from(genesis_hash),
+            tip_height: u64::from_le_bytes(tip_height),
+            record: Vec::new(),
+        })
+    }
+
+    /// The network of the chain the snapshot was taken from
+    pub fn network(&self) -> Network {
+        self.network
+    }
+
+    /// The genesis block hash of the chain the snapshot was taken from
+    pub fn genesis_hash(&self) -> &BlockHash {
+        &self.genesis_hash
+    }
+
+    /// The height of the chain tip when the snapshot was taken
+    pub fn tip_height(&self) -> u64 {
+        self.tip_height
+    }
+
+    /// Returns the next block in the snapshot, or `None` once every block has been read
+    pub fn next_block(&mut self) -> Result<Option<SyncUtxosByBlockResponse>, UtxoScannerError> {
+        let len = match self.read_record_length()? {
+            Some(len) => len,
+            None => return Ok(None),
+        };
+        if len > MAX_RECORD_SIZE {
+            return Err(UtxoScannerError::BlockOutputSnapshotError(format!(
+                "Block record of {} bytes exceeds the maximum of {} bytes",
+                len, MAX_RECORD_SIZE
+            )));
+        }
+        self.record.resize(len, 0);
+        self.reader.read_exact(&mut self.record).map_err(snapshot_error)?;
+        let block = SyncUtxosByBlockResponse::decode(self.record.as_slice())
+            .map_err(|e| UtxoScannerError::BlockOutputSnapshotError(e.to_string()))?;
+        Ok(Some(block))
+    }
+
+    /// Reads the varint length prefix of the next record. Returns `None` at a clean end of the file.
+    fn read_record_length(&mut self) -> Result<Option<usize>, UtxoScannerError> {
+        let mut len = 0u64;
+        for i in 0..10 {
+            let mut byte = [0u8; 1];
+            match self.reader.read_exact(&mut byte) {
+                Ok(()) => {},
+                Err(e) if i == 0 && e.kind() == io::ErrorKind::UnexpectedEof => return Ok(None),
+                Err(e) => return Err(snapshot_error(e)),
+            }
+            len |= u64::from(byte[0] & 0x7f) << (7 * i);
+            if byte[0] & 0x80 == 0 {
+                return usize::try_from(len)
+                    .map(Some)
+                    .map_err(|_| UtxoScannerError::OverflowError);
+            }
+        }
+        Err(UtxoScannerError::BlockOutputSnapshotError(
+            "Invalid block record length".to_string(),
+        ))
+    }
+}
+
+fn snapshot_error(err: io::Error) -> UtxoScannerError {
+    UtxoScannerError::BlockOutputSnapshotError(err.to_string())
+}
+
+#[cfg(test)]
+mod test {
+    use tempfile::tempdir;
+
+    use super::*;
+
+    #[test]
+    fn it_reads_back_the_blocks_that_were_written() {
+        let dir = tempdir().unwrap();
+        let path = dir.path().join("snapshot.bin");
+        let blocks = (0..3u8)
+            .map(|height| SyncUtxosByBlockResponse {
+                outputs: vec![],
+                height: u64::from(height),
+                header_hash: vec![height; 32],
+                mined_timestamp: 1_700_000_000 + u64::from(height) * 120,
+            })
+            .collect::<Vec<_>>();
+
+        let genesis_hash = BlockHash::from([7u8; 32]);
+        let mut writer = BlockOutputSnapshotWriter::create(&path, Network::LocalNet, &genesis_hash, 2).unwrap();
+        for block in &blocks {
+            writer.write_block(block).unwrap();
+        }
+        writer.finish().unwrap();
+
+        let mut reader = BlockOutputSnapshotReader::open(&path).unwrap();
+        assert_eq!(reader.network(), Network::LocalNet);
+        assert_eq!(reader.genesis_hash(), &genesis_hash);
+        assert_eq!(reader.tip_height(), 2);
+        let mut read = Vec::new();
+        while let Some(block) = reader.next_block().unwrap() {
+            read.push(block);
+        }
+        assert_eq!(read, blocks);
+    }
+
+    #[test]
+    fn it_rejects_a_file_that_is_not_a_snapshot() {
+        let dir = tempdir().unwrap();
+        let path = dir.path().join("snapshot.bin");
+        std::fs::write(&path, b"not a snapshot").unwrap();
+        assert!(matches!(
+            BlockOutputSnapshotReader::open(&path),
+            Err(UtxoScannerError::BlockOutputSnapshotError(_))
+        ));
+    }
+}
@@ -63,6 +63,8 @@ pub enum UtxoScannerError {
     FixedHashSizeError(#[from] FixedHashSizeError),
     #[error("Connectivity has shut down")]
     ConnectivityShutdown,
+    #[error("Block output snapshot error: `{0}`")]
+    BlockOutputSnapshotError(String),
 }
 
 impl From<HexError> for UtxoScannerError {
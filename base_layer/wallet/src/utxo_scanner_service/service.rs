@@ -20,6 +20,8 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+use std::{path::PathBuf, time::Duration};
+
 use chrono::NaiveDateTime;
 use futures::FutureExt;
 use log::*;
@@ -51,11 +53,27 @@ pub const LOG_TARGET: &str = "wallet::utxo_scanning";
 // Cache 1 days worth of headers.
 pub const SCANNED_BLOCK_CACHE_SIZE: u64 = 720;
 
+// The number of blocks that may be buffered between each stage of the scanning pipeline (stream, scan, import)
+pub const UTXO_SCAN_PIPELINE_DEPTH: usize = 16;
+
+// The maximum number of scanned blocks whose outputs and scanned block markers are written in one database transaction
+pub const UTXO_SCAN_IMPORT_BATCH_SIZE: usize = 100;
+
+// The number of blocks requested from one peer at a time when scanning is sharded across several peers
+pub const UTXO_SCAN_SEGMENT_SIZE: u64 = 250;
+
+// A segment whose peer sends nothing for this long is reassigned to the next peer
+pub const UTXO_SCAN_SEGMENT_TIMEOUT: Duration = Duration::from_secs(120);
+
+// How long a recovery from a block output snapshot waits for the base node to compare genesis block hashes with
+pub const SNAPSHOT_GENESIS_CHECK_TIMEOUT: Duration = Duration::from_secs(30);
+
 pub struct UtxoScannerService<TBackend, TWalletConnectivity> {
     pub(crate) resources: UtxoScannerResources<TBackend, TWalletConnectivity>,
     pub(crate) retry_limit: usize,
     pub(crate) peer_seeds: Vec<CommsPublicKey>,
     pub(crate) mode: UtxoScannerMode,
+    pub(crate) snapshot_path: Option<PathBuf>,
     pub(crate) shutdown_signal: ShutdownSignal,
     pub(crate) event_sender: broadcast::Sender<UtxoScannerEvent>,
     pub(crate) base_node_service: BaseNodeServiceHandle,
@@ -72,6 +90,7 @@ where
         peer_seeds: Vec<CommsPublicKey>,
         retry_limit: usize,
         mode: UtxoScannerMode,
+        snapshot_path: Option<PathBuf>,
         resources: UtxoScannerResources<TBackend, TWalletConnectivity>,
         shutdown_signal: ShutdownSignal,
         event_sender: broadcast::Sender<UtxoScannerEvent>,
@@ -84,6 +103,7 @@ where
             peer_seeds,
             retry_limit,
             mode,
+            snapshot_path,
             shutdown_signal,
             event_sender,
             base_node_service,
@@ -101,6 +121,7 @@ where
             peer_index: 0,
             num_retries: 1,
             mode: self.mode.clone(),
+            snapshot_path: self.snapshot_path.clone(),
             shutdown_signal,
         }
     }
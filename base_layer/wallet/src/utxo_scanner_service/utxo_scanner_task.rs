@@ -21,21 +21,23 @@
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 use std::{
+    collections::VecDeque,
     convert::{TryFrom, TryInto},
+    path::PathBuf,
     time::{Duration, Instant},
 };
 
 use chrono::{NaiveDateTime, Utc};
-use futures::StreamExt;
+use futures::{future, pin_mut, stream::FuturesUnordered, FutureExt, StreamExt};
 use log::*;
 use tari_common_types::{
     tari_address::TariAddress,
     transaction::{ImportStatus, TxId},
-    types::HashOutput,
+    types::{BlockHash, HashOutput},
 };
 use tari_comms::{
     peer_manager::NodeId,
-    protocol::rpc::RpcClientLease,
+    protocol::rpc::{RpcClientLease, Streaming},
     traits::OrOptional,
     types::CommsPublicKey,
     Minimized,
@@ -44,7 +46,7 @@ use tari_comms::{
 use tari_core::{
     base_node::rpc::BaseNodeWalletRpcClient,
     blocks::BlockHeader,
-    proto::base_node::SyncUtxosByBlockRequest,
+    proto::base_node::{SyncUtxosByBlockRequest, SyncUtxosByBlockResponse},
     transactions::{
         tari_amount::MicroMinotari,
         transaction_components::{TransactionOutput, WalletOutput},
@@ -53,17 +55,31 @@ use tari_core::{
 use tari_key_manager::get_birthday_from_unix_epoch_in_seconds;
 use tari_shutdown::ShutdownSignal;
 use tari_utilities::hex::Hex;
-use tokio::sync::broadcast;
+use tokio::{
+    sync::{broadcast, mpsc},
+    task,
+    time,
+};
 
 use crate::{
     connectivity_service::WalletConnectivityInterface,
-    error::WalletError,
+    output_manager_service::handle::OutputManagerHandle,
     storage::database::WalletBackend,
-    transaction_service::error::{TransactionServiceError, TransactionStorageError},
+    transaction_service::storage::models::UtxoImport,
     utxo_scanner_service::{
+        block_output_snapshot::BlockOutputSnapshotReader,
         error::UtxoScannerError,
         handle::UtxoScannerEvent,
-        service::{ScannedBlock, UtxoScannerResources, SCANNED_BLOCK_CACHE_SIZE},
+        service::{
+            ScannedBlock,
+            UtxoScannerResources,
+            SCANNED_BLOCK_CACHE_SIZE,
+            SNAPSHOT_GENESIS_CHECK_TIMEOUT,
+            UTXO_SCAN_IMPORT_BATCH_SIZE,
+            UTXO_SCAN_PIPELINE_DEPTH,
+            UTXO_SCAN_SEGMENT_SIZE,
+            UTXO_SCAN_SEGMENT_TIMEOUT,
+        },
         uxto_scanner_service_builder::UtxoScannerMode,
         RECOVERY_KEY,
     },
@@ -79,6 +95,7 @@ pub struct UtxoScannerTask<TBackend, TWalletConnectivity> {
     pub(crate) peer_seeds: Vec<CommsPublicKey>,
     pub(crate) peer_index: usize,
     pub(crate) mode: UtxoScannerMode,
+    pub(crate) snapshot_path: Option<PathBuf>,
     pub(crate) shutdown_signal: ShutdownSignal,
 }
 impl<TBackend, TWalletConnectivity> UtxoScannerTask<TBackend, TWalletConnectivity>
@@ -100,6 +117,12 @@ where
             }
         }
 
+        if self.mode == UtxoScannerMode::Recovery {
+            if let Some(snapshot_path) = self.snapshot_path.clone() {
+                return self.run_snapshot_recovery(snapshot_path).await;
+            }
+        }
+
         loop {
             if self.shutdown_signal.is_triggered() {
                 return Ok(());
@@ -178,6 +201,122 @@ where
         Ok(())
     }
 
+    async fn run_snapshot_recovery(mut self, snapshot_path: PathBuf) -> Result<(), UtxoScannerError> {
+        match self.attempt_snapshot_sync(snapshot_path).await {
+            Ok((num_outputs_recovered, final_height, final_amount, elapsed)) => {
+                debug!(target: LOG_TARGET, "Scanned snapshot to height #{}", final_height);
+                self.finalize(num_outputs_recovered, final_height, final_amount, elapsed)
+                    .await
+            },
+            Err(e) => {
+                warn!(target: LOG_TARGET, "Failed to scan UTXO's from snapshot: {}", e);
+                self.publish_event(UtxoScannerEvent::ScanningRoundFailed {
+                    num_retries: self.num_retries,
+                    retry_limit: self.retry_limit,
+                    error: e.to_string(),
+                });
+                self.publish_event(UtxoScannerEvent::ScanningFailed);
+                Err(e)
+            },
+        }
+    }
+
+    /// Scans the blocks of a local block output snapshot from the wallet birthday, feeding them into the same scan and
+    /// import stages used when streaming from a base node. The scan always starts afresh, outputs that were already
+    /// imported are skipped, so running it again against the same snapshot is harmless. A snapshot of another chain
+    /// than the wallet's is rejected before anything is imported.
+    async fn attempt_snapshot_sync(
+        &mut self,
+        snapshot_path: PathBuf,
+    ) -> Result<(u64, u64, MicroMinotari, Duration), UtxoScannerError> {
+        let timer = Instant::now();
+        let reader = BlockOutputSnapshotReader::open(&snapshot_path)?;
+        let network = self.resources.one_sided_tari_address.network();
+        if reader.network() != network {
+            return Err(UtxoScannerError::BlockOutputSnapshotError(format!(
+                "The snapshot was taken on {} but the wallet is on {}",
+                reader.network(),
+                network
+            )));
+        }
+        self.check_snapshot_genesis_hash(reader.genesis_hash()).await?;
+        let tip_height = reader.tip_height();
+        self.resources.db.clear_scanned_blocks()?;
+        let birthday = self.resources.db.get_wallet_birthday()?;
+        // Start two weeks (14 days) before the wallet birthday, as is done when scanning from a base node
+        let start_time = get_birthday_from_unix_epoch_in_seconds(birthday, 14u16);
+        info!(
+            target: LOG_TARGET,
+            "Wallet recovery from snapshot '{}' starting (tip height: {})",
+            snapshot_path.display(),
+            tip_height
+        );
+
+        let (block_sender, block_receiver) = mpsc::channel(UTXO_SCAN_PIPELINE_DEPTH);
+        let (scanned_sender, scanned_receiver) = mpsc::channel(UTXO_SCAN_PIPELINE_DEPTH);
+        let shutdown_signal = self.shutdown_signal.clone();
+        let output_manager_service = self.resources.output_manager_service.clone();
+        let recovery_message = self.resources.recovery_message.clone();
+
+        // File reads are blocking, so the blocks are read on the blocking thread pool
+        let read_stage = async move {
+            task::spawn_blocking(move || read_snapshot_blocks(reader, start_time, block_sender, shutdown_signal))
+                .await
+                .map_err(|e| UtxoScannerError::BlockOutputSnapshotError(e.to_string()))?
+        };
+
+        let (total_scanned, _, (num_recovered, total_amount)) = tokio::try_join!(
+            read_stage,
+            Self::scan_blocks(output_manager_service, recovery_message, block_receiver, scanned_sender),
+            self.import_scanned_blocks(scanned_receiver, tip_height),
+        )?;
+        debug!(
+            target: LOG_TARGET,
+            "Snapshot scan completed up to height {} in {:.2?} ({} outputs scanned, {} recovered with value {})",
+            tip_height,
+            timer.elapsed(),
+            total_scanned,
+            num_recovered,
+            total_amount
+        );
+
+        Ok((num_recovered, tip_height, total_amount, timer.elapsed()))
+    }
+
+    /// Checks that a snapshot belongs to the chain of the wallet's base node by comparing their genesis block hashes.
+    /// The wallet cannot build the genesis block itself, so the check is skipped when no base node can be reached.
+    async fn check_snapshot_genesis_hash(&mut self, genesis_hash: &BlockHash) -> Result<(), UtxoScannerError> {
+        let client = if self.resources.wallet_connectivity.is_base_node_set() {
+            self.resources
+                .wallet_connectivity
+                .obtain_base_node_wallet_rpc_client_timeout(SNAPSHOT_GENESIS_CHECK_TIMEOUT)
+                .await
+        } else {
+            None
+        };
+        let mut client = match client {
+            Some(client) => client,
+            None => {
+                warn!(
+                    target: LOG_TARGET,
+                    "No base node to check the genesis block hash of the snapshot against, assuming {} is correct",
+                    genesis_hash
+                );
+                return Ok(());
+            },
+        };
+        let genesis_header =
+            BlockHeader::try_from(client.get_header_by_height(0).await?).map_err(UtxoScannerError::ConversionError)?;
+        if genesis_header.hash() != *genesis_hash {
+            return Err(UtxoScannerError::BlockOutputSnapshotError(format!(
+                "The snapshot has genesis block {} but the base node has {}",
+                genesis_hash,
+                genesis_header.hash()
+            )));
+        }
+        Ok(())
+    }
+
     async fn connect_to_peer(&mut self, peer: NodeId) -> Result<PeerConnection, UtxoScannerError> {
         debug!(
             target: LOG_TARGET,
@@ -224,6 +363,7 @@ where
             peer.clone(),
             latency.unwrap_or_default(),
         ));
+        let shard_clients = self.connect_to_shard_peers(&peer, &client).await;
 
         let timer = Instant::now();
         loop {
@@ -295,6 +435,8 @@ where
             let (num_recovered, num_scanned, amount) = self
                 .scan_utxos(
                     &mut client,
+                    &shard_clients,
+                    next_block_to_scan.height,
                     next_block_to_scan.header_hash,
                     tip_header_hash,
                     tip_header.height,
@@ -317,6 +459,40 @@ where
         }
     }
 
+    /// When more than one peer is configured, connects to all of them so that the scan can be sharded across them. The
+    /// sync peer is always included, peers that cannot be reached are left out of this round.
+    async fn connect_to_shard_peers(
+        &mut self,
+        sync_peer: &NodeId,
+        sync_client: &BaseNodeWalletRpcClient,
+    ) -> Vec<(NodeId, BaseNodeWalletRpcClient)> {
+        if self.peer_seeds.len() < 2 {
+            return vec![];
+        }
+        let mut shard_clients = vec![(sync_peer.clone(), sync_client.clone())];
+        let other_peers = self
+            .peer_seeds
+            .iter()
+            .map(NodeId::from_public_key)
+            .filter(|p| p != sync_peer)
+            .collect::<Vec<_>>();
+        for peer in other_peers {
+            match self.establish_new_rpc_connection(&peer).await {
+                Ok(client) => shard_clients.push((peer, (*client).clone())),
+                Err(e) => warn!(
+                    target: LOG_TARGET,
+                    "Could not connect to peer {} for sharded UTXO scanning, continuing without it: {}", peer, e
+                ),
+            }
+        }
+        debug!(
+            target: LOG_TARGET,
+            "Sharding UTXO scanning across {} peer(s)",
+            shard_clients.len()
+        );
+        shard_clients
+    }
+
     async fn establish_new_rpc_connection(
         &mut self,
         peer: &NodeId,
@@ -434,118 +610,341 @@ where
         }
     }
 
-    #[allow(clippy::too_many_lines)]
-    // converting u64 to i64 is its only used for timestamps
-    #[allow(clippy::cast_possible_wrap)]
+    /// Streams, scans and imports the blocks from `start_header_hash` to `end_header_hash`. The three stages run
+    /// concurrently and are connected by bounded channels, so a slow stage applies back-pressure to the ones before
+    /// it and throughput is limited by the slowest stage rather than the sum of all of them. If `shard_clients` holds
+    /// more than one peer, blocks are downloaded from all of them.
     async fn scan_utxos(
         &mut self,
         client: &mut BaseNodeWalletRpcClient,
+        shard_clients: &[(NodeId, BaseNodeWalletRpcClient)],
+        start_height: u64,
         start_header_hash: HashOutput,
         end_header_hash: HashOutput,
         tip_height: u64,
     ) -> Result<(u64, u64, MicroMinotari), UtxoScannerError> {
-        // Setting how often the progress event and log should occur during scanning. Defined in blocks
-        const PROGRESS_REPORT_INTERVAL: u64 = 100;
+        let (block_sender, block_receiver) = mpsc::channel(UTXO_SCAN_PIPELINE_DEPTH);
+        let (scanned_sender, scanned_receiver) = mpsc::channel(UTXO_SCAN_PIPELINE_DEPTH);
+        let shutdown_signal = self.shutdown_signal.clone();
+        let output_manager_service = self.resources.output_manager_service.clone();
+        let recovery_message = self.resources.recovery_message.clone();
 
-        let mut num_recovered = 0u64;
-        let mut total_amount = MicroMinotari::from(0);
-        let mut total_scanned = 0;
+        let fetch_stage = async {
+            if shard_clients.len() > 1 {
+                return Self::stream_block_segments(
+                    client.clone(),
+                    shard_clients,
+                    start_height,
+                    tip_height,
+                    block_sender,
+                    shutdown_signal,
+                )
+                .await;
+            }
 
-        let request = SyncUtxosByBlockRequest {
-            start_header_hash: start_header_hash.to_vec(),
-            end_header_hash: end_header_hash.to_vec(),
+            let request = SyncUtxosByBlockRequest {
+                start_header_hash: start_header_hash.to_vec(),
+                end_header_hash: end_header_hash.to_vec(),
+            };
+            let start = Instant::now();
+            let utxo_stream = client.sync_utxos_by_block(request).await?;
+            trace!(
+                target: LOG_TARGET,
+                "bulletproof rewind profile - UTXO stream request time {} ms",
+                start.elapsed().as_millis(),
+            );
+            Self::stream_blocks(utxo_stream, block_sender, shutdown_signal).await
         };
 
-        let start = Instant::now();
-        let mut utxo_stream = client.sync_utxos_by_block(request).await?;
-        trace!(
-            target: LOG_TARGET,
-            "bulletproof rewind profile - UTXO stream request time {} ms",
-            start.elapsed().as_millis(),
-        );
+        let (total_scanned, _, (num_recovered, total_amount)) = tokio::try_join!(
+            fetch_stage,
+            Self::scan_blocks(output_manager_service, recovery_message, block_receiver, scanned_sender),
+            self.import_scanned_blocks(scanned_receiver, tip_height),
+        )?;
+
+        Ok((num_recovered, total_scanned, total_amount))
+    }
 
+    /// Pipeline stage 1: receive blocks from the base node and convert their outputs
+    async fn stream_blocks(
+        mut utxo_stream: Streaming<SyncUtxosByBlockResponse>,
+        block_sender: mpsc::Sender<StreamedBlock>,
+        shutdown_signal: ShutdownSignal,
+    ) -> Result<u64, UtxoScannerError> {
+        let mut total_scanned = 0u64;
         let mut utxo_next_await_profiling = Vec::new();
-        let mut scan_for_outputs_profiling = Vec::new();
-        let mut prev_scanned_block: Option<ScannedBlock> = None;
         while let Some(response) = {
             let start = Instant::now();
             let utxo_stream_next = utxo_stream.next().await;
             utxo_next_await_profiling.push(start.elapsed());
             utxo_stream_next
         } {
-            if self.shutdown_signal.is_triggered() {
+            if shutdown_signal.is_triggered() {
                 // if running is set to false, we know its been canceled upstream so lets exit the loop
-                return Ok((num_recovered, total_scanned as u64, total_amount));
+                break;
             }
 
             let response = response.map_err(|e| UtxoScannerError::RpcStatus(e.to_string()))?;
-            let current_height = response.height;
-            let current_header_hash = response.header_hash;
-            let mined_timestamp =
-                NaiveDateTime::from_timestamp_opt(response.mined_timestamp as i64, 0).unwrap_or(NaiveDateTime::MIN);
-            let outputs = response
-                .outputs
-                .into_iter()
-                .map(|utxo| TransactionOutput::try_from(utxo).map_err(UtxoScannerError::ConversionError))
-                .collect::<Result<Vec<_>, _>>()?;
-            total_scanned += outputs.len();
+            let block = StreamedBlock::try_from(response)?;
+            total_scanned = total_scanned.saturating_add(block.outputs.len() as u64);
+            if block_sender.send(block).await.is_err() {
+                // The downstream stages have stopped, either on shutdown or with an error that they will report
+                break;
+            }
+        }
+        trace!(
+            target: LOG_TARGET,
+            "bulletproof rewind profile - streamed {} outputs in {} ms",
+            total_scanned,
+            utxo_next_await_profiling.iter().fold(0, |acc, &x| acc + x.as_millis()),
+        );
 
-            let start = Instant::now();
-            let found_outputs = self.scan_for_outputs(outputs, current_height).await?;
-            scan_for_outputs_profiling.push(start.elapsed());
+        Ok(total_scanned)
+    }
 
-            let (mut count, mut amount) = self
-                .import_utxos_to_transaction_service(found_outputs, current_height, mined_timestamp)
-                .await?;
-            let block_hash = current_header_hash.try_into()?;
-            if let Some(scanned_block) = prev_scanned_block {
-                if block_hash == scanned_block.header_hash {
-                    count += scanned_block.num_outputs.unwrap_or(0);
-                    amount += scanned_block.amount.unwrap_or_else(|| 0.into())
-                } else {
-                    self.resources.db.save_scanned_block(scanned_block)?;
-                    self.resources.db.clear_scanned_blocks_before_height(
-                        current_height.saturating_sub(SCANNED_BLOCK_CACHE_SIZE),
-                        true,
-                    )?;
+    /// Pipeline stage 1 when scanning from several peers: the height range is split into segments of
+    /// `UTXO_SCAN_SEGMENT_SIZE` blocks that are downloaded concurrently, one segment per peer at a time, and forwarded
+    /// in height order. Every segment streams into its own channel of `UTXO_SCAN_PIPELINE_DEPTH` blocks, so a
+    /// segment that is ahead of the one being forwarded waits for it rather than being buffered whole. The segments
+    /// are resolved on the sync peer while the earlier ones are downloading.
+    #[allow(clippy::too_many_lines)]
+    async fn stream_block_segments(
+        sync_client: BaseNodeWalletRpcClient,
+        shard_clients: &[(NodeId, BaseNodeWalletRpcClient)],
+        start_height: u64,
+        end_height: u64,
+        block_sender: mpsc::Sender<StreamedBlock>,
+        mut shutdown_signal: ShutdownSignal,
+    ) -> Result<u64, UtxoScannerError> {
+        enum Progress {
+            Resolved(Result<(), UtxoScannerError>),
+            Segment(Option<BlockSegment>),
+            Block(Option<Result<StreamedBlock, UtxoScannerError>>),
+            Downloaded,
+        }
 
-                    if current_height % PROGRESS_REPORT_INTERVAL == 0 {
-                        debug!(
-                            target: LOG_TARGET,
-                            "Scanned up to block {} with a current tip_height of {}", current_height, tip_height
-                        );
-                        self.publish_event(UtxoScannerEvent::Progress {
-                            current_height,
-                            tip_height,
-                        });
+        let start = Instant::now();
+        // Resolving runs at most one segment per peer ahead of the downloads
+        let (resolved_sender, mut resolved_receiver) = mpsc::channel(shard_clients.len().max(1));
+        let resolver = Self::resolve_segments(sync_client, start_height, end_height, resolved_sender).fuse();
+        pin_mut!(resolver);
+        let mut resolving = true;
+        let mut all_resolved = false;
+        let mut next_index = 0usize;
+        let mut downloads = FuturesUnordered::new();
+        let mut segment_receivers = VecDeque::new();
+        let mut total_scanned = 0u64;
+        loop {
+            if all_resolved && segment_receivers.is_empty() {
+                break;
+            }
+            let can_download = !all_resolved && downloads.len() < shard_clients.len();
+            let progress = tokio::select! {
+                result = &mut resolver, if resolving => Progress::Resolved(result),
+                segment = resolved_receiver.recv(), if can_download => Progress::Segment(segment),
+                block = async {
+                    match segment_receivers.front_mut() {
+                        Some(receiver) => receiver.recv().await,
+                        None => future::pending().await,
                     }
-
-                    num_recovered = num_recovered.saturating_add(count);
-                    total_amount += amount;
-                }
+                } => Progress::Block(block),
+                // A download that is finished makes room for the next one
+                Some(()) = downloads.next() => Progress::Downloaded,
+                _ = shutdown_signal.wait() => break,
+            };
+            match progress {
+                Progress::Resolved(result) => {
+                    resolving = false;
+                    result?;
+                },
+                Progress::Segment(Some(segment)) => {
+                    let (segment_sender, segment_receiver) = mpsc::channel(UTXO_SCAN_PIPELINE_DEPTH);
+                    downloads.push(Self::fetch_segment(shard_clients, next_index, segment, segment_sender));
+                    segment_receivers.push_back(segment_receiver);
+                    next_index += 1;
+                },
+                Progress::Segment(None) => {
+                    all_resolved = true;
+                },
+                Progress::Block(Some(block)) => {
+                    let block = block?;
+                    total_scanned = total_scanned.saturating_add(block.outputs.len() as u64);
+                    if block_sender.send(block).await.is_err() {
+                        return Ok(total_scanned);
+                    }
+                },
+                // The segment is complete
+                Progress::Block(None) => {
+                    segment_receivers.pop_front();
+                },
+                Progress::Downloaded => {},
             }
-            prev_scanned_block = Some(ScannedBlock {
-                header_hash: block_hash,
-                height: current_height,
-                num_outputs: Some(count),
-                amount: Some(amount),
-                timestamp: Utc::now().naive_utc(),
-            });
-        }
-        // We need to update the last one
-        if let Some(scanned_block) = prev_scanned_block {
-            self.resources.db.clear_scanned_blocks_before_height(
-                scanned_block.height.saturating_sub(SCANNED_BLOCK_CACHE_SIZE),
-                true,
-            )?;
-            self.resources.db.save_scanned_block(scanned_block)?;
         }
         trace!(
             target: LOG_TARGET,
-            "bulletproof rewind profile - streamed {} outputs in {} ms",
+            "bulletproof rewind profile - streamed {} outputs from {} peers in {} ms",
             total_scanned,
-            utxo_next_await_profiling.iter().fold(0, |acc, &x| acc + x.as_millis()),
+            shard_clients.len(),
+            start.elapsed().as_millis(),
         );
+
+        Ok(total_scanned)
+    }
+
+    /// Splits the height range into segments, in height order, and looks up the hashes of their first and last blocks
+    /// on the sync peer, so that every segment belongs to the same chain. The last block of a segment is the parent of
+    /// the first block of the next one, so a single header is requested per segment.
+    async fn resolve_segments(
+        mut sync_client: BaseNodeWalletRpcClient,
+        start_height: u64,
+        end_height: u64,
+        segment_sender: mpsc::Sender<BlockSegment>,
+    ) -> Result<(), UtxoScannerError> {
+        if start_height > end_height {
+            return Ok(());
+        }
+        let mut from_height = start_height;
+        let mut start_header_hash = BlockHeader::try_from(sync_client.get_header_by_height(from_height).await?)
+            .map_err(UtxoScannerError::ConversionError)?
+            .hash();
+        loop {
+            let to_height = from_height.saturating_add(UTXO_SCAN_SEGMENT_SIZE - 1).min(end_height);
+            let next_start_header = if to_height < end_height {
+                Some(
+                    BlockHeader::try_from(sync_client.get_header_by_height(to_height.saturating_add(1)).await?)
+                        .map_err(UtxoScannerError::ConversionError)?,
+                )
+            } else {
+                None
+            };
+            let end_header_hash = match &next_start_header {
+                Some(header) => header.prev_hash,
+                None => BlockHeader::try_from(sync_client.get_header_by_height(to_height).await?)
+                    .map_err(UtxoScannerError::ConversionError)?
+                    .hash(),
+            };
+            let segment = BlockSegment {
+                from_height,
+                to_height,
+                start_header_hash,
+                end_header_hash,
+            };
+            if segment_sender.send(segment).await.is_err() {
+                // The downloads have stopped
+                return Ok(());
+            }
+            match next_start_header {
+                Some(header) => {
+                    start_header_hash = header.hash();
+                    from_height = to_height.saturating_add(1);
+                },
+                None => return Ok(()),
+            }
+        }
+    }
+
+    /// Downloads the blocks of a segment into `segment_sender`. The segment is first requested from the peer at
+    /// `segment_index`, and reassigned to the following peers if that one fails or stops sending blocks for
+    /// `UTXO_SCAN_SEGMENT_TIMEOUT`. A reassigned segment resumes after the last block that was sent on. If no peer
+    /// can provide the segment, the last error is sent instead.
+    async fn fetch_segment(
+        shard_clients: &[(NodeId, BaseNodeWalletRpcClient)],
+        segment_index: usize,
+        segment: BlockSegment,
+        segment_sender: mpsc::Sender<Result<StreamedBlock, UtxoScannerError>>,
+    ) {
+        let BlockSegment {
+            from_height,
+            to_height,
+            mut start_header_hash,
+            end_header_hash,
+        } = segment;
+        let mut next_height = from_height;
+        let mut last_error = None;
+        for attempt in 0..shard_clients.len() {
+            let (peer, client) = &shard_clients[(segment_index + attempt) % shard_clients.len()];
+            let mut client = client.clone();
+            let request = SyncUtxosByBlockRequest {
+                start_header_hash: start_header_hash.to_vec(),
+                end_header_hash: end_header_hash.to_vec(),
+            };
+            let timed_out = || {
+                UtxoScannerError::UtxoScanningError(format!(
+                    "Timed out fetching blocks {}-{} from {}",
+                    from_height, to_height, peer
+                ))
+            };
+            let download = async {
+                let mut stream = time::timeout(UTXO_SCAN_SEGMENT_TIMEOUT, client.sync_utxos_by_block(request))
+                    .await
+                    .map_err(|_| timed_out())??;
+                while let Some(response) = time::timeout(UTXO_SCAN_SEGMENT_TIMEOUT, stream.next())
+                    .await
+                    .map_err(|_| timed_out())?
+                {
+                    let response = response.map_err(|e| UtxoScannerError::RpcStatus(e.to_string()))?;
+                    let block = StreamedBlock::try_from(response)?;
+                    // A reassigned segment starts at the last block that was sent on
+                    if block.height < next_height {
+                        continue;
+                    }
+                    next_height = block.height.saturating_add(1);
+                    start_header_hash = block.header_hash;
+                    if segment_sender.send(Ok(block)).await.is_err() {
+                        // The blocks are no longer needed
+                        break;
+                    }
+                }
+                Ok::<_, UtxoScannerError>(())
+            };
+            match download.await {
+                Ok(()) => return,
+                Err(e) => {
+                    warn!(
+                        target: LOG_TARGET,
+                        "Peer {} failed to provide blocks {}-{}, reassigning: {}", peer, next_height, to_height, e
+                    );
+                    last_error = Some(e);
+                },
+            }
+        }
+        let error = last_error.unwrap_or_else(|| {
+            UtxoScannerError::UtxoScanningError(format!("No peers to fetch blocks {}-{}", from_height, to_height))
+        });
+        let _ = segment_sender.send(Err(error)).await;
+    }
+
+    /// Pipeline stage 2: find the outputs in each block that belong to this wallet
+    async fn scan_blocks(
+        mut output_manager_service: OutputManagerHandle,
+        recovery_message: String,
+        mut block_receiver: mpsc::Receiver<StreamedBlock>,
+        scanned_sender: mpsc::Sender<ScannedBlockOutputs>,
+    ) -> Result<(), UtxoScannerError> {
+        let mut scan_for_outputs_profiling = Vec::new();
+        let mut total_scanned = 0usize;
+        while let Some(block) = block_receiver.recv().await {
+            total_scanned += block.outputs.len();
+            let start = Instant::now();
+            let found_outputs = Self::scan_for_outputs(
+                &mut output_manager_service,
+                &recovery_message,
+                block.outputs,
+                block.height,
+            )
+            .await?;
+            scan_for_outputs_profiling.push(start.elapsed());
+
+            let scanned = ScannedBlockOutputs {
+                height: block.height,
+                header_hash: block.header_hash,
+                mined_timestamp: block.mined_timestamp,
+                found_outputs,
+            };
+            if scanned_sender.send(scanned).await.is_err() {
+                break;
+            }
+        }
         trace!(
             target: LOG_TARGET,
             "bulletproof rewind profile - scanned {} outputs in {} ms",
@@ -553,20 +952,116 @@ where
             scan_for_outputs_profiling.iter().fold(0, |acc, &x| acc + x.as_millis()),
         );
 
-        Ok((num_recovered, total_scanned as u64, total_amount))
+        Ok(())
     }
 
-    async fn scan_for_outputs(
+    /// Pipeline stage 3: import the found outputs and record the scanned blocks, in height order
+    async fn import_scanned_blocks(
         &mut self,
+        mut scanned_receiver: mpsc::Receiver<ScannedBlockOutputs>,
+        tip_height: u64,
+    ) -> Result<(u64, MicroMinotari), UtxoScannerError> {
+        // Setting how often the progress event and log should occur during scanning. Defined in blocks
+        const PROGRESS_REPORT_INTERVAL: u64 = 100;
+
+        let mut num_recovered = 0u64;
+        let mut total_amount = MicroMinotari::from(0);
+        let mut import_profiling = Vec::new();
+        let mut prev_scanned_block: Option<ScannedBlock> = None;
+        let mut batch = Vec::with_capacity(UTXO_SCAN_IMPORT_BATCH_SIZE);
+        while let Some(block) = scanned_receiver.recv().await {
+            if self.shutdown_signal.is_triggered() {
+                // if running is set to false, we know its been canceled upstream so lets exit the loop
+                return Ok((num_recovered, total_amount));
+            }
+
+            // Take whatever else is already waiting so that a range of blocks is written together, without holding
+            // blocks back when the scanning stage is the slower one
+            batch.push(block);
+            while batch.len() < UTXO_SCAN_IMPORT_BATCH_SIZE {
+                match scanned_receiver.try_recv() {
+                    Ok(block) => batch.push(block),
+                    Err(_) => break,
+                }
+            }
+
+            let start = Instant::now();
+            let imported = self.import_utxos_to_transaction_service(&mut batch).await?;
+            import_profiling.push(start.elapsed());
+
+            let mut completed_blocks = Vec::new();
+            let mut progress_height = None;
+            for (block, (mut count, mut amount)) in batch.drain(..).zip(imported) {
+                let current_height = block.height;
+                if let Some(scanned_block) = prev_scanned_block.take() {
+                    if block.header_hash == scanned_block.header_hash {
+                        count += scanned_block.num_outputs.unwrap_or(0);
+                        amount += scanned_block.amount.unwrap_or_else(|| 0.into())
+                    } else {
+                        completed_blocks.push(scanned_block);
+                        if current_height % PROGRESS_REPORT_INTERVAL == 0 {
+                            progress_height = Some(current_height);
+                        }
+
+                        num_recovered = num_recovered.saturating_add(count);
+                        total_amount += amount;
+                    }
+                }
+                prev_scanned_block = Some(ScannedBlock {
+                    header_hash: block.header_hash,
+                    height: current_height,
+                    num_outputs: Some(count),
+                    amount: Some(amount),
+                    timestamp: Utc::now().naive_utc(),
+                });
+            }
+
+            if let Some(current_height) = prev_scanned_block.as_ref().map(|b| b.height) {
+                if !completed_blocks.is_empty() {
+                    self.resources.db.save_scanned_blocks(
+                        completed_blocks,
+                        current_height.saturating_sub(SCANNED_BLOCK_CACHE_SIZE),
+                    )?;
+                }
+            }
+            if let Some(current_height) = progress_height {
+                debug!(
+                    target: LOG_TARGET,
+                    "Scanned up to block {} with a current tip_height of {}", current_height, tip_height
+                );
+                self.publish_event(UtxoScannerEvent::Progress {
+                    current_height,
+                    tip_height,
+                });
+            }
+        }
+        // We need to update the last one
+        if let Some(scanned_block) = prev_scanned_block {
+            let clear_before_height = scanned_block.height.saturating_sub(SCANNED_BLOCK_CACHE_SIZE);
+            self.resources
+                .db
+                .save_scanned_blocks(vec![scanned_block], clear_before_height)?;
+        }
+        trace!(
+            target: LOG_TARGET,
+            "bulletproof rewind profile - imported {} outputs in {} ms",
+            num_recovered,
+            import_profiling.iter().fold(0, |acc, &x| acc + x.as_millis()),
+        );
+
+        Ok((num_recovered, total_amount))
+    }
+
+    async fn scan_for_outputs(
+        output_manager_service: &mut OutputManagerHandle,
+        recovery_message: &str,
         outputs: Vec<TransactionOutput>,
         height: u64,
     ) -> Result<Vec<(WalletOutput, String, ImportStatus, TxId, TransactionOutput)>, UtxoScannerError> {
         let mut found_outputs: Vec<(WalletOutput, String, ImportStatus, TxId, TransactionOutput)> = Vec::new();
         let start = Instant::now();
         found_outputs.append(
-            &mut self
-                .resources
-                .output_manager_service
+            &mut output_manager_service
                 .scan_for_recoverable_outputs(outputs.clone())
                 .await?
                 .into_iter()
@@ -577,7 +1072,7 @@ where
                             ImportStatus::CoinbaseUnconfirmed,
                         )
                     } else {
-                        (self.resources.recovery_message.clone(), ImportStatus::Imported)
+                        (recovery_message.to_string(), ImportStatus::Imported)
                     };
                     let output = outputs.iter().find(|o| o.hash() == ro.hash).ok_or_else(|| {
                         UtxoScannerError::UtxoScanningError(format!("Output '{}' not found", ro.hash.to_hex()))
@@ -590,9 +1085,7 @@ where
         let start = Instant::now();
 
         found_outputs.append(
-            &mut self
-                .resources
-                .output_manager_service
+            &mut output_manager_service
                 .scan_outputs_for_one_sided_payments(outputs.clone())
                 .await?
                 .into_iter()
@@ -603,10 +1096,7 @@ where
                             ImportStatus::CoinbaseUnconfirmed,
                         )
                     } else {
-                        (
-                            self.resources.recovery_message.clone(),
-                            ImportStatus::OneSidedUnconfirmed,
-                        )
+                        (recovery_message.to_string(), ImportStatus::OneSidedUnconfirmed)
                     };
                     let output = outputs.iter().find(|o| o.hash() == ro.hash).ok_or_else(|| {
                         UtxoScannerError::UtxoScanningError(format!("Output '{}' not found", ro.hash.to_hex()))
@@ -625,54 +1115,69 @@ where
         Ok(found_outputs)
     }
 
+    /// Records the outputs found in a range of blocks as faux transactions, all in one database transaction. Returns
+    /// the number and value of the outputs imported for each block, outputs that were already imported are skipped.
     async fn import_utxos_to_transaction_service(
         &mut self,
-        utxos: Vec<(WalletOutput, String, ImportStatus, TxId, TransactionOutput)>,
-        current_height: u64,
-        mined_timestamp: NaiveDateTime,
-    ) -> Result<(u64, MicroMinotari), UtxoScannerError> {
-        let mut num_recovered = 0u64;
-        let mut total_amount = MicroMinotari::from(0);
-        for (wo, message, import_status, tx_id, to) in utxos {
-            let source_address = if wo.features.is_coinbase() {
-                // It's a coinbase, so we know we mined it (we do mining with cold wallets).
-                self.resources.one_sided_tari_address.clone()
-            } else {
-                // Because we do not know the source public key we are making it the default key of zeroes to make it
-                // clear this value is a placeholder.
-                TariAddress::default()
-            };
-            match self
-                .import_key_manager_utxo_to_transaction_service(
-                    wo.clone(),
+        blocks: &mut [ScannedBlockOutputs],
+    ) -> Result<Vec<(u64, MicroMinotari)>, UtxoScannerError> {
+        let mut block_indexes = Vec::new();
+        let mut imports = Vec::new();
+        for (index, block) in blocks.iter_mut().enumerate() {
+            for (wo, message, import_status, tx_id, to) in block.found_outputs.drain(..) {
+                let source_address = if wo.features.is_coinbase() {
+                    // It's a coinbase, so we know we mined it (we do mining with cold wallets).
+                    self.resources.one_sided_tari_address.clone()
+                } else {
+                    // Because we do not know the source public key we are making it the default key of zeroes to make
+                    // it clear this value is a placeholder.
+                    TariAddress::default()
+                };
+                block_indexes.push(index);
+                imports.push(UtxoImport {
+                    tx_id,
+                    amount: wo.value,
                     source_address,
                     message,
                     import_status,
-                    tx_id,
-                    current_height,
-                    mined_timestamp,
-                    to.clone(),
-                )
-                .await
-            {
-                Ok(_) => {
-                    num_recovered = num_recovered.saturating_add(1);
-                    total_amount += wo.value;
-                },
-                Err(WalletError::TransactionServiceError(TransactionServiceError::TransactionStorageError(
-                    TransactionStorageError::DuplicateOutput,
-                ))) => {
-                    info!(
-                        target: LOG_TARGET,
-                        "Recoverer attempted to add a duplicate output to the database for faux transaction ({}); \
-                         ignoring it as this is not a real error",
-                        tx_id
-                    );
-                },
-                Err(e) => return Err(UtxoScannerError::UtxoImportError(e.to_string())),
+                    current_height: Some(block.height),
+                    mined_timestamp: Some(block.mined_timestamp),
+                    scanned_output: to,
+                    payment_id: wo.payment_id,
+                });
             }
         }
-        Ok((num_recovered, total_amount))
+
+        let mut imported = vec![(0u64, MicroMinotari::from(0)); blocks.len()];
+        if imports.is_empty() {
+            return Ok(imported);
+        }
+        let values = imports.iter().map(|i| (i.tx_id, i.amount)).collect::<Vec<_>>();
+        let added = self
+            .resources
+            .transaction_service
+            .import_utxos_with_status(imports)
+            .await
+            .map_err(|e| UtxoScannerError::UtxoImportError(e.to_string()))?;
+        for ((index, (tx_id, value)), added) in block_indexes.into_iter().zip(values).zip(added) {
+            if added {
+                info!(
+                    target: LOG_TARGET,
+                    "UTXO with value {} imported into wallet with TxId {}", value, tx_id
+                );
+                let (count, amount) = &mut imported[index];
+                *count = count.saturating_add(1);
+                *amount += value;
+            } else {
+                info!(
+                    target: LOG_TARGET,
+                    "Recoverer attempted to add a duplicate output to the database for faux transaction ({}); \
+                     ignoring it as this is not a real error",
+                    tx_id
+                );
+            }
+        }
+        Ok(imported)
     }
 
     fn set_recovery_mode(&self) -> Result<(), UtxoScannerError> {
@@ -699,43 +1204,6 @@ where
         let _size = self.event_sender.send(event);
     }
 
-    /// A faux incoming transaction will be created to provide a record of the event of importing a scanned UTXO. The
-    /// TxId of the generated transaction is returned.
-    pub async fn import_key_manager_utxo_to_transaction_service(
-        &mut self,
-        wallet_output: WalletOutput,
-        source_address: TariAddress,
-        message: String,
-        import_status: ImportStatus,
-        tx_id: TxId,
-        current_height: u64,
-        mined_timestamp: NaiveDateTime,
-        scanned_output: TransactionOutput,
-    ) -> Result<TxId, WalletError> {
-        let tx_id = self
-            .resources
-            .transaction_service
-            .import_utxo_with_status(
-                wallet_output.value,
-                source_address,
-                message,
-                import_status.clone(),
-                Some(tx_id),
-                Some(current_height),
-                Some(mined_timestamp),
-                scanned_output,
-                wallet_output.payment_id,
-            )
-            .await?;
-
-        info!(
-            target: LOG_TARGET,
-            "UTXO with value {},  imported into wallet as 'ImportStatus::{}'", wallet_output.value, import_status
-        );
-
-        Ok(tx_id)
-    }
-
     fn get_next_peer(&mut self) -> Option<NodeId> {
         let peer = self.peer_seeds.get(self.peer_index).map(NodeId::from_public_key);
         self.peer_index += 1;
@@ -781,3 +1249,73 @@ struct HeightHash {
     height: u64,
     header_hash: HashOutput,
 }
+
+/// A range of blocks downloaded from one peer when scanning is sharded across several peers
+struct BlockSegment {
+    from_height: u64,
+    to_height: u64,
+    start_header_hash: HashOutput,
+    end_header_hash: HashOutput,
+}
+
+/// A block received from the base node, waiting to be scanned
+struct StreamedBlock {
+    height: u64,
+    header_hash: HashOutput,
+    mined_timestamp: NaiveDateTime,
+    outputs: Vec<TransactionOutput>,
+}
+
+impl TryFrom<SyncUtxosByBlockResponse> for StreamedBlock {
+    type Error = UtxoScannerError;
+
+    // converting u64 to i64 is its only used for timestamps
+    #[allow(clippy::cast_possible_wrap)]
+    fn try_from(response: SyncUtxosByBlockResponse) -> Result<Self, Self::Error> {
+        let mined_timestamp =
+            NaiveDateTime::from_timestamp_opt(response.mined_timestamp as i64, 0).unwrap_or(NaiveDateTime::MIN);
+        let outputs = response
+            .outputs
+            .into_iter()
+            .map(|utxo| TransactionOutput::try_from(utxo).map_err(UtxoScannerError::ConversionError))
+            .collect::<Result<Vec<_>, _>>()?;
+        Ok(Self {
+            height: response.height,
+            header_hash: response.header_hash.try_into()?,
+            mined_timestamp,
+            outputs,
+        })
+    }
+}
+
+/// Pipeline stage 1 when recovering from a snapshot: read the blocks mined from `start_time` onwards
+fn read_snapshot_blocks(
+    mut reader: BlockOutputSnapshotReader,
+    start_time: u64,
+    block_sender: mpsc::Sender<StreamedBlock>,
+    shutdown_signal: ShutdownSignal,
+) -> Result<u64, UtxoScannerError> {
+    let mut total_scanned = 0u64;
+    while let Some(response) = reader.next_block()? {
+        if shutdown_signal.is_triggered() {
+            break;
+        }
+        if response.mined_timestamp < start_time {
+            continue;
+        }
+        let block = StreamedBlock::try_from(response)?;
+        total_scanned = total_scanned.saturating_add(block.outputs.len() as u64);
+        if block_sender.blocking_send(block).is_err() {
+            break;
+        }
+    }
+    Ok(total_scanned)
+}
+
+/// A scanned block with the outputs found for this wallet, waiting to be imported
+struct ScannedBlockOutputs {
+    height: u64,
+    header_hash: HashOutput,
+    mined_timestamp: NaiveDateTime,
+    found_outputs: Vec<(WalletOutput, String, ImportStatus, TxId, TransactionOutput)>,
+}
@@ -20,6 +20,8 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+use std::path::PathBuf;
+
 use tari_common_types::tari_address::TariAddress;
 use tari_comms::{connectivity::ConnectivityRequester, types::CommsPublicKey};
 use tari_core::transactions::{key_manager::TransactionKeyManagerInterface, CryptoFactories};
@@ -57,6 +59,7 @@ pub struct UtxoScannerServiceBuilder {
     mode: Option<UtxoScannerMode>,
     one_sided_message: String,
     recovery_message: String,
+    snapshot_path: Option<PathBuf>,
 }
 
 impl Default for UtxoScannerServiceBuilder {
@@ -67,6 +70,7 @@ impl Default for UtxoScannerServiceBuilder {
             mode: None,
             one_sided_message: "Detected one-sided payment on blockchain".to_string(),
             recovery_message: "Output found on blockchain during Wallet Recovery".to_string(),
+            snapshot_path: None,
         }
     }
 }
@@ -99,6 +103,13 @@ impl UtxoScannerServiceBuilder {
         self
     }
 
+    /// Recover from a local block output snapshot file instead of streaming the blocks from a base node. A snapshot of
+    /// another network, or with another genesis block than the wallet's base node, is rejected.
+    pub fn with_block_output_snapshot(&mut self, path: PathBuf) -> &mut Self {
+        self.snapshot_path = Some(path);
+        self
+    }
+
     pub async fn build_with_wallet(
         &mut self,
         wallet: &WalletSqlite,
@@ -124,6 +135,7 @@ impl UtxoScannerServiceBuilder {
             self.peers.drain(..).collect(),
             self.retry_limit,
             self.mode.clone().unwrap_or_default(),
+            self.snapshot_path.take(),
             resources,
             shutdown_signal,
             event_sender,
@@ -169,6 +181,7 @@ impl UtxoScannerServiceBuilder {
             self.peers.drain(..).collect(),
             self.retry_limit,
             self.mode.clone().unwrap_or_default(),
+            self.snapshot_path.take(),
             resources,
             shutdown_signal,
             event_sender,
@@ -24,7 +24,7 @@ use std::{cmp, marker::PhantomData, sync::Arc, thread};
 
 use blake2::Blake2b;
 use digest::consts::U32;
-use futures::executor::block_on;
+use futures::{executor::block_on, future};
 use log::*;
 use rand::rngs::OsRng;
 use tari_common::configuration::bootstrap::ApplicationType;
@@ -78,8 +78,8 @@ use tari_p2p::{
     TransportType,
 };
 use tari_script::{push_pubkey_script, ExecutionStack, TariScript};
-use tari_service_framework::StackBuilder;
-use tari_shutdown::ShutdownSignal;
+use tari_service_framework::{RegisterHandle, StackBuilder};
+use tari_shutdown::{Shutdown, ShutdownSignal};
 use tari_utilities::{hex::Hex, ByteArray};
 
 use crate::{
@@ -89,27 +89,29 @@ use crate::{
     consts,
     error::{WalletError, WalletStorageError},
     output_manager_service::{
-        error::OutputManagerError,
+        error::{OutputManagerError, OutputManagerStorageError},
         handle::OutputManagerHandle,
         storage::{
             database::{OutputManagerBackend, OutputManagerDatabase},
             models::KnownOneSidedPaymentScript,
         },
+        utxo_compaction::{UtxoCompactionPolicy, UtxoCompactionTask},
         OutputManagerServiceInitializer,
     },
     storage::database::{WalletBackend, WalletDatabase},
     transaction_service::{
         handle::TransactionServiceHandle,
-        storage::database::TransactionBackend,
+        storage::{database::TransactionBackend, models::UtxoImport},
         TransactionServiceInitializer,
     },
-    util::wallet_identity::WalletIdentity,
+    util::{parallel::try_par_map, wallet_identity::WalletIdentity, watch::Watch},
     utxo_scanner_service::{handle::UtxoScannerHandle, initializer::UtxoScannerServiceInitializer, RECOVERY_KEY},
+    wallet_host::WalletHost,
 };
 
 const LOG_TARGET: &str = "wallet";
 /// The minimum buffer size for the wallet pubsub_connector channel
-const WALLET_BUFFER_MIN_SIZE: usize = 300;
+pub(crate) const WALLET_BUFFER_MIN_SIZE: usize = 300;
 
 // Domain separator for signing arbitrary messages with a wallet secret key
 hash_domain!(
@@ -138,6 +140,8 @@ pub struct Wallet<T, U, V, W, TKeyManagerInterface> {
     pub output_db: OutputManagerDatabase<V>,
     pub factories: CryptoFactories,
     wallet_type: WalletType,
+    utxo_compaction_policy: Watch<UtxoCompactionPolicy>,
+    services_complete: Vec<ShutdownSignal>,
     _u: PhantomData<U>,
     _v: PhantomData<V>,
     _w: PhantomData<W>,
@@ -173,6 +177,19 @@ where
         let wallet_type = read_or_create_wallet_type(wallet_type, &wallet_database)?;
         let buf_size = cmp::max(WALLET_BUFFER_MIN_SIZE, config.buffer_size);
         let (publisher, subscription_factory) = pubsub_connector(buf_size);
+        let utxo_compaction_policy = config.output_manager_service_config.utxo_compaction.clone();
+        // A disabled policy is never acted on, so it only has to be valid once it is enabled
+        if utxo_compaction_policy.enabled {
+            utxo_compaction_policy
+                .validate()
+                .map_err(|message| WalletError::ArgumentError {
+                    argument: "utxo_compaction".to_string(),
+                    value: format!("{:?}", utxo_compaction_policy),
+                    message,
+                })?;
+        }
+        let utxo_compaction_policy = Watch::new(utxo_compaction_policy);
+        let compaction_shutdown_signal = shutdown_signal.clone();
         let peer_message_subscription_factory = Arc::new(subscription_factory);
 
         debug!(target: LOG_TARGET, "Wallet Initializing");
@@ -327,6 +344,16 @@ where
                 e
             })?;
 
+        let mut services_complete = handles.get_complete_signals();
+        services_complete.push(spawn_utxo_compaction_task(
+            UtxoCompactionTask::new(
+                output_manager_handle.clone(),
+                transaction_service_handle.clone(),
+                utxo_compaction_policy.clone(),
+            ),
+            compaction_shutdown_signal,
+        ));
+
         wallet_database.set_node_features(comms.node_identity().features())?;
         let identity_sig = comms.node_identity().identity_signature_read().as_ref().cloned();
         if let Some(identity_sig) = identity_sig {
@@ -357,6 +384,149 @@ where
             output_db: output_manager_database,
             factories,
             wallet_type,
+            utxo_compaction_policy,
+            services_complete,
+            _u: PhantomData,
+            _v: PhantomData,
+            _w: PhantomData,
+        })
+    }
+
+    /// Starts a wallet on the shared network stack of `host` instead of a comms node of its own. The wallet keeps its
+    /// own storage, keys and services, while the comms node, the base node connection and the base node events of the
+    /// host are shared by all the wallets it hosts. A hosted wallet shares the network identity of the host, so it does
+    /// not take part in interactive transactions: sends other than to itself have to be one-sided.
+    #[allow(clippy::too_many_lines)]
+    pub async fn start_hosted<TKeyManagerBackend: KeyManagerBackend<PublicKey> + 'static>(
+        host: &WalletHost,
+        mut config: WalletConfig,
+        consensus_manager: ConsensusManager,
+        factories: CryptoFactories,
+        wallet_database: WalletDatabase<T>,
+        output_manager_database: OutputManagerDatabase<V>,
+        transaction_backend: U,
+        output_manager_backend: V,
+        contacts_backend: W,
+        key_manager_backend: TKeyManagerBackend,
+        shutdown_signal: ShutdownSignal,
+        master_seed: CipherSeed,
+        wallet_type: Option<WalletType>,
+    ) -> Result<Self, WalletError> {
+        // Replies to an interactive send would be addressed to the host identity and never reach this wallet
+        config.transaction_service_config.one_sided_only = true;
+        let wallet_type = read_or_create_wallet_type(wallet_type, &wallet_database)?;
+        let buf_size = cmp::max(WALLET_BUFFER_MIN_SIZE, config.buffer_size);
+        // Messages from the host's comms node are not routed to hosted wallets, so this feed stays empty
+        let (_, subscription_factory) = pubsub_connector(buf_size);
+        let utxo_compaction_policy = config.output_manager_service_config.utxo_compaction.clone();
+        // A disabled policy is never acted on, so it only has to be valid once it is enabled
+        if utxo_compaction_policy.enabled {
+            utxo_compaction_policy
+                .validate()
+                .map_err(|message| WalletError::ArgumentError {
+                    argument: "utxo_compaction".to_string(),
+                    value: format!("{:?}", utxo_compaction_policy),
+                    message,
+                })?;
+        }
+        let utxo_compaction_policy = Watch::new(utxo_compaction_policy);
+        let compaction_shutdown_signal = shutdown_signal.clone();
+        let peer_message_subscription_factory = Arc::new(subscription_factory);
+        let node_identity = host.comms.node_identity();
+
+        debug!(target: LOG_TARGET, "Hosted wallet initializing");
+        let mut handles = StackBuilder::new(shutdown_signal)
+            .add_initializer(RegisterHandle::new(host.comms.connectivity()))
+            .add_initializer(RegisterHandle::new(host.comms.peer_manager()))
+            .add_initializer(RegisterHandle::new(host.dht_service.clone()))
+            .add_initializer(RegisterHandle::new(host.wallet_connectivity.clone()))
+            .add_initializer(RegisterHandle::new(host.base_node_service.clone()))
+            .add_initializer(OutputManagerServiceInitializer::<V, TKeyManagerInterface>::new(
+                config.output_manager_service_config,
+                output_manager_backend.clone(),
+                factories.clone(),
+                config.network.into(),
+            ))
+            .add_initializer(TransactionKeyManagerInitializer::new(
+                key_manager_backend,
+                master_seed,
+                factories.clone(),
+                wallet_type.clone(),
+            ))
+            .add_initializer(TransactionServiceInitializer::<U, T, TKeyManagerInterface>::new(
+                config.transaction_service_config,
+                peer_message_subscription_factory.clone(),
+                transaction_backend,
+                node_identity,
+                config.network,
+                consensus_manager,
+                factories.clone(),
+                wallet_database.clone(),
+            ))
+            .add_initializer(LivenessInitializer::new(
+                LivenessConfig {
+                    auto_ping_interval: Some(config.contacts_auto_ping_interval),
+                    num_peers_per_round: 0,       // No random peers
+                    max_allowed_ping_failures: 0, // Peer with failed ping-pong will never be removed
+                    ..Default::default()
+                },
+                peer_message_subscription_factory.clone(),
+            ))
+            .add_initializer(ContactsServiceInitializer::new(
+                contacts_backend,
+                peer_message_subscription_factory,
+                config.contacts_auto_ping_interval,
+                config.contacts_online_ping_window,
+            ))
+            .add_initializer(UtxoScannerServiceInitializer::<T, TKeyManagerInterface>::new(
+                wallet_database.clone(),
+                factories.clone(),
+                config.network,
+            ))
+            .build()
+            .await?;
+
+        let transaction_service_handle = handles.expect_handle::<TransactionServiceHandle>();
+        let output_manager_handle = handles.expect_handle::<OutputManagerHandle>();
+        let key_manager_handle = handles.expect_handle::<TKeyManagerInterface>();
+        let contacts_handle = handles.expect_handle::<ContactsServiceHandle>();
+        let utxo_scanner_service_handle = handles.expect_handle::<UtxoScannerHandle>();
+
+        let mut services_complete = handles.get_complete_signals();
+        services_complete.push(spawn_utxo_compaction_task(
+            UtxoCompactionTask::new(
+                output_manager_handle.clone(),
+                transaction_service_handle.clone(),
+                utxo_compaction_policy.clone(),
+            ),
+            compaction_shutdown_signal,
+        ));
+
+        if let Err(e) = wallet_database
+            .set_last_network_and_version(config.network.to_string(), consts::APP_VERSION_NUMBER.to_string())
+        {
+            warn!("failed to store network and version: {:#?}", e);
+        }
+
+        Ok(Self {
+            network: host.network,
+            comms: host.comms.clone(),
+            dht_service: host.dht_service.clone(),
+            store_and_forward_requester: host.dht_service.store_and_forward_requester(),
+            output_manager_service: output_manager_handle,
+            key_manager_service: key_manager_handle,
+            transaction_service: transaction_service_handle,
+            contacts_service: contacts_handle,
+            base_node_service: host.base_node_service.clone(),
+            utxo_scanner_service: utxo_scanner_service_handle,
+            updater_service: None,
+            wallet_connectivity: host.wallet_connectivity.clone(),
+            db: wallet_database,
+            output_db: output_manager_database,
+            factories,
+            wallet_type,
+            utxo_compaction_policy,
+            services_complete,
             _u: PhantomData,
             _v: PhantomData,
             _w: PhantomData,
@@ -369,6 +539,12 @@ where
         self.comms.to_owned().wait_until_shutdown().await;
     }
 
+    /// Waits until the services of this wallet have finished after its shutdown signal was triggered. Unlike
+    /// `wait_until_shutdown`, this does not wait for the comms node, which a hosted wallet shares with its host.
+    pub async fn wait_until_services_complete(self) {
+        future::join_all(self.services_complete).await;
+    }
+
     /// This function will set the base node that the wallet uses to broadcast transactions, monitor outputs, and
     /// monitor the base node state.
     pub async fn set_base_node_peer(
@@ -376,68 +552,7 @@ where
         public_key: CommsPublicKey,
         address: Option<Multiaddr>,
     ) -> Result<(), WalletError> {
-        info!(
-            "Wallet setting base node peer, public key: {}, net address: {:?}.",
-            public_key, address
-        );
-
-        if let Some(current_node) = self.wallet_connectivity.get_current_base_node_id() {
-            self.comms
-                .connectivity()
-                .remove_peer_from_allow_list(current_node)
-                .await?;
-        }
-
-        let peer_manager = self.comms.peer_manager();
-        let mut connectivity = self.comms.connectivity();
-        if let Some(mut current_peer) = peer_manager.find_by_public_key(&public_key).await? {
-            // Only invalidate the identity signature if addresses are different
-            if address.is_some() {
-                let add = address.unwrap();
-                if !current_peer.addresses.contains(&add) {
-                    info!(
-                        target: LOG_TARGET,
-                        "Address for base node differs from storage. Was {}, setting to {}",
-                        current_peer.addresses,
-                        add
-                    );
-
-                    current_peer.addresses.add_address(&add, &PeerAddressSource::Config);
-                    peer_manager.add_peer(current_peer.clone()).await?;
-                }
-            }
-            connectivity
-                .add_peer_to_allow_list(current_peer.node_id.clone())
-                .await?;
-            self.wallet_connectivity.set_base_node(current_peer);
-        } else {
-            let node_id = NodeId::from_key(&public_key);
-            if address.is_none() {
-                debug!(
-                    target: LOG_TARGET,
-                    "Trying to add new peer without an address",
-                );
-                return Err(WalletError::ArgumentError {
-                    argument: "set_base_node_peer, address".to_string(),
-                    value: "{Missing}".to_string(),
-                    message: "New peers need the address filled in".to_string(),
-                });
-            }
-            let peer = Peer::new(
-                public_key,
-                node_id,
-                MultiaddressesWithStats::from_addresses_with_source(vec![address.unwrap()], &PeerAddressSource::Config),
-                PeerFlags::empty(),
-                PeerFeatures::COMMUNICATION_NODE,
-                Default::default(),
-                String::new(),
-            );
-            peer_manager.add_peer(peer.clone()).await?;
-            connectivity.add_peer_to_allow_list(peer.node_id.clone()).await?;
-            self.wallet_connectivity.set_base_node(peer);
-        }
-
-        Ok(())
+        set_base_node_peer(&self.comms, &mut self.wallet_connectivity, public_key, address).await
     }
 
     pub async fn get_base_node_peer(&mut self) -> Option<Peer> {
@@ -598,6 +713,111 @@ where
         Ok(tx_id)
     }
 
+    /// Import a batch of external spendable UTXOs into the wallet as non-rewindable/non-recoverable UTXOs, as
+    /// `import_unblinded_output_as_non_rewindable` does for one. The metadata signatures and range proofs of the
+    /// outputs are verified in parallel before anything is written, then the Output Manager and the faux incoming
+    /// transactions each receive the whole batch in one database transaction. Returns, in order, the TxId of the
+    /// generated transaction for every imported output or the reason the output was not imported. If the faux
+    /// transactions cannot be recorded, the outputs just added are removed again and the error is returned.
+    pub async fn import_unblinded_outputs_as_non_rewindable(
+        &mut self,
+        unblinded_outputs: Vec<UnblindedOutput>,
+        source_address: TariAddress,
+        message: String,
+    ) -> Result<Vec<Result<TxId, WalletError>>, WalletError> {
+        // Deriving the outputs needs the key manager, so it is done in order, the verification is pure computation
+        let mut outputs = Vec::with_capacity(unblinded_outputs.len());
+        for unblinded_output in unblinded_outputs {
+            let output = match unblinded_output
+                .to_wallet_output(&self.key_manager_service, PaymentId::Empty)
+                .await
+            {
+                Ok(wallet_output) => match wallet_output.to_transaction_output(&self.key_manager_service).await {
+                    Ok(output) => Ok((wallet_output, output)),
+                    Err(e) => Err(WalletError::from(e)),
+                },
+                Err(e) => Err(WalletError::from(e)),
+            };
+            outputs.push(output);
+        }
+        let range_proof_service = self.factories.range_proof.clone();
+        let outputs = try_par_map(outputs, |output| {
+            Ok::<_, WalletError>(output.and_then(|(wallet_output, output)| {
+                output.verify_metadata_signature()?;
+                output.verify_range_proof(&range_proof_service)?;
+                Ok((wallet_output, output))
+            }))
+        })?;
+
+        let mut results = Vec::with_capacity(outputs.len());
+        let mut valid_outputs = Vec::new();
+        for output in outputs {
+            match output {
+                Ok((wallet_output, output)) => {
+                    let tx_id = TxId::new_random();
+                    valid_outputs.push((results.len(), tx_id, wallet_output, output));
+                    results.push(Ok(tx_id));
+                },
+                Err(e) => results.push(Err(e)),
+            }
+        }
+        if valid_outputs.is_empty() {
+            return Ok(results);
+        }
+
+        // The outputs are added first, so that no faux transaction is recorded for an output the wallet already has
+        let added = self
+            .output_manager_service
+            .add_unvalidated_outputs(
+                valid_outputs
+                    .iter()
+                    .map(|(_, tx_id, wallet_output, _)| (*tx_id, wallet_output.clone()))
+                    .collect(),
+            )
+            .await?;
+        let mut imports = Vec::with_capacity(valid_outputs.len());
+        for ((index, tx_id, wallet_output, output), added) in valid_outputs.into_iter().zip(added) {
+            if !added {
+                results[index] = Err(OutputManagerError::from(OutputManagerStorageError::DuplicateOutput).into());
+                continue;
+            }
+            imports.push(UtxoImport {
+                tx_id,
+                amount: wallet_output.value,
+                source_address: source_address.clone(),
+                message: message.clone(),
+                import_status: ImportStatus::Imported,
+                current_height: None,
+                mined_timestamp: None,
+                scanned_output: output,
+                payment_id: PaymentId::Empty,
+            });
+        }
+        let num_imported = imports.len();
+        let commitments = imports
+            .iter()
+            .map(|import| import.scanned_output.commitment.clone())
+            .collect::<Vec<_>>();
+        if let Err(e) = self.transaction_service.import_utxos_with_status(imports).await {
+            // Without their faux transactions the outputs would be orphaned, so the batch is undone
+            if let Err(remove_error) = self.output_manager_service.remove_outputs(commitments).await {
+                error!(
+                    target: LOG_TARGET,
+                    "Failed to remove {} outputs after their import failed: {}", num_imported, remove_error
+                );
+            }
+            return Err(e.into());
+        }
+        info!(
+            target: LOG_TARGET,
+            "{} of {} UTXOs imported into wallet as 'ImportStatus::Imported' and are non-rewindable",
+            num_imported,
+            results.len(),
+        );
+
+        Ok(results)
+    }
+
     pub fn sign_message(
         &mut self,
         secret: &PrivateKey,
@@ -752,6 +972,25 @@ where
         }
     }
 
+    /// Replaces the policy of the background UTXO compaction task, which takes effect on its next run. Only enabled
+    /// policies are validated.
+    pub fn set_utxo_compaction_policy(&self, policy: UtxoCompactionPolicy) -> Result<(), WalletError> {
+        if policy.enabled {
+            policy.validate().map_err(|message| WalletError::ArgumentError {
+                argument: "utxo_compaction_policy".to_string(),
+                value: format!("{:?}", policy),
+                message,
+            })?;
+        }
+        self.utxo_compaction_policy.send(policy);
+        Ok(())
+    }
+
+    /// Returns the current policy of the background UTXO compaction task
+    pub fn get_utxo_compaction_policy(&self) -> UtxoCompactionPolicy {
+        self.utxo_compaction_policy.borrow().clone()
+    }
+
     /// Utility function to find out if there is data in the database indicating that there is an incomplete recovery
     /// process in progress
     pub fn is_recovery_in_progress(&self) -> Result<bool, WalletError> {
@@ -830,6 +1069,86 @@ pub fn derive_comms_secret_key(master_seed: &CipherSeed) -> Result<CommsSecretKe
     Ok(comms_key_manager.derive_key(0)?.key)
 }
 
+/// Sets the base node that the wallet connectivity service uses to broadcast transactions, monitor outputs, and monitor
+/// the base node state, allowing it through the connectivity allow list of `comms`.
+pub(crate) async fn set_base_node_peer(
+    comms: &CommsNode,
+    wallet_connectivity: &mut WalletConnectivityHandle,
+    public_key: CommsPublicKey,
+    address: Option<Multiaddr>,
+) -> Result<(), WalletError> {
+    info!(
+        "Wallet setting base node peer, public key: {}, net address: {:?}.",
+        public_key, address
+    );
+
+    if let Some(current_node) = wallet_connectivity.get_current_base_node_id() {
+        comms.connectivity().remove_peer_from_allow_list(current_node).await?;
+    }
+
+    let peer_manager = comms.peer_manager();
+    let mut connectivity = comms.connectivity();
+    if let Some(mut current_peer) = peer_manager.find_by_public_key(&public_key).await? {
+        // Only invalidate the identity signature if addresses are different
+        if address.is_some() {
+            let add = address.unwrap();
+            if !current_peer.addresses.contains(&add) {
+                info!(
+                    target: LOG_TARGET,
+                    "Address for base node differs from storage. Was {}, setting to {}",
+                    current_peer.addresses,
+                    add
+                );
+
+                current_peer.addresses.add_address(&add, &PeerAddressSource::Config);
+                peer_manager.add_peer(current_peer.clone()).await?;
+            }
+        }
+        connectivity
+            .add_peer_to_allow_list(current_peer.node_id.clone())
+            .await?;
+        wallet_connectivity.set_base_node(current_peer);
+    } else {
+        let node_id = NodeId::from_key(&public_key);
+        if address.is_none() {
+            debug!(
+                target: LOG_TARGET,
+                "Trying to add new peer without an address",
+            );
+            return Err(WalletError::ArgumentError {
+                argument: "set_base_node_peer, address".to_string(),
+                value: "{Missing}".to_string(),
+                message: "New peers need the address filled in".to_string(),
+            });
+        }
+        let peer = Peer::new(
+            public_key,
+            node_id,
+            MultiaddressesWithStats::from_addresses_with_source(vec![address.unwrap()], &PeerAddressSource::Config),
+            PeerFlags::empty(),
+            PeerFeatures::COMMUNICATION_NODE,
+            Default::default(),
+            String::new(),
+        );
+        peer_manager.add_peer(peer.clone()).await?;
+        connectivity.add_peer_to_allow_list(peer.node_id.clone()).await?;
+        wallet_connectivity.set_base_node(peer);
+    }
+
+    Ok(())
+}
+
+/// Spawns the UTXO compaction task of a wallet and returns a signal that is triggered once the task has finished
+fn spawn_utxo_compaction_task(task: UtxoCompactionTask, shutdown_signal: ShutdownSignal) -> ShutdownSignal {
+    let complete = Shutdown::new();
+    let complete_signal = complete.to_signal();
+    tokio::spawn(async move {
+        let _complete = complete;
+        task.run(shutdown_signal).await;
+    });
+    complete_signal
+}
+
 /// Persist the one-sided payment script for the current wallet NodeIdentity for use during scanning for One-sided
 /// payment outputs. This is peristed so that if the Node Identity changes the wallet will still scan for outputs
 /// using old node identities.
@@ -0,0 +1,165 @@
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+use std::{cmp, sync::Arc};
+
+use futures::{pin_mut, StreamExt};
+use log::*;
+use tari_common_types::types::PublicKey;
+use tari_comms::{
+    multiaddr::Multiaddr,
+    tor::TorIdentity,
+    types::CommsPublicKey,
+    CommsNode,
+    NodeIdentity,
+    UnspawnedCommsNode,
+};
+use tari_comms_dht::Dht;
+use tari_core::consensus::NetworkConsensus;
+use tari_p2p::{
+    comms_connector::{pubsub_connector, SubscriptionFactory},
+    initialization,
+    initialization::P2pInitializer,
+    tari_message::TariMessageType,
+    PeerSeedsConfig,
+};
+use tari_service_framework::StackBuilder;
+use tari_shutdown::ShutdownSignal;
+use tokio::task;
+
+use crate::{
+    base_node_service::{handle::BaseNodeServiceHandle, BaseNodeServiceInitializer},
+    config::WalletConfig,
+    connectivity_service::{WalletConnectivityHandle, WalletConnectivityInitializer},
+    error::WalletError,
+    storage::database::{WalletBackend, WalletDatabase},
+    wallet::{set_base_node_peer, WALLET_BUFFER_MIN_SIZE},
+};
+
+const LOG_TARGET: &str = "wallet::wallet_host";
+
+/// The network stack of a process that hosts many wallets: one comms node with its DHT, one connection to the base
+/// node and one feed of base node events. Wallets started with [Wallet::start_hosted](crate::Wallet::start_hosted)
+/// share it instead of each running a network stack of their own, while keeping their own storage, keys and
+/// services.
+///
+/// Hosted wallets share the network identity of the host, so they do not receive interactive transactions and should
+/// transact with one-sided payments.
+#[derive(Clone)]
+pub struct WalletHost {
+    pub network: NetworkConsensus,
+    pub comms: CommsNode,
+    pub dht_service: Dht,
+    pub wallet_connectivity: WalletConnectivityHandle,
+    pub base_node_service: BaseNodeServiceHandle,
+}
+
+impl WalletHost {
+    /// Starts the shared network stack. `host_database` stores the state of the host itself, such as the last known
+    /// chain metadata and the Tor identity, and must not be the database of a hosted wallet.
+    pub async fn start<T: WalletBackend + 'static>(
+        config: WalletConfig,
+        peer_seeds: PeerSeedsConfig,
+        node_identity: Arc<NodeIdentity>,
+        host_database: WalletDatabase<T>,
+        shutdown_signal: ShutdownSignal,
+        user_agent: String,
+    ) -> Result<Self, WalletError> {
+        let buf_size = cmp::max(WALLET_BUFFER_MIN_SIZE, config.buffer_size);
+        // Inbound wallet messages are addressed to the host identity and are not handed to any hosted wallet
+        let (publisher, subscription_factory) = pubsub_connector(buf_size);
+        task::spawn(drain_inbound_messages(subscription_factory, shutdown_signal.clone()));
+
+        debug!(target: LOG_TARGET, "Wallet host initializing");
+        let mut handles = StackBuilder::new(shutdown_signal)
+            .add_initializer(P2pInitializer::new(
+                config.p2p.clone(),
+                user_agent,
+                peer_seeds,
+                config.network,
+                node_identity,
+                publisher,
+            ))
+            .add_initializer(BaseNodeServiceInitializer::new(
+                config.base_node_service_config.clone(),
+                host_database.clone(),
+            ))
+            .add_initializer(WalletConnectivityInitializer::new(config.base_node_service_config))
+            .build()
+            .await?;
+
+        let comms = handles
+            .take_handle::<UnspawnedCommsNode>()
+            .expect("P2pInitializer was not added to the stack");
+        let after_comms = move |identity: TorIdentity| {
+            if let Err(e) = host_database.set_tor_identity(identity) {
+                error!(target: LOG_TARGET, "Failed to set wallet host db tor identity {:?}", e);
+            }
+        };
+        let comms = initialization::spawn_comms_using_transport(comms, config.p2p.transport, after_comms).await?;
+
+        Ok(Self {
+            network: config.network.into(),
+            comms,
+            dht_service: handles.expect_handle::<Dht>(),
+            wallet_connectivity: handles.expect_handle::<WalletConnectivityHandle>(),
+            base_node_service: handles.expect_handle::<BaseNodeServiceHandle>(),
+        })
+    }
+
+    /// Sets the base node shared by all the hosted wallets
+    pub async fn set_base_node_peer(
+        &mut self,
+        public_key: CommsPublicKey,
+        address: Option<Multiaddr>,
+    ) -> Result<(), WalletError> {
+        set_base_node_peer(&self.comms, &mut self.wallet_connectivity, public_key, address).await
+    }
+
+    /// The public key of the network identity shared by the hosted wallets
+    pub fn public_key(&self) -> &PublicKey {
+        self.comms.node_identity_ref().public_key()
+    }
+
+    /// Waits for the shared network stack to shut down, once the shutdown signal it was started with is triggered
+    pub async fn wait_until_shutdown(self) {
+        self.comms.wait_until_shutdown().await;
+    }
+}
+
+/// Subscribes to the inbound wallet messages of the host until shutdown, so that they are dropped quietly instead of
+/// each being reported as having no subscribers. Hosted wallets only send one-sided transactions, so the only messages
+/// expected here are interactive transactions that other wallets try to start with the shared identity.
+async fn drain_inbound_messages(subscription_factory: SubscriptionFactory, shutdown_signal: ShutdownSignal) {
+    let messages = subscription_factory
+        .get_subscription(TariMessageType::SenderPartialTransaction, "Wallet host")
+        .take_until(shutdown_signal);
+    pin_mut!(messages);
+    while let Some(message) = messages.next().await {
+        debug!(
+            target: LOG_TARGET,
+            "Dropped an interactive transaction from {} sent to the wallet host, hosted wallets only accept one-sided \
+             payments",
+            message.origin_node_id()
+        );
+    }
+}
@@ -164,7 +164,7 @@ async fn create_wallet(
         .with_extension("sqlite3");
 
     let (wallet_backend, transaction_backend, output_manager_backend, contacts_backend, key_manager_backend) =
-        initialize_sqlite_database_backends(sql_database_path, passphrase, 16).unwrap();
+        initialize_sqlite_database_backends(sql_database_path, passphrase, Default::default()).unwrap();
 
     let transaction_service_config = TransactionServiceConfig {
         resend_response_cooldown: Duration::from_secs(1),
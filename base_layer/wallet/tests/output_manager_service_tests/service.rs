@@ -375,6 +375,41 @@ async fn fee_estimate() {
         .await
         .unwrap();
     assert_eq!(fee, MicroMinotari::from(375));
+
+    // A new output changes the spendable outputs, so the estimate is not served from the cache
+    let uo = make_input(
+        &mut OsRng.clone(),
+        MicroMinotari::from(3000),
+        &OutputFeatures::default(),
+        &oms.key_manager_handle,
+    )
+    .await;
+    oms.output_manager_handle.add_output(uo.clone(), None).await.unwrap();
+    backend
+        .mark_outputs_as_unspent(vec![(uo.hash(&oms.key_manager_handle).await.unwrap(), true)])
+        .unwrap();
+    let fee = oms
+        .output_manager_handle
+        .fee_estimate(
+            MicroMinotari::from(2750),
+            UtxoSelectionCriteria::default(),
+            fee_per_gram,
+            1,
+            1,
+        )
+        .await
+        .unwrap();
+    assert_eq!(
+        fee,
+        fee_calc.calculate(
+            fee_per_gram,
+            1,
+            2,
+            2,
+            2 * default_features_and_scripts_size_byte_size()
+                .expect("Failed to get default features and scripts size byte size")
+        )
+    );
 }
 
 #[allow(clippy::identity_op)]
@@ -2145,6 +2180,53 @@ async fn test_get_status_by_tx_id() {
     );
 }
 
+#[tokio::test]
+async fn test_add_unvalidated_outputs_batch() {
+    let (connection, _tempdir) = get_temp_sqlite_database_connection();
+    let backend = OutputManagerSqliteDatabase::new(connection.clone());
+    let mut oms = setup_output_manager_service(backend, true).await;
+
+    let mut outputs = Vec::new();
+    for i in 1..=3u64 {
+        let uo = make_input(
+            &mut OsRng.clone(),
+            MicroMinotari::from(10000 * i),
+            &OutputFeatures::default(),
+            &oms.key_manager_handle,
+        )
+        .await;
+        outputs.push((TxId::from(i), uo));
+    }
+    // The same output twice in one batch is only added once
+    outputs.push((TxId::from(4u64), outputs[0].1.clone()));
+
+    let added = oms
+        .output_manager_handle
+        .add_unvalidated_outputs(outputs.clone())
+        .await
+        .unwrap();
+    assert_eq!(added, vec![true, true, true, false]);
+
+    for i in 1..=3u64 {
+        let output_statuses_by_tx_id = oms
+            .output_manager_handle
+            .get_output_info_for_tx_id(TxId::from(i))
+            .await
+            .unwrap();
+        assert_eq!(output_statuses_by_tx_id.statuses, vec![
+            OutputStatus::UnspentMinedUnconfirmed
+        ]);
+    }
+
+    // Importing the batch again adds nothing
+    let added = oms
+        .output_manager_handle
+        .add_unvalidated_outputs(outputs)
+        .await
+        .unwrap();
+    assert_eq!(added, vec![false; 4]);
+}
+
 #[tokio::test]
 #[allow(clippy::too_many_lines)]
 async fn scan_for_recovery_test() {
@@ -26,12 +26,13 @@ use minotari_wallet::output_manager_service::{
     error::OutputManagerStorageError,
     service::Balance,
     storage::{
-        database::{OutputManagerBackend, OutputManagerDatabase},
+        database::{OutputBackendQuery, OutputManagerBackend, OutputManagerDatabase, SortDirection},
         models::DbWalletOutput,
         sqlite_db::{OutputManagerSqliteDatabase, ReceivedOutputInfoForBatch, SpentOutputInfoForBatch},
         OutputSource,
         OutputStatus,
     },
+    UtxoSelectionCriteria,
 };
 use rand::{rngs::OsRng, RngCore};
 use tari_common_types::{
@@ -674,6 +675,62 @@ pub async fn test_no_duplicate_outputs() {
     assert_eq!(outputs.len(), 1);
 }
 
+#[tokio::test]
+pub async fn test_fetch_unsettled_mined_unspent_outputs() {
+    let (connection, _tempdir) = get_temp_sqlite_database_connection();
+    let backend = OutputManagerSqliteDatabase::new(connection);
+    let db = OutputManagerDatabase::new(backend);
+
+    let key_manager = create_memory_db_key_manager().unwrap();
+    let mut outputs = Vec::new();
+    // (mined height, confirmed)
+    for (mined_height, confirmed) in [(1, true), (15, true), (1, false)] {
+        let uo = make_input(
+            &mut OsRng,
+            MicroMinotari::from(1000),
+            &OutputFeatures::default(),
+            &key_manager,
+        )
+        .await;
+        let kmo = DbWalletOutput::from_wallet_output(uo, &key_manager, None, OutputSource::Standard, None, None)
+            .await
+            .unwrap();
+        db.add_unspent_output(kmo.clone()).unwrap();
+        db.set_received_outputs_mined_height_and_statuses(vec![ReceivedOutputInfoForBatch {
+            commitment: kmo.commitment.clone(),
+            mined_height,
+            mined_in_block: FixedHash::zero(),
+            confirmed,
+            mined_timestamp: 0,
+        }])
+        .unwrap();
+        outputs.push(kmo);
+    }
+    assert_eq!(db.fetch_mined_unspent_outputs().unwrap().len(), 3);
+
+    // Confirmed outputs mined at or below the settled height are left out, unconfirmed ones never are
+    let unsettled = db.fetch_unsettled_mined_unspent_outputs(10).unwrap();
+    assert_eq!(unsettled.len(), 2);
+    assert!(unsettled.iter().any(|o| o.hash == outputs[1].hash));
+    assert!(unsettled.iter().any(|o| o.hash == outputs[2].hash));
+
+    let unsettled = db.fetch_unsettled_mined_unspent_outputs(20).unwrap();
+    assert_eq!(unsettled.len(), 1);
+    assert_eq!(unsettled[0].hash, outputs[2].hash);
+
+    // An output with a pending spend is never settled
+    db.mark_outputs_as_spent(vec![SpentOutputInfoForBatch {
+        commitment: outputs[0].commitment.clone(),
+        confirmed: false,
+        mark_deleted_at_height: 16,
+        mark_deleted_in_block: FixedHash::zero(),
+    }])
+    .unwrap();
+    let unsettled = db.fetch_unsettled_mined_unspent_outputs(20).unwrap();
+    assert_eq!(unsettled.len(), 2);
+    assert!(unsettled.iter().any(|o| o.hash == outputs[0].hash));
+}
+
 #[tokio::test]
 pub async fn test_mark_as_unmined() {
     let (connection, _tempdir) = get_temp_sqlite_database_connection();
@@ -762,3 +819,204 @@ pub async fn test_mark_as_unmined() {
     }
     assert_eq!(batch_invalid_count, batch_count);
 }
+
+#[tokio::test]
+pub async fn test_fetch_outputs_by_keyset_cursor() {
+    let (connection, _tempdir) = get_temp_sqlite_database_connection();
+    let backend = OutputManagerSqliteDatabase::new(connection);
+    let db = OutputManagerDatabase::new(backend);
+
+    // two outputs per value so that the id tie breaker is exercised across page boundaries
+    let key_manager = create_memory_db_key_manager().unwrap();
+    for i in 0..10u64 {
+        let uo = make_input(
+            &mut OsRng,
+            MicroMinotari::from(1000 + (i / 2) * 100),
+            &OutputFeatures::default(),
+            &key_manager,
+        )
+        .await;
+        let kmo = DbWalletOutput::from_wallet_output(uo, &key_manager, None, OutputSource::Standard, None, None)
+            .await
+            .unwrap();
+        db.add_unspent_output(kmo.clone()).unwrap();
+        db.mark_outputs_as_unspent(vec![(kmo.hash, true)]).unwrap();
+    }
+
+    for direction in [SortDirection::Asc, SortDirection::Desc] {
+        let all = db
+            .fetch_outputs_by_query(OutputBackendQuery {
+                status: vec![OutputStatus::Unspent],
+                sorting: vec![("value", direction)],
+                ..Default::default()
+            })
+            .unwrap();
+        assert_eq!(all.len(), 10);
+
+        let mut paged = Vec::new();
+        let mut cursor = None;
+        loop {
+            let page = db
+                .fetch_outputs_page_by_query(OutputBackendQuery {
+                    status: vec![OutputStatus::Unspent],
+                    pagination: Some((0, 3)),
+                    sorting: vec![("value", direction)],
+                    cursor,
+                    ..Default::default()
+                })
+                .unwrap();
+            if page.outputs.is_empty() {
+                assert!(page.next_cursor.is_none());
+                break;
+            }
+            cursor = page.next_cursor;
+            paged.extend(page.outputs);
+        }
+        assert_eq!(
+            paged.iter().map(|o| o.commitment.clone()).collect::<Vec<_>>(),
+            all.iter().map(|o| o.commitment.clone()).collect::<Vec<_>>()
+        );
+    }
+}
+
+#[tokio::test]
+pub async fn test_add_unspent_outputs_with_tx_id_batch() {
+    let (connection, _tempdir) = get_temp_sqlite_database_connection();
+    let backend = OutputManagerSqliteDatabase::new(connection);
+    let db = OutputManagerDatabase::new(backend);
+
+    let key_manager = create_memory_db_key_manager().unwrap();
+    let mut outputs = Vec::new();
+    for i in 0..4u64 {
+        let uo = make_input(
+            &mut OsRng,
+            MicroMinotari::from(1000 + i * 100),
+            &OutputFeatures::default(),
+            &key_manager,
+        )
+        .await;
+        let kmo = DbWalletOutput::from_wallet_output(uo, &key_manager, None, OutputSource::Standard, None, None)
+            .await
+            .unwrap();
+        outputs.push((TxId::new_random(), kmo));
+    }
+
+    // The first output is already in the database and must be skipped without failing the batch
+    db.add_unspent_output_with_tx_id(outputs[0].0, outputs[0].1.clone())
+        .unwrap();
+    let added = db.add_unspent_outputs_with_tx_id(outputs.clone()).unwrap();
+    assert_eq!(added, vec![false, true, true, true]);
+
+    for (tx_id, output) in &outputs {
+        let stored = db.fetch_outputs_by_tx_id(*tx_id).unwrap();
+        assert_eq!(stored.len(), 1);
+        assert_eq!(stored[0].commitment, output.commitment);
+    }
+}
+
+#[tokio::test]
+pub async fn test_spendable_output_index_follows_the_database() {
+    let (connection, _tempdir) = get_temp_sqlite_database_connection();
+    let backend = OutputManagerSqliteDatabase::new(connection);
+    let db = OutputManagerDatabase::new(backend);
+
+    let key_manager = create_memory_db_key_manager().unwrap();
+    let mut outputs = Vec::new();
+    for i in 0..6u64 {
+        let uo = make_input(
+            &mut OsRng,
+            MicroMinotari::from(1000 + i * 100),
+            &OutputFeatures::default(),
+            &key_manager,
+        )
+        .await;
+        let mut kmo = DbWalletOutput::from_wallet_output(uo, &key_manager, None, OutputSource::Standard, None, None)
+            .await
+            .unwrap();
+        // The last two outputs only mature at height 10
+        kmo.wallet_output.features.maturity = if i >= 4 { 10 } else { 0 };
+        db.add_unspent_output(kmo.clone()).unwrap();
+        db.mark_outputs_as_unspent(vec![(kmo.hash, true)]).unwrap();
+        outputs.push(kmo);
+    }
+    let values = |selected: Vec<DbWalletOutput>| {
+        selected
+            .iter()
+            .map(|o| o.wallet_output.value.as_u64())
+            .collect::<Vec<_>>()
+    };
+
+    let criteria = UtxoSelectionCriteria::smallest_first(0);
+    let selected = db
+        .fetch_unspent_outputs_for_spending(&criteria, MicroMinotari::from(100), Some(5))
+        .unwrap();
+    assert_eq!(values(selected), vec![1000, 1100, 1200, 1300]);
+
+    // Advancing the tip makes the time locked outputs spendable
+    let criteria = UtxoSelectionCriteria::largest_first(0);
+    let selected = db
+        .fetch_unspent_outputs_for_spending(&criteria, MicroMinotari::from(100), Some(10))
+        .unwrap();
+    assert_eq!(values(selected), vec![1500, 1400, 1300, 1200, 1100, 1000]);
+
+    // Encumbered outputs are no longer selected, and come back once the encumbrance is cleared
+    db.encumber_outputs(TxId::new_random(), vec![outputs[5].clone()], vec![])
+        .unwrap();
+    let selected = db
+        .fetch_unspent_outputs_for_spending(&criteria, MicroMinotari::from(100), Some(10))
+        .unwrap();
+    assert_eq!(values(selected), vec![1400, 1300, 1200, 1100, 1000]);
+    db.clear_short_term_encumberances().unwrap();
+    let selected = db
+        .fetch_unspent_outputs_for_spending(&criteria, MicroMinotari::from(100), Some(10))
+        .unwrap();
+    assert_eq!(values(selected), vec![1500, 1400, 1300, 1200, 1100, 1000]);
+
+    // The default ordering and the exclusions behave as the database query did
+    let criteria = UtxoSelectionCriteria {
+        excluding: vec![outputs[0].commitment.clone()],
+        ..Default::default()
+    };
+    let selected = db
+        .fetch_unspent_outputs_for_spending(&criteria, MicroMinotari::from(5000), Some(10))
+        .unwrap();
+    assert_eq!(values(selected), vec![1500, 1400, 1300, 1200, 1100]);
+
+    // Adding an output that is not yet mined leaves the spendable outputs as they are
+    let uo = make_input(
+        &mut OsRng,
+        MicroMinotari::from(2000),
+        &OutputFeatures::default(),
+        &key_manager,
+    )
+    .await;
+    let kmo = DbWalletOutput::from_wallet_output(uo, &key_manager, None, OutputSource::Standard, None, None)
+        .await
+        .unwrap();
+    let generation = db.spendable_outputs_generation();
+    db.add_unspent_output(kmo.clone()).unwrap();
+    assert_eq!(db.spendable_outputs_generation(), generation);
+
+    // Outputs confirmed as mined join the index and spent outputs leave it
+    db.set_received_outputs_mined_height_and_statuses(vec![ReceivedOutputInfoForBatch {
+        commitment: kmo.commitment.clone(),
+        mined_height: 8,
+        mined_in_block: FixedHash::zero(),
+        confirmed: true,
+        mined_timestamp: 0,
+    }])
+    .unwrap();
+    db.mark_outputs_as_spent(vec![SpentOutputInfoForBatch {
+        commitment: outputs[1].commitment.clone(),
+        confirmed: true,
+        mark_deleted_at_height: 9,
+        mark_deleted_in_block: FixedHash::zero(),
+    }])
+    .unwrap();
+    assert!(db.spendable_outputs_generation() > generation);
+    let criteria = UtxoSelectionCriteria::largest_first(0);
+    let selected = db
+        .fetch_unspent_outputs_for_spending(&criteria, MicroMinotari::from(100), Some(10))
+        .unwrap();
+    assert_eq!(values(selected), vec![2000, 1500, 1400, 1300, 1200, 1000]);
+}
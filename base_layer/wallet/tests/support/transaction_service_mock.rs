@@ -109,6 +109,13 @@ impl TransactionServiceMock {
                         warn!(target: LOG_TARGET, "Failed to send reply");
                     });
             },
+            TransactionServiceRequest::ImportUtxosWithStatus(imports) => {
+                let _result = reply_tx
+                    .send(Ok(TransactionServiceResponse::UtxosImported(vec![true; imports.len()])))
+                    .inspect_err(|_| {
+                        warn!(target: LOG_TARGET, "Failed to send reply");
+                    });
+            },
             TransactionServiceRequest::ValidateTransactions => {},
             _ => panic!("Transaction Service Mock does not support this call"),
         }
@@ -71,8 +71,9 @@ use minotari_wallet::{
     },
     transaction_service::{
         config::TransactionServiceConfig,
-        handle::{TransactionEvent, TransactionSendStatus, TransactionServiceHandle},
-        service::TransactionService,
+        error::TransactionServiceError,
+        handle::{PaymentRecipient, TransactionEvent, TransactionSendStatus, TransactionServiceHandle},
+        service::{TransactionService, ONE_SIDED_BATCH_MAX_OUTPUTS},
         storage::{
             database::{DbKeyValuePair, TransactionBackend, TransactionDatabase, WriteOperation},
             models::{CompletedTransaction, InboundTransaction, OutboundTransaction, WalletTransaction},
@@ -1668,6 +1669,171 @@ async fn send_one_sided_transaction_to_other() {
     assert!(found, "'TransactionCompletedImmediately(_)' event not found");
 }
 
+#[tokio::test]
+async fn send_one_sided_batch_to_others() {
+    let network = Network::LocalNet;
+    let consensus_manager = ConsensusManager::builder(network).build().unwrap();
+    let factories = CryptoFactories::default();
+    let alice_node_identity = Arc::new(NodeIdentity::random(
+        &mut OsRng,
+        get_next_memory_address(),
+        PeerFeatures::COMMUNICATION_NODE,
+    ));
+
+    let temp_dir = tempdir().unwrap();
+    let database_path = temp_dir.path().to_str().unwrap().to_string();
+    let db_connection = make_wallet_database_memory_connection();
+
+    let shutdown = Shutdown::new();
+    let (mut alice_ts, mut alice_oms, _alice_comms, _alice_connectivity, key_manager_handle, alice_db) =
+        setup_transaction_service(
+            alice_node_identity,
+            vec![],
+            consensus_manager,
+            factories.clone(),
+            db_connection,
+            database_path,
+            Duration::from_secs(0),
+            shutdown.to_signal(),
+        )
+        .await;
+
+    let initial_wallet_value = 50000.into();
+    let uo1 = make_input(
+        &mut OsRng,
+        initial_wallet_value,
+        &OutputFeatures::default(),
+        &key_manager_handle,
+    )
+    .await;
+    alice_oms.add_output(uo1.clone(), None).await.unwrap();
+    alice_db
+        .mark_outputs_as_unspent(vec![(uo1.hash(&key_manager_handle).await.unwrap(), true)])
+        .unwrap();
+
+    let recipients = (0..3u64)
+        .map(|i| {
+            let view_key = PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng));
+            let spend_key = PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng));
+            PaymentRecipient {
+                destination: TariAddress::new_dual_address_with_default_features(view_key, spend_key, network),
+                amount: MicroMinotari::from(5000 + i * 1000),
+                payment_id: PaymentId::Open(format!("payout {}", i).into_bytes()),
+            }
+        })
+        .collect::<Vec<_>>();
+    let total_sent = recipients.iter().map(|r| r.amount).sum::<MicroMinotari>();
+
+    let tx_ids = alice_ts
+        .send_one_sided_to_stealth_address_batch(
+            recipients,
+            UtxoSelectionCriteria::default(),
+            20.into(),
+            "Payout".to_string(),
+        )
+        .await
+        .expect("Alice sending one-sided batch");
+    assert_eq!(tx_ids.len(), 1);
+
+    let completed_tx = alice_ts.get_completed_transaction(tx_ids[0]).await.unwrap();
+    assert_eq!(completed_tx.amount, total_sent);
+    // The transaction pays several recipients, so no single one is recorded as its destination
+    assert_eq!(completed_tx.destination_address, TariAddress::default());
+    assert_eq!(completed_tx.transaction.body.inputs().len(), 1);
+    assert_eq!(completed_tx.transaction.body.kernels().len(), 1);
+    // Three recipient outputs and one change output
+    assert_eq!(completed_tx.transaction.body.outputs().len(), 4);
+    assert_eq!(
+        alice_oms.get_balance().await.unwrap().pending_incoming_balance,
+        initial_wallet_value - total_sent - completed_tx.fee
+    );
+}
+
+#[tokio::test]
+async fn send_one_sided_batch_sends_nothing_if_a_transaction_cannot_be_funded() {
+    let network = Network::LocalNet;
+    let consensus_manager = ConsensusManager::builder(network).build().unwrap();
+    let factories = CryptoFactories::default();
+    let alice_node_identity = Arc::new(NodeIdentity::random(
+        &mut OsRng,
+        get_next_memory_address(),
+        PeerFeatures::COMMUNICATION_NODE,
+    ));
+
+    let temp_dir = tempdir().unwrap();
+    let database_path = temp_dir.path().to_str().unwrap().to_string();
+    let db_connection = make_wallet_database_memory_connection();
+
+    let shutdown = Shutdown::new();
+    let (mut alice_ts, mut alice_oms, _alice_comms, _alice_connectivity, key_manager_handle, alice_db) =
+        setup_transaction_service(
+            alice_node_identity,
+            vec![],
+            consensus_manager,
+            factories.clone(),
+            db_connection,
+            database_path,
+            Duration::from_secs(0),
+            shutdown.to_signal(),
+        )
+        .await;
+
+    let initial_wallet_value = 1_000_000.into();
+    let uo1 = make_input(
+        &mut OsRng,
+        initial_wallet_value,
+        &OutputFeatures::default(),
+        &key_manager_handle,
+    )
+    .await;
+    alice_oms.add_output(uo1.clone(), None).await.unwrap();
+    alice_db
+        .mark_outputs_as_unspent(vec![(uo1.hash(&key_manager_handle).await.unwrap(), true)])
+        .unwrap();
+
+    // One more recipient than fits in a transaction, so the second transaction has no output left to spend
+    let recipients = (0..=ONE_SIDED_BATCH_MAX_OUTPUTS)
+        .map(|_| {
+            let view_key = PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng));
+            let spend_key = PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng));
+            PaymentRecipient {
+                destination: TariAddress::new_dual_address_with_default_features(view_key, spend_key, network),
+                amount: MicroMinotari::from(1000),
+                payment_id: PaymentId::Empty,
+            }
+        })
+        .collect::<Vec<_>>();
+
+    assert!(alice_ts
+        .send_one_sided_to_stealth_address_batch(
+            recipients.clone(),
+            UtxoSelectionCriteria::default(),
+            1.into(),
+            "Payout".to_string(),
+        )
+        .await
+        .is_err());
+    assert!(alice_ts.get_completed_transactions().await.unwrap().is_empty());
+    let balance = alice_oms.get_balance().await.unwrap();
+    assert_eq!(balance.available_balance, initial_wallet_value);
+    assert_eq!(balance.pending_incoming_balance, MicroMinotari::zero());
+
+    // Specific outputs cannot be shared between the transactions of a batch
+    let commitment = uo1.commitment(&key_manager_handle).await.unwrap();
+    match alice_ts
+        .send_one_sided_to_stealth_address_batch(
+            recipients,
+            UtxoSelectionCriteria::specific(vec![commitment]),
+            1.into(),
+            "Payout".to_string(),
+        )
+        .await
+    {
+        Err(TransactionServiceError::OneSidedTransactionError(_)) => {},
+        r => panic!("Unexpected result: {:?}", r),
+    }
+}
+
 #[tokio::test]
 async fn recover_one_sided_transaction() {
     let network = Network::LocalNet;
@@ -3161,6 +3327,50 @@ async fn test_set_num_confirmations() {
     }
 }
 
+#[tokio::test]
+async fn test_one_sided_only_rejects_interactive_sends() {
+    let factories = CryptoFactories::default();
+    let bob_node_identity =
+        NodeIdentity::random(&mut OsRng, get_next_memory_address(), PeerFeatures::COMMUNICATION_NODE);
+    let connection = make_wallet_database_memory_connection();
+
+    let mut alice_ts_interface = setup_transaction_service_no_comms(
+        factories,
+        connection,
+        Some(TransactionServiceConfig {
+            one_sided_only: true,
+            ..Default::default()
+        }),
+    )
+    .await;
+
+    let bob_address = TariAddress::new_single_address_with_interactive_only(
+        bob_node_identity.public_key().clone(),
+        Network::LocalNet,
+    );
+    match alice_ts_interface
+        .transaction_service_handle
+        .send_transaction(
+            bob_address,
+            100000 * uT,
+            UtxoSelectionCriteria::default(),
+            OutputFeatures::default(),
+            100 * uT,
+            "Testing Message".to_string(),
+        )
+        .await
+    {
+        Err(TransactionServiceError::InteractiveTransactionsDisabled) => {},
+        r => panic!("Unexpected result: {:?}", r),
+    }
+    assert!(alice_ts_interface
+        .transaction_service_handle
+        .get_pending_outbound_transactions()
+        .await
+        .unwrap()
+        .is_empty());
+}
+
 #[tokio::test]
 async fn test_transaction_cancellation() {
     let factories = CryptoFactories::default();
@@ -683,3 +683,75 @@ async fn import_tx_and_read_it_from_db() {
     assert_eq!(db_tx.first().unwrap().tx_id, TxId::from(3u64));
     assert_eq!(db_tx.first().unwrap().mined_height, Some(7));
 }
+
+#[tokio::test]
+async fn completed_transactions_are_paged_by_timestamp() {
+    let db_name = format!("{}.sqlite3", random::string(8));
+    let db_tempdir = tempdir().unwrap();
+    let db_folder = db_tempdir.path().to_str().unwrap().to_string();
+    let db_path = format!("{}/{}", db_folder, db_name);
+    let connection = run_migration_and_create_sqlite_connection(db_path, 16).unwrap();
+
+    let mut key = [0u8; size_of::<Key>()];
+    OsRng.fill_bytes(&mut key);
+    let key_ga = Key::from_slice(&key);
+    let cipher = XChaCha20Poly1305::new(key_ga);
+    let sqlite_db = TransactionServiceSqliteDatabase::new(connection, cipher);
+
+    // Transactions 4 and 5 share a timestamp, so their order is decided by their id
+    let timestamp = |secs: i64| NaiveDateTime::from_timestamp_opt(1_700_000_000 + secs, 0).unwrap();
+    let transactions = [(3u64, 0), (1, 10), (5, 20), (4, 20), (2, 30)]
+        .into_iter()
+        .map(|(tx_id, secs)| {
+            CompletedTransaction::new(
+                TxId::from(tx_id),
+                TariAddress::default(),
+                TariAddress::default(),
+                MicroMinotari::from(100000),
+                MicroMinotari::from(0),
+                Transaction::new(
+                    Vec::new(),
+                    Vec::new(),
+                    Vec::new(),
+                    PrivateKey::random(&mut OsRng),
+                    PrivateKey::random(&mut OsRng),
+                ),
+                TransactionStatus::MinedConfirmed,
+                "message".to_string(),
+                timestamp(secs),
+                TransactionDirection::Inbound,
+                Some(5),
+                None,
+                None,
+            )
+            .unwrap()
+        })
+        .collect::<Vec<_>>();
+    sqlite_db.insert_completed_transactions(transactions).unwrap();
+    sqlite_db
+        .reject_completed_transaction(TxId::from(1u64), TxCancellationReason::UserCancelled)
+        .unwrap();
+
+    let mut pages = Vec::new();
+    let mut after = None;
+    loop {
+        let page = sqlite_db
+            .fetch_completed_transactions_page(None, None, after, 2)
+            .unwrap();
+        if page.is_empty() {
+            break;
+        }
+        after = page.last().map(|tx| (tx.timestamp, tx.tx_id));
+        pages.push(page.iter().map(|tx| tx.tx_id.as_u64()).collect::<Vec<_>>());
+    }
+    // Cancelled transactions are part of the history
+    assert_eq!(pages, vec![vec![3, 1], vec![4, 5], vec![2]]);
+
+    let page = sqlite_db
+        .fetch_completed_transactions_page(Some(timestamp(10)), Some(timestamp(30)), None, 10)
+        .unwrap();
+    assert_eq!(page.iter().map(|tx| tx.tx_id.as_u64()).collect::<Vec<_>>(), vec![
+        1, 4, 5
+    ]);
+    assert!(page[0].cancelled.is_some());
+}
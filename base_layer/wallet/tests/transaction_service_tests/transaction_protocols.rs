@@ -20,7 +20,13 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-use std::{collections::HashMap, mem::size_of, sync::Arc, time::Duration};
+use std::{
+    collections::HashMap,
+    convert::TryFrom,
+    mem::size_of,
+    sync::Arc,
+    time::{Duration, Instant},
+};
 
 use chacha20poly1305::{Key, KeyInit, XChaCha20Poly1305};
 use chrono::Utc;
@@ -33,6 +39,7 @@ use minotari_wallet::{
     },
     storage::sqlite_utilities::run_migration_and_create_sqlite_connection,
     transaction_service::{
+        broadcast_scheduler::{BroadcastQueueStats, TransactionBroadcastScheduler},
         config::TransactionServiceConfig,
         error::TransactionServiceError,
         handle::{TransactionEvent, TransactionEventReceiver, TransactionEventSender},
@@ -57,7 +64,7 @@ use tari_common_types::{
 };
 use tari_comms::{
     peer_manager::PeerFeatures,
-    protocol::rpc::{mock::MockRpcServer, NamedProtocolService},
+    protocol::rpc::{mock::MockRpcServer, NamedProtocolService, RpcError, RpcStatus, RpcStatusCode},
     test_utils::node_identity::build_node_identity,
     NodeIdentity,
 };
@@ -75,7 +82,7 @@ use tari_core::{
             TxQueryBatchResponse as TxQueryBatchResponseProto,
             TxQueryBatchResponses as TxQueryBatchResponsesProto,
         },
-        types::Signature as SignatureProto,
+        types::{Signature as SignatureProto, Transaction as TransactionProto},
     },
     transactions::{
         key_manager::{create_memory_db_key_manager, MemoryDbKeyManager, TransactionKeyManagerInterface},
@@ -164,6 +171,13 @@ pub async fn setup() -> (
         client_node_identity.public_key().clone(),
         network,
     );
+    let config = TransactionServiceConfig {
+        broadcast_monitoring_timeout: Duration::from_secs(3),
+        max_tx_query_batch_size: 2,
+        ..TransactionServiceConfig::default()
+    };
+    let broadcast_scheduler =
+        TransactionBroadcastScheduler::spawn(wallet_connectivity.clone(), &config, shutdown.to_signal());
     let resources = TransactionServiceResources {
         db,
         output_manager_service: output_manager_service_handle,
@@ -175,12 +189,9 @@ pub async fn setup() -> (
         node_identity: client_node_identity.clone(),
         consensus_manager,
         factories: CryptoFactories::default(),
-        config: TransactionServiceConfig {
-            broadcast_monitoring_timeout: Duration::from_secs(3),
-            max_tx_query_batch_size: 2,
-            ..TransactionServiceConfig::default()
-        },
+        config,
         shutdown_signal: shutdown.to_signal(),
+        broadcast_scheduler,
     };
 
     (
@@ -750,6 +761,169 @@ async fn tx_broadcast_protocol_submit_and_base_node_gets_changed() {
     assert_eq!(db_completed_tx.status, TransactionStatus::Broadcast);
 }
 
+/// Test that the broadcast scheduler holds back status queries while one is in flight and then answers them with a
+/// single batch query
+#[tokio::test]
+async fn tx_broadcast_scheduler_batches_status_queries() {
+    let (
+        resources,
+        _outbound_mock_state,
+        mock_rpc_server,
+        server_node_identity,
+        rpc_service_state,
+        _shutdown,
+        _temp_dir,
+        _transaction_event_receiver,
+        wallet_connectivity,
+    ) = setup().await;
+
+    let mut signatures = Vec::new();
+    for tx_id in 1u64..=3 {
+        add_transaction_to_database(tx_id.into(), tx_id * T, None, resources.db.clone()).await;
+        let tx = resources.db.get_completed_transaction(tx_id.into()).unwrap();
+        signatures.push(tx.transaction.first_kernel_excess_sig().unwrap().clone());
+    }
+    rpc_service_state.set_transaction_query_response(TxQueryResponse {
+        location: TxLocation::InMempool,
+        best_block_hash: None,
+        confirmations: 0,
+        is_synced: true,
+        best_block_height: 1,
+        mined_timestamp: None,
+    });
+    rpc_service_state.set_transaction_query_batch_responses(TxQueryBatchResponsesProto {
+        responses: signatures
+            .iter()
+            .map(|sig| TxQueryBatchResponseProto {
+                signature: Some(SignatureProto::from(sig.clone())),
+                location: TxLocationProto::from(TxLocation::InMempool) as i32,
+                best_block_hash: vec![],
+                confirmations: 0,
+                best_block_height: 1,
+                mined_timestamp: 0,
+            })
+            .collect(),
+        is_synced: true,
+        best_block_hash: [1u8; 32].to_vec(),
+        best_block_height: 1,
+        tip_mined_timestamp: EpochTime::now().as_u64(),
+    });
+
+    // Without a base node connection the first query waits in flight and the others queue up behind it
+    let scheduler = resources.broadcast_scheduler.clone();
+    let queries = signatures
+        .iter()
+        .enumerate()
+        .map(|(i, sig)| {
+            let scheduler = scheduler.clone();
+            let sig = sig.clone();
+            task::spawn(async move { scheduler.query_transaction((i as u64 + 1).into(), sig).await })
+        })
+        .collect::<Vec<_>>();
+    let held_back = BroadcastQueueStats {
+        queued: 2,
+        in_flight: 1,
+        batches_in_flight: 1,
+    };
+    let start = Instant::now();
+    while scheduler.stats() != held_back && start.elapsed() < Duration::from_secs(5) {
+        sleep(Duration::from_millis(10)).await;
+    }
+    assert_eq!(scheduler.stats(), held_back);
+
+    wallet_connectivity.notify_base_node_set(server_node_identity.to_peer());
+    let mut connection = mock_rpc_server
+        .create_connection(server_node_identity.to_peer(), "t/bnwallet/1".into())
+        .await;
+    wallet_connectivity.set_base_node_wallet_rpc_client(connect_rpc_client(&mut connection).await);
+
+    for query in queries {
+        let response = query.await.unwrap().unwrap();
+        assert_eq!(response.location, TxLocation::InMempool);
+        assert!(response.is_synced);
+    }
+    assert_eq!(rpc_service_state.take_transaction_query_calls().len(), 1);
+    let batch_calls = rpc_service_state.take_transaction_batch_query_calls();
+    assert_eq!(batch_calls.len(), 1);
+    assert_eq!(batch_calls[0].len(), 2);
+    let start = Instant::now();
+    while scheduler.stats() != BroadcastQueueStats::default() && start.elapsed() < Duration::from_secs(5) {
+        sleep(Duration::from_millis(10)).await;
+    }
+    assert_eq!(scheduler.stats(), BroadcastQueueStats::default());
+}
+
+#[tokio::test]
+async fn tx_broadcast_scheduler_handles_failing_submissions() {
+    let (
+        resources,
+        _outbound_mock_state,
+        mock_rpc_server,
+        server_node_identity,
+        rpc_service_state,
+        _shutdown,
+        _temp_dir,
+        _transaction_event_receiver,
+        wallet_connectivity,
+    ) = setup().await;
+    let mut connection = mock_rpc_server
+        .create_connection(server_node_identity.to_peer(), "t/bnwallet/1".into())
+        .await;
+    wallet_connectivity.set_base_node_wallet_rpc_client(connect_rpc_client(&mut connection).await);
+
+    add_transaction_to_database(1u64.into(), T, None, resources.db.clone()).await;
+    let tx = resources.db.get_completed_transaction(1u64.into()).unwrap();
+    let tx_proto = TransactionProto::try_from(tx.transaction).unwrap();
+    let scheduler = resources.broadcast_scheduler.clone();
+
+    // A bad request is returned to the caller instead of being retried
+    rpc_service_state.set_rpc_status_error(Some(RpcStatus::bad_request("Transaction was invalid")));
+    match scheduler.submit_transaction(1u64.into(), tx_proto.clone()).await {
+        Err(TransactionServiceError::RpcError(RpcError::RequestFailed(status))) => {
+            assert_eq!(status.as_status_code(), RpcStatusCode::BadRequest)
+        },
+        r => panic!("Unexpected result: {:?}", r),
+    }
+    let _calls = rpc_service_state
+        .wait_pop_submit_transaction_calls(1, Duration::from_secs(5))
+        .await
+        .unwrap();
+
+    // Other failures are retried after a backoff
+    rpc_service_state.set_rpc_status_error(Some(RpcStatus::general("Base node overloaded")));
+    let failing = {
+        let scheduler = scheduler.clone();
+        let tx_proto = tx_proto.clone();
+        task::spawn(async move { scheduler.submit_transaction(1u64.into(), tx_proto).await })
+    };
+    let _calls = rpc_service_state
+        .wait_pop_submit_transaction_calls(1, Duration::from_secs(5))
+        .await
+        .unwrap();
+    let backoff_start = Instant::now();
+    let backing_off = BroadcastQueueStats {
+        queued: 0,
+        in_flight: 1,
+        batches_in_flight: 1,
+    };
+    while scheduler.stats() != backing_off && backoff_start.elapsed() < Duration::from_secs(5) {
+        sleep(Duration::from_millis(10)).await;
+    }
+    assert_eq!(scheduler.stats(), backing_off);
+
+    // The batch backing off does not hold up a new submission
+    rpc_service_state.set_rpc_status_error(None);
+    scheduler.submit_transaction(1u64.into(), tx_proto).await.unwrap();
+
+    // The backoff ends as soon as nothing waits for the failed submission any more
+    failing.abort();
+    while scheduler.stats() != BroadcastQueueStats::default() && backoff_start.elapsed() < Duration::from_secs(5) {
+        sleep(Duration::from_millis(10)).await;
+    }
+    assert_eq!(scheduler.stats(), BroadcastQueueStats::default());
+    assert!(backoff_start.elapsed() < TransactionServiceConfig::default().broadcast_retry_backoff);
+}
+
 /// Test that validation detects transactions becoming mined unconfirmed and then confirmed with some going back to
 /// completed
 #[tokio::test]
@@ -23,6 +23,7 @@
 use std::{
     collections::HashMap,
     convert::{TryFrom, TryInto},
+    path::PathBuf,
     sync::Arc,
     time::Duration,
 };
@@ -40,14 +41,15 @@ use minotari_wallet::{
     transaction_service::handle::TransactionServiceRequest,
     util::watch::Watch,
     utxo_scanner_service::{
+        block_output_snapshot::BlockOutputSnapshotWriter,
         handle::{UtxoScannerEvent, UtxoScannerHandle},
-        service::{ScannedBlock, UtxoScannerService},
+        service::{ScannedBlock, UtxoScannerService, UTXO_SCAN_SEGMENT_SIZE},
         uxto_scanner_service_builder::UtxoScannerMode,
     },
 };
 use rand::{rngs::OsRng, RngCore};
 use tari_common::configuration::Network;
-use tari_common_types::tari_address::TariAddress;
+use tari_common_types::{tari_address::TariAddress, types::FixedHash};
 use tari_comms::{
     peer_manager::PeerFeatures,
     protocol::rpc::{mock::MockRpcServer, NamedProtocolService},
@@ -59,7 +61,7 @@ use tari_comms::{
 use tari_core::{
     base_node::rpc::BaseNodeWalletRpcServer,
     blocks::BlockHeader,
-    proto::base_node::{ChainMetadata, TipInfoResponse},
+    proto::base_node::{ChainMetadata, SyncUtxosByBlockResponse, TipInfoResponse},
     transactions::{
         key_manager::{create_memory_db_key_manager, MemoryDbKeyManager, TransactionKeyManagerInterface},
         tari_amount::MicroMinotari,
@@ -94,6 +96,8 @@ pub struct UtxoScannerTestInterface {
     base_node_service_event_publisher: broadcast::Sender<Arc<BaseNodeEvent>>,
     rpc_service_state: BaseNodeWalletRpcMockState,
     _rpc_mock_server: MockRpcServer<BaseNodeWalletRpcServer<BaseNodeWalletRpcMockService>>,
+    shard_rpc_service_states: Vec<BaseNodeWalletRpcMockState>,
+    _shard_rpc_mock_servers: Vec<MockRpcServer<BaseNodeWalletRpcServer<BaseNodeWalletRpcMockService>>>,
     _comms_connectivity_mock_state: ConnectivityManagerMockState,
     transaction_service_mock_state: TransactionServiceMockState,
     oms_mock_state: OutputManagerMockState,
@@ -107,6 +111,30 @@ async fn setup(
     previous_db: Option<WalletDatabase<WalletSqliteDatabase>>,
     recovery_message: Option<String>,
     one_sided_message: Option<String>,
+) -> UtxoScannerTestInterface {
+    setup_scanner(
+        key_manager,
+        mode,
+        previous_db,
+        recovery_message,
+        one_sided_message,
+        0,
+        None,
+    )
+    .await
+}
+
+/// Sets up the scanner with `num_shard_peers` base nodes in addition to the sync peer, so that scanning is sharded
+/// across all of them, and optionally to recover from the block output snapshot at `snapshot_path`
+#[allow(clippy::too_many_lines)]
+async fn setup_scanner(
+    key_manager: MemoryDbKeyManager,
+    mode: UtxoScannerMode,
+    previous_db: Option<WalletDatabase<WalletSqliteDatabase>>,
+    recovery_message: Option<String>,
+    one_sided_message: Option<String>,
+    num_shard_peers: usize,
+    snapshot_path: Option<PathBuf>,
 ) -> UtxoScannerTestInterface {
     let shutdown = Shutdown::new();
     let factories = CryptoFactories::default();
@@ -137,6 +165,23 @@ async fn setup(
     comms_connectivity_mock_state
         .add_active_connection(rpc_server_connection)
         .await;
+    let mut peers = vec![server_node_identity.public_key().clone()];
+    let mut shard_rpc_service_states = Vec::with_capacity(num_shard_peers);
+    let mut shard_rpc_mock_servers = Vec::with_capacity(num_shard_peers);
+    for _ in 0..num_shard_peers {
+        let service = BaseNodeWalletRpcMockService::new();
+        shard_rpc_service_states.push(service.get_state());
+        let server = BaseNodeWalletRpcServer::new(service);
+        let node_identity = build_node_identity(PeerFeatures::COMMUNICATION_NODE);
+        let mut mock_server = MockRpcServer::new(server, node_identity.clone());
+        mock_server.serve();
+        let connection = mock_server
+            .create_connection(node_identity.to_peer(), protocol_name.into())
+            .await;
+        comms_connectivity_mock_state.add_active_connection(connection).await;
+        peers.push(node_identity.public_key().clone());
+        shard_rpc_mock_servers.push(mock_server);
+    }
     task::spawn(connectivity_mock.run());
 
     let wallet_connectivity_mock = create_wallet_connectivity_mock();
@@ -181,7 +226,7 @@ async fn setup(
     let mut scanner_service_builder = UtxoScannerService::<WalletSqliteDatabase, WalletConnectivityMock>::builder();
 
     scanner_service_builder
-        .with_peers(vec![server_node_identity.public_key().clone()])
+        .with_peers(peers)
         .with_retry_limit(1)
         .with_mode(mode);
 
@@ -193,6 +238,10 @@ async fn setup(
         scanner_service_builder.with_recovery_message(message);
     }
 
+    if let Some(path) = snapshot_path {
+        scanner_service_builder.with_block_output_snapshot(path);
+    }
+
     let (_view_key_id, view_key) = key_manager.get_view_key().await.unwrap();
     let tari_address = TariAddress::new_dual_address_with_default_features(
         view_key,
@@ -223,6 +272,8 @@ async fn setup(
         base_node_service_event_publisher: event_publisher_bns,
         rpc_service_state,
         _rpc_mock_server: mock_server,
+        shard_rpc_service_states,
+        _shard_rpc_mock_servers: shard_rpc_mock_servers,
         _comms_connectivity_mock_state: comms_connectivity_mock_state,
         transaction_service_mock_state,
         oms_mock_state,
@@ -385,6 +436,285 @@ async fn test_utxo_scanner_recovery() {
         }
     }
 }
+#[tokio::test]
+#[allow(clippy::too_many_lines)]
+async fn test_utxo_scanner_recovery_sharded_across_peers() {
+    let key_manager = create_memory_db_key_manager().unwrap();
+    let mut test_interface = setup_scanner(
+        key_manager.clone(),
+        UtxoScannerMode::Recovery,
+        None,
+        None,
+        None,
+        1,
+        None,
+    )
+    .await;
+
+    let cipher_seed = CipherSeed::new();
+    // get birthday duration, in seconds, from unix epoch
+    let birthday_epoch_time = get_birthday_from_unix_epoch_in_seconds(cipher_seed.birthday(), 14u16);
+    test_interface.wallet_db.set_master_seed(cipher_seed).unwrap();
+
+    // Scanning starts at block 1, so blocks 1 to 300 are scanned in two segments and each peer provides one of them
+    const NUM_BLOCKS: u64 = UTXO_SCAN_SEGMENT_SIZE + 51;
+    const BIRTHDAY_OFFSET: u64 = 2;
+
+    let TestBlockData {
+        block_headers,
+        wallet_outputs,
+        utxos_by_block,
+    } = generate_block_headers_and_utxos(0, NUM_BLOCKS, birthday_epoch_time, BIRTHDAY_OFFSET, true, &key_manager).await;
+
+    let chain_metadata = ChainMetadata {
+        best_block_height: NUM_BLOCKS - 1,
+        best_block_hash: block_headers.get(&(NUM_BLOCKS - 1)).unwrap().clone().hash().to_vec(),
+        accumulated_difficulty: Vec::new(),
+        pruned_height: 0,
+        timestamp: 0,
+    };
+    let rpc_service_states = test_interface
+        .shard_rpc_service_states
+        .iter()
+        .chain(Some(&test_interface.rpc_service_state))
+        .collect::<Vec<_>>();
+    for state in &rpc_service_states {
+        state.set_utxos_by_block(utxos_by_block.clone());
+        state.set_blocks(block_headers.clone());
+        state.set_tip_info_response(TipInfoResponse {
+            metadata: Some(chain_metadata.clone()),
+            is_synced: true,
+        });
+    }
+
+    let mut db_wallet_outputs = Vec::new();
+    let mut total_outputs_to_recover = 0;
+    let mut total_amount_to_recover = MicroMinotari::from(0);
+    for (h, outputs) in &wallet_outputs {
+        for output in outputs {
+            let dbo = DbWalletOutput::from_wallet_output(
+                output.clone(),
+                &key_manager,
+                None,
+                OutputSource::Standard,
+                None,
+                None,
+            )
+            .await
+            .unwrap();
+            // Only the outputs in blocks after the birthday should be included in the recovered total
+            if *h >= BIRTHDAY_OFFSET - 1 {
+                total_outputs_to_recover += 1;
+                total_amount_to_recover += dbo.wallet_output.value;
+            }
+            db_wallet_outputs.push(dbo);
+        }
+    }
+    test_interface.oms_mock_state.set_recoverable_outputs(db_wallet_outputs);
+
+    let mut scanner_event_stream = test_interface.scanner_handle.get_event_receiver();
+
+    tokio::spawn(test_interface.scanner_service.take().unwrap().run());
+
+    let delay = time::sleep(Duration::from_secs(60));
+    tokio::pin!(delay);
+    loop {
+        tokio::select! {
+            _ = &mut delay => {
+                panic!("Completed event should have arrived by now.");
+            }
+            event = scanner_event_stream.recv() => {
+                if let UtxoScannerEvent::Completed {
+                    final_height,
+                    num_recovered,
+                    value_recovered,
+                    time_taken: _,
+                } = event.unwrap() {
+                    assert_eq!(final_height, NUM_BLOCKS - 1);
+                    assert_eq!(num_recovered, total_outputs_to_recover);
+                    assert_eq!(value_recovered, total_amount_to_recover);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Each peer provided exactly one of the segments
+    for state in rpc_service_states {
+        assert_eq!(state.take_sync_utxos_by_block_calls().len(), 1);
+    }
+}
+
+#[tokio::test]
+#[allow(clippy::too_many_lines)]
+async fn test_utxo_scanner_recovery_from_snapshot() {
+    let key_manager = create_memory_db_key_manager().unwrap();
+    let snapshot_dir = tempdir().unwrap();
+    let snapshot_path = snapshot_dir.path().join("snapshot.bin");
+    let mut test_interface = setup_scanner(
+        key_manager.clone(),
+        UtxoScannerMode::Recovery,
+        None,
+        None,
+        None,
+        0,
+        Some(snapshot_path.clone()),
+    )
+    .await;
+
+    let cipher_seed = CipherSeed::new();
+    // get birthday duration, in seconds, from unix epoch
+    let birthday_epoch_time = get_birthday_from_unix_epoch_in_seconds(cipher_seed.birthday(), 14u16);
+    test_interface.wallet_db.set_master_seed(cipher_seed).unwrap();
+
+    const NUM_BLOCKS: u64 = 11;
+    const BIRTHDAY_OFFSET: u64 = 5;
+
+    let TestBlockData {
+        block_headers,
+        wallet_outputs,
+        utxos_by_block,
+    } = generate_block_headers_and_utxos(0, NUM_BLOCKS, birthday_epoch_time, BIRTHDAY_OFFSET, false, &key_manager)
+        .await;
+
+    let genesis_hash = block_headers.get(&0).unwrap().hash();
+    let mut writer =
+        BlockOutputSnapshotWriter::create(&snapshot_path, Network::default(), &genesis_hash, NUM_BLOCKS - 1).unwrap();
+    for block in &utxos_by_block {
+        writer
+            .write_block(&SyncUtxosByBlockResponse {
+                outputs: block.utxos.clone().into_iter().map(|o| o.try_into().unwrap()).collect(),
+                height: block.height,
+                header_hash: block.header_hash.clone(),
+                mined_timestamp: block_headers.get(&block.height).unwrap().timestamp.as_u64(),
+            })
+            .unwrap();
+    }
+    writer.finish().unwrap();
+
+    // Adding half the outputs of the blocks to the OMS mock
+    let mut db_wallet_outputs = Vec::new();
+    let mut total_outputs_to_recover = 0;
+    let mut total_amount_to_recover = MicroMinotari::from(0);
+    for (h, outputs) in &wallet_outputs {
+        for output in outputs.iter().skip(outputs.len() / 2) {
+            let dbo = DbWalletOutput::from_wallet_output(
+                output.clone(),
+                &key_manager,
+                None,
+                OutputSource::Standard,
+                None,
+                None,
+            )
+            .await
+            .unwrap();
+            // Only the outputs in blocks mined after the birthday are read from the snapshot
+            if *h >= BIRTHDAY_OFFSET {
+                total_outputs_to_recover += 1;
+                total_amount_to_recover += dbo.wallet_output.value;
+            }
+            db_wallet_outputs.push(dbo);
+        }
+    }
+    test_interface.oms_mock_state.set_recoverable_outputs(db_wallet_outputs);
+
+    let mut scanner_event_stream = test_interface.scanner_handle.get_event_receiver();
+
+    tokio::spawn(test_interface.scanner_service.take().unwrap().run());
+
+    let delay = time::sleep(Duration::from_secs(60));
+    tokio::pin!(delay);
+    loop {
+        tokio::select! {
+            _ = &mut delay => {
+                panic!("Completed event should have arrived by now.");
+            }
+            event = scanner_event_stream.recv() => {
+                if let UtxoScannerEvent::Completed {
+                    final_height,
+                    num_recovered,
+                    value_recovered,
+                    time_taken: _,
+                } = event.unwrap() {
+                    assert_eq!(final_height, NUM_BLOCKS - 1);
+                    assert_eq!(num_recovered, total_outputs_to_recover);
+                    assert_eq!(value_recovered, total_amount_to_recover);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Every recovered output was imported, without asking the base node for any blocks
+    let mut num_imported = 0;
+    let mut amount_imported = MicroMinotari::from(0);
+    for req in test_interface.transaction_service_mock_state.drain_requests() {
+        if let TransactionServiceRequest::ImportUtxosWithStatus(imports) = req {
+            for import in imports {
+                num_imported += 1;
+                amount_imported += import.amount;
+            }
+        }
+    }
+    assert_eq!(num_imported, total_outputs_to_recover);
+    assert_eq!(amount_imported, total_amount_to_recover);
+    assert!(test_interface
+        .rpc_service_state
+        .take_sync_utxos_by_block_calls()
+        .is_empty());
+}
+
+#[tokio::test]
+async fn test_utxo_scanner_rejects_a_snapshot_of_another_network() {
+    let key_manager = create_memory_db_key_manager().unwrap();
+    let snapshot_dir = tempdir().unwrap();
+    let snapshot_path = snapshot_dir.path().join("snapshot.bin");
+    let mut test_interface = setup_scanner(
+        key_manager.clone(),
+        UtxoScannerMode::Recovery,
+        None,
+        None,
+        None,
+        0,
+        Some(snapshot_path.clone()),
+    )
+    .await;
+    test_interface.wallet_db.set_master_seed(CipherSeed::new()).unwrap();
+
+    let other_network = if Network::default() == Network::LocalNet {
+        Network::Esmeralda
+    } else {
+        Network::LocalNet
+    };
+    let writer = BlockOutputSnapshotWriter::create(&snapshot_path, other_network, &FixedHash::zero(), 0).unwrap();
+    writer.finish().unwrap();
+
+    let mut scanner_event_stream = test_interface.scanner_handle.get_event_receiver();
+
+    tokio::spawn(test_interface.scanner_service.take().unwrap().run());
+
+    let delay = time::sleep(Duration::from_secs(60));
+    tokio::pin!(delay);
+    loop {
+        tokio::select! {
+            _ = &mut delay => {
+                panic!("ScanningFailed event should have arrived by now.");
+            }
+            event = scanner_event_stream.recv() => {
+                match event.unwrap() {
+                    UtxoScannerEvent::ScanningFailed => break,
+                    UtxoScannerEvent::Completed { .. } => panic!("A snapshot of another network was scanned"),
+                    _ => {},
+                }
+            }
+        }
+    }
+    assert!(test_interface
+        .transaction_service_mock_state
+        .drain_requests()
+        .is_empty());
+}
+
 #[tokio::test]
 #[allow(clippy::too_many_lines)]
 async fn test_utxo_scanner_recovery_with_restart() {
@@ -476,20 +806,14 @@ async fn test_utxo_scanner_recovery_with_restart() {
     let requests = test_interface.transaction_service_mock_state.drain_requests();
     assert!(!requests.is_empty());
     for req in requests {
-        if let TransactionServiceRequest::ImportUtxoWithStatus {
-            amount: _,
-            source_address,
-            message,
-            import_status: _,
-            tx_id: _,
-            current_height: _,
-            mined_timestamp: _,
-            scanned_output: _,
-            payment_id: _,
-        } = req
-        {
-            assert_eq!(message, "Output found on blockchain during Wallet Recovery".to_string());
-            assert_eq!(source_address, TariAddress::default());
+        if let TransactionServiceRequest::ImportUtxosWithStatus(imports) = req {
+            for import in imports {
+                assert_eq!(
+                    import.message,
+                    "Output found on blockchain during Wallet Recovery".to_string()
+                );
+                assert_eq!(import.source_address, TariAddress::default());
+            }
         }
     }
 
@@ -545,19 +869,10 @@ async fn test_utxo_scanner_recovery_with_restart() {
     let requests = test_interface2.transaction_service_mock_state.drain_requests();
     assert!(!requests.is_empty());
     for req in requests {
-        if let TransactionServiceRequest::ImportUtxoWithStatus {
-            amount: _,
-            source_address: _,
-            message,
-            import_status: _,
-            tx_id: _,
-            current_height: _,
-            mined_timestamp: _,
-            scanned_output: _,
-            payment_id: _,
-        } = req
-        {
-            assert_eq!(message, "recovery".to_string());
+        if let TransactionServiceRequest::ImportUtxosWithStatus(imports) = req {
+            for import in imports {
+                assert_eq!(import.message, "recovery".to_string());
+            }
         }
     }
 }
@@ -965,19 +1280,13 @@ async fn test_utxo_scanner_one_sided_payments() {
     let requests = test_interface.transaction_service_mock_state.drain_requests();
     assert!(!requests.is_empty());
     for req in requests {
-        if let TransactionServiceRequest::ImportUtxoWithStatus {
-            amount: _,
-            source_address: _,
-            message,
-            import_status: _,
-            tx_id: _,
-            current_height: _,
-            mined_timestamp: _,
-            scanned_output: _,
-            payment_id: _,
-        } = req
-        {
-            assert_eq!(message, "Output found on blockchain during Wallet Recovery".to_string());
+        if let TransactionServiceRequest::ImportUtxosWithStatus(imports) = req {
+            for import in imports {
+                assert_eq!(
+                    import.message,
+                    "Output found on blockchain during Wallet Recovery".to_string()
+                );
+            }
         }
     }
 
@@ -1064,20 +1373,14 @@ async fn test_utxo_scanner_one_sided_payments() {
     assert!(!requests.is_empty());
 
     for req in requests {
-        if let TransactionServiceRequest::ImportUtxoWithStatus {
-            amount: _,
-            source_address: _,
-            message,
-            import_status: _,
-            tx_id: _,
-            current_height: h,
-            mined_timestamp: _,
-            scanned_output: _,
-            payment_id: _,
-        } = req
-        {
-            println!("{:?}", h);
-            assert_eq!(message, "Output found on blockchain during Wallet Recovery".to_string());
+        if let TransactionServiceRequest::ImportUtxosWithStatus(imports) = req {
+            for import in imports {
+                println!("{:?}", import.current_height);
+                assert_eq!(
+                    import.message,
+                    "Output found on blockchain during Wallet Recovery".to_string()
+                );
+            }
         }
     }
 }
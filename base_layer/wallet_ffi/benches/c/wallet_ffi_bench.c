@@ -0,0 +1,350 @@
+// Copyright 2024. The Tari Project
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Benchmarks the wallet FFI the way integrators use it: from C, through wallet.h, linked against
+// libminotari_wallet_ffi. It opens a wallet that was seeded by the `wallet_ffi` criterion bench, e.g.
+//
+//   TARI_FFI_BENCH_SEED_DIR=/tmp/wallet_ffi_bench cargo bench -p minotari_wallet_ffi --bench wallet_ffi
+//   cargo build --release -p minotari_wallet_ffi
+//   cc -O2 -Ibase_layer/wallet_ffi -o wallet_ffi_bench base_layer/wallet_ffi/benches/c/wallet_ffi_bench.c
+//      -Ltarget/release -lminotari_wallet_ffi -lpthread -ldl -lm
+//   LD_LIBRARY_PATH=target/release ./wallet_ffi_bench /tmp/wallet_ffi_bench/1000 20
+//
+// and prints one line per measurement with the number of runs and the mean, minimum and maximum time in milliseconds.
+// The sends are made from a copy of the seeded wallet in a temporary folder, so the seeded wallet can be reused.
+
+#define _XOPEN_SOURCE 700
+
+#include <dirent.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "wallet.h"
+
+#define DATABASE_NAME "wallet_ffi_bench"
+#define PASSPHRASE "wallet ffi benchmark"
+#define NETWORK "localnet"
+#define UTXO_PAGE_SIZE 100
+#define SEND_AMOUNT 10000
+#define FEE_PER_GRAM 5
+#define CALLBACK_TIMEOUT_SECS 30
+
+struct stats {
+    const char *name;
+    int runs;
+    double total_ms;
+    double min_ms;
+    double max_ms;
+};
+
+static pthread_mutex_t balance_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t balance_updated = PTHREAD_COND_INITIALIZER;
+static unsigned long long balance_updates = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void record(struct stats *stats, double elapsed_ms) {
+    if (stats->runs == 0 || elapsed_ms < stats->min_ms) {
+        stats->min_ms = elapsed_ms;
+    }
+    if (stats->runs == 0 || elapsed_ms > stats->max_ms) {
+        stats->max_ms = elapsed_ms;
+    }
+    stats->runs++;
+    stats->total_ms += elapsed_ms;
+}
+
+static void report(const struct stats *stats) {
+    if (stats->runs == 0) {
+        printf("%-40s no successful runs\n", stats->name);
+        return;
+    }
+    printf("%-40s runs %4d  mean %10.3f ms  min %10.3f ms  max %10.3f ms\n", stats->name, stats->runs,
+           stats->total_ms / stats->runs, stats->min_ms, stats->max_ms);
+}
+
+static int check(const char *function, int error) {
+    if (error != 0) {
+        fprintf(stderr, "%s failed with error %d\n", function, error);
+    }
+    return error;
+}
+
+static void received_tx(TariPendingInboundTransaction *tx) { pending_inbound_transaction_destroy(tx); }
+static void completed_tx(TariCompletedTransaction *tx) { completed_transaction_destroy(tx); }
+static void completed_tx_with_value(TariCompletedTransaction *tx, uint64_t value) {
+    (void)value;
+    completed_transaction_destroy(tx);
+}
+static void send_result(unsigned long long tx_id, TariTransactionSendStatus *status) {
+    (void)tx_id;
+    transaction_send_status_destroy(status);
+}
+static void validation_complete(uint64_t request_key, uint64_t result) {
+    (void)request_key;
+    (void)result;
+}
+static void liveness_data(TariContactsLivenessData *data) { liveness_data_destroy(data); }
+static void balance(TariBalance *balance) {
+    balance_destroy(balance);
+    pthread_mutex_lock(&balance_lock);
+    balance_updates++;
+    pthread_cond_broadcast(&balance_updated);
+    pthread_mutex_unlock(&balance_lock);
+}
+static void saf_messages_received(void) {}
+static void connectivity_status(uint64_t status) { (void)status; }
+static void base_node_state(struct TariBaseNodeState *state) { basenode_state_destroy(state); }
+
+static int copy_file(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    if (in == NULL) {
+        return -1;
+    }
+    FILE *out = fopen(to, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return -1;
+    }
+    char buf[65536];
+    size_t n;
+    int result = 0;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        if (fwrite(buf, 1, n, out) != n) {
+            result = -1;
+            break;
+        }
+    }
+    if (ferror(in)) {
+        result = -1;
+    }
+    fclose(in);
+    if (fclose(out) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+// Copies the wallet database files in `from_dir`, which are the database along with its write-ahead log if there is
+// one, to `to_dir`.
+static int copy_wallet(const char *from_dir, const char *to_dir) {
+    DIR *dir = opendir(from_dir);
+    if (dir == NULL) {
+        return -1;
+    }
+    int result = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, DATABASE_NAME, strlen(DATABASE_NAME)) != 0) {
+            continue;
+        }
+        char from[4096];
+        char to[4096];
+        snprintf(from, sizeof(from), "%s/%s", from_dir, entry->d_name);
+        snprintf(to, sizeof(to), "%s/%s", to_dir, entry->d_name);
+        if (copy_file(from, to) != 0) {
+            result = -1;
+            break;
+        }
+    }
+    closedir(dir);
+    return result;
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int type, struct FTW *ftw) {
+    (void)sb;
+    (void)type;
+    (void)ftw;
+    return remove(path);
+}
+
+static struct TariWallet *open_wallet(const char *wallet_dir) {
+    int error = 0;
+    bool recovery_in_progress = false;
+    TariTransportConfig *transport = transport_memory_create();
+    TariCommsConfig *config =
+        comms_config_create("/memory/0", transport, DATABASE_NAME, wallet_dir, 20, 10800, &error);
+    if (check("comms_config_create", error)) {
+        transport_config_destroy(transport);
+        return NULL;
+    }
+    struct TariWallet *wallet = wallet_create(
+        config, NULL, 0, 0, 0, PASSPHRASE, NULL, NETWORK, "", false, NULL, NULL, received_tx, completed_tx,
+        completed_tx, completed_tx, completed_tx, completed_tx_with_value, completed_tx, completed_tx_with_value,
+        send_result, completed_tx_with_value, validation_complete, liveness_data, balance, validation_complete,
+        saf_messages_received, connectivity_status, base_node_state, &recovery_in_progress, &error);
+    check("wallet_create", error);
+    comms_config_destroy(config);
+    transport_config_destroy(transport);
+    return wallet;
+}
+
+static void bench_startup(const char *wallet_dir, int iterations) {
+    struct stats stats = {"wallet_create", 0, 0, 0, 0};
+    for (int i = 0; i < iterations; i++) {
+        double start = now_ms();
+        struct TariWallet *wallet = open_wallet(wallet_dir);
+        double elapsed = now_ms() - start;
+        if (wallet == NULL) {
+            break;
+        }
+        record(&stats, elapsed);
+        wallet_destroy(wallet);
+    }
+    report(&stats);
+}
+
+static void bench_queries(struct TariWallet *wallet, int iterations) {
+    struct stats get_balance = {"wallet_get_balance", 0, 0, 0, 0};
+    struct stats first_page = {"wallet_get_utxos_after (first page)", 0, 0, 0, 0};
+    struct stats all_pages = {"wallet_get_utxos_after (all pages)", 0, 0, 0, 0};
+    struct stats completed = {"wallet_get_completed_transactions", 0, 0, 0, 0};
+    int error = 0;
+
+    for (int i = 0; i < iterations; i++) {
+        double start = now_ms();
+        TariBalance *balance = wallet_get_balance(wallet, &error);
+        double elapsed = now_ms() - start;
+        if (check("wallet_get_balance", error)) {
+            break;
+        }
+        record(&get_balance, elapsed);
+        balance_destroy(balance);
+    }
+
+    for (int i = 0; i < iterations; i++) {
+        struct TariUtxoCursor *cursor = utxo_cursor_create();
+        uintptr_t num_utxos = 0;
+        double start = now_ms();
+        for (;;) {
+            struct TariVector *utxos =
+                wallet_get_utxos_after(wallet, cursor, UTXO_PAGE_SIZE, ValueAsc, NULL, 0, &error);
+            if (check("wallet_get_utxos_after", error)) {
+                break;
+            }
+            uintptr_t len = utxos->len;
+            destroy_tari_vector(utxos);
+            if (num_utxos == 0) {
+                record(&first_page, now_ms() - start);
+            }
+            if (len == 0) {
+                break;
+            }
+            num_utxos += len;
+        }
+        utxo_cursor_destroy(cursor);
+        if (error != 0) {
+            break;
+        }
+        record(&all_pages, now_ms() - start);
+    }
+
+    for (int i = 0; i < iterations; i++) {
+        double start = now_ms();
+        struct TariCompletedTransactions *transactions = wallet_get_completed_transactions(wallet, &error);
+        double elapsed = now_ms() - start;
+        if (check("wallet_get_completed_transactions", error)) {
+            break;
+        }
+        record(&completed, elapsed);
+        completed_transactions_destroy(transactions);
+    }
+
+    report(&get_balance);
+    report(&first_page);
+    report(&all_pages);
+    report(&completed);
+}
+
+// Sends to the wallet's own address, which completes the transaction without a counterparty, and measures both the
+// send call and how long after the send the balance callback arrives.
+static void bench_sends(struct TariWallet *wallet, int iterations) {
+    struct stats send = {"wallet_send_transaction (to self)", 0, 0, 0, 0};
+    struct stats latency = {"balance callback latency", 0, 0, 0, 0};
+    int error = 0;
+    TariWalletAddress *destination = wallet_get_tari_address(wallet, &error);
+    if (check("wallet_get_tari_address", error)) {
+        return;
+    }
+
+    for (int i = 0; i < iterations; i++) {
+        pthread_mutex_lock(&balance_lock);
+        unsigned long long before = balance_updates;
+        pthread_mutex_unlock(&balance_lock);
+
+        double start = now_ms();
+        wallet_send_transaction(wallet, destination, SEND_AMOUNT, NULL, FEE_PER_GRAM, "Benchmark", false, NULL,
+                                &error);
+        double elapsed = now_ms() - start;
+        if (check("wallet_send_transaction", error)) {
+            break;
+        }
+        record(&send, elapsed);
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += CALLBACK_TIMEOUT_SECS;
+        int timed_out = 0;
+        pthread_mutex_lock(&balance_lock);
+        while (balance_updates == before && !timed_out) {
+            timed_out = pthread_cond_timedwait(&balance_updated, &balance_lock, &deadline) != 0;
+        }
+        pthread_mutex_unlock(&balance_lock);
+        if (timed_out) {
+            fprintf(stderr, "No balance callback was received within %d seconds\n", CALLBACK_TIMEOUT_SECS);
+            break;
+        }
+        record(&latency, now_ms() - start);
+    }
+
+    tari_address_destroy(destination);
+    report(&send);
+    report(&latency);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <seeded wallet folder> [iterations]\n", argv[0]);
+        return 1;
+    }
+    const char *wallet_dir = argv[1];
+    int iterations = argc > 2 ? atoi(argv[2]) : 10;
+    if (iterations <= 0) {
+        fprintf(stderr, "The number of iterations must be positive\n");
+        return 1;
+    }
+
+    bench_startup(wallet_dir, iterations);
+
+    struct TariWallet *wallet = open_wallet(wallet_dir);
+    if (wallet == NULL) {
+        return 1;
+    }
+    bench_queries(wallet, iterations);
+    wallet_destroy(wallet);
+
+    char send_dir[] = "/tmp/wallet_ffi_bench_XXXXXX";
+    if (mkdtemp(send_dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    int result = 1;
+    if (copy_wallet(wallet_dir, send_dir) != 0) {
+        fprintf(stderr, "Could not copy the seeded wallet to %s\n", send_dir);
+    } else if ((wallet = open_wallet(send_dir)) != NULL) {
+        bench_sends(wallet, iterations);
+        wallet_destroy(wallet);
+        result = 0;
+    }
+    // The copy is removed along with everything the wallet created next to it
+    nftw(send_dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    return result;
+}
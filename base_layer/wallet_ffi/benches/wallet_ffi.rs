@@ -0,0 +1,511 @@
+//  Copyright 2024. The Tari Project
+//
+//  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+//  following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+//  disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+//  following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+//  products derived from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+//  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//! End to end benchmarks of the wallet FFI, driven through the same `extern "C"` functions that the mobile wallets
+//! call. Every benchmark runs against a wallet that was seeded with a synthetic history of outputs and transactions.
+//!
+//! The history sizes are read from the comma separated `TARI_FFI_BENCH_SIZES` environment variable and default to
+//! `1000`, e.g. `TARI_FFI_BENCH_SIZES=1000,100000,1000000 cargo bench --bench wallet_ffi` runs the full set. Seeding a
+//! million outputs takes a while, so if `TARI_FFI_BENCH_SEED_DIR` is set the seeded wallets are kept in that folder
+//! and reused by later runs. The same folder can be passed to `benches/c/wallet_ffi_bench.c`. The send benchmarks run
+//! on a copy of the seeded wallet, so the kept wallets are never spent from.
+
+use std::{
+    env,
+    ffi::CString,
+    os::raw::c_int,
+    path::{Path, PathBuf},
+    ptr,
+    sync::{Condvar, Mutex},
+    time::{Duration, Instant},
+};
+
+use chrono::Utc;
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use minotari_wallet::{
+    output_manager_service::storage::{
+        database::OutputManagerDatabase,
+        models::DbWalletOutput,
+        sqlite_db::ReceivedOutputInfoForBatch,
+        OutputSource,
+    },
+    storage::{
+        database::WalletDatabase,
+        sqlite_utilities::{initialize_sqlite_database_backends, SqlitePerformanceProfile},
+    },
+    transaction_service::storage::{database::TransactionBackend, models::CompletedTransaction},
+};
+use minotari_wallet_ffi::*;
+use rand::rngs::OsRng;
+use tari_common::configuration::Network;
+use tari_common_types::{
+    tari_address::TariAddress,
+    transaction::{TransactionDirection, TransactionStatus, TxId},
+    types::{FixedHash, PrivateKey, PublicKey},
+    wallet_types::WalletType,
+};
+use tari_core::transactions::{
+    key_manager::TransactionKeyManagerWrapper,
+    tari_amount::MicroMinotari,
+    test_helpers::{create_wallet_output_with_data, TestParams},
+    transaction_components::{OutputFeatures, Transaction},
+    CryptoFactories,
+};
+use tari_crypto::keys::{PublicKey as PublicKeyTrait, SecretKey};
+use tari_key_manager::{cipher_seed::CipherSeed, key_manager_service::storage::database::KeyManagerDatabase};
+use tari_script::script;
+use tari_utilities::SafePassword;
+use tempfile::TempDir;
+use tokio::runtime::Runtime;
+
+const PASSPHRASE: &str = "wallet ffi benchmark";
+const DATABASE_NAME: &str = "wallet_ffi_bench";
+const NETWORK: &str = "localnet";
+/// The seeded outputs are worth this much plus their index, so that every output has a distinct commitment
+const OUTPUT_VALUE: u64 = 100_000;
+const SEED_BATCH_SIZE: usize = 10_000;
+const UTXO_PAGE_SIZE: usize = 100;
+const SEND_AMOUNT: u64 = 10_000;
+const FEE_PER_GRAM: u64 = 5;
+const CALLBACK_TIMEOUT: Duration = Duration::from_secs(30);
+
+/// The number of balance updates received, used to time how long a callback takes to arrive after an action
+static BALANCE_UPDATES: (Mutex<u64>, Condvar) = (Mutex::new(0), Condvar::new());
+
+fn history_sizes() -> Vec<usize> {
+    env::var("TARI_FFI_BENCH_SIZES")
+        .unwrap_or_else(|_| "1000".to_string())
+        .split(',')
+        .map(|size| {
+            size.trim()
+                .parse()
+                .expect("TARI_FFI_BENCH_SIZES must be a list of numbers")
+        })
+        .collect()
+}
+
+/// Creates a wallet database in `dir` with `size` unspent outputs and `size` completed transactions. The outputs all
+/// belong to the wallet's own key manager, so that they can be spent by the send benchmarks.
+fn seed_wallet(runtime: &Runtime, dir: &Path, size: usize) {
+    let db_path = dir.join(DATABASE_NAME).with_extension("sqlite3");
+    let (wallet_backend, transaction_backend, output_manager_backend, _, key_manager_backend) =
+        initialize_sqlite_database_backends(
+            db_path,
+            SafePassword::from(PASSPHRASE),
+            SqlitePerformanceProfile::default(),
+        )
+        .unwrap();
+    let master_seed = CipherSeed::new();
+    WalletDatabase::new(wallet_backend)
+        .set_master_seed(master_seed.clone())
+        .unwrap();
+    let key_manager = TransactionKeyManagerWrapper::new(
+        master_seed,
+        KeyManagerDatabase::new(key_manager_backend),
+        CryptoFactories::default(),
+        WalletType::default(),
+    )
+    .unwrap();
+    let output_db = OutputManagerDatabase::new(output_manager_backend);
+
+    let test_params = runtime.block_on(TestParams::new(&key_manager));
+    let template = runtime
+        .block_on(create_wallet_output_with_data(
+            script!(Nop),
+            OutputFeatures::default(),
+            &test_params,
+            MicroMinotari(OUTPUT_VALUE),
+            &key_manager,
+        ))
+        .unwrap();
+    let network = Network::LocalNet;
+    let counterparty = random_address(network);
+
+    for start in (0..size).step_by(SEED_BATCH_SIZE) {
+        let end = (start + SEED_BATCH_SIZE).min(size);
+        let mut outputs = Vec::with_capacity(end - start);
+        let mut transactions = Vec::with_capacity(end - start);
+        let mut mined = Vec::with_capacity(end - start);
+        for i in start..end {
+            let tx_id = TxId::from(i as u64 + 1);
+            let mut wallet_output = template.clone();
+            wallet_output.value = MicroMinotari(OUTPUT_VALUE + i as u64);
+            let output = runtime
+                .block_on(DbWalletOutput::from_wallet_output(
+                    wallet_output,
+                    &key_manager,
+                    None,
+                    OutputSource::Standard,
+                    Some(tx_id),
+                    None,
+                ))
+                .unwrap();
+            mined.push(ReceivedOutputInfoForBatch {
+                commitment: output.commitment.clone(),
+                mined_height: i as u64 + 1,
+                mined_in_block: FixedHash::default(),
+                confirmed: true,
+                mined_timestamp: Utc::now().timestamp() as u64,
+            });
+            transactions.push(
+                CompletedTransaction::new(
+                    tx_id,
+                    counterparty.clone(),
+                    TariAddress::default(),
+                    output.wallet_output.value,
+                    MicroMinotari(0),
+                    Transaction::new(vec![], vec![], vec![], PrivateKey::default(), PrivateKey::default()),
+                    TransactionStatus::MinedConfirmed,
+                    "Synthetic history".to_string(),
+                    Utc::now().naive_utc(),
+                    TransactionDirection::Inbound,
+                    Some(i as u64 + 1),
+                    Some(Utc::now().naive_utc()),
+                    None,
+                )
+                .unwrap(),
+            );
+            outputs.push((tx_id, output));
+        }
+        output_db.add_unspent_outputs_with_tx_id(outputs).unwrap();
+        output_db.set_received_outputs_mined_height_and_statuses(mined).unwrap();
+        transaction_backend.insert_completed_transactions(transactions).unwrap();
+    }
+}
+
+/// Returns the folder holding a seeded wallet of `size`, seeding it first if needed. The `TempDir` is kept alive by the
+/// caller when the wallet is not kept in `TARI_FFI_BENCH_SEED_DIR`.
+fn seeded_wallet_dir(runtime: &Runtime, size: usize) -> (PathBuf, Option<TempDir>) {
+    let (dir, temp_dir) = match env::var("TARI_FFI_BENCH_SEED_DIR") {
+        Ok(seed_dir) => (Path::new(&seed_dir).join(size.to_string()), None),
+        Err(_) => {
+            let temp_dir = tempfile::tempdir().unwrap();
+            (temp_dir.path().to_path_buf(), Some(temp_dir))
+        },
+    };
+    if !dir.join(DATABASE_NAME).with_extension("sqlite3").exists() {
+        std::fs::create_dir_all(&dir).unwrap();
+        eprintln!(
+            "Seeding a wallet with {} outputs and transactions in {}",
+            size,
+            dir.display()
+        );
+        let start = Instant::now();
+        seed_wallet(runtime, &dir, size);
+        eprintln!("Seeded in {:.1}s", start.elapsed().as_secs_f64());
+    }
+    (dir, temp_dir)
+}
+
+/// Copies the wallet database in `dir` to a new temporary folder, for benchmarks that change the wallet
+fn copy_seeded_wallet(dir: &Path) -> TempDir {
+    let copy = tempfile::tempdir().unwrap();
+    for entry in std::fs::read_dir(dir).unwrap() {
+        let entry = entry.unwrap();
+        // The database file along with its write-ahead log, if there is one
+        if entry.file_type().unwrap().is_file() && entry.file_name().to_string_lossy().starts_with(DATABASE_NAME) {
+            std::fs::copy(entry.path(), copy.path().join(entry.file_name())).unwrap();
+        }
+    }
+    copy
+}
+
+fn random_address(network: Network) -> TariAddress {
+    let view_key = PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng));
+    let spend_key = PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng));
+    TariAddress::new_dual_address_with_default_features(view_key, spend_key, network)
+}
+
+unsafe extern "C" fn received_tx_callback(tx: *mut TariPendingInboundTransaction) {
+    pending_inbound_transaction_destroy(tx);
+}
+
+unsafe extern "C" fn completed_tx_callback(tx: *mut TariCompletedTransaction) {
+    completed_transaction_destroy(tx);
+}
+
+unsafe extern "C" fn completed_tx_with_value_callback(tx: *mut TariCompletedTransaction, _: u64) {
+    completed_transaction_destroy(tx);
+}
+
+unsafe extern "C" fn send_result_callback(_: u64, status: *mut TariTransactionSendStatus) {
+    transaction_send_status_destroy(status);
+}
+
+unsafe extern "C" fn validation_complete_callback(_: u64, _: u64) {}
+
+unsafe extern "C" fn liveness_data_callback(data: *mut TariContactsLivenessData) {
+    liveness_data_destroy(data);
+}
+
+unsafe extern "C" fn balance_updated_callback(balance: *mut TariBalance) {
+    balance_destroy(balance);
+    let (count, updated) = &BALANCE_UPDATES;
+    *count.lock().unwrap() += 1;
+    updated.notify_all();
+}
+
+unsafe extern "C" fn saf_messages_received_callback() {}
+
+unsafe extern "C" fn connectivity_status_callback(_: u64) {}
+
+unsafe extern "C" fn base_node_state_callback(state: *mut TariBaseNodeState) {
+    basenode_state_destroy(state);
+}
+
+/// Opens the seeded wallet in `dir` with `wallet_create`, on a memory transport so that no network is needed
+unsafe fn open_wallet(dir: &Path) -> *mut TariWallet {
+    let mut error: c_int = 0;
+    let error_ptr = &mut error as *mut c_int;
+    let transport = transport_memory_create();
+    let public_address = CString::new("/memory/0").unwrap();
+    let database_name = CString::new(DATABASE_NAME).unwrap();
+    let datastore_path = CString::new(dir.to_str().unwrap()).unwrap();
+    let config = comms_config_create(
+        public_address.as_ptr(),
+        transport,
+        database_name.as_ptr(),
+        datastore_path.as_ptr(),
+        20,
+        10800,
+        error_ptr,
+    );
+    assert_eq!(error, 0, "comms_config_create failed");
+    let passphrase = CString::new(PASSPHRASE).unwrap();
+    let network = CString::new(NETWORK).unwrap();
+    let peer_seed = CString::new("").unwrap();
+    let mut recovery_in_progress = false;
+    let wallet = wallet_create(
+        config,
+        ptr::null(),
+        0,
+        0,
+        0,
+        passphrase.as_ptr(),
+        ptr::null(),
+        network.as_ptr(),
+        peer_seed.as_ptr(),
+        false,
+        ptr::null_mut(),
+        ptr::null(),
+        received_tx_callback,
+        completed_tx_callback,
+        completed_tx_callback,
+        completed_tx_callback,
+        completed_tx_callback,
+        completed_tx_with_value_callback,
+        completed_tx_callback,
+        completed_tx_with_value_callback,
+        send_result_callback,
+        completed_tx_with_value_callback,
+        validation_complete_callback,
+        liveness_data_callback,
+        balance_updated_callback,
+        validation_complete_callback,
+        saf_messages_received_callback,
+        connectivity_status_callback,
+        base_node_state_callback,
+        &mut recovery_in_progress as *mut bool,
+        error_ptr,
+    );
+    assert_eq!(error, 0, "wallet_create failed");
+    comms_config_destroy(config);
+    transport_config_destroy(transport);
+    wallet
+}
+
+fn wallet_startup(c: &mut Criterion) {
+    let runtime = Runtime::new().unwrap();
+    let mut group = c.benchmark_group("wallet_create");
+    group.sample_size(10);
+    for size in history_sizes() {
+        let (dir, _temp_dir) = seeded_wallet_dir(&runtime, size);
+        group.bench_function(BenchmarkId::from_parameter(size), |b| {
+            b.iter_custom(|iters| {
+                let mut elapsed = Duration::ZERO;
+                for _ in 0..iters {
+                    let start = Instant::now();
+                    let wallet = unsafe { open_wallet(&dir) };
+                    elapsed += start.elapsed();
+                    unsafe { wallet_destroy(wallet) };
+                }
+                elapsed
+            })
+        });
+    }
+    group.finish();
+}
+
+fn wallet_queries(c: &mut Criterion) {
+    let runtime = Runtime::new().unwrap();
+    for size in history_sizes() {
+        let (dir, _temp_dir) = seeded_wallet_dir(&runtime, size);
+        let wallet = unsafe { open_wallet(&dir) };
+        let mut error: c_int = 0;
+        let error_ptr = &mut error as *mut c_int;
+
+        c.bench_function(&format!("wallet_get_balance/{}", size), |b| {
+            b.iter(|| unsafe {
+                let balance = wallet_get_balance(wallet, error_ptr);
+                assert_eq!(*error_ptr, 0);
+                balance_destroy(balance);
+            })
+        });
+
+        c.bench_function(&format!("wallet_get_utxos_after/first_page/{}", size), |b| {
+            b.iter(|| unsafe {
+                let cursor = utxo_cursor_create();
+                let utxos = wallet_get_utxos_after(
+                    wallet,
+                    cursor,
+                    UTXO_PAGE_SIZE,
+                    TariUtxoSort::ValueAsc,
+                    ptr::null_mut(),
+                    0,
+                    error_ptr,
+                );
+                assert_eq!(*error_ptr, 0);
+                destroy_tari_vector(utxos);
+                utxo_cursor_destroy(cursor);
+            })
+        });
+
+        let mut group = c.benchmark_group("wallet_get_utxos_after/all_pages");
+        group.sample_size(10);
+        group.bench_function(BenchmarkId::from_parameter(size), |b| {
+            b.iter(|| unsafe {
+                let cursor = utxo_cursor_create();
+                let mut num_utxos = 0;
+                loop {
+                    let utxos = wallet_get_utxos_after(
+                        wallet,
+                        cursor,
+                        UTXO_PAGE_SIZE,
+                        TariUtxoSort::ValueAsc,
+                        ptr::null_mut(),
+                        0,
+                        error_ptr,
+                    );
+                    assert_eq!(*error_ptr, 0);
+                    let len = (*utxos).len;
+                    destroy_tari_vector(utxos);
+                    if len == 0 {
+                        break;
+                    }
+                    num_utxos += len;
+                }
+                utxo_cursor_destroy(cursor);
+                num_utxos
+            })
+        });
+        group.finish();
+
+        let mut group = c.benchmark_group("wallet_get_completed_transactions");
+        group.sample_size(10);
+        group.bench_function(BenchmarkId::from_parameter(size), |b| {
+            b.iter(|| unsafe {
+                let transactions = wallet_get_completed_transactions(wallet, error_ptr);
+                assert_eq!(*error_ptr, 0);
+                completed_transactions_destroy(transactions);
+            })
+        });
+        group.finish();
+
+        unsafe { wallet_destroy(wallet) };
+    }
+}
+
+/// Measures one-sided sends, which complete without a counterparty, and how long after a send the balance callback
+/// arrives. Every send encumbers outputs of the seeded history, so the number of sends is bounded by its size, and the
+/// sends are made from a copy of the seeded wallet that is discarded afterwards.
+fn wallet_sends(c: &mut Criterion) {
+    let runtime = Runtime::new().unwrap();
+    let network = Network::LocalNet;
+    let message = CString::new("Benchmark").unwrap();
+    for size in history_sizes() {
+        let (seed_dir, _temp_dir) = seeded_wallet_dir(&runtime, size);
+        let dir = copy_seeded_wallet(&seed_dir);
+        let wallet = unsafe { open_wallet(dir.path()) };
+        let mut error: c_int = 0;
+        let error_ptr = &mut error as *mut c_int;
+        let destination = Box::into_raw(Box::new(random_address(network)));
+
+        let mut group = c.benchmark_group("wallet_send_transaction");
+        group.sample_size(10);
+        group.bench_function(BenchmarkId::new("one_sided", size), |b| {
+            b.iter(|| unsafe {
+                let tx_id = wallet_send_transaction(
+                    wallet,
+                    destination,
+                    SEND_AMOUNT,
+                    ptr::null_mut(),
+                    FEE_PER_GRAM,
+                    message.as_ptr(),
+                    true,
+                    ptr::null(),
+                    error_ptr,
+                );
+                assert_eq!(*error_ptr, 0, "wallet_send_transaction failed");
+                tx_id
+            })
+        });
+        group.bench_function(BenchmarkId::new("balance_callback_latency", size), |b| {
+            b.iter_custom(|iters| {
+                let mut elapsed = Duration::ZERO;
+                for _ in 0..iters {
+                    let (count, updated) = &BALANCE_UPDATES;
+                    let before = *count.lock().unwrap();
+                    let start = Instant::now();
+                    unsafe {
+                        wallet_send_transaction(
+                            wallet,
+                            destination,
+                            SEND_AMOUNT,
+                            ptr::null_mut(),
+                            FEE_PER_GRAM,
+                            message.as_ptr(),
+                            true,
+                            ptr::null(),
+                            error_ptr,
+                        );
+                        assert_eq!(*error_ptr, 0, "wallet_send_transaction failed");
+                    }
+                    let (_count, timeout) = updated
+                        .wait_timeout_while(count.lock().unwrap(), CALLBACK_TIMEOUT, |count| *count == before)
+                        .unwrap();
+                    assert!(!timeout.timed_out(), "No balance callback was received");
+                    elapsed += start.elapsed();
+                }
+                elapsed
+            })
+        });
+        group.finish();
+
+        unsafe {
+            tari_address_destroy(destination);
+            wallet_destroy(wallet);
+        }
+    }
+}
+
+criterion_group!(wallet_ffi, wallet_startup, wallet_queries, wallet_sends);
+criterion_main!(wallet_ffi);
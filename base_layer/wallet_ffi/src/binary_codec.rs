@@ -0,0 +1,379 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//! A compact binary encoding of FFI objects that host applications cache, as an alternative to their JSON encoding.
+//! Every buffer starts with a four byte header: the `TB` magic, the format version and the kind of object, followed by
+//! the borsh encoding of a versioned mirror of the object. Values that are not borsh encodable, like secret keys,
+//! addresses and timestamps, are stored in their canonical byte or integer form.
+
+use std::convert::{TryFrom, TryInto};
+
+use borsh::{BorshDeserialize, BorshSerialize};
+use chrono::NaiveDateTime;
+use minotari_wallet::transaction_service::storage::models::{CompletedTransaction, TxCancellationReason};
+use tari_common_types::{
+    tari_address::TariAddress,
+    transaction::{TransactionDirection, TransactionStatus},
+    types::{BlockHash, ComAndPubSignature, PrivateKey, PublicKey, RangeProof, Signature},
+};
+use tari_core::{
+    covenants::Covenant,
+    transactions::{
+        aggregated_body::AggregateBody,
+        tari_amount::MicroMinotari,
+        transaction_components::{
+            encrypted_data::PaymentId,
+            EncryptedData,
+            OutputFeatures,
+            Transaction,
+            TransactionOutputVersion,
+            UnblindedOutput,
+        },
+    },
+};
+use tari_crypto::tari_utilities::ByteArray;
+use tari_script::{ExecutionStack, TariScript};
+
+const MAGIC: [u8; 2] = *b"TB";
+/// Bumped whenever the encoding changes, buffers of any other version are rejected rather than misread
+pub const BINARY_FORMAT_VERSION: u8 = 1;
+const HEADER_SIZE: usize = 4;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+enum ObjectKind {
+    CompletedTransaction = 1,
+    CompletedTransactions = 2,
+    UnblindedOutput = 3,
+}
+
+fn encode<T: BorshSerialize>(kind: ObjectKind, object: &T) -> Result<Vec<u8>, String> {
+    let mut buf = Vec::with_capacity(HEADER_SIZE + 512);
+    buf.extend_from_slice(&MAGIC);
+    buf.push(BINARY_FORMAT_VERSION);
+    buf.push(kind as u8);
+    object.serialize(&mut buf).map_err(|e| e.to_string())?;
+    Ok(buf)
+}
+
+fn decode<T: BorshDeserialize>(kind: ObjectKind, bytes: &[u8]) -> Result<T, String> {
+    if bytes.len() < HEADER_SIZE || bytes[..2] != MAGIC {
+        return Err("Not a binary encoded wallet object".to_string());
+    }
+    if bytes[2] != BINARY_FORMAT_VERSION {
+        return Err(format!("Unsupported binary format version {}", bytes[2]));
+    }
+    if bytes[3] != kind as u8 {
+        return Err(format!("Expected an object of kind {:?}, got {}", kind, bytes[3]));
+    }
+    borsh::from_slice(&bytes[HEADER_SIZE..]).map_err(|e| e.to_string())
+}
+
+fn private_key_from_bytes(bytes: &[u8]) -> Result<PrivateKey, String> {
+    PrivateKey::from_canonical_bytes(bytes).map_err(|e| e.to_string())
+}
+
+/// Seconds and nanoseconds since the unix epoch
+type TimestampV1 = (i64, u32);
+
+fn timestamp_to_v1(timestamp: &NaiveDateTime) -> TimestampV1 {
+    (timestamp.timestamp(), timestamp.timestamp_subsec_nanos())
+}
+
+fn timestamp_from_v1((secs, nanos): TimestampV1) -> Result<NaiveDateTime, String> {
+    NaiveDateTime::from_timestamp_opt(secs, nanos)
+        .ok_or_else(|| format!("Timestamp {}.{} is out of range", secs, nanos))
+}
+
+#[derive(BorshSerialize, BorshDeserialize)]
+struct TransactionV1 {
+    offset: Vec<u8>,
+    body: AggregateBody,
+    script_offset: Vec<u8>,
+}
+
+impl From<&Transaction> for TransactionV1 {
+    fn from(tx: &Transaction) -> Self {
+        Self {
+            offset: tx.offset.to_vec(),
+            body: tx.body.clone(),
+            script_offset: tx.script_offset.to_vec(),
+        }
+    }
+}
+
+impl TryFrom<TransactionV1> for Transaction {
+    type Error = String;
+
+    fn try_from(tx: TransactionV1) -> Result<Self, Self::Error> {
+        Ok(Self {
+            offset: private_key_from_bytes(&tx.offset)?,
+            body: tx.body,
+            script_offset: private_key_from_bytes(&tx.script_offset)?,
+        })
+    }
+}
+
+#[derive(BorshSerialize, BorshDeserialize)]
+struct CompletedTransactionV1 {
+    tx_id: u64,
+    source_address: Vec<u8>,
+    destination_address: Vec<u8>,
+    amount: MicroMinotari,
+    fee: MicroMinotari,
+    transaction: TransactionV1,
+    status: i32,
+    message: String,
+    timestamp: TimestampV1,
+    cancelled: Option<u32>,
+    direction: i32,
+    send_count: u32,
+    last_send_timestamp: Option<TimestampV1>,
+    transaction_signature: Signature,
+    confirmations: Option<u64>,
+    mined_height: Option<u64>,
+    mined_in_block: Option<BlockHash>,
+    mined_timestamp: Option<TimestampV1>,
+    payment_id: Option<Vec<u8>>,
+}
+
+impl From<&CompletedTransaction> for CompletedTransactionV1 {
+    fn from(tx: &CompletedTransaction) -> Self {
+        Self {
+            tx_id: tx.tx_id.as_u64(),
+            source_address: tx.source_address.to_vec(),
+            destination_address: tx.destination_address.to_vec(),
+            amount: tx.amount,
+            fee: tx.fee,
+            transaction: (&tx.transaction).into(),
+            status: tx.status.clone() as i32,
+            message: tx.message.clone(),
+            timestamp: timestamp_to_v1(&tx.timestamp),
+            cancelled: tx.cancelled.map(|reason| reason as u32),
+            direction: tx.direction.clone() as i32,
+            send_count: tx.send_count,
+            last_send_timestamp: tx.last_send_timestamp.as_ref().map(timestamp_to_v1),
+            transaction_signature: tx.transaction_signature.clone(),
+            confirmations: tx.confirmations,
+            mined_height: tx.mined_height,
+            mined_in_block: tx.mined_in_block,
+            mined_timestamp: tx.mined_timestamp.as_ref().map(timestamp_to_v1),
+            payment_id: tx.payment_id.as_ref().map(|id| id.as_bytes()),
+        }
+    }
+}
+
+impl TryFrom<CompletedTransactionV1> for CompletedTransaction {
+    type Error = String;
+
+    fn try_from(tx: CompletedTransactionV1) -> Result<Self, Self::Error> {
+        Ok(Self {
+            tx_id: tx.tx_id.into(),
+            source_address: TariAddress::from_bytes(&tx.source_address).map_err(|e| e.to_string())?,
+            destination_address: TariAddress::from_bytes(&tx.destination_address).map_err(|e| e.to_string())?,
+            amount: tx.amount,
+            fee: tx.fee,
+            transaction: tx.transaction.try_into()?,
+            status: TransactionStatus::try_from(tx.status).map_err(|e| e.to_string())?,
+            message: tx.message,
+            timestamp: timestamp_from_v1(tx.timestamp)?,
+            cancelled: tx
+                .cancelled
+                .map(TxCancellationReason::try_from)
+                .transpose()
+                .map_err(|e| e.to_string())?,
+            direction: TransactionDirection::try_from(tx.direction).map_err(|e| e.to_string())?,
+            send_count: tx.send_count,
+            last_send_timestamp: tx.last_send_timestamp.map(timestamp_from_v1).transpose()?,
+            transaction_signature: tx.transaction_signature,
+            confirmations: tx.confirmations,
+            mined_height: tx.mined_height,
+            mined_in_block: tx.mined_in_block,
+            mined_timestamp: tx.mined_timestamp.map(timestamp_from_v1).transpose()?,
+            payment_id: tx
+                .payment_id
+                .map(|bytes| PaymentId::from_bytes(&bytes))
+                .transpose()
+                .map_err(|e| e.to_string())?,
+        })
+    }
+}
+
+#[derive(BorshSerialize, BorshDeserialize)]
+struct UnblindedOutputV1 {
+    version: TransactionOutputVersion,
+    value: MicroMinotari,
+    spending_key: Vec<u8>,
+    features: OutputFeatures,
+    script: TariScript,
+    covenant: Covenant,
+    input_data: ExecutionStack,
+    script_private_key: Vec<u8>,
+    sender_offset_public_key: PublicKey,
+    metadata_signature: ComAndPubSignature,
+    script_lock_height: u64,
+    encrypted_data: EncryptedData,
+    minimum_value_promise: MicroMinotari,
+    range_proof: Option<RangeProof>,
+}
+
+impl From<&UnblindedOutput> for UnblindedOutputV1 {
+    fn from(output: &UnblindedOutput) -> Self {
+        Self {
+            version: output.version,
+            value: output.value,
+            spending_key: output.spending_key.to_vec(),
+            features: output.features.clone(),
+            script: output.script.clone(),
+            covenant: output.covenant.clone(),
+            input_data: output.input_data.clone(),
+            script_private_key: output.script_private_key.to_vec(),
+            sender_offset_public_key: output.sender_offset_public_key.clone(),
+            metadata_signature: output.metadata_signature.clone(),
+            script_lock_height: output.script_lock_height,
+            encrypted_data: output.encrypted_data.clone(),
+            minimum_value_promise: output.minimum_value_promise,
+            range_proof: output.range_proof.clone(),
+        }
+    }
+}
+
+impl TryFrom<UnblindedOutputV1> for UnblindedOutput {
+    type Error = String;
+
+    fn try_from(output: UnblindedOutputV1) -> Result<Self, Self::Error> {
+        Ok(Self {
+            version: output.version,
+            value: output.value,
+            spending_key: private_key_from_bytes(&output.spending_key)?,
+            features: output.features,
+            script: output.script,
+            covenant: output.covenant,
+            input_data: output.input_data,
+            script_private_key: private_key_from_bytes(&output.script_private_key)?,
+            sender_offset_public_key: output.sender_offset_public_key,
+            metadata_signature: output.metadata_signature,
+            script_lock_height: output.script_lock_height,
+            encrypted_data: output.encrypted_data,
+            minimum_value_promise: output.minimum_value_promise,
+            range_proof: output.range_proof,
+        })
+    }
+}
+
+pub fn completed_transaction_to_bytes(tx: &CompletedTransaction) -> Result<Vec<u8>, String> {
+    encode(ObjectKind::CompletedTransaction, &CompletedTransactionV1::from(tx))
+}
+
+pub fn completed_transaction_from_bytes(bytes: &[u8]) -> Result<CompletedTransaction, String> {
+    decode::<CompletedTransactionV1>(ObjectKind::CompletedTransaction, bytes)?.try_into()
+}
+
+pub fn completed_transactions_to_bytes(txs: &[CompletedTransaction]) -> Result<Vec<u8>, String> {
+    let txs = txs.iter().map(CompletedTransactionV1::from).collect::<Vec<_>>();
+    encode(ObjectKind::CompletedTransactions, &txs)
+}
+
+pub fn completed_transactions_from_bytes(bytes: &[u8]) -> Result<Vec<CompletedTransaction>, String> {
+    decode::<Vec<CompletedTransactionV1>>(ObjectKind::CompletedTransactions, bytes)?
+        .into_iter()
+        .map(CompletedTransaction::try_from)
+        .collect()
+}
+
+pub fn unblinded_output_to_bytes(output: &UnblindedOutput) -> Result<Vec<u8>, String> {
+    encode(ObjectKind::UnblindedOutput, &UnblindedOutputV1::from(output))
+}
+
+pub fn unblinded_output_from_bytes(bytes: &[u8]) -> Result<UnblindedOutput, String> {
+    decode::<UnblindedOutputV1>(ObjectKind::UnblindedOutput, bytes)?.try_into()
+}
+
+#[cfg(test)]
+mod test {
+    use chrono::Utc;
+    use rand::rngs::OsRng;
+    use tari_common::configuration::Network;
+    use tari_crypto::keys::{PublicKey as PublicKeyTrait, SecretKey};
+
+    use super::*;
+
+    fn completed_transaction(tx_id: u64) -> CompletedTransaction {
+        let address = TariAddress::new_single_address_with_interactive_only(
+            PublicKey::from_secret_key(&PrivateKey::random(&mut OsRng)),
+            Network::LocalNet,
+        );
+        let transaction = Transaction::new(
+            vec![],
+            vec![],
+            vec![],
+            PrivateKey::random(&mut OsRng),
+            PrivateKey::random(&mut OsRng),
+        );
+        let mut tx = CompletedTransaction::new(
+            tx_id.into(),
+            address.clone(),
+            address,
+            MicroMinotari(1_000_000),
+            MicroMinotari(100),
+            transaction,
+            TransactionStatus::MinedConfirmed,
+            "binary".to_string(),
+            Utc::now().naive_utc(),
+            TransactionDirection::Outbound,
+            Some(10),
+            Some(Utc::now().naive_utc()),
+            Some(PaymentId::U64(tx_id)),
+        )
+        .unwrap();
+        tx.cancelled = Some(TxCancellationReason::Orphan);
+        tx.mined_in_block = Some(BlockHash::from([7u8; 32]));
+        tx
+    }
+
+    #[test]
+    fn it_round_trips_completed_transactions() {
+        let tx = completed_transaction(1);
+        let bytes = completed_transaction_to_bytes(&tx).unwrap();
+        assert_eq!(&bytes[..HEADER_SIZE], &[b'T', b'B', BINARY_FORMAT_VERSION, 1]);
+        assert_eq!(completed_transaction_from_bytes(&bytes).unwrap(), tx);
+        assert!(bytes.len() < serde_json::to_vec(&tx).unwrap().len());
+
+        let txs = (0..3).map(completed_transaction).collect::<Vec<_>>();
+        let bytes = completed_transactions_to_bytes(&txs).unwrap();
+        assert_eq!(completed_transactions_from_bytes(&bytes).unwrap(), txs);
+    }
+
+    #[test]
+    fn it_rejects_other_kinds_and_versions() {
+        let tx = completed_transaction(1);
+        let mut bytes = completed_transaction_to_bytes(&tx).unwrap();
+        assert!(completed_transactions_from_bytes(&bytes).is_err());
+        assert!(unblinded_output_from_bytes(&bytes).is_err());
+        assert!(completed_transaction_from_bytes(&bytes[..HEADER_SIZE + 10]).is_err());
+
+        bytes[2] = BINARY_FORMAT_VERSION + 1;
+        assert!(completed_transaction_from_bytes(&bytes).is_err());
+        assert!(completed_transaction_from_bytes(b"{}").is_err());
+    }
+}
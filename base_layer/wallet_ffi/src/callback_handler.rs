@@ -35,7 +35,7 @@
 //! request_key is used to identify which request this callback references and a result of true means it was successful
 //! and false that the process timed out and new one will be started
 
-use std::{ops::Deref, sync::Arc};
+use std::{ops::Deref, sync::Arc, time::Duration};
 
 use log::*;
 use minotari_wallet::{
@@ -57,15 +57,109 @@ use minotari_wallet::{
     },
 };
 use tari_common_types::{tari_address::TariAddress, transaction::TxId, types::BlockHash};
+use tari_comms::peer_manager::NodeId;
 use tari_comms_dht::event::{DhtEvent, DhtEventReceiver};
 use tari_contacts::contacts_service::handle::{ContactsLivenessData, ContactsLivenessEvent};
 use tari_shutdown::ShutdownSignal;
-use tokio::sync::{broadcast, watch};
+use tokio::{
+    sync::{broadcast, watch},
+    time::{self, Instant},
+};
 
 use crate::ffi_basenode_state::TariBaseNodeState;
 
 const LOG_TARGET: &str = "wallet::transaction_service::callback_handler";
 
+/// The default width of the latency buckets the base node state callback compares latencies in
+pub const DEFAULT_LATENCY_BUCKET: Duration = Duration::from_millis(100);
+
+/// How often the base node state and connectivity status callbacks may fire. A state that is unchanged since the last
+/// callback is never delivered again, and a state that changes within `min_interval` of the last callback is held back
+/// and delivered, in its latest form, when the interval ends.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StateCallbackThrottle {
+    /// The minimum time between two callbacks of the same kind, zero to deliver every change as it happens
+    pub min_interval: Duration,
+    /// Base node latencies within the same bucket of this width are treated as unchanged, zero to compare them exactly
+    pub latency_bucket: Duration,
+}
+
+impl Default for StateCallbackThrottle {
+    fn default() -> Self {
+        Self {
+            min_interval: Duration::ZERO,
+            latency_bucket: DEFAULT_LATENCY_BUCKET,
+        }
+    }
+}
+
+/// The fields of a base node state that are worth a callback when they change
+#[derive(Debug, Clone, PartialEq, Eq)]
+struct BaseNodeStateKey {
+    node_id: Option<NodeId>,
+    best_block_height: u64,
+    is_node_synced: bool,
+    latency_bucket: u64,
+}
+
+/// Coalesces the updates of one kind of state into the callbacks that should be made for it, see
+/// `StateCallbackThrottle`
+pub(crate) struct CoalescedState<K, T> {
+    delivered_key: Option<K>,
+    delivered_at: Option<Instant>,
+    pending: Option<(K, T)>,
+}
+
+impl<K: PartialEq, T> CoalescedState<K, T> {
+    pub fn new() -> Self {
+        Self {
+            delivered_key: None,
+            delivered_at: None,
+            pending: None,
+        }
+    }
+
+    /// Offers the latest state, identified by `key`, and returns it if its callback should be made now
+    pub fn offer(&mut self, key: K, state: T, min_interval: Duration, now: Instant) -> Option<T> {
+        if self.delivered_key.as_ref() == Some(&key) {
+            // Back to what the client already has, so anything held back is stale
+            self.pending = None;
+            return None;
+        }
+        match self.delivered_at {
+            Some(delivered_at) if now < delivered_at + min_interval => {
+                self.pending = Some((key, state));
+                None
+            },
+            _ => {
+                self.pending = None;
+                self.delivered_key = Some(key);
+                self.delivered_at = Some(now);
+                Some(state)
+            },
+        }
+    }
+
+    /// The time at which the held back state is due, if there is one
+    pub fn due_at(&self, min_interval: Duration) -> Option<Instant> {
+        self.pending
+            .as_ref()
+            .and(self.delivered_at)
+            .map(|delivered_at| delivered_at + min_interval)
+    }
+
+    /// Returns the held back state if its callback is due
+    pub fn take_due(&mut self, min_interval: Duration, now: Instant) -> Option<T> {
+        if self.due_at(min_interval).filter(|due_at| *due_at <= now).is_none() {
+            return None;
+        }
+        let (key, state) = self.pending.take()?;
+        self.delivered_key = Some(key);
+        self.delivered_at = Some(now);
+        Some(state)
+    }
+}
+
 pub struct CallbackHandler<TBackend>
 where TBackend: TransactionBackend + 'static
 {
@@ -97,6 +191,9 @@ where TBackend: TransactionBackend + 'static
     balance_cache: Balance,
     connectivity_status_watch: watch::Receiver<OnlineStatus>,
     contacts_liveness_events: broadcast::Receiver<Arc<ContactsLivenessEvent>>,
+    state_callback_throttle: watch::Receiver<StateCallbackThrottle>,
+    base_node_state: CoalescedState<BaseNodeStateKey, TariBaseNodeState>,
+    connectivity_status: CoalescedState<OnlineStatus, OnlineStatus>,
 }
 
 impl<TBackend> CallbackHandler<TBackend>
@@ -226,9 +323,19 @@ where TBackend: TransactionBackend + 'static
             balance_cache: Balance::zero(),
             connectivity_status_watch,
             contacts_liveness_events,
+            state_callback_throttle: watch::channel(StateCallbackThrottle::default()).1,
+            base_node_state: CoalescedState::new(),
+            connectivity_status: CoalescedState::new(),
         }
     }
 
+    /// Throttles the base node state and connectivity status callbacks with the latest value of `throttle`, which the
+    /// client can change while the handler runs
+    pub fn with_state_callback_throttle(mut self, throttle: watch::Receiver<StateCallbackThrottle>) -> Self {
+        self.state_callback_throttle = throttle;
+        self
+    }
+
     #[allow(clippy::too_many_lines)]
     pub async fn start(mut self) {
         let mut shutdown_signal = self
@@ -239,6 +346,7 @@ where TBackend: TransactionBackend + 'static
         info!(target: LOG_TARGET, "Transaction Service Callback Handler starting");
 
         loop {
+            let held_back_state_due_at = self.held_back_state_due_at();
             tokio::select! {
                 result = self.transaction_service_event_stream.recv() => {
                     match result {
@@ -390,6 +498,11 @@ where TBackend: TransactionBackend + 'static
                         Err(broadcast::error::RecvError::Closed) => {}
                     }
                 }
+                _ = time::sleep_until(held_back_state_due_at.unwrap_or_else(Instant::now)),
+                    if held_back_state_due_at.is_some() => {
+                    self.deliver_held_back_states();
+                },
+
                  _ = shutdown_signal.wait() => {
                     info!(target: LOG_TARGET, "Transaction Callback Handler shutting down because the shutdown signal was received");
                     break;
@@ -643,6 +756,18 @@ where TBackend: TransactionBackend + 'static
     }
 
     fn connectivity_status_changed(&mut self, status: OnlineStatus) {
+        let min_interval = self.state_callback_throttle.borrow().min_interval;
+        if let Some(status) = self
+            .connectivity_status
+            .offer(status, status, min_interval, Instant::now())
+        {
+            self.deliver_connectivity_status(status);
+        } else {
+            trace!(target: LOG_TARGET, "Connectivity status callback held back or unchanged");
+        }
+    }
+
+    fn deliver_connectivity_status(&mut self, status: OnlineStatus) {
         debug!(
             target: LOG_TARGET,
             "Calling Connectivity Status changed callback function"
@@ -655,8 +780,6 @@ where TBackend: TransactionBackend + 'static
     // casting here is okay as we dont care about the super high latency
     #[allow(clippy::cast_possible_truncation)]
     fn base_node_state_changed(&mut self, state: BaseNodeState) {
-        debug!(target: LOG_TARGET, "Calling Base Node State changed callback function");
-
         let state = match state.chain_metadata {
             None => TariBaseNodeState {
                 node_id: state.node_id,
@@ -683,8 +806,54 @@ where TBackend: TransactionBackend + 'static
             },
         };
 
+        let throttle = *self.state_callback_throttle.borrow();
+        let latency_bucket = match throttle.latency_bucket.as_millis() as u64 {
+            0 => state.latency,
+            width => state.latency / width,
+        };
+        let key = BaseNodeStateKey {
+            node_id: state.node_id.clone(),
+            best_block_height: state.best_block_height,
+            is_node_synced: state.is_node_synced,
+            latency_bucket,
+        };
+        if let Some(state) = self
+            .base_node_state
+            .offer(key, state, throttle.min_interval, Instant::now())
+        {
+            self.deliver_base_node_state(state);
+        } else {
+            trace!(target: LOG_TARGET, "Base node state callback held back or unchanged");
+        }
+    }
+
+    fn deliver_base_node_state(&mut self, state: TariBaseNodeState) {
+        debug!(target: LOG_TARGET, "Calling Base Node State changed callback function");
         unsafe {
             (self.callback_base_node_state)(Box::into_raw(Box::new(state)));
         }
     }
+
+    /// The earliest time at which a held back base node state or connectivity status is due
+    fn held_back_state_due_at(&self) -> Option<Instant> {
+        let min_interval = self.state_callback_throttle.borrow().min_interval;
+        match (
+            self.base_node_state.due_at(min_interval),
+            self.connectivity_status.due_at(min_interval),
+        ) {
+            (Some(a), Some(b)) => Some(a.min(b)),
+            (a, b) => a.or(b),
+        }
+    }
+
+    fn deliver_held_back_states(&mut self) {
+        let min_interval = self.state_callback_throttle.borrow().min_interval;
+        let now = Instant::now();
+        if let Some(state) = self.base_node_state.take_due(min_interval, now) {
+            self.deliver_base_node_state(state);
+        }
+        if let Some(status) = self.connectivity_status.take_due(min_interval, now) {
+            self.deliver_connectivity_status(status);
+        }
+    }
 }
@@ -61,7 +61,7 @@ mod test {
     };
 
     use crate::{
-        callback_handler::CallbackHandler,
+        callback_handler::{CallbackHandler, CoalescedState},
         ffi_basenode_state::TariBaseNodeState,
         output_manager_service_mock::MockOutputManagerService,
     };
@@ -870,4 +870,34 @@ mod test {
 
         drop(lock);
     }
+
+    #[test]
+    fn test_coalesced_state_callbacks() {
+        let min_interval = Duration::from_secs(1);
+        let start = Instant::now();
+        let mut state = CoalescedState::new();
+
+        // The first state is delivered immediately and an unchanged one is dropped
+        assert_eq!(state.offer(1, "one", min_interval, start), Some("one"));
+        assert_eq!(state.offer(1, "one again", min_interval, start), None);
+        assert_eq!(state.due_at(min_interval), None);
+
+        // Changes within the interval are held back, and only the latest is delivered when the interval ends
+        let soon = start + Duration::from_millis(100);
+        assert_eq!(state.offer(2, "two", min_interval, soon), None);
+        assert_eq!(state.offer(3, "three", min_interval, soon), None);
+        assert_eq!(state.due_at(min_interval), Some(start + min_interval));
+        assert_eq!(state.take_due(min_interval, soon), None);
+        assert_eq!(state.take_due(min_interval, start + min_interval), Some("three"));
+        assert_eq!(state.due_at(min_interval), None);
+
+        // A held back change that is reverted before the interval ends is never delivered
+        let later = start + min_interval + Duration::from_millis(100);
+        assert_eq!(state.offer(4, "four", min_interval, later), None);
+        assert_eq!(state.offer(3, "three", min_interval, later), None);
+        assert_eq!(state.due_at(min_interval), None);
+
+        // Without an interval every change is delivered as it happens
+        assert_eq!(state.offer(5, "five", Duration::ZERO, later), Some("five"));
+    }
 }
@@ -59,6 +59,8 @@ pub enum InterfaceError {
     InvalidArgument(String),
     #[error("Balance Unavailable")]
     BalanceError,
+    #[error("An error has occurred reading or writing a file: `{0}`")]
+    FileError(String),
 }
 
 /// This struct is meant to hold an error for use by FFI client applications. The error has an integer code and string
@@ -106,6 +108,10 @@ impl From<InterfaceError> for LibWalletError {
                 code: 9,
                 message: format!("Pointer error on {}:{:?}", p, v),
             },
+            InterfaceError::FileError(_) => Self {
+                code: 10,
+                message: format!("{:?}", v),
+            },
         }
     }
 }
@@ -235,6 +241,10 @@ impl From<WalletError> for LibWalletError {
                 code: 212,
                 message: format!("{:?}", w),
             },
+            WalletError::TransactionServiceError(TransactionServiceError::BatchPartiallySent { .. }) => Self {
+                code: 213,
+                message: format!("{:?}", w),
+            },
             WalletError::TransactionServiceError(_) => Self {
                 code: 211,
                 message: format!("{:?}", w),
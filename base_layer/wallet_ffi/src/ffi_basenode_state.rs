@@ -330,6 +330,23 @@ pub unsafe extern "C" fn basenode_state_get_latency(ptr: *mut TariBaseNodeState,
     (*ptr).latency
 }
 
+/// Frees memory for a `TariBaseNodeState`
+///
+/// ## Arguments
+/// `ptr` - The pointer to a `TariBaseNodeState`
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn basenode_state_destroy(ptr: *mut TariBaseNodeState) {
+    if !ptr.is_null() {
+        drop(Box::from_raw(ptr))
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use tari_common_types::types::FixedHash;
@@ -411,6 +428,8 @@ mod tests {
 
             assert_eq!(basenode_state_get_latency(boxed_state, &mut error_code), 115);
             assert_eq!(error_code, 0);
+
+            basenode_state_destroy(boxed_state);
         }
     }
 }
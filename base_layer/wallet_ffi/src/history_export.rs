@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright 2024. The Tari Project
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+// disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+// following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+// products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//! Streams the completed transaction history of a wallet to a file a page at a time, so that exporting millions of
+//! transactions needs no more memory than a single page.
+
+use std::{
+    convert::TryFrom,
+    fs::{self, File},
+    io::{self, BufWriter, Write},
+    path::{Path, PathBuf},
+};
+
+use chrono::NaiveDateTime;
+use minotari_wallet::transaction_service::{
+    error::TransactionServiceError,
+    handle::TransactionServiceHandle,
+    storage::models::CompletedTransaction,
+};
+use tari_utilities::hex::Hex;
+use thiserror::Error;
+
+use crate::binary_codec;
+
+/// The number of transactions read, decrypted and written at a time
+pub const EXPORT_HISTORY_PAGE_SIZE: usize = 1000;
+
+const CSV_HEADER: &str = "tx_id,timestamp,direction,status,cancelled,amount,fee,source_address,destination_address,\
+                          mined_height,mined_timestamp,mined_in_block,signature_nonce,signature,payment_id,message";
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum HistoryFormat {
+    /// One row per transaction with a header row, amounts in micro MinoTari and timestamps in UTC
+    Csv,
+    /// A sequence of records, each the little endian `u32` length of a `tari_completed_transaction_to_bytes`
+    /// buffer followed by the buffer
+    Binary,
+}
+
+#[derive(Debug, Error)]
+pub enum HistoryExportError {
+    #[error("IO error: `{0}`")]
+    Io(#[from] io::Error),
+    #[error("Transaction service error: `{0}`")]
+    TransactionService(#[from] TransactionServiceError),
+    #[error("Encoding error: `{0}`")]
+    Encoding(String),
+}
+
+/// Writes every completed transaction, cancelled or not, with a timestamp in `[from_time, to_time)` to `path` in
+/// timestamp order. The export is written next to `path` and only renamed into place once complete, so an interrupted
+/// export never leaves a truncated file behind. `progress` is called with the number of transactions written after
+/// every page. Returns the number of transactions written.
+pub async fn export_history<F: FnMut(u64)>(
+    mut transaction_service: TransactionServiceHandle,
+    path: &Path,
+    format: HistoryFormat,
+    from_time: Option<NaiveDateTime>,
+    to_time: Option<NaiveDateTime>,
+    mut progress: F,
+) -> Result<u64, HistoryExportError> {
+    let partial_path = partial_path(path);
+    let mut writer = BufWriter::new(File::create(&partial_path)?);
+    let result = async move {
+        if format == HistoryFormat::Csv {
+            writeln!(writer, "{}", CSV_HEADER)?;
+        }
+        let mut written = 0u64;
+        let mut after = None;
+        loop {
+            let page = transaction_service
+                .get_completed_transactions_page(from_time, to_time, after, EXPORT_HISTORY_PAGE_SIZE)
+                .await?;
+            for tx in &page {
+                match format {
+                    HistoryFormat::Csv => write_csv_row(&mut writer, tx)?,
+                    HistoryFormat::Binary => {
+                        let bytes =
+                            binary_codec::completed_transaction_to_bytes(tx).map_err(HistoryExportError::Encoding)?;
+                        let len = u32::try_from(bytes.len()).map_err(|_| {
+                            HistoryExportError::Encoding(format!("Transaction {} is too large to export", tx.tx_id))
+                        })?;
+                        writer.write_all(&len.to_le_bytes())?;
+                        writer.write_all(&bytes)?;
+                    },
+                }
+            }
+            written += page.len() as u64;
+            after = match page.last() {
+                Some(tx) => Some((tx.timestamp, tx.tx_id)),
+                None => break,
+            };
+            progress(written);
+            if page.len() < EXPORT_HISTORY_PAGE_SIZE {
+                break;
+            }
+        }
+        writer.flush()?;
+        writer.get_ref().sync_all()?;
+        Ok(written)
+    }
+    .await;
+
+    match result {
+        Ok(written) => {
+            fs::rename(&partial_path, path)?;
+            Ok(written)
+        },
+        Err(e) => {
+            let _result = fs::remove_file(&partial_path);
+            Err(e)
+        },
+    }
+}
+
+fn partial_path(path: &Path) -> PathBuf {
+    let mut file_name = path.file_name().unwrap_or_default().to_os_string();
+    file_name.push(".partial");
+    path.with_file_name(file_name)
+}
+
+fn format_timestamp(timestamp: &NaiveDateTime) -> String {
+    timestamp.format("%Y-%m-%dT%H:%M:%S%.6fZ").to_string()
+}
+
+/// Quotes a CSV field if it contains a separator, quote or line break
+fn csv_field(value: &str) -> String {
+    if value.contains(|c| matches!(c, ',' | '"' | '\n' | '\r')) {
+        format!("\"{}\"", value.replace('"', "\"\""))
+    } else {
+        value.to_string()
+    }
+}
+
+fn write_csv_row<W: Write>(writer: &mut W, tx: &CompletedTransaction) -> io::Result<()> {
+    writeln!(
+        writer,
+        "{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}",
+        tx.tx_id,
+        format_timestamp(&tx.timestamp),
+        tx.direction,
+        tx.status,
+        tx.cancelled.map(|reason| reason.to_string()).unwrap_or_default(),
+        tx.amount.as_u64(),
+        tx.fee.as_u64(),
+        tx.source_address.to_base58(),
+        tx.destination_address.to_base58(),
+        tx.mined_height.map(|h| h.to_string()).unwrap_or_default(),
+        tx.mined_timestamp.as_ref().map(format_timestamp).unwrap_or_default(),
+        tx.mined_in_block.map(|hash| hash.to_hex()).unwrap_or_default(),
+        tx.transaction_signature.get_public_nonce().to_hex(),
+        tx.transaction_signature.get_signature().to_hex(),
+        csv_field(&tx.payment_id.as_ref().map(|id| id.to_string()).unwrap_or_default()),
+        csv_field(&tx.message),
+    )
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn it_quotes_csv_fields_only_when_needed() {
+        assert_eq!(csv_field("plain message"), "plain message");
+        assert_eq!(csv_field("a, b"), "\"a, b\"");
+        assert_eq!(csv_field("say \"hi\"\n"), "\"say \"\"hi\"\"\n\"");
+    }
+
+    #[test]
+    fn it_exports_next_to_the_destination() {
+        assert_eq!(
+            partial_path(Path::new("/tmp/history.csv")),
+            PathBuf::from("/tmp/history.csv.partial")
+        );
+    }
+}
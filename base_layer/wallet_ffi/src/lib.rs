@@ -61,9 +61,9 @@ use std::{
     time::Duration,
 };
 
-use chrono::{DateTime, Local};
+use chrono::{DateTime, Local, NaiveDateTime};
 use error::LibWalletError;
-use ffi_basenode_state::TariBaseNodeState;
+pub use ffi_basenode_state::{basenode_state_destroy, TariBaseNodeState};
 use itertools::Itertools;
 use libc::{c_char, c_int, c_uchar, c_uint, c_ulonglong, c_ushort, c_void};
 use log::*;
@@ -86,27 +86,40 @@ use minotari_wallet::{
     output_manager_service::{
         error::OutputManagerError,
         storage::{
-            database::{OutputBackendQuery, OutputManagerDatabase, SortDirection},
+            database::{OutputBackendQuery, OutputManagerDatabase, OutputQueryCursor, SortDirection},
             models::DbWalletOutput,
+            sqlite_db::OutputManagerSqliteDatabase,
             OutputStatus,
         },
+        utxo_compaction::UtxoCompactionPolicy,
         UtxoSelectionCriteria,
     },
     storage::{
         database::WalletDatabase,
         sqlite_db::wallet::WalletSqliteDatabase,
-        sqlite_utilities::{get_last_network, get_last_version, initialize_sqlite_database_backends},
+        sqlite_utilities::{
+            get_last_network,
+            get_last_version,
+            initialize_sqlite_database_backends,
+            open_sqlite_database_backends_readonly,
+            SqlitePerformanceProfile,
+            SqliteSynchronous,
+            SqliteTempStore,
+        },
     },
     transaction_service::{
         config::TransactionServiceConfig,
         error::TransactionServiceError,
+        handle::PaymentRecipient,
         storage::{
             database::TransactionDatabase,
             models::{CompletedTransaction, InboundTransaction, OutboundTransaction},
+            sqlite_db::TransactionServiceSqliteDatabase,
         },
     },
     utxo_scanner_service::{service::UtxoScannerService, RECOVERY_KEY},
     wallet::{derive_comms_secret_key, read_or_create_master_seed, WalletMessageSigningDomain},
+    wallet_host::WalletHost,
     Wallet,
     WalletConfig,
     WalletSqlite,
@@ -179,22 +192,25 @@ use tari_utilities::{
     hex::{Hex, HexError},
     SafePassword,
 };
-use tokio::runtime::Runtime;
+use tokio::{runtime::Runtime, sync::watch, task::JoinHandle};
 use zeroize::Zeroize;
 
 use crate::{
-    callback_handler::CallbackHandler,
+    callback_handler::{CallbackHandler, StateCallbackThrottle},
     enums::SeedWordPushResult,
     error::{InterfaceError, TransactionError},
+    history_export::{HistoryExportError, HistoryFormat},
     tasks::recovery_event_monitoring,
 };
 
+mod binary_codec;
 mod callback_handler;
 #[cfg(test)]
 mod callback_handler_tests;
 mod enums;
 mod error;
 mod ffi_basenode_state;
+mod history_export;
 #[cfg(test)]
 mod output_manager_service_mock;
 mod tasks;
@@ -205,6 +221,11 @@ mod consts {
 }
 
 const LOG_TARGET: &str = "wallet_ffi";
+/// The most runtime worker threads used by default, enough for several wallets without oversubscribing the few cores of
+/// a mobile device
+const DEFAULT_RUNTIME_WORKER_THREADS: usize = 4;
+/// The default limit on runtime threads for blocking work such as database access
+const DEFAULT_RUNTIME_MAX_BLOCKING_THREADS: usize = 64;
 
 pub type TariTransportConfig = TransportConfig;
 pub type TariPublicKey = PublicKey;
@@ -219,6 +240,10 @@ pub type TariCovenant = tari_core::covenants::Covenant;
 pub type TariEncryptedOpenings = tari_core::transactions::transaction_components::EncryptedData;
 pub type TariComAndPubSignature = ComAndPubSignature;
 pub type TariUnblindedOutput = UnblindedOutput;
+/// A tokio runtime that can be shared by several wallets and chat clients
+pub type TariRuntime = Arc<Runtime>;
+pub type TariSqliteProfile = SqlitePerformanceProfile;
+pub type TariUtxoCompactionPolicy = UtxoCompactionPolicy;
 pub struct TariUnblindedOutputs(Vec<UnblindedOutput>);
 
 pub struct TariContacts(Vec<TariContact>);
@@ -230,6 +255,7 @@ pub type TariFeePerGramStats = minotari_wallet::transaction_service::handle::Fee
 pub type TariFeePerGramStat = tari_core::mempool::FeePerGramStat;
 pub type TariContactsLivenessData = tari_contacts::contacts_service::handle::ContactsLivenessData;
 pub type TariBalance = minotari_wallet::output_manager_service::service::Balance;
+pub type TariBroadcastQueueStats = minotari_wallet::transaction_service::broadcast_scheduler::BroadcastQueueStats;
 pub type TariMnemonicLanguage = MnemonicLanguage;
 
 pub struct TariCompletedTransactions(Vec<TariCompletedTransaction>);
@@ -241,6 +267,10 @@ pub struct TariPendingInboundTransactions(Vec<TariPendingInboundTransaction>);
 
 pub struct TariPendingOutboundTransactions(Vec<TariPendingOutboundTransaction>);
 
+/// Keyset pagination position for `wallet_get_utxos_after`, `None` until the first page has been fetched
+#[derive(Debug, Default)]
+pub struct TariUtxoCursor(Option<OutputQueryCursor>);
+
 #[derive(Debug, PartialEq, Clone)]
 pub struct ByteVector(Vec<c_uchar>); // declared like this so that it can be exposed to external header
 
@@ -255,10 +285,26 @@ pub struct TariPublicKeys(Vec<TariPublicKey>);
 
 pub struct TariWallet {
     wallet: WalletSqlite,
-    runtime: Runtime,
+    runtime: Arc<Runtime>,
+    shutdown: Shutdown,
+    /// Whether the wallet runs on the network stack of a TariWalletHost
+    hosted: bool,
+    state_callback_throttle: watch::Sender<StateCallbackThrottle>,
+    callback_handler: JoinHandle<()>,
+}
+
+pub struct TariWalletHost {
+    host: WalletHost,
+    runtime: Arc<Runtime>,
     shutdown: Shutdown,
 }
 
+pub struct TariWalletReader {
+    wallet_db: WalletDatabase<WalletSqliteDatabase>,
+    output_db: OutputManagerDatabase<OutputManagerSqliteDatabase>,
+    transaction_db: TransactionDatabase<TransactionServiceSqliteDatabase>,
+}
+
 #[derive(Debug)]
 #[repr(C)]
 pub struct TariCoinPreview {
@@ -266,6 +312,13 @@ pub struct TariCoinPreview {
     pub fee: u64,
 }
 
+#[derive(Debug)]
+#[repr(C)]
+pub struct TariUtxoImportResults {
+    pub tx_ids: *mut TariVector,
+    pub error_codes: *mut TariVector,
+}
+
 #[derive(Debug)]
 #[repr(C)]
 pub enum TariUtxoSort {
@@ -275,6 +328,17 @@ pub enum TariUtxoSort {
     MinedHeightDesc = 3,
 }
 
+impl TariUtxoSort {
+    fn as_query_sorting(&self) -> (&'static str, SortDirection) {
+        match self {
+            TariUtxoSort::MinedHeightAsc => ("mined_height", SortDirection::Asc),
+            TariUtxoSort::MinedHeightDesc => ("mined_height", SortDirection::Desc),
+            TariUtxoSort::ValueAsc => ("value", SortDirection::Asc),
+            TariUtxoSort::ValueDesc => ("value", SortDirection::Desc),
+        }
+    }
+}
+
 #[derive(Debug, Copy, Clone, Eq, PartialEq)]
 #[repr(C)]
 pub enum TariTypeTag {
@@ -484,6 +548,34 @@ impl TariVector {
             .try_collect::<Commitment, Vec<Commitment>, InterfaceError>()
     }
 
+    /// Parses a vector of hex strings into public keys without taking ownership of the vector
+    fn to_public_key_vec(&self) -> Result<Vec<TariPublicKey>, InterfaceError> {
+        if self.tag != TariTypeTag::Text {
+            return Err(InterfaceError::InvalidArgument(format!(
+                "expecting String, got {}",
+                self.tag
+            )));
+        }
+
+        if self.ptr.is_null() {
+            return Err(InterfaceError::NullError(String::from(
+                "tari vector of strings has null pointer",
+            )));
+        }
+
+        unsafe { slice::from_raw_parts(self.ptr as *const *const c_char, self.len) }
+            .iter()
+            .map(|x| {
+                let hex = unsafe { CStr::from_ptr(*x) }
+                    .to_str()
+                    .map_err(|e| InterfaceError::PointerError(format!("invalid public key string: {:?}", e)))?;
+                TariPublicKey::from_hex(hex).map_err(|e| {
+                    InterfaceError::InvalidArgument(format!("failed to convert hex to public key: {:?}", e))
+                })
+            })
+            .collect()
+    }
+
     #[allow(dead_code)]
     pub fn to_utxo_vec(&self) -> Result<Vec<TariUtxo>, InterfaceError> {
         if self.tag != TariTypeTag::Utxo {
@@ -619,6 +711,25 @@ pub unsafe extern "C" fn destroy_tari_coin_preview(p: *mut TariCoinPreview) {
     }
 }
 
+/// Frees memory allocated for `TariUtxoImportResults`.
+///
+/// ## Arguments
+/// `r` - The pointer to `TariUtxoImportResults`
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn destroy_tari_utxo_import_results(r: *mut TariUtxoImportResults) {
+    if !r.is_null() {
+        let x = Box::from_raw(r);
+        destroy_tari_vector(x.tx_ids);
+        destroy_tari_vector(x.error_codes);
+    }
+}
+
 /// -------------------------------- Strings ------------------------------------------------ ///
 
 /// Frees memory for a char array
@@ -1945,6 +2056,81 @@ pub unsafe extern "C" fn create_tari_unblinded_output_from_json(
     }
 }
 
+/// Serializes a TariUnblindedOutput into the compact binary format, a smaller and faster alternative to
+/// `tari_unblinded_output_to_json`. The buffer starts with a versioned header and is read back with
+/// `create_tari_unblinded_output_from_bytes`, which rejects buffers of another format version.
+///
+/// ## Arguments
+/// `output` - The pointer to a TariUnblindedOutput
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut ByteVector` - Returns a pointer to a ByteVector, note that it returns ptr::null_mut() if output is null or
+/// cannot be serialized
+///
+/// # Safety
+/// The ```byte_vector_destroy``` function must be called when finished with the ByteVector to prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn tari_unblinded_output_to_bytes(
+    output: *mut TariUnblindedOutput,
+    error_out: *mut c_int,
+) -> *mut ByteVector {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if output.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("output".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    match binary_codec::unblinded_output_to_bytes(&*output) {
+        Ok(bytes) => Box::into_raw(Box::new(ByteVector(bytes))),
+        Err(e) => {
+            error!(target: LOG_TARGET, "Error serializing a TariUnblindedOutput: {}", e);
+            error = LibWalletError::from(InterfaceError::InvalidArgument("output".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Creates a TariUnblindedOutput from a buffer written by `tari_unblinded_output_to_bytes`
+///
+/// ## Arguments
+/// `bytes` - The pointer to a ByteVector holding the binary encoded TariUnblindedOutput
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariUnblindedOutput` - Returns a pointer to a TariUnblindedOutput. Note that it returns ptr::null_mut() if
+/// bytes is null, or is not a supported version of the binary encoding of a TariUnblindedOutput
+///
+/// # Safety
+/// The ```tari_unblinded_output_destroy``` function must be called when finished with a TariUnblindedOutput to prevent
+/// a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn create_tari_unblinded_output_from_bytes(
+    bytes: *const ByteVector,
+    error_out: *mut c_int,
+) -> *mut TariUnblindedOutput {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if bytes.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("bytes".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    match binary_codec::unblinded_output_from_bytes(&(*bytes).0) {
+        Ok(v) => Box::into_raw(Box::new(v)),
+        Err(e) => {
+            error!(target: LOG_TARGET, "Error creating a TariUnblindedOutput from bytes: {}", e);
+            error = LibWalletError::from(InterfaceError::InvalidArgument("bytes".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
 /// -------------------------------------------------------------------------------------------- ///
 
 /// ----------------------------------- TariUnblindedOutputs ------------------------------------///
@@ -2178,6 +2364,99 @@ pub unsafe extern "C" fn wallet_import_external_utxo_as_non_rewindable(
         },
     }
 }
+/// Import a batch of external UTXOs into the wallet as non-rewindable (i.e. non-recoverable) outputs, as
+/// `wallet_import_external_utxo_as_non_rewindable` does for one. The metadata signature and range proof of every output
+/// are verified in parallel first, then all the outputs and their faux completed transactions are written in one
+/// database transaction per service.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer
+/// `outputs` - The pointer to a TariUnblindedOutputs
+/// `source_address` - The tari address of the source of the transactions, may be null
+/// `message` - The message that the transactions will have, "Imported UTXO" is used if it is null
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariUtxoImportResults` - Returns, for each output in order, the TransactionID of the generated transaction and
+/// an error code. The TransactionID is zero and the error code is set for an output that was not imported, such as an
+/// invalid output or one the wallet already has. Note that it returns ptr::null_mut() if the batch could not be
+/// imported at all.
+///
+/// # Safety
+/// The ```destroy_tari_utxo_import_results``` method must be called when finished with the result to prevent a memory
+/// leak
+#[no_mangle]
+pub unsafe extern "C" fn wallet_import_external_utxos_as_non_rewindable(
+    wallet: *mut TariWallet,
+    outputs: *mut TariUnblindedOutputs,
+    source_address: *mut TariWalletAddress,
+    message: *const c_char,
+    error_out: *mut c_int,
+) -> *mut TariUtxoImportResults {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    if outputs.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("outputs".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    };
+    let source_address = if source_address.is_null() {
+        TariWalletAddress::default()
+    } else {
+        (*source_address).clone()
+    };
+    let message_string = if message.is_null() {
+        "Imported UTXO".to_string()
+    } else {
+        match CStr::from_ptr(message).to_str() {
+            Ok(v) => v.to_owned(),
+            Err(_) => {
+                error = LibWalletError::from(InterfaceError::PointerError("message".to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        }
+    };
+    match (*wallet)
+        .runtime
+        .block_on((*wallet).wallet.import_unblinded_outputs_as_non_rewindable(
+            (*outputs).0.clone(),
+            source_address,
+            message_string,
+        )) {
+        Ok(results) => {
+            let mut tx_ids = Vec::with_capacity(results.len());
+            let mut error_codes = Vec::with_capacity(results.len());
+            for result in results {
+                match result {
+                    Ok(tx_id) => {
+                        tx_ids.push(tx_id.as_u64());
+                        error_codes.push(0i64);
+                    },
+                    Err(e) => {
+                        tx_ids.push(0);
+                        error_codes.push(i64::from(LibWalletError::from(e).code));
+                    },
+                }
+            }
+            Box::into_raw(Box::new(TariUtxoImportResults {
+                tx_ids: Box::into_raw(Box::new(TariVector::from(tx_ids))),
+                error_codes: Box::into_raw(Box::new(TariVector::from(error_codes))),
+            }))
+        },
+        Err(e) => {
+            error = LibWalletError::from(e).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
 /// -------------------------------------------------------------------------------------------- ///
 /// -------------------------------- Private Key ----------------------------------------------- ///
 
@@ -3604,6 +3883,82 @@ pub unsafe extern "C" fn completed_transactions_get_at(
     Box::into_raw(Box::new((*transactions).0[position as usize].clone()))
 }
 
+/// Serializes a TariCompletedTransactions into the compact binary format, a smaller and faster alternative to
+/// serializing each transaction with `tari_completed_transaction_to_json`. The buffer starts with a versioned header
+/// and is read back with `completed_transactions_from_bytes`, which rejects buffers of another format version.
+///
+/// ## Arguments
+/// `transactions` - The pointer to a TariCompletedTransactions
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut ByteVector` - Returns a pointer to a ByteVector, note that it returns ptr::null_mut() if transactions is null
+/// or cannot be serialized
+///
+/// # Safety
+/// The ```byte_vector_destroy``` function must be called when finished with the ByteVector to prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn completed_transactions_to_bytes(
+    transactions: *mut TariCompletedTransactions,
+    error_out: *mut c_int,
+) -> *mut ByteVector {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if transactions.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("transactions".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    match binary_codec::completed_transactions_to_bytes(&(*transactions).0) {
+        Ok(bytes) => Box::into_raw(Box::new(ByteVector(bytes))),
+        Err(e) => {
+            error!(target: LOG_TARGET, "Error serializing a TariCompletedTransactions: {}", e);
+            error = LibWalletError::from(InterfaceError::InvalidArgument("transactions".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Creates a TariCompletedTransactions from a buffer written by `completed_transactions_to_bytes`
+///
+/// ## Arguments
+/// `bytes` - The pointer to a ByteVector holding the binary encoded TariCompletedTransactions
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariCompletedTransactions` - Returns a pointer to a TariCompletedTransactions. Note that it returns
+/// ptr::null_mut() if bytes is null, or is not a supported version of the binary encoding of a
+/// TariCompletedTransactions
+///
+/// # Safety
+/// The ```completed_transactions_destroy``` function must be called when finished with a TariCompletedTransactions to
+/// prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn completed_transactions_from_bytes(
+    bytes: *const ByteVector,
+    error_out: *mut c_int,
+) -> *mut TariCompletedTransactions {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if bytes.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("bytes".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    match binary_codec::completed_transactions_from_bytes(&(*bytes).0) {
+        Ok(v) => Box::into_raw(Box::new(TariCompletedTransactions(v))),
+        Err(e) => {
+            error!(target: LOG_TARGET, "Error creating a TariCompletedTransactions from bytes: {}", e);
+            error = LibWalletError::from(InterfaceError::InvalidArgument("bytes".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
 /// Frees memory for a TariCompletedTransactions
 ///
 /// ## Arguments
@@ -4304,48 +4659,123 @@ pub unsafe extern "C" fn create_tari_completed_transaction_from_json(
     }
 }
 
-/// Frees memory for a TariCompletedTransaction
+/// Serializes a TariCompletedTransaction into the compact binary format, a smaller and faster alternative to
+/// `tari_completed_transaction_to_json`. The buffer starts with a versioned header and is read back with
+/// `create_tari_completed_transaction_from_bytes`, which rejects buffers of another format version.
 ///
 /// ## Arguments
-/// `transaction` - The pointer to a TariCompletedTransaction
+/// `tx` - The pointer to a TariCompletedTransaction
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
 ///
 /// ## Returns
-/// `()` - Does not return a value, equivalent to void in C
+/// `*mut ByteVector` - Returns a pointer to a ByteVector, note that it returns ptr::null_mut() if tx is null or
+/// cannot be serialized
 ///
 /// # Safety
-/// None
+/// The ```byte_vector_destroy``` function must be called when finished with the ByteVector to prevent a memory leak
 #[no_mangle]
-pub unsafe extern "C" fn completed_transaction_destroy(transaction: *mut TariCompletedTransaction) {
-    if !transaction.is_null() {
-        drop(Box::from_raw(transaction))
+pub unsafe extern "C" fn tari_completed_transaction_to_bytes(
+    tx: *mut TariCompletedTransaction,
+    error_out: *mut c_int,
+) -> *mut ByteVector {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if tx.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("tx".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    match binary_codec::completed_transaction_to_bytes(&*tx) {
+        Ok(bytes) => Box::into_raw(Box::new(ByteVector(bytes))),
+        Err(e) => {
+            error!(target: LOG_TARGET, "Error serializing a TariCompletedTransaction: {}", e);
+            error = LibWalletError::from(InterfaceError::InvalidArgument("tx".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
     }
 }
 
-/// -------------------------------------------------------------------------------------------- ///
-
-/// ----------------------------------- OutboundTransaction ------------------------------------- ///
-
-/// Gets the TransactionId of a TariPendingOutboundTransaction
+/// Creates a TariCompletedTransaction from a buffer written by `tari_completed_transaction_to_bytes`
 ///
 /// ## Arguments
-/// `transaction` - The pointer to a TariPendingOutboundTransaction
+/// `bytes` - The pointer to a ByteVector holding the binary encoded TariCompletedTransaction
 /// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
 /// as an out parameter.
 ///
 /// ## Returns
-/// `c_ulonglong` - Returns the TransactionID, note that it will be zero if transaction is null
+/// `*mut TariCompletedTransaction` - Returns a pointer to a TariCompletedTransaction. Note that it returns
+/// ptr::null_mut() if bytes is null, or is not a supported version of the binary encoding of a TariCompletedTransaction
 ///
 /// # Safety
-/// None
+/// The ```completed_transaction_destroy``` function must be called when finished with a TariCompletedTransaction to
+/// prevent a memory leak
 #[no_mangle]
-pub unsafe extern "C" fn pending_outbound_transaction_get_transaction_id(
-    transaction: *mut TariPendingOutboundTransaction,
+pub unsafe extern "C" fn create_tari_completed_transaction_from_bytes(
+    bytes: *const ByteVector,
     error_out: *mut c_int,
-) -> c_ulonglong {
+) -> *mut TariCompletedTransaction {
     let mut error = 0;
     ptr::swap(error_out, &mut error as *mut c_int);
-    if transaction.is_null() {
-        error = LibWalletError::from(InterfaceError::NullError("transaction".to_string())).code;
+    if bytes.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("bytes".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    match binary_codec::completed_transaction_from_bytes(&(*bytes).0) {
+        Ok(v) => Box::into_raw(Box::new(v)),
+        Err(e) => {
+            error!(target: LOG_TARGET, "Error creating a TariCompletedTransaction from bytes: {}", e);
+            error = LibWalletError::from(InterfaceError::InvalidArgument("bytes".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Frees memory for a TariCompletedTransaction
+///
+/// ## Arguments
+/// `transaction` - The pointer to a TariCompletedTransaction
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn completed_transaction_destroy(transaction: *mut TariCompletedTransaction) {
+    if !transaction.is_null() {
+        drop(Box::from_raw(transaction))
+    }
+}
+
+/// -------------------------------------------------------------------------------------------- ///
+
+/// ----------------------------------- OutboundTransaction ------------------------------------- ///
+
+/// Gets the TransactionId of a TariPendingOutboundTransaction
+///
+/// ## Arguments
+/// `transaction` - The pointer to a TariPendingOutboundTransaction
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `c_ulonglong` - Returns the TransactionID, note that it will be zero if transaction is null
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn pending_outbound_transaction_get_transaction_id(
+    transaction: *mut TariPendingOutboundTransaction,
+    error_out: *mut c_int,
+) -> c_ulonglong {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if transaction.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("transaction".to_string())).code;
         ptr::swap(error_out, &mut error as *mut c_int);
         return 0;
     }
@@ -5563,333 +5993,1142 @@ unsafe fn init_logging(
     }
 }
 
-/// Creates a TariWallet
+/// Builds a multi-threaded runtime, a value of zero selects the default for the number of threads
+fn build_runtime(worker_threads: usize, max_blocking_threads: usize) -> Result<Runtime, std::io::Error> {
+    let worker_threads = match worker_threads {
+        0 => std::thread::available_parallelism()
+            .map_or(1, |n| n.get())
+            .min(DEFAULT_RUNTIME_WORKER_THREADS),
+        n => n,
+    };
+    let max_blocking_threads = match max_blocking_threads {
+        0 => DEFAULT_RUNTIME_MAX_BLOCKING_THREADS,
+        n => n,
+    };
+    tokio::runtime::Builder::new_multi_thread()
+        .worker_threads(worker_threads)
+        .max_blocking_threads(max_blocking_threads)
+        .enable_all()
+        .build()
+}
+
+/// Creates a runtime that can be passed to `wallet_create` and to the chat client constructors, so that they share
+/// one set of threads instead of each starting a runtime with a worker per CPU core.
 ///
 /// ## Arguments
-/// `config` - The TariCommsConfig pointer
-/// `log_path` - An optional file path to the file where the logs will be written. If no log is required pass *null*
-/// pointer.
-/// `log_verbosity` - how verbose should logging be as a c_int 0-5, or 11
-///        0 => Off
-///        1 => Error
-///        2 => Warn
-///        3 => Info
-///        4 => Debug
-///        5 | 11 => Trace // Cranked up to 11
-/// `num_rolling_log_files` - Specifies how many rolling log files to produce, if no rolling files are wanted then set
-/// this to 0
-/// `size_per_log_file_bytes` - Specifies the size, in bytes, at which the logs files will roll over, if no
-/// rolling files are wanted then set this to 0
-/// `passphrase` - An optional string that represents the passphrase used to
-/// encrypt/decrypt the databases for this wallet. If it is left Null no encryption is used. If the databases have been
-/// encrypted then the correct passphrase is required or this function will fail.
-/// `seed_words` - An optional instance of TariSeedWords, used to create a wallet for recovery purposes.
-/// If this is null, then a new master key is created for the wallet.
-/// `callback_received_transaction` - The callback function pointer matching the function signature. This will be
-/// called when an inbound transaction is received.
-/// `callback_received_transaction_reply` - The callback function
-/// pointer matching the function signature. This will be called when a reply is received for a pending outbound
-/// transaction
-/// `callback_received_finalized_transaction` - The callback function pointer matching the function
-/// signature. This will be called when a Finalized version on an Inbound transaction is received
-/// `callback_transaction_broadcast` - The callback function pointer matching the function signature. This will be
-/// called when a Finalized transaction is detected a Broadcast to a base node mempool.
-/// `callback_transaction_mined` - The callback function pointer matching the function signature. This will be called
-/// when a Broadcast transaction is detected as mined AND confirmed.
-/// `callback_transaction_mined_unconfirmed` - The callback function pointer matching the function signature. This will
-/// be called when a Broadcast transaction is detected as mined but not yet confirmed.
-/// `callback_faux_transaction_confirmed` - The callback function pointer matching the function signature. This will be
-/// called when a one-sided transaction is detected as mined AND confirmed.
-/// `callback_faux_transaction_unconfirmed` - The callback function pointer matching the function signature. This
-/// will be called when a one-sided transaction is detected as mined but not yet confirmed.
-/// `callback_transaction_send_result` - The callback function pointer matching the function signature. This is called
-/// when a transaction send is completed. The first parameter is the transaction id and the second contains the
-/// transaction send status, weather it was send direct and/or send via saf on the one hand or queued for further retry
-/// sending on the other hand.
-///     !direct_send & !saf_send &  queued   = 0
-///      direct_send &  saf_send & !queued   = 1
-///      direct_send & !saf_send & !queued   = 2
-///     !direct_send &  saf_send & !queued   = 3
-///     any other combination (is not valid) = 4
-/// `callback_transaction_cancellation` - The callback function pointer matching
-/// the function signature. This is called when a transaction is cancelled. The first parameter is a pointer to the
-/// cancelled transaction, the second is a reason as to why said transaction failed that is mapped to the
-/// `TxCancellationReason` enum: pub enum TxCancellationReason {
-///     Unknown,                // 0
-///     UserCancelled,          // 1
-///     Timeout,                // 2
-///     DoubleSpend,            // 3
-///     Orphan,                 // 4
-///     TimeLocked,             // 5
-///     InvalidTransaction,     // 6
-/// }
-/// `callback_txo_validation_complete` - The callback function pointer matching the function signature. This is called
-/// when a TXO validation process is completed. The request_key is used to identify which request this
-/// callback references and the second parameter the second contains, weather it was successful, already busy, failed
-/// due to an internal failure or failed due to a communication failure.
-///     TxoValidationSuccess,               // 0
-///     TxoValidationAlreadyBusy            // 1
-///     TxoValidationInternalFailure        // 2
-///     TxoValidationCommunicationFailure   // 3
-/// `callback_contacts_liveness_data_updated` - The callback function pointer matching the function signature. This is
-/// called when a contact's liveness status changed. The data represents the contact's updated status information.
-/// `callback_balance_updated` - The callback function pointer matching the function signature. This is called whenever
-/// the balance changes.
-/// `callback_transaction_validation_complete` - The callback function pointer matching the function signature. This is
-/// called when a Transaction validation process is completed. The request_key is used to identify which request this
-/// callback references and the second parameter is a u64 that returns if the validation was successful or not.
-///         ValidationSuccess,               // 0
-///         ValidationAlreadyBusy            // 1
-///         ValidationInternalFailure        // 2
-///         ValidationCommunicationFailure   // 3
-/// `callback_saf_message_received` - The callback function pointer that will be called when the Dht has determined that
-/// is has connected to enough of its neighbours to be confident that it has received any SAF messages that were waiting
-/// for it.
-/// `callback_connectivity_status` -  This callback is called when the status of connection to the set base node
-/// changes. it will return an enum encoded as an integer as follows:
-/// pub enum OnlineStatus {
-///     Connecting,     // 0
-///     Online,         // 1
-///     Offline,        // 2
-/// }
-/// `recovery_in_progress` - Pointer to an bool which will be modified to indicate if there is an outstanding recovery
-/// that should be completed or not to an error code should one occur, may not be null. Functions as an out parameter.
-/// `error_out` - Pointer to an int which will be modified
-/// to an error code should one occur, may not be null. Functions as an out parameter.
+/// `worker_threads` - The number of threads that run async tasks, 0 for the default of one per CPU core up to 4
+/// `blocking_threads` - The maximum number of threads for blocking work such as database access, 0 for the default
+/// of 64
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
 /// ## Returns
-/// `*mut TariWallet` - Returns a pointer to a TariWallet, note that it returns ptr::null_mut()
-/// if config is null, a wallet error was encountered or if the runtime could not be created
+/// `*mut TariRuntime` - Returns a pointer to a TariRuntime, note that it returns ptr::null_mut() if the runtime could
+/// not be created
 ///
 /// # Safety
-/// The ```wallet_destroy``` method must be called when finished with a TariWallet to prevent a memory leak
+/// The ```tari_runtime_destroy``` method must be called when finished with a TariRuntime to prevent a memory leak. The
+/// runtime keeps running until it has been destroyed and every wallet and chat client using it has been destroyed.
 #[no_mangle]
-#[allow(clippy::cognitive_complexity)]
-#[allow(clippy::too_many_lines)]
-pub unsafe extern "C" fn wallet_create(
-    config: *mut TariCommsConfig,
-    log_path: *const c_char,
-    log_verbosity: c_int,
-    num_rolling_log_files: c_uint,
-    size_per_log_file_bytes: c_uint,
-    passphrase: *const c_char,
-    seed_words: *const TariSeedWords,
-    network_str: *const c_char,
-    peer_seed_str: *const c_char,
-    dns_sec: bool,
-
-    callback_received_transaction: unsafe extern "C" fn(*mut TariPendingInboundTransaction),
-    callback_received_transaction_reply: unsafe extern "C" fn(*mut TariCompletedTransaction),
-    callback_received_finalized_transaction: unsafe extern "C" fn(*mut TariCompletedTransaction),
-    callback_transaction_broadcast: unsafe extern "C" fn(*mut TariCompletedTransaction),
-    callback_transaction_mined: unsafe extern "C" fn(*mut TariCompletedTransaction),
-    callback_transaction_mined_unconfirmed: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
-    callback_faux_transaction_confirmed: unsafe extern "C" fn(*mut TariCompletedTransaction),
-    callback_faux_transaction_unconfirmed: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
-    callback_transaction_send_result: unsafe extern "C" fn(c_ulonglong, *mut TariTransactionSendStatus),
-    callback_transaction_cancellation: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
-    callback_txo_validation_complete: unsafe extern "C" fn(u64, u64),
-    callback_contacts_liveness_data_updated: unsafe extern "C" fn(*mut TariContactsLivenessData),
-    callback_balance_updated: unsafe extern "C" fn(*mut TariBalance),
-    callback_transaction_validation_complete: unsafe extern "C" fn(u64, u64),
-    callback_saf_messages_received: unsafe extern "C" fn(),
-    callback_connectivity_status: unsafe extern "C" fn(u64),
-    callback_base_node_state: unsafe extern "C" fn(*mut TariBaseNodeState),
-    recovery_in_progress: *mut bool,
+pub unsafe extern "C" fn tari_runtime_create(
+    worker_threads: c_uint,
+    blocking_threads: c_uint,
     error_out: *mut c_int,
-) -> *mut TariWallet {
-    use tari_key_manager::mnemonic::Mnemonic;
-
+) -> *mut TariRuntime {
     let mut error = 0;
     ptr::swap(error_out, &mut error as *mut c_int);
-    if config.is_null() {
-        error = LibWalletError::from(InterfaceError::NullError("config".to_string())).code;
-        ptr::swap(error_out, &mut error as *mut c_int);
-        return ptr::null_mut();
+    match build_runtime(worker_threads as usize, blocking_threads as usize) {
+        Ok(runtime) => Box::into_raw(Box::new(Arc::new(runtime))),
+        Err(e) => {
+            error = LibWalletError::from(InterfaceError::TokioError(e.to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
     }
+}
 
-    if !log_path.is_null() {
-        init_logging(
-            log_path,
-            log_verbosity,
-            num_rolling_log_files,
-            size_per_log_file_bytes,
-            error_out,
-        );
-
-        if error > 0 {
-            return ptr::null_mut();
-        }
+/// Frees memory for a TariRuntime
+///
+/// ## Arguments
+/// `runtime` - The TariRuntime pointer
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn tari_runtime_destroy(runtime: *mut TariRuntime) {
+    if !runtime.is_null() {
+        drop(Box::from_raw(runtime))
     }
-    info!(
-        target: LOG_TARGET,
-        "Starting Tari Wallet FFI version: {}",
-        consts::APP_VERSION
-    );
+}
 
-    let passphrase = if passphrase.is_null() {
-        error = LibWalletError::from(InterfaceError::NullError("passphrase".to_string())).code;
-        ptr::swap(error_out, &mut error as *mut c_int);
-        return ptr::null_mut();
-    } else {
-        let pf = CStr::from_ptr(passphrase)
-            .to_str()
-            .expect("A non-null passphrase should be able to be converted to string")
-            .to_owned();
-        SafePassword::from(pf)
+/// Creates a TariSqliteProfile, which tunes the wallet database for the device it runs on. It can be adjusted with
+/// the `sqlite_profile_set_*` functions and passed to `wallet_create`.
+///
+/// ## Arguments
+/// `preset` - The starting point for the profile:
+///     0 => Default, the settings used when no profile is given
+///     1 => Mobile, a small page cache and write-ahead log to keep memory and storage use down
+///     2 => Server, a large page cache, memory mapped I/O and more pooled connections for throughput
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariSqliteProfile` - Returns a pointer to a TariSqliteProfile, note that it returns ptr::null_mut() if the
+/// preset is not valid
+///
+/// # Safety
+/// The ```sqlite_profile_destroy``` method must be called when finished with a TariSqliteProfile to prevent a memory
+/// leak
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_create(preset: c_uint, error_out: *mut c_int) -> *mut TariSqliteProfile {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    let profile = match preset {
+        0 => SqlitePerformanceProfile::default(),
+        1 => SqlitePerformanceProfile::mobile(),
+        2 => SqlitePerformanceProfile::server(),
+        _ => {
+            error = LibWalletError::from(InterfaceError::InvalidArgument("preset".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
     };
+    Box::into_raw(Box::new(profile))
+}
 
-    let peer_seed = if peer_seed_str.is_null() {
-        error = LibWalletError::from(InterfaceError::NullError("peer seed dns".to_string())).code;
+/// Sets the maximum number of pooled database connections
+///
+/// ## Arguments
+/// `profile` - The TariSqliteProfile pointer
+/// `pool_size` - The number of connections, must be at least 1
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_set_pool_size(
+    profile: *mut TariSqliteProfile,
+    pool_size: c_uint,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if profile.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("profile".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    if pool_size == 0 {
+        error = LibWalletError::from(InterfaceError::InvalidArgument("pool_size".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*profile).pool_size = pool_size as usize;
+}
+
+/// Sets the size of the memory mapped region of the database file
+///
+/// ## Arguments
+/// `profile` - The TariSqliteProfile pointer
+/// `mmap_size` - The size in bytes, 0 to not memory map the database (the sqlite default)
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_set_mmap_size(
+    profile: *mut TariSqliteProfile,
+    mmap_size: c_ulonglong,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if profile.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("profile".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*profile).mmap_size = Some(mmap_size).filter(|s| *s > 0);
+}
+
+/// Sets the size of the page cache of each pooled connection
+///
+/// ## Arguments
+/// `profile` - The TariSqliteProfile pointer
+/// `cache_size_kib` - The size in KiB, 0 for the sqlite default of 2 MiB
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_set_cache_size(
+    profile: *mut TariSqliteProfile,
+    cache_size_kib: c_ulonglong,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if profile.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("profile".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*profile).cache_size_kib = Some(cache_size_kib).filter(|s| *s > 0);
+}
+
+/// Sets how often the database waits for writes to reach the disk
+///
+/// ## Arguments
+/// `profile` - The TariSqliteProfile pointer
+/// `synchronous` - The sqlite synchronous level:
+///     0 => Off
+///     1 => Normal
+///     2 => Full
+///     3 => Extra
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_set_synchronous(
+    profile: *mut TariSqliteProfile,
+    synchronous: c_uint,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if profile.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("profile".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*profile).synchronous = match synchronous {
+        0 => SqliteSynchronous::Off,
+        1 => SqliteSynchronous::Normal,
+        2 => SqliteSynchronous::Full,
+        3 => SqliteSynchronous::Extra,
+        _ => {
+            error = LibWalletError::from(InterfaceError::InvalidArgument("synchronous".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return;
+        },
+    };
+}
+
+/// Sets where temporary tables and indices are kept
+///
+/// ## Arguments
+/// `profile` - The TariSqliteProfile pointer
+/// `temp_store` - The location:
+///     0 => Default, as sqlite was compiled
+///     1 => File
+///     2 => Memory
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_set_temp_store(
+    profile: *mut TariSqliteProfile,
+    temp_store: c_uint,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if profile.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("profile".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*profile).temp_store = match temp_store {
+        0 => SqliteTempStore::Default,
+        1 => SqliteTempStore::File,
+        2 => SqliteTempStore::Memory,
+        _ => {
+            error = LibWalletError::from(InterfaceError::InvalidArgument("temp_store".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return;
+        },
+    };
+}
+
+/// Sets when the write-ahead log is checkpointed into the database file
+///
+/// ## Arguments
+/// `profile` - The TariSqliteProfile pointer
+/// `pages` - Checkpoint once the write-ahead log holds this many pages, 0 disables automatic checkpoints
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_set_wal_autocheckpoint(
+    profile: *mut TariSqliteProfile,
+    pages: c_uint,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if profile.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("profile".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*profile).wal_autocheckpoint_pages = Some(pages);
+}
+
+/// Frees memory for a TariSqliteProfile
+///
+/// ## Arguments
+/// `profile` - The TariSqliteProfile pointer
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn sqlite_profile_destroy(profile: *mut TariSqliteProfile) {
+    if !profile.is_null() {
+        drop(Box::from_raw(profile))
+    }
+}
+
+/// Reads the master seed of the wallet database, creating it from `recovery_seed` or a new seed if the database has
+/// none, and derives the comms node identity from it, signing the identity again if its addresses or features changed.
+fn load_or_create_node_identity(
+    recovery_seed: Option<CipherSeed>,
+    wallet_database: &WalletDatabase<WalletSqliteDatabase>,
+    comms_config: &TariCommsConfig,
+) -> Result<(CipherSeed, Arc<NodeIdentity>), WalletStorageError> {
+    let master_seed = read_or_create_master_seed(recovery_seed, wallet_database)
+        .map_err(|err| WalletStorageError::RecoverySeedError(err.to_string()))?;
+    let comms_secret_key =
+        derive_comms_secret_key(&master_seed).map_err(|err| WalletStorageError::RecoverySeedError(err.to_string()))?;
+
+    let node_features = wallet_database.get_node_features()?.unwrap_or_default();
+    let node_addresses = if comms_config.public_addresses.is_empty() {
+        match wallet_database.get_node_address()? {
+            Some(addr) => MultiaddrList::from(vec![addr]),
+            None => MultiaddrList::default(),
+        }
+    } else {
+        comms_config.public_addresses.clone()
+    };
+    debug!(target: LOG_TARGET, "We have the following addresses");
+    for address in &node_addresses {
+        debug!(target: LOG_TARGET, "Address: {}", address);
+    }
+    let identity_sig = wallet_database.get_comms_identity_signature()?;
+
+    // This checks if anything has changed by validating the previous signature and if invalid, setting identity_sig
+    // to None
+    let identity_sig = identity_sig.filter(|sig| {
+        let comms_public_key = CommsPublicKey::from_secret_key(&comms_secret_key);
+        sig.is_valid(&comms_public_key, node_features, &node_addresses)
+    });
+
+    // SAFETY: we are manually checking the validity of this signature before adding Some(..)
+    let node_identity = Arc::new(NodeIdentity::with_signature_unchecked(
+        comms_secret_key,
+        node_addresses.to_vec(),
+        node_features,
+        identity_sig,
+    ));
+    if !node_identity.is_signed() {
+        node_identity.sign();
+        // unreachable panic: signed above
+        let sig = node_identity
+            .identity_signature_read()
+            .as_ref()
+            .expect("unreachable panic")
+            .clone();
+        wallet_database.set_comms_identity_signature(sig)?;
+    }
+    Ok((master_seed, node_identity))
+}
+
+/// Creates a TariWallet
+///
+/// ## Arguments
+/// `config` - The TariCommsConfig pointer
+/// `log_path` - An optional file path to the file where the logs will be written. If no log is required pass *null*
+/// pointer.
+/// `log_verbosity` - how verbose should logging be as a c_int 0-5, or 11
+///        0 => Off
+///        1 => Error
+///        2 => Warn
+///        3 => Info
+///        4 => Debug
+///        5 | 11 => Trace // Cranked up to 11
+/// `num_rolling_log_files` - Specifies how many rolling log files to produce, if no rolling files are wanted then set
+/// this to 0
+/// `size_per_log_file_bytes` - Specifies the size, in bytes, at which the logs files will roll over, if no
+/// rolling files are wanted then set this to 0
+/// `passphrase` - An optional string that represents the passphrase used to
+/// encrypt/decrypt the databases for this wallet. If it is left Null no encryption is used. If the databases have been
+/// encrypted then the correct passphrase is required or this function will fail.
+/// `seed_words` - An optional instance of TariSeedWords, used to create a wallet for recovery purposes.
+/// If this is null, then a new master key is created for the wallet.
+/// `runtime` - An optional TariRuntime, created with `tari_runtime_create`, for the wallet to run on. Wallets given the
+/// same runtime share its threads. If this is null the wallet creates a runtime of its own.
+/// `sqlite_profile` - An optional TariSqliteProfile, created with `sqlite_profile_create`, to tune the wallet database
+/// with. If this is null the default profile is used.
+/// `callback_received_transaction` - The callback function pointer matching the function signature. This will be
+/// called when an inbound transaction is received.
+/// `callback_received_transaction_reply` - The callback function
+/// pointer matching the function signature. This will be called when a reply is received for a pending outbound
+/// transaction
+/// `callback_received_finalized_transaction` - The callback function pointer matching the function
+/// signature. This will be called when a Finalized version on an Inbound transaction is received
+/// `callback_transaction_broadcast` - The callback function pointer matching the function signature. This will be
+/// called when a Finalized transaction is detected a Broadcast to a base node mempool.
+/// `callback_transaction_mined` - The callback function pointer matching the function signature. This will be called
+/// when a Broadcast transaction is detected as mined AND confirmed.
+/// `callback_transaction_mined_unconfirmed` - The callback function pointer matching the function signature. This will
+/// be called when a Broadcast transaction is detected as mined but not yet confirmed.
+/// `callback_faux_transaction_confirmed` - The callback function pointer matching the function signature. This will be
+/// called when a one-sided transaction is detected as mined AND confirmed.
+/// `callback_faux_transaction_unconfirmed` - The callback function pointer matching the function signature. This
+/// will be called when a one-sided transaction is detected as mined but not yet confirmed.
+/// `callback_transaction_send_result` - The callback function pointer matching the function signature. This is called
+/// when a transaction send is completed. The first parameter is the transaction id and the second contains the
+/// transaction send status, weather it was send direct and/or send via saf on the one hand or queued for further retry
+/// sending on the other hand.
+///     !direct_send & !saf_send &  queued   = 0
+///      direct_send &  saf_send & !queued   = 1
+///      direct_send & !saf_send & !queued   = 2
+///     !direct_send &  saf_send & !queued   = 3
+///     any other combination (is not valid) = 4
+/// `callback_transaction_cancellation` - The callback function pointer matching
+/// the function signature. This is called when a transaction is cancelled. The first parameter is a pointer to the
+/// cancelled transaction, the second is a reason as to why said transaction failed that is mapped to the
+/// `TxCancellationReason` enum: pub enum TxCancellationReason {
+///     Unknown,                // 0
+///     UserCancelled,          // 1
+///     Timeout,                // 2
+///     DoubleSpend,            // 3
+///     Orphan,                 // 4
+///     TimeLocked,             // 5
+///     InvalidTransaction,     // 6
+/// }
+/// `callback_txo_validation_complete` - The callback function pointer matching the function signature. This is called
+/// when a TXO validation process is completed. The request_key is used to identify which request this
+/// callback references and the second parameter the second contains, weather it was successful, already busy, failed
+/// due to an internal failure or failed due to a communication failure.
+///     TxoValidationSuccess,               // 0
+///     TxoValidationAlreadyBusy            // 1
+///     TxoValidationInternalFailure        // 2
+///     TxoValidationCommunicationFailure   // 3
+/// `callback_contacts_liveness_data_updated` - The callback function pointer matching the function signature. This is
+/// called when a contact's liveness status changed. The data represents the contact's updated status information.
+/// `callback_balance_updated` - The callback function pointer matching the function signature. This is called whenever
+/// the balance changes.
+/// `callback_transaction_validation_complete` - The callback function pointer matching the function signature. This is
+/// called when a Transaction validation process is completed. The request_key is used to identify which request this
+/// callback references and the second parameter is a u64 that returns if the validation was successful or not.
+///         ValidationSuccess,               // 0
+///         ValidationAlreadyBusy            // 1
+///         ValidationInternalFailure        // 2
+///         ValidationCommunicationFailure   // 3
+/// `callback_saf_message_received` - The callback function pointer that will be called when the Dht has determined that
+/// is has connected to enough of its neighbours to be confident that it has received any SAF messages that were waiting
+/// for it.
+/// `callback_connectivity_status` -  This callback is called when the status of connection to the set base node
+/// changes. it will return an enum encoded as an integer as follows:
+/// pub enum OnlineStatus {
+///     Connecting,     // 0
+///     Online,         // 1
+///     Offline,        // 2
+/// }
+/// `recovery_in_progress` - Pointer to an bool which will be modified to indicate if there is an outstanding recovery
+/// that should be completed or not to an error code should one occur, may not be null. Functions as an out parameter.
+/// `error_out` - Pointer to an int which will be modified
+/// to an error code should one occur, may not be null. Functions as an out parameter.
+/// ## Returns
+/// `*mut TariWallet` - Returns a pointer to a TariWallet, note that it returns ptr::null_mut()
+/// if config is null, a wallet error was encountered or if the runtime could not be created
+///
+/// # Safety
+/// The ```wallet_destroy``` method must be called when finished with a TariWallet to prevent a memory leak
+#[no_mangle]
+#[allow(clippy::cognitive_complexity)]
+#[allow(clippy::too_many_lines)]
+pub unsafe extern "C" fn wallet_create(
+    config: *mut TariCommsConfig,
+    log_path: *const c_char,
+    log_verbosity: c_int,
+    num_rolling_log_files: c_uint,
+    size_per_log_file_bytes: c_uint,
+    passphrase: *const c_char,
+    seed_words: *const TariSeedWords,
+    network_str: *const c_char,
+    peer_seed_str: *const c_char,
+    dns_sec: bool,
+    runtime: *mut TariRuntime,
+    sqlite_profile: *const TariSqliteProfile,
+
+    callback_received_transaction: unsafe extern "C" fn(*mut TariPendingInboundTransaction),
+    callback_received_transaction_reply: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_received_finalized_transaction: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_transaction_broadcast: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_transaction_mined: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_transaction_mined_unconfirmed: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
+    callback_faux_transaction_confirmed: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_faux_transaction_unconfirmed: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
+    callback_transaction_send_result: unsafe extern "C" fn(c_ulonglong, *mut TariTransactionSendStatus),
+    callback_transaction_cancellation: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
+    callback_txo_validation_complete: unsafe extern "C" fn(u64, u64),
+    callback_contacts_liveness_data_updated: unsafe extern "C" fn(*mut TariContactsLivenessData),
+    callback_balance_updated: unsafe extern "C" fn(*mut TariBalance),
+    callback_transaction_validation_complete: unsafe extern "C" fn(u64, u64),
+    callback_saf_messages_received: unsafe extern "C" fn(),
+    callback_connectivity_status: unsafe extern "C" fn(u64),
+    callback_base_node_state: unsafe extern "C" fn(*mut TariBaseNodeState),
+    recovery_in_progress: *mut bool,
+    error_out: *mut c_int,
+) -> *mut TariWallet {
+    use tari_key_manager::mnemonic::Mnemonic;
+
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if config.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("config".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+
+    if !log_path.is_null() {
+        init_logging(
+            log_path,
+            log_verbosity,
+            num_rolling_log_files,
+            size_per_log_file_bytes,
+            error_out,
+        );
+
+        if error > 0 {
+            return ptr::null_mut();
+        }
+    }
+    info!(
+        target: LOG_TARGET,
+        "Starting Tari Wallet FFI version: {}",
+        consts::APP_VERSION
+    );
+
+    let passphrase = if passphrase.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("passphrase".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    } else {
+        let pf = CStr::from_ptr(passphrase)
+            .to_str()
+            .expect("A non-null passphrase should be able to be converted to string")
+            .to_owned();
+        SafePassword::from(pf)
+    };
+
+    let peer_seed = if peer_seed_str.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("peer seed dns".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    } else {
+        let peer_seed = CStr::from_ptr(peer_seed_str)
+            .to_str()
+            .expect("A non-null peer seed should be able to be converted to string");
+        info!(target: LOG_TARGET, "peer seed dns {}", peer_seed);
+        peer_seed
+    };
+
+    let recovery_seed = if seed_words.is_null() {
+        None
+    } else {
+        match CipherSeed::from_mnemonic(&(*seed_words).0, None) {
+            Ok(seed) => Some(seed),
+            Err(e) => {
+                error!(target: LOG_TARGET, "Mnemonic Error for given seed words: {:?}", e);
+                error = LibWalletError::from(WalletError::KeyManagerError(e)).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        }
+    };
+
+    let network = if network_str.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("network".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    } else {
+        let network = CStr::from_ptr(network_str)
+            .to_str()
+            .expect("A non-null network should be able to be converted to string");
+        info!(target: LOG_TARGET, "network set to {}", network);
+
+        match Network::from_str(network) {
+            Ok(n) => n,
+            Err(_) => {
+                error = LibWalletError::from(InterfaceError::InvalidArgument("network".to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        }
+    };
+    // Set the static network variable according to the user chosen network (for use with
+    // `get_current_or_user_setting_or_default()`) -
+    if let Err(e) = set_network_if_choice_valid(network) {
+        error = LibWalletError::from(InterfaceError::InvalidArgument(e.to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    };
+
+    let runtime = match runtime.as_ref() {
+        Some(runtime) => runtime.clone(),
+        None => match build_runtime(0, 0) {
+            Ok(r) => Arc::new(r),
+            Err(e) => {
+                error = LibWalletError::from(InterfaceError::TokioError(e.to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        },
+    };
+    let factories = CryptoFactories::default();
+
+    let sql_database_path = (*config)
+        .datastore_path
+        .join((*config).peer_database_name.clone())
+        .with_extension("sqlite3");
+
+    debug!(target: LOG_TARGET, "Running Wallet database migrations");
+
+    let sqlite_profile = if sqlite_profile.is_null() {
+        SqlitePerformanceProfile::default()
+    } else {
+        (*sqlite_profile).clone()
+    };
+    let (wallet_backend, transaction_backend, output_manager_backend, contacts_backend, key_manager_backend) =
+        match initialize_sqlite_database_backends(sql_database_path, passphrase, sqlite_profile) {
+            Ok((w, t, o, c, x)) => (w, t, o, c, x),
+            Err(e) => {
+                error = LibWalletError::from(WalletError::WalletStorageError(e)).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        };
+
+    let wallet_database = WalletDatabase::new(wallet_backend);
+    let output_manager_database = OutputManagerDatabase::new(output_manager_backend.clone());
+
+    debug!(target: LOG_TARGET, "Databases Initialized");
+
+    // If the transport type is Tor then check if there is a stored TorID, if there is update the Transport Type
+    let mut comms_config = (*config).clone();
+    if let TransportType::Tor = comms_config.transport.transport_type {
+        comms_config.transport.tor.identity = wallet_database.get_tor_id().ok().flatten();
+    }
+
+    let result = load_or_create_node_identity(recovery_seed, &wallet_database, &comms_config);
+
+    let (master_seed, node_identity) = match result {
+        Ok(tuple) => tuple,
+        Err(e) => {
+            error = LibWalletError::from(WalletError::WalletStorageError(e)).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
+
+    let shutdown = Shutdown::new();
+    let wallet_config = WalletConfig {
+        override_from: None,
+        p2p: comms_config,
+        transaction_service_config: TransactionServiceConfig {
+            direct_send_timeout: (*config).dht.discovery_request_timeout,
+            ..Default::default()
+        },
+        base_node_service_config: BaseNodeServiceConfig { ..Default::default() },
+        network,
+        ..Default::default()
+    };
+
+    let mut recovery_lookup = match wallet_database.get_client_key_value(RECOVERY_KEY.to_owned()) {
+        Err(_) => false,
+        Ok(None) => false,
+        Ok(Some(_)) => true,
+    };
+    ptr::swap(recovery_in_progress, &mut recovery_lookup as *mut bool);
+
+    let peer_seeds = PeerSeedsConfig {
+        dns_seeds_name_server: DEFAULT_DNS_NAME_SERVER.parse().unwrap(),
+        dns_seeds_use_dnssec: dns_sec,
+        dns_seeds: StringList::from(vec![peer_seed.to_string()]),
+        ..Default::default()
+    };
+
+    let auto_update = AutoUpdateConfig::default();
+    let consensus_manager = match ConsensusManager::builder(network).build() {
+        Ok(cm) => cm,
+        Err(_) => {
+            error = 10;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
+
+    let user_agent = format!("tari/wallet_ffi/{}", env!("CARGO_PKG_VERSION"));
+    let w = runtime.block_on(Wallet::start(
+        wallet_config,
+        peer_seeds,
+        auto_update,
+        node_identity,
+        consensus_manager,
+        factories,
+        wallet_database,
+        output_manager_database,
+        transaction_backend.clone(),
+        output_manager_backend,
+        contacts_backend,
+        key_manager_backend,
+        shutdown.to_signal(),
+        master_seed,
+        Some(WalletType::default()),
+        user_agent,
+    ));
+
+    match w {
+        Ok(w) => {
+            let wallet_address = match runtime.block_on(async { w.get_wallet_interactive_address().await }) {
+                Ok(address) => address,
+                Err(e) => {
+                    error = LibWalletError::from(e).code;
+                    ptr::swap(error_out, &mut error as *mut c_int);
+                    return ptr::null_mut();
+                },
+            };
+
+            // Start Callback Handler
+            let callback_handler = CallbackHandler::new(
+                TransactionDatabase::new(transaction_backend),
+                w.base_node_service.get_event_stream(),
+                w.transaction_service.get_event_stream(),
+                w.output_manager_service.get_event_stream(),
+                w.output_manager_service.clone(),
+                w.dht_service.subscribe_dht_events(),
+                w.comms.shutdown_signal(),
+                wallet_address,
+                w.wallet_connectivity.get_connectivity_status_watch(),
+                w.contacts_service.get_contacts_liveness_event_stream(),
+                callback_received_transaction,
+                callback_received_transaction_reply,
+                callback_received_finalized_transaction,
+                callback_transaction_broadcast,
+                callback_transaction_mined,
+                callback_transaction_mined_unconfirmed,
+                callback_faux_transaction_confirmed,
+                callback_faux_transaction_unconfirmed,
+                callback_transaction_send_result,
+                callback_transaction_cancellation,
+                callback_txo_validation_complete,
+                callback_contacts_liveness_data_updated,
+                callback_balance_updated,
+                callback_transaction_validation_complete,
+                callback_saf_messages_received,
+                callback_connectivity_status,
+                callback_base_node_state,
+            );
+            let (state_callback_throttle, state_callback_throttle_rx) =
+                watch::channel(StateCallbackThrottle::default());
+
+            let callback_handler = runtime.spawn(
+                callback_handler
+                    .with_state_callback_throttle(state_callback_throttle_rx)
+                    .start(),
+            );
+
+            let tari_wallet = TariWallet {
+                wallet: w,
+                runtime,
+                shutdown,
+                hosted: false,
+                state_callback_throttle,
+                callback_handler,
+            };
+
+            Box::into_raw(Box::new(tari_wallet))
+        },
+        Err(e) => {
+            error = LibWalletError::from(e).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Creates a TariWalletHost, the network stack shared by the wallets added to it with `wallet_host_add_wallet`. The
+/// host runs one comms node, one connection to the base node and one feed of base node events for all of them, so that
+/// a process hosting many wallets does not run a network stack per wallet.
+///
+/// The hosted wallets share the network identity of the host, so they do not receive interactive transactions and
+/// should transact with one-sided payments.
+///
+/// ## Arguments
+/// `config` - The TariCommsConfig pointer of the host. Its datastore holds the peer database and the host's own
+/// database, which must not be the database of a hosted wallet.
+/// `log_path` - An optional file path to the file where the logs will be written. If no log is required pass *null*
+/// pointer.
+/// `log_verbosity` - how verbose should logging be as a c_int 0-5, or 11, see `wallet_create`
+/// `num_rolling_log_files` - Specifies how many rolling log files to produce, if no rolling files are wanted then set
+/// this to 0
+/// `size_per_log_file_bytes` - Specifies the size, in bytes, at which the logs files will roll over, if no
+/// rolling files are wanted then set this to 0
+/// `passphrase` - The passphrase used to encrypt/decrypt the host's database
+/// `network_str` - The network the hosted wallets run on
+/// `peer_seed_str` - The DNS name to fetch seed peers from
+/// `dns_sec` - Whether DNSSEC is used when fetching seed peers
+/// `runtime` - An optional TariRuntime, created with `tari_runtime_create`, for the host and its wallets to run on. If
+/// this is null the host creates a runtime of its own.
+/// `sqlite_profile` - An optional TariSqliteProfile, created with `sqlite_profile_create`, to tune the host database
+/// with. If this is null the default profile is used.
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariWalletHost` - Returns a pointer to a TariWalletHost, note that it returns ptr::null_mut() if an argument
+/// is invalid or the network stack could not be started
+///
+/// # Safety
+/// The ```wallet_host_destroy``` method must be called when finished with a TariWalletHost to prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn wallet_host_create(
+    config: *mut TariCommsConfig,
+    log_path: *const c_char,
+    log_verbosity: c_int,
+    num_rolling_log_files: c_uint,
+    size_per_log_file_bytes: c_uint,
+    passphrase: *const c_char,
+    network_str: *const c_char,
+    peer_seed_str: *const c_char,
+    dns_sec: bool,
+    runtime: *mut TariRuntime,
+    sqlite_profile: *const TariSqliteProfile,
+    error_out: *mut c_int,
+) -> *mut TariWalletHost {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if config.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("config".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    if passphrase.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("passphrase".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    if network_str.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("network".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    if peer_seed_str.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("peer seed dns".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+
+    if !log_path.is_null() {
+        init_logging(
+            log_path,
+            log_verbosity,
+            num_rolling_log_files,
+            size_per_log_file_bytes,
+            error_out,
+        );
+    }
+
+    let passphrase = match CStr::from_ptr(passphrase).to_str() {
+        Ok(v) => SafePassword::from(v.to_owned()),
+        Err(_) => {
+            error = LibWalletError::from(InterfaceError::PointerError("passphrase".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
+    let peer_seed = match CStr::from_ptr(peer_seed_str).to_str() {
+        Ok(v) => v.to_owned(),
+        Err(_) => {
+            error = LibWalletError::from(InterfaceError::PointerError("peer seed dns".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
+    let network = match CStr::from_ptr(network_str).to_str().ok().map(Network::from_str) {
+        Some(Ok(n)) => n,
+        _ => {
+            error = LibWalletError::from(InterfaceError::InvalidArgument("network".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
+    if let Err(e) = set_network_if_choice_valid(network) {
+        error = LibWalletError::from(InterfaceError::InvalidArgument(e.to_string())).code;
         ptr::swap(error_out, &mut error as *mut c_int);
         return ptr::null_mut();
-    } else {
-        let peer_seed = CStr::from_ptr(peer_seed_str)
-            .to_str()
-            .expect("A non-null peer seed should be able to be converted to string");
-        info!(target: LOG_TARGET, "peer seed dns {}", peer_seed);
-        peer_seed
     };
 
-    let recovery_seed = if seed_words.is_null() {
-        None
-    } else {
-        match CipherSeed::from_mnemonic(&(*seed_words).0, None) {
-            Ok(seed) => Some(seed),
+    let runtime = match runtime.as_ref() {
+        Some(runtime) => runtime.clone(),
+        None => match build_runtime(0, 0) {
+            Ok(r) => Arc::new(r),
             Err(e) => {
-                error!(target: LOG_TARGET, "Mnemonic Error for given seed words: {:?}", e);
-                error = LibWalletError::from(WalletError::KeyManagerError(e)).code;
+                error = LibWalletError::from(InterfaceError::TokioError(e.to_string())).code;
                 ptr::swap(error_out, &mut error as *mut c_int);
                 return ptr::null_mut();
             },
-        }
+        },
+    };
+    let sqlite_profile = if sqlite_profile.is_null() {
+        SqlitePerformanceProfile::default()
+    } else {
+        (*sqlite_profile).clone()
     };
 
-    let network = if network_str.is_null() {
-        error = LibWalletError::from(InterfaceError::NullError("network".to_string())).code;
+    let sql_database_path = (*config)
+        .datastore_path
+        .join((*config).peer_database_name.clone())
+        .with_extension("sqlite3");
+    let wallet_database = match initialize_sqlite_database_backends(sql_database_path, passphrase, sqlite_profile) {
+        Ok((wallet_backend, _, _, _, _)) => WalletDatabase::new(wallet_backend),
+        Err(e) => {
+            error = LibWalletError::from(WalletError::WalletStorageError(e)).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
+
+    let mut comms_config = (*config).clone();
+    if let TransportType::Tor = comms_config.transport.transport_type {
+        comms_config.transport.tor.identity = wallet_database.get_tor_id().ok().flatten();
+    }
+    let node_identity = match load_or_create_node_identity(None, &wallet_database, &comms_config) {
+        Ok((_, node_identity)) => node_identity,
+        Err(e) => {
+            error = LibWalletError::from(WalletError::WalletStorageError(e)).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
+
+    let peer_seeds = PeerSeedsConfig {
+        dns_seeds_name_server: DEFAULT_DNS_NAME_SERVER.parse().unwrap(),
+        dns_seeds_use_dnssec: dns_sec,
+        dns_seeds: StringList::from(vec![peer_seed]),
+        ..Default::default()
+    };
+    let wallet_config = WalletConfig {
+        override_from: None,
+        p2p: comms_config,
+        network,
+        ..Default::default()
+    };
+
+    let shutdown = Shutdown::new();
+    let user_agent = format!("tari/wallet_ffi/{}", env!("CARGO_PKG_VERSION"));
+    match runtime.block_on(WalletHost::start(
+        wallet_config,
+        peer_seeds,
+        node_identity,
+        wallet_database,
+        shutdown.to_signal(),
+        user_agent,
+    )) {
+        Ok(host) => Box::into_raw(Box::new(TariWalletHost {
+            host,
+            runtime,
+            shutdown,
+        })),
+        Err(e) => {
+            error = LibWalletError::from(e).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Creates a TariWallet that runs on the network stack of a TariWalletHost. The wallet has its own database, keys and
+/// services, and behaves like a wallet created with `wallet_create`, except that it shares the comms node, base node
+/// and network identity of the host. It therefore does not take part in interactive transactions: sends to other
+/// wallets fail unless they are one-sided, and setting its base node sets the base node of every wallet of the host.
+///
+/// ## Arguments
+/// `host` - The TariWalletHost pointer
+/// `config` - A TariCommsConfig pointer, configures the wallet as in `wallet_create`, with its datastore path and
+/// database name locating the database of this wallet. The comms node of the host is used instead of one started from
+/// it.
+/// `passphrase` - The passphrase used to encrypt/decrypt the database of this wallet
+/// `seed_words` - An optional instance of TariSeedWords, used to create a wallet for recovery purposes.
+/// If this is null, then a new master key is created for the wallet.
+/// `sqlite_profile` - An optional TariSqliteProfile to tune the wallet database with. If this is null the default
+/// profile is used.
+/// `callback_*` - The callback function pointers, see `wallet_create`. The base node state, connectivity status and SAF
+/// callbacks report on the shared network stack of the host.
+/// `recovery_in_progress` - Pointer to an bool which will be modified to indicate if there is an outstanding recovery
+/// that should be completed or not, may not be null. Functions as an out parameter.
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariWallet` - Returns a pointer to a TariWallet, note that it returns ptr::null_mut() if an argument is
+/// invalid or the wallet could not be started
+///
+/// # Safety
+/// The ```wallet_destroy``` method must be called when finished with the TariWallet, before the TariWalletHost is
+/// destroyed
+#[no_mangle]
+#[allow(clippy::too_many_lines)]
+pub unsafe extern "C" fn wallet_host_add_wallet(
+    host: *mut TariWalletHost,
+    config: *mut TariCommsConfig,
+    passphrase: *const c_char,
+    seed_words: *const TariSeedWords,
+    sqlite_profile: *const TariSqliteProfile,
+
+    callback_received_transaction: unsafe extern "C" fn(*mut TariPendingInboundTransaction),
+    callback_received_transaction_reply: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_received_finalized_transaction: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_transaction_broadcast: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_transaction_mined: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_transaction_mined_unconfirmed: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
+    callback_faux_transaction_confirmed: unsafe extern "C" fn(*mut TariCompletedTransaction),
+    callback_faux_transaction_unconfirmed: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
+    callback_transaction_send_result: unsafe extern "C" fn(c_ulonglong, *mut TariTransactionSendStatus),
+    callback_transaction_cancellation: unsafe extern "C" fn(*mut TariCompletedTransaction, u64),
+    callback_txo_validation_complete: unsafe extern "C" fn(u64, u64),
+    callback_contacts_liveness_data_updated: unsafe extern "C" fn(*mut TariContactsLivenessData),
+    callback_balance_updated: unsafe extern "C" fn(*mut TariBalance),
+    callback_transaction_validation_complete: unsafe extern "C" fn(u64, u64),
+    callback_saf_messages_received: unsafe extern "C" fn(),
+    callback_connectivity_status: unsafe extern "C" fn(u64),
+    callback_base_node_state: unsafe extern "C" fn(*mut TariBaseNodeState),
+    recovery_in_progress: *mut bool,
+    error_out: *mut c_int,
+) -> *mut TariWallet {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if host.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("host".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    if config.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("config".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    let passphrase = if passphrase.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("passphrase".to_string())).code;
         ptr::swap(error_out, &mut error as *mut c_int);
         return ptr::null_mut();
     } else {
-        let network = CStr::from_ptr(network_str)
-            .to_str()
-            .expect("A non-null network should be able to be converted to string");
-        info!(target: LOG_TARGET, "network set to {}", network);
-
-        match Network::from_str(network) {
-            Ok(n) => n,
+        match CStr::from_ptr(passphrase).to_str() {
+            Ok(v) => SafePassword::from(v.to_owned()),
             Err(_) => {
-                error = LibWalletError::from(InterfaceError::InvalidArgument("network".to_string())).code;
+                error = LibWalletError::from(InterfaceError::PointerError("passphrase".to_string())).code;
                 ptr::swap(error_out, &mut error as *mut c_int);
                 return ptr::null_mut();
             },
         }
     };
-    // Set the static network variable according to the user chosen network (for use with
-    // `get_current_or_user_setting_or_default()`) -
-    if let Err(e) = set_network_if_choice_valid(network) {
-        error = LibWalletError::from(InterfaceError::InvalidArgument(e.to_string())).code;
-        ptr::swap(error_out, &mut error as *mut c_int);
-        return ptr::null_mut();
+    let recovery_seed = if seed_words.is_null() {
+        None
+    } else {
+        match CipherSeed::from_mnemonic(&(*seed_words).0, None) {
+            Ok(seed) => Some(seed),
+            Err(e) => {
+                error!(target: LOG_TARGET, "Mnemonic Error for given seed words: {:?}", e);
+                error = LibWalletError::from(WalletError::KeyManagerError(e)).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        }
     };
-
-    let runtime = match Runtime::new() {
-        Ok(r) => r,
-        Err(e) => {
-            error = LibWalletError::from(InterfaceError::TokioError(e.to_string())).code;
-            ptr::swap(error_out, &mut error as *mut c_int);
-            return ptr::null_mut();
-        },
+    let sqlite_profile = if sqlite_profile.is_null() {
+        SqlitePerformanceProfile::default()
+    } else {
+        (*sqlite_profile).clone()
     };
-    let factories = CryptoFactories::default();
 
     let sql_database_path = (*config)
         .datastore_path
         .join((*config).peer_database_name.clone())
         .with_extension("sqlite3");
-
-    debug!(target: LOG_TARGET, "Running Wallet database migrations");
-
     let (wallet_backend, transaction_backend, output_manager_backend, contacts_backend, key_manager_backend) =
-        match initialize_sqlite_database_backends(sql_database_path, passphrase, 16) {
-            Ok((w, t, o, c, x)) => (w, t, o, c, x),
+        match initialize_sqlite_database_backends(sql_database_path, passphrase, sqlite_profile) {
+            Ok(backends) => backends,
             Err(e) => {
                 error = LibWalletError::from(WalletError::WalletStorageError(e)).code;
                 ptr::swap(error_out, &mut error as *mut c_int);
                 return ptr::null_mut();
             },
         };
-
     let wallet_database = WalletDatabase::new(wallet_backend);
     let output_manager_database = OutputManagerDatabase::new(output_manager_backend.clone());
 
-    debug!(target: LOG_TARGET, "Databases Initialized");
-
-    // If the transport type is Tor then check if there is a stored TorID, if there is update the Transport Type
-    let mut comms_config = (*config).clone();
-    if let TransportType::Tor = comms_config.transport.transport_type {
-        comms_config.transport.tor.identity = wallet_database.get_tor_id().ok().flatten();
-    }
-
-    let result = runtime.block_on(async {
-        let master_seed = read_or_create_master_seed(recovery_seed, &wallet_database)
-            .map_err(|err| WalletStorageError::RecoverySeedError(err.to_string()))?;
-        let comms_secret_key = derive_comms_secret_key(&master_seed)
-            .map_err(|err| WalletStorageError::RecoverySeedError(err.to_string()))?;
-
-        let node_features = wallet_database.get_node_features()?.unwrap_or_default();
-        let node_addresses = if comms_config.public_addresses.is_empty() {
-            match wallet_database.get_node_address()? {
-                Some(addr) => MultiaddrList::from(vec![addr]),
-                None => MultiaddrList::default(),
-            }
-        } else {
-            comms_config.public_addresses.clone()
-        };
-        debug!(target: LOG_TARGET, "We have the following addresses");
-        for address in &node_addresses {
-            debug!(target: LOG_TARGET, "Address: {}", address);
-        }
-        let identity_sig = wallet_database.get_comms_identity_signature()?;
-
-        // This checks if anything has changed by validating the previous signature and if invalid, setting identity_sig
-        // to None
-        let identity_sig = identity_sig.filter(|sig| {
-            let comms_public_key = CommsPublicKey::from_secret_key(&comms_secret_key);
-            sig.is_valid(&comms_public_key, node_features, &node_addresses)
-        });
+    let master_seed = match read_or_create_master_seed(recovery_seed, &wallet_database) {
+        Ok(seed) => seed,
+        Err(e) => {
+            error = LibWalletError::from(e).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return ptr::null_mut();
+        },
+    };
 
-        // SAFETY: we are manually checking the validity of this signature before adding Some(..)
-        let node_identity = Arc::new(NodeIdentity::with_signature_unchecked(
-            comms_secret_key,
-            node_addresses.to_vec(),
-            node_features,
-            identity_sig,
-        ));
-        if !node_identity.is_signed() {
-            node_identity.sign();
-            // unreachable panic: signed above
-            let sig = node_identity
-                .identity_signature_read()
-                .as_ref()
-                .expect("unreachable panic")
-                .clone();
-            wallet_database.set_comms_identity_signature(sig)?;
-        }
-        Ok((master_seed, node_identity))
-    });
+    let mut recovery_lookup = matches!(
+        wallet_database.get_client_key_value(RECOVERY_KEY.to_owned()),
+        Ok(Some(_))
+    );
+    ptr::swap(recovery_in_progress, &mut recovery_lookup as *mut bool);
 
-    let (master_seed, node_identity) = match result {
-        Ok(tuple) => tuple,
+    let network = (*host).host.network.as_network();
+    let consensus_manager = match ConsensusManager::builder(network).build() {
+        Ok(cm) => cm,
         Err(e) => {
-            error = LibWalletError::from(WalletError::WalletStorageError(e)).code;
+            error = LibWalletError::from(InterfaceError::InvalidArgument(e.to_string())).code;
             ptr::swap(error_out, &mut error as *mut c_int);
             return ptr::null_mut();
         },
     };
-
-    let shutdown = Shutdown::new();
     let wallet_config = WalletConfig {
         override_from: None,
-        p2p: comms_config,
+        p2p: (*config).clone(),
         transaction_service_config: TransactionServiceConfig {
             direct_send_timeout: (*config).dht.discovery_request_timeout,
             ..Default::default()
@@ -5899,38 +7138,13 @@ pub unsafe extern "C" fn wallet_create(
         ..Default::default()
     };
 
-    let mut recovery_lookup = match wallet_database.get_client_key_value(RECOVERY_KEY.to_owned()) {
-        Err(_) => false,
-        Ok(None) => false,
-        Ok(Some(_)) => true,
-    };
-    ptr::swap(recovery_in_progress, &mut recovery_lookup as *mut bool);
-
-    let peer_seeds = PeerSeedsConfig {
-        dns_seeds_name_server: DEFAULT_DNS_NAME_SERVER.parse().unwrap(),
-        dns_seeds_use_dnssec: dns_sec,
-        dns_seeds: StringList::from(vec![peer_seed.to_string()]),
-        ..Default::default()
-    };
-
-    let auto_update = AutoUpdateConfig::default();
-    let consensus_manager = match ConsensusManager::builder(network).build() {
-        Ok(cm) => cm,
-        Err(_) => {
-            error = 10;
-            ptr::swap(error_out, &mut error as *mut c_int);
-            return ptr::null_mut();
-        },
-    };
-
-    let user_agent = format!("tari/wallet_ffi/{}", env!("CARGO_PKG_VERSION"));
-    let w = runtime.block_on(Wallet::start(
+    let runtime = (*host).runtime.clone();
+    let shutdown = Shutdown::new();
+    let w = runtime.block_on(Wallet::start_hosted(
+        &(*host).host,
         wallet_config,
-        peer_seeds,
-        auto_update,
-        node_identity,
         consensus_manager,
-        factories,
+        CryptoFactories::default(),
         wallet_database,
         output_manager_database,
         transaction_backend.clone(),
@@ -5940,7 +7154,6 @@ pub unsafe extern "C" fn wallet_create(
         shutdown.to_signal(),
         master_seed,
         Some(WalletType::default()),
-        user_agent,
     ));
 
     match w {
@@ -5954,7 +7167,7 @@ pub unsafe extern "C" fn wallet_create(
                 },
             };
 
-            // Start Callback Handler
+            // The callback handler stops with this wallet rather than with the shared comms node
             let callback_handler = CallbackHandler::new(
                 TransactionDatabase::new(transaction_backend),
                 w.base_node_service.get_event_stream(),
@@ -5962,7 +7175,7 @@ pub unsafe extern "C" fn wallet_create(
                 w.output_manager_service.get_event_stream(),
                 w.output_manager_service.clone(),
                 w.dht_service.subscribe_dht_events(),
-                w.comms.shutdown_signal(),
+                shutdown.to_signal(),
                 wallet_address,
                 w.wallet_connectivity.get_connectivity_status_watch(),
                 w.contacts_service.get_contacts_liveness_event_stream(),
@@ -5984,13 +7197,22 @@ pub unsafe extern "C" fn wallet_create(
                 callback_connectivity_status,
                 callback_base_node_state,
             );
+            let (state_callback_throttle, state_callback_throttle_rx) =
+                watch::channel(StateCallbackThrottle::default());
 
-            runtime.spawn(callback_handler.start());
+            let callback_handler = runtime.spawn(
+                callback_handler
+                    .with_state_callback_throttle(state_callback_throttle_rx)
+                    .start(),
+            );
 
             let tari_wallet = TariWallet {
                 wallet: w,
                 runtime,
                 shutdown,
+                hosted: true,
+                state_callback_throttle,
+                callback_handler,
             };
 
             Box::into_raw(Box::new(tari_wallet))
@@ -6003,6 +7225,95 @@ pub unsafe extern "C" fn wallet_create(
     }
 }
 
+/// Sets the base node used by all the wallets of a TariWalletHost
+///
+/// ## Arguments
+/// `host` - The TariWalletHost pointer
+/// `public_key` - The TariPublicKey pointer of the base node
+/// `address` - The address of the base node, may be null if the base node is already known to the host
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `bool` - Returns if successful or not
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn wallet_host_set_base_node_peer(
+    host: *mut TariWalletHost,
+    public_key: *mut TariPublicKey,
+    address: *const c_char,
+    error_out: *mut c_int,
+) -> bool {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if host.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("host".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+    if public_key.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("public_key".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+
+    let parsed_addr = if address.is_null() {
+        None
+    } else {
+        match CStr::from_ptr(address).to_str() {
+            Ok(v) => match Multiaddr::from_str(v) {
+                Ok(v) => Some(v),
+                Err(_) => {
+                    error =
+                        LibWalletError::from(InterfaceError::InvalidArgument("address is invalid".to_string())).code;
+                    ptr::swap(error_out, &mut error as *mut c_int);
+                    return false;
+                },
+            },
+            _ => {
+                error = LibWalletError::from(InterfaceError::PointerError("address".to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return false;
+            },
+        }
+    };
+
+    if let Err(e) = (*host)
+        .runtime
+        .block_on((*host).host.set_base_node_peer((*public_key).clone(), parsed_addr))
+    {
+        error = LibWalletError::from(e).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+    true
+}
+
+/// Frees memory for a TariWalletHost, shutting down its network stack
+///
+/// ## Arguments
+/// `host` - The TariWalletHost pointer
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// Every wallet added with `wallet_host_add_wallet` must be destroyed with `wallet_destroy` first
+#[no_mangle]
+pub unsafe extern "C" fn wallet_host_destroy(host: *mut TariWalletHost) {
+    if !host.is_null() {
+        let TariWalletHost {
+            host,
+            runtime,
+            mut shutdown,
+        } = *Box::from_raw(host);
+        shutdown.trigger();
+        runtime.block_on(host.wait_until_shutdown());
+    }
+}
+
 /// Retrieves the version of an app that last accessed the wallet database
 ///
 /// ## Arguments
@@ -6081,6 +7392,231 @@ pub unsafe extern "C" fn wallet_get_last_network(config: *mut TariCommsConfig, e
     }
 }
 
+/// Opens a wallet database for reading only, without starting comms or any of the wallet services. This is much faster
+/// than `wallet_create` and suits callers that only query the balance, UTXOs or transaction history of the wallet.
+/// The database is read as it was last written, nothing is refreshed from the network. The database is not locked, so
+/// a TariWallet can be created for the same database while the TariWalletReader is open.
+///
+/// ## Arguments
+/// `config` - The TariCommsConfig pointer, only its datastore path and database name are used
+/// `passphrase` - The passphrase used to encrypt/decrypt the databases for this wallet
+/// `sqlite_profile` - An optional pointer to a TariSqliteProfile, the defaults are used if null
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariWalletReader` - Returns a pointer to a TariWalletReader, note that it returns ptr::null_mut() if the
+/// database does not exist, has not been migrated to this version by `wallet_create` or the passphrase is wrong
+///
+/// # Safety
+/// The ```wallet_reader_destroy``` method must be called when finished with a TariWalletReader to prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn wallet_open_readonly(
+    config: *mut TariCommsConfig,
+    passphrase: *const c_char,
+    sqlite_profile: *const TariSqliteProfile,
+    error_out: *mut c_int,
+) -> *mut TariWalletReader {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if config.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("config".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    let passphrase = if passphrase.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("passphrase".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    } else {
+        match CStr::from_ptr(passphrase).to_str() {
+            Ok(v) => SafePassword::from(v.to_owned()),
+            Err(_) => {
+                error = LibWalletError::from(InterfaceError::PointerError("passphrase".to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        }
+    };
+    let sqlite_profile = if sqlite_profile.is_null() {
+        SqlitePerformanceProfile::default()
+    } else {
+        (*sqlite_profile).clone()
+    };
+
+    let sql_database_path = (*config)
+        .datastore_path
+        .join((*config).peer_database_name.clone())
+        .with_extension("sqlite3");
+    match open_sqlite_database_backends_readonly(sql_database_path, passphrase, sqlite_profile) {
+        Ok((wallet_backend, transaction_backend, output_manager_backend)) => {
+            Box::into_raw(Box::new(TariWalletReader {
+                wallet_db: WalletDatabase::new(wallet_backend),
+                output_db: OutputManagerDatabase::new(output_manager_backend),
+                transaction_db: TransactionDatabase::new(transaction_backend),
+            }))
+        },
+        Err(e) => {
+            error = LibWalletError::from(WalletError::WalletStorageError(e)).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Retrieves the balance from a TariWalletReader. Time locked outputs are determined at the chain tip the wallet last
+/// knew of.
+///
+/// ## Arguments
+/// `reader` - The TariWalletReader pointer.
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+/// ## Returns
+/// `*mut Balance` - Returns the pointer to the TariBalance or null if error occurs
+///
+/// # Safety
+/// The ```balance_destroy``` method must be called when finished with a TariBalance to prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn wallet_reader_get_balance(
+    reader: *mut TariWalletReader,
+    error_out: *mut c_int,
+) -> *mut TariBalance {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if reader.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("reader".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    let tip = match (*reader).wallet_db.get_chain_metadata() {
+        Ok(metadata) => metadata.map(|m| m.best_block_height()),
+        Err(_) => None,
+    };
+    match (*reader).output_db.get_balance(tip) {
+        Ok(balance) => Box::into_raw(Box::new(balance)),
+        Err(_) => {
+            error = LibWalletError::from(InterfaceError::BalanceError).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// This function returns a list of unspent UTXO values and commitments from a TariWalletReader, as `wallet_get_utxos`
+/// does for a TariWallet.
+///
+/// ## Arguments
+/// * `reader` - The TariWalletReader pointer,
+/// * `page` - Page offset,
+/// * `page_size` - A number of items per page,
+/// * `sorting` - An enum representing desired sorting,
+/// * `states` - A `TariVector` of UTXO states to filter on, all states are included if null,
+/// * `dust_threshold` - A value filtering threshold. Outputs whose values are <= `dust_threshold` are not listed in the
+///   result.
+/// * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null.
+///   Functions as an out parameter.
+///
+/// ## Returns
+/// `*mut TariVector` - Returns a struct with an array pointer, length and capacity (needed for proper destruction
+/// after use).
+///
+/// # Safety
+/// `destroy_tari_vector()` must be called after use.
+#[no_mangle]
+pub unsafe extern "C" fn wallet_reader_get_utxos(
+    reader: *mut TariWalletReader,
+    page: usize,
+    page_size: usize,
+    sorting: TariUtxoSort,
+    states: *mut TariVector,
+    dust_threshold: u64,
+    error_ptr: *mut i32,
+) -> *mut TariVector {
+    if reader.is_null() {
+        error!(target: LOG_TARGET, "reader pointer is null");
+        ptr::replace(
+            error_ptr,
+            LibWalletError::from(InterfaceError::NullError("reader".to_string())).code,
+        );
+        return ptr::null_mut();
+    }
+
+    fetch_utxos(
+        &(*reader).output_db,
+        page,
+        page_size,
+        sorting,
+        states,
+        dust_threshold,
+        error_ptr,
+    )
+}
+
+/// Get the TariCompletedTransactions from a TariWalletReader, as `wallet_get_completed_transactions` does for a
+/// TariWallet
+///
+/// ## Arguments
+/// `reader` - The TariWalletReader pointer
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariCompletedTransactions` - returns the transactions, note that it returns ptr::null_mut() if
+/// reader is null or an error is encountered
+///
+/// # Safety
+/// The ```completed_transactions_destroy``` method must be called when finished with a TariCompletedTransactions to
+/// prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn wallet_reader_get_completed_transactions(
+    reader: *mut TariWalletReader,
+    error_out: *mut c_int,
+) -> *mut TariCompletedTransactions {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if reader.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("reader".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+
+    match (*reader).transaction_db.get_completed_transactions() {
+        Ok(completed_transactions) => {
+            // Completed, broadcast and imported transactions are listed as pending, see
+            // `wallet_get_completed_transactions`
+            let completed = completed_transactions
+                .into_values()
+                .filter(|ct| ct.status != TransactionStatus::Completed)
+                .filter(|ct| ct.status != TransactionStatus::Broadcast)
+                .filter(|ct| ct.status != TransactionStatus::Imported)
+                .collect();
+            Box::into_raw(Box::new(TariCompletedTransactions(completed)))
+        },
+        Err(e) => {
+            error = LibWalletError::from(WalletError::TransactionServiceError(e.into())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Frees memory for a TariWalletReader
+///
+/// ## Arguments
+/// `reader` - The TariWalletReader pointer
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn wallet_reader_destroy(reader: *mut TariWalletReader) {
+    if !reader.is_null() {
+        drop(Box::from_raw(reader))
+    }
+}
+
 /// Retrieves the balance from a wallet
 ///
 /// ## Arguments
@@ -6134,8 +7670,6 @@ pub unsafe extern "C" fn wallet_get_balance(wallet: *mut TariWallet, error_out:
 /// `destroy_tari_vector()` must be called after use.
 /// Items that fail to produce `.as_transaction_output()` are omitted from the list and a `warn!()` message is logged to
 /// LOG_TARGET.
-// casting here is okay as we wont have more than u32 utxos
-#[allow(clippy::cast_possible_truncation)]
 #[no_mangle]
 pub unsafe extern "C" fn wallet_get_utxos(
     wallet: *mut TariWallet,
@@ -6155,6 +7689,29 @@ pub unsafe extern "C" fn wallet_get_utxos(
         return ptr::null_mut();
     }
 
+    fetch_utxos(
+        &(*wallet).wallet.output_db,
+        page,
+        page_size,
+        sorting,
+        states,
+        dust_threshold,
+        error_ptr,
+    )
+}
+
+/// Fetches a page of UTXOs for `wallet_get_utxos` and `wallet_reader_get_utxos`
+// casting here is okay as we wont have more than u32 utxos
+#[allow(clippy::cast_possible_truncation)]
+unsafe fn fetch_utxos(
+    output_db: &OutputManagerDatabase<OutputManagerSqliteDatabase>,
+    page: usize,
+    page_size: usize,
+    sorting: TariUtxoSort,
+    states: *mut TariVector,
+    dust_threshold: u64,
+    error_ptr: *mut i32,
+) -> *mut TariVector {
     let page = i64::from_usize(page).unwrap_or(i64::MAX);
     let page_size = i64::from_usize(page_size).unwrap_or(i64::MAX);
     let dust_threshold = i64::from_u64(dust_threshold).unwrap_or(0);
@@ -6170,7 +7727,6 @@ pub unsafe extern "C" fn wallet_get_utxos(
         }
     };
 
-    use SortDirection::{Asc, Desc};
     let q = OutputBackendQuery {
         tip_height: i64::MAX,
         status,
@@ -6178,15 +7734,11 @@ pub unsafe extern "C" fn wallet_get_utxos(
         pagination: Some((page, page_size)),
         value_min: Some((dust_threshold, false)),
         value_max: None,
-        sorting: vec![match sorting {
-            TariUtxoSort::MinedHeightAsc => ("mined_height", Asc),
-            TariUtxoSort::MinedHeightDesc => ("mined_height", Desc),
-            TariUtxoSort::ValueAsc => ("value", Asc),
-            TariUtxoSort::ValueDesc => ("value", Desc),
-        }],
+        sorting: vec![sorting.as_query_sorting()],
+        cursor: None,
     };
 
-    match (*wallet).wallet.output_db.fetch_outputs_by_query(q) {
+    match output_db.fetch_outputs_by_query(q) {
         Ok(outputs) => {
             ptr::replace(error_ptr, 0);
             Box::into_raw(Box::new(TariVector::from(outputs)))
@@ -6206,6 +7758,137 @@ pub unsafe extern "C" fn wallet_get_utxos(
     }
 }
 
+/// Creates a new, empty cursor for use with `wallet_get_utxos_after`. An empty cursor starts at the first UTXO.
+///
+/// ## Arguments
+/// `()` - Does not take any arguments
+///
+/// ## Returns
+/// `*mut TariUtxoCursor` - Returns a pointer to a TariUtxoCursor
+///
+/// # Safety
+/// The ```utxo_cursor_destroy``` method must be called when finished with a TariUtxoCursor to prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn utxo_cursor_create() -> *mut TariUtxoCursor {
+    Box::into_raw(Box::default())
+}
+
+/// Frees memory for a TariUtxoCursor
+///
+/// ## Arguments
+/// `cursor` - The pointer to a TariUtxoCursor
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn utxo_cursor_destroy(cursor: *mut TariUtxoCursor) {
+    if !cursor.is_null() {
+        drop(Box::from_raw(cursor))
+    }
+}
+
+/// This function returns the next page of UTXOs after the position held by `cursor` and advances the cursor to the
+/// last UTXO returned. Unlike `wallet_get_utxos`, the cost of a page does not grow with the depth of the page.
+///
+/// ## Arguments
+/// * `wallet` - The TariWallet pointer,
+/// * `cursor` - The TariUtxoCursor pointer, created with `utxo_cursor_create()`. The same `sorting`, `states` and
+///   `dust_threshold` must be used for every call with the same cursor,
+/// * `page_size` - A number of items per page,
+/// * `sorting` - An enum representing desired sorting,
+/// * `states` - A `TariVector` of UTXO states to filter on, all states are included if null,
+/// * `dust_threshold` - A value filtering threshold. Outputs whose values are <= `dust_threshold` are not listed in the
+///   result.
+/// * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null.
+///   Functions as an out parameter.
+///
+/// ## Returns
+/// `*mut TariVector` - Returns a struct with an array pointer, length and capacity (needed for proper destruction
+/// after use). An empty vector means there are no more UTXOs after the cursor, in which case the cursor is unchanged.
+///
+/// # Safety
+/// `destroy_tari_vector()` must be called after use.
+// casting here is okay as we wont have more than u32 utxos
+#[allow(clippy::cast_possible_truncation)]
+#[no_mangle]
+pub unsafe extern "C" fn wallet_get_utxos_after(
+    wallet: *mut TariWallet,
+    cursor: *mut TariUtxoCursor,
+    page_size: usize,
+    sorting: TariUtxoSort,
+    states: *mut TariVector,
+    dust_threshold: u64,
+    error_ptr: *mut i32,
+) -> *mut TariVector {
+    if wallet.is_null() {
+        error!(target: LOG_TARGET, "wallet pointer is null");
+        ptr::replace(
+            error_ptr,
+            LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code,
+        );
+        return ptr::null_mut();
+    }
+    if cursor.is_null() {
+        error!(target: LOG_TARGET, "cursor pointer is null");
+        ptr::replace(
+            error_ptr,
+            LibWalletError::from(InterfaceError::NullError("cursor".to_string())).code,
+        );
+        return ptr::null_mut();
+    }
+
+    let page_size = i64::from_usize(page_size).unwrap_or(i64::MAX);
+    let dust_threshold = i64::from_u64(dust_threshold).unwrap_or(0);
+
+    let status = {
+        if states.is_null() || (*states).ptr.is_null() {
+            vec![]
+        } else {
+            // the states vector remains owned by the caller, so it is only borrowed here
+            slice::from_raw_parts((*states).ptr as *const u64, (*states).len)
+                .iter()
+                .filter_map(|x| OutputStatus::try_from(*x as i32).ok())
+                .collect_vec()
+        }
+    };
+
+    let q = OutputBackendQuery {
+        tip_height: i64::MAX,
+        status,
+        commitments: vec![],
+        pagination: Some((0, page_size)),
+        value_min: Some((dust_threshold, false)),
+        value_max: None,
+        sorting: vec![sorting.as_query_sorting()],
+        cursor: (*cursor).0,
+    };
+
+    match (*wallet).wallet.output_db.fetch_outputs_page_by_query(q) {
+        Ok(page) => {
+            if page.next_cursor.is_some() {
+                (*cursor).0 = page.next_cursor;
+            }
+            ptr::replace(error_ptr, 0);
+            Box::into_raw(Box::new(TariVector::from(page.outputs)))
+        },
+
+        Err(e) => {
+            error!(target: LOG_TARGET, "failed to obtain outputs: {:#?}", e);
+            ptr::replace(
+                error_ptr,
+                LibWalletError::from(WalletError::OutputManagerError(
+                    OutputManagerError::OutputManagerStorageError(e),
+                ))
+                .code,
+            );
+            ptr::null_mut()
+        },
+    }
+}
+
 /// This function returns a list of all UTXO values, commitment's hex values and states.
 ///
 /// ## Arguments
@@ -6254,6 +7937,7 @@ pub unsafe extern "C" fn wallet_get_all_utxos(wallet: *mut TariWallet, error_ptr
         value_min: None,
         value_max: None,
         sorting: vec![],
+        cursor: None,
     };
 
     match (*wallet).wallet.output_db.fetch_outputs_by_query(q) {
@@ -6578,6 +8262,196 @@ pub unsafe extern "C" fn wallet_preview_coin_split(
     }
 }
 
+/// Creates an enabled TariUtxoCompactionPolicy with the default dust, fee and split settings. It can be adjusted with
+/// the `utxo_compaction_policy_set_*` functions and applied with `wallet_set_utxo_compaction_policy`.
+///
+/// ## Arguments
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariUtxoCompactionPolicy` - Returns a pointer to a TariUtxoCompactionPolicy
+///
+/// # Safety
+/// The ```utxo_compaction_policy_destroy``` method must be called when finished with a TariUtxoCompactionPolicy to
+/// prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn utxo_compaction_policy_create(error_out: *mut c_int) -> *mut TariUtxoCompactionPolicy {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    Box::into_raw(Box::new(UtxoCompactionPolicy {
+        enabled: true,
+        ..Default::default()
+    }))
+}
+
+/// Sets which outputs are dust and how they are joined
+///
+/// ## Arguments
+/// `policy` - The TariUtxoCompactionPolicy pointer
+/// `dust_threshold` - Outputs with a value below this, in micro MinoTari, are dust
+/// `min_dust_outputs` - The number of dust outputs that must be present before they are joined, at least 2
+/// `max_inputs_per_join` - The maximum number of dust outputs joined in a single transaction, at least 2
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn utxo_compaction_policy_set_dust(
+    policy: *mut TariUtxoCompactionPolicy,
+    dust_threshold: c_ulonglong,
+    min_dust_outputs: c_uint,
+    max_inputs_per_join: c_uint,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if policy.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("policy".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*policy).dust_threshold = dust_threshold;
+    (*policy).min_dust_outputs = min_dust_outputs as usize;
+    (*policy).max_inputs_per_join = max_inputs_per_join as usize;
+}
+
+/// Sets when compaction may happen and how much it may spend on fees
+///
+/// ## Arguments
+/// `policy` - The TariUtxoCompactionPolicy pointer
+/// `max_fee_per_gram` - Compaction only happens while the next block's minimum mempool fee per gram is at or below this
+/// `fee_budget` - The total fee, in micro MinoTari, that compaction may spend in each budget period
+/// `budget_period_secs` - The length of the fee budget period in seconds, must be greater than 0
+/// `min_interval_secs` - The minimum number of seconds between two compaction transactions
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn utxo_compaction_policy_set_fee_limits(
+    policy: *mut TariUtxoCompactionPolicy,
+    max_fee_per_gram: c_ulonglong,
+    fee_budget: c_ulonglong,
+    budget_period_secs: c_ulonglong,
+    min_interval_secs: c_ulonglong,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if policy.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("policy".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*policy).max_fee_per_gram = max_fee_per_gram;
+    (*policy).fee_budget = fee_budget;
+    (*policy).budget_period_secs = budget_period_secs;
+    (*policy).min_interval_secs = min_interval_secs;
+}
+
+/// Sets the pool of evenly split outputs that is kept available for parallel sends
+///
+/// ## Arguments
+/// `policy` - The TariUtxoCompactionPolicy pointer
+/// `target_split_count` - The number of outputs of roughly `target_split_value` to keep available, 0 disables
+/// splitting
+/// `target_split_value` - The value of the pooled outputs in micro MinoTari, more than twice the dust threshold
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn utxo_compaction_policy_set_split_target(
+    policy: *mut TariUtxoCompactionPolicy,
+    target_split_count: c_uint,
+    target_split_value: c_ulonglong,
+    error_out: *mut c_int,
+) {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if policy.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("policy".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return;
+    }
+    (*policy).target_split_count = target_split_count as usize;
+    (*policy).target_split_value = target_split_value;
+}
+
+/// Frees memory for a TariUtxoCompactionPolicy
+///
+/// ## Arguments
+/// `policy` - The TariUtxoCompactionPolicy pointer
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn utxo_compaction_policy_destroy(policy: *mut TariUtxoCompactionPolicy) {
+    if !policy.is_null() {
+        drop(Box::from_raw(policy))
+    }
+}
+
+/// Applies a UTXO compaction policy to the wallet's background compaction task, which joins dust outputs while fees are
+/// low and keeps a pool of evenly split outputs. The policy is copied, so it can be destroyed after this call.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer
+/// `policy` - The TariUtxoCompactionPolicy pointer, or null to disable compaction
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `bool` - Returns true if the policy was applied, false if the wallet is null or an enabled policy is not valid
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn wallet_set_utxo_compaction_policy(
+    wallet: *mut TariWallet,
+    policy: *const TariUtxoCompactionPolicy,
+    error_out: *mut c_int,
+) -> bool {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+    let policy = match policy.as_ref() {
+        Some(policy) => policy.clone(),
+        None => UtxoCompactionPolicy {
+            enabled: false,
+            ..(*wallet).wallet.get_utxo_compaction_policy()
+        },
+    };
+    match (*wallet).wallet.set_utxo_compaction_policy(policy) {
+        Ok(_) => true,
+        Err(e) => {
+            error = LibWalletError::from(e).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            false
+        },
+    }
+}
+
 /// Signs a message using the public key of the TariWallet
 ///
 /// ## Arguments
@@ -6738,7 +8612,48 @@ pub unsafe extern "C" fn wallet_verify_message_signature(
         ptr::swap(error_out, &mut error as *mut c_int);
     }
 
-    result
+    result
+}
+
+/// Limits how often the base node state and connectivity status callbacks fire. Either callback only fires when its
+/// state has changed, and at most once per `min_interval_ms`; a change within the interval is held back and the
+/// latest state is delivered when the interval ends. The base node state counts as changed when the base node, its
+/// height, its synced flag or its latency bucket changes.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer
+/// `min_interval_ms` - The minimum number of milliseconds between two callbacks of the same kind, 0 to deliver every
+/// change as it happens (the default)
+/// `latency_bucket_ms` - The width, in milliseconds, of the buckets base node latencies are compared in, 0 to compare
+/// them exactly. The default is 100.
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `bool` - Returns if successful or not
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn wallet_set_state_callback_throttle(
+    wallet: *mut TariWallet,
+    min_interval_ms: c_ulonglong,
+    latency_bucket_ms: c_ulonglong,
+    error_out: *mut c_int,
+) -> bool {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+
+    (*wallet).state_callback_throttle.send_replace(StateCallbackThrottle {
+        min_interval: Duration::from_millis(min_interval_ms),
+        latency_bucket: Duration::from_millis(latency_bucket_ms),
+    });
+    true
 }
 
 /// Adds a base node peer to the TariWallet
@@ -7199,6 +9114,154 @@ pub unsafe extern "C" fn wallet_send_transaction(
     }
 }
 
+/// Sends one-sided payments to several recipients in as few transactions as possible. Recipients share the input
+/// selection, kernel and change output of their transaction instead of each paying for their own, which makes this
+/// much cheaper than calling `wallet_send_transaction` once per recipient for payout runs.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer
+/// `destinations` - An array of `count` TariWalletAddress pointers
+/// `amounts` - An array of `count` amounts, one per destination
+/// `payment_ids` - An array of `count` char pointers holding the payment id for each destination, which is encrypted
+/// into the recipient's output. The array, or any entry in it, may be null for no payment id
+/// `count` - The number of recipients
+/// `commitments` - A `TariVector` of "strings", tagged as `TariTypeTag::String`, containing commitment's hex values
+///   (see `Commitment::to_hex()`) to spend, may be null to let the wallet select the inputs
+/// `fee_per_gram` - The transaction fee
+/// `message` - The pointer to a char array holding the message stored with the transactions
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariVector` - Returns a `TariVector` tagged as `TariTypeTag::U64` holding the TxIds of the sent
+/// transactions, or null if unsuccessful. All transactions are funded before any is sent, so a failure normally
+/// sends nothing. If some were already sent when a later one failed, `error_out` is set to 213 and the returned
+/// vector holds the TxIds of the transactions that were sent
+///
+/// # Safety
+/// The `destinations`, `amounts` and `payment_ids` arrays must hold at least `count` elements. The returned
+/// `TariVector` must be freed after use with `destroy_tari_vector()`
+#[no_mangle]
+pub unsafe extern "C" fn wallet_send_transaction_batch(
+    wallet: *mut TariWallet,
+    destinations: *const *mut TariWalletAddress,
+    amounts: *const c_ulonglong,
+    payment_ids: *const *const c_char,
+    count: usize,
+    commitments: *mut TariVector,
+    fee_per_gram: c_ulonglong,
+    message: *const c_char,
+    error_out: *mut c_int,
+) -> *mut TariVector {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    if destinations.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("destinations".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+    if amounts.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("amounts".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+
+    let selection_criteria = match commitments.as_ref() {
+        None => UtxoSelectionCriteria::default(),
+        Some(cs) => match cs.to_commitment_vec() {
+            Ok(cs) => UtxoSelectionCriteria::specific(cs),
+            Err(e) => {
+                error!(target: LOG_TARGET, "failed to convert from tari vector: {:?}", e);
+                ptr::replace(error_out, LibWalletError::from(e).code as c_int);
+                return ptr::null_mut();
+            },
+        },
+    };
+
+    let message_string = if message.is_null() {
+        String::new()
+    } else {
+        match CStr::from_ptr(message).to_str() {
+            Ok(v) => v.to_owned(),
+            _ => {
+                error = LibWalletError::from(InterfaceError::NullError("message".to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        }
+    };
+
+    let destinations = slice::from_raw_parts(destinations, count);
+    let amounts = slice::from_raw_parts(amounts, count);
+    let payment_ids = if payment_ids.is_null() {
+        None
+    } else {
+        Some(slice::from_raw_parts(payment_ids, count))
+    };
+    let mut recipients = Vec::with_capacity(count);
+    for (i, (destination, amount)) in destinations.iter().zip(amounts).enumerate() {
+        let destination = match destination.as_ref() {
+            Some(d) => d.clone(),
+            None => {
+                error = LibWalletError::from(InterfaceError::NullError(format!("destinations[{}]", i))).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return ptr::null_mut();
+            },
+        };
+        let payment_id = match payment_ids.map(|p| p[i]) {
+            Some(p) if !p.is_null() => match CStr::from_ptr(p).to_str() {
+                Ok(v) => PaymentId::Open(v.as_bytes().to_vec()),
+                _ => {
+                    error = LibWalletError::from(InterfaceError::NullError(format!("payment_ids[{}]", i))).code;
+                    ptr::swap(error_out, &mut error as *mut c_int);
+                    return ptr::null_mut();
+                },
+            },
+            _ => PaymentId::Empty,
+        };
+        recipients.push(PaymentRecipient {
+            destination,
+            amount: MicroMinotari::from(*amount),
+            payment_id,
+        });
+    }
+
+    match (*wallet).runtime.block_on(
+        (*wallet)
+            .wallet
+            .transaction_service
+            .send_one_sided_to_stealth_address_batch(
+                recipients,
+                selection_criteria,
+                MicroMinotari::from(fee_per_gram),
+                message_string,
+            ),
+    ) {
+        Ok(tx_ids) => Box::into_raw(Box::new(TariVector::from(
+            tx_ids.into_iter().map(|tx_id| tx_id.as_u64()).collect::<Vec<u64>>(),
+        ))),
+        Err(e) => {
+            let sent = match &e {
+                TransactionServiceError::BatchPartiallySent { sent, .. } => {
+                    Some(sent.iter().map(|tx_id| tx_id.as_u64()).collect::<Vec<u64>>())
+                },
+                _ => None,
+            };
+            error = LibWalletError::from(WalletError::TransactionServiceError(e)).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            match sent {
+                Some(sent) => Box::into_raw(Box::new(TariVector::from(sent))),
+                None => ptr::null_mut(),
+            }
+        },
+    }
+}
+
 /// Gets a fee estimate for an amount
 ///
 /// ## Arguments
@@ -7436,6 +9499,121 @@ pub unsafe extern "C" fn wallet_get_completed_transactions(
     }
 }
 
+/// Exports the completed transaction history of a TariWallet to a file, cancelled transactions included. The history is
+/// read, decrypted and written a page at a time, so memory use does not grow with the size of the wallet. The file is
+/// written next to `path` and only renamed to `path` once the export is complete.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer
+/// `path` - The path of the file to write, an existing file is replaced
+/// `format` - The file format:
+///     0 => CSV, one row per transaction with a header row, amounts in micro MinoTari and timestamps in UTC
+///     1 => Binary, a sequence of records that are each the little endian 32 bit length of a
+///          `tari_completed_transaction_to_bytes` buffer followed by the buffer
+/// `from_time` - Only transactions at or after this unix timestamp in seconds are exported, 0 for no lower bound
+/// `to_time` - Only transactions before this unix timestamp in seconds are exported, 0 for no upper bound
+/// `callback_progress` - The callback function pointer which is called with the number of transactions written so far
+/// after every page
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `c_ulonglong` - Returns the number of transactions exported, 0 if an error occurred
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn wallet_export_history(
+    wallet: *mut TariWallet,
+    path: *const c_char,
+    format: c_uint,
+    from_time: c_ulonglong,
+    to_time: c_ulonglong,
+    callback_progress: unsafe extern "C" fn(c_ulonglong),
+    error_out: *mut c_int,
+) -> c_ulonglong {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return 0;
+    }
+    if path.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("path".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return 0;
+    }
+    let path = match CStr::from_ptr(path).to_str() {
+        Ok(v) => PathBuf::from(v),
+        Err(_) => {
+            error = LibWalletError::from(InterfaceError::PointerError("path".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return 0;
+        },
+    };
+    let format = match format {
+        0 => HistoryFormat::Csv,
+        1 => HistoryFormat::Binary,
+        _ => {
+            error = LibWalletError::from(InterfaceError::InvalidArgument("format".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return 0;
+        },
+    };
+    let to_naive_date_time = |secs: c_ulonglong| {
+        i64::try_from(secs)
+            .ok()
+            .and_then(|secs| NaiveDateTime::from_timestamp_opt(secs, 0))
+    };
+    let from_time = match from_time {
+        0 => None,
+        secs => match to_naive_date_time(secs) {
+            Some(t) => Some(t),
+            None => {
+                error = LibWalletError::from(InterfaceError::InvalidArgument("from_time".to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return 0;
+            },
+        },
+    };
+    let to_time = match to_time {
+        0 => None,
+        secs => match to_naive_date_time(secs) {
+            Some(t) => Some(t),
+            None => {
+                error = LibWalletError::from(InterfaceError::InvalidArgument("to_time".to_string())).code;
+                ptr::swap(error_out, &mut error as *mut c_int);
+                return 0;
+            },
+        },
+    };
+
+    let transaction_service = (*wallet).wallet.transaction_service.clone();
+    match (*wallet).runtime.block_on(history_export::export_history(
+        transaction_service,
+        &path,
+        format,
+        from_time,
+        to_time,
+        |written| callback_progress(written),
+    )) {
+        Ok(written) => written,
+        Err(e) => {
+            error!(target: LOG_TARGET, "Error exporting the wallet history: {}", e);
+            error = match e {
+                HistoryExportError::TransactionService(e) => {
+                    LibWalletError::from(WalletError::TransactionServiceError(e)).code
+                },
+                HistoryExportError::Io(e) => LibWalletError::from(InterfaceError::FileError(e.to_string())).code,
+                HistoryExportError::Encoding(e) => LibWalletError::from(InterfaceError::InvalidArgument(e)).code,
+            };
+            ptr::swap(error_out, &mut error as *mut c_int);
+            0
+        },
+    }
+}
+
 /// Get the TariPendingInboundTransactions from a TariWallet
 ///
 /// Currently a CompletedTransaction with the Status of Completed and Broadcast is considered Pending by the frontend
@@ -7644,15 +9822,10 @@ pub unsafe extern "C" fn wallet_get_cancelled_transactions(
     for tx in completed_transactions.values() {
         completed.push(tx.clone());
     }
-    let runtime = match Runtime::new() {
-        Ok(r) => r,
-        Err(e) => {
-            error = LibWalletError::from(InterfaceError::TokioError(e.to_string())).code;
-            ptr::swap(error_out, &mut error as *mut c_int);
-            return ptr::null_mut();
-        },
-    };
-    let wallet_address = match runtime.block_on(async { (*wallet).wallet.get_wallet_interactive_address().await }) {
+    let wallet_address = match (*wallet)
+        .runtime
+        .block_on(async { (*wallet).wallet.get_wallet_interactive_address().await })
+    {
         Ok(address) => address,
         Err(e) => {
             error = LibWalletError::from(e).code;
@@ -8227,6 +10400,148 @@ pub unsafe extern "C" fn wallet_restart_transaction_broadcast(wallet: *mut TariW
     }
 }
 
+/// Gets how much broadcast work the wallet has queued and in flight. The broadcast protocols of all completed
+/// transactions share one scheduler, which submits transactions to the base node and queries their status in batches.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `*mut TariBroadcastQueueStats` - Returns a pointer to a TariBroadcastQueueStats, or null if an error occurred
+///
+/// # Safety
+/// The ```broadcast_queue_stats_destroy``` method must be called when finished with a TariBroadcastQueueStats to
+/// prevent a memory leak
+#[no_mangle]
+pub unsafe extern "C" fn wallet_get_broadcast_queue_stats(
+    wallet: *mut TariWallet,
+    error_out: *mut c_int,
+) -> *mut TariBroadcastQueueStats {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return ptr::null_mut();
+    }
+
+    match (*wallet)
+        .runtime
+        .block_on((*wallet).wallet.transaction_service.get_broadcast_queue_stats())
+    {
+        Ok(stats) => Box::into_raw(Box::new(stats)),
+        Err(e) => {
+            error = LibWalletError::from(WalletError::TransactionServiceError(e)).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            ptr::null_mut()
+        },
+    }
+}
+
+/// Gets the number of transaction submissions and status queries waiting for a broadcast batch
+///
+/// ## Arguments
+/// `stats` - The TariBroadcastQueueStats pointer
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `c_ulonglong` - The number of queued requests, 0 if stats is null
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn broadcast_queue_stats_get_queued(
+    stats: *mut TariBroadcastQueueStats,
+    error_out: *mut c_int,
+) -> c_ulonglong {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if stats.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("stats".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return 0;
+    }
+
+    (*stats).queued as c_ulonglong
+}
+
+/// Gets the number of transaction submissions and status queries in broadcast batches that are being sent, or backing
+/// off after a failed attempt
+///
+/// ## Arguments
+/// `stats` - The TariBroadcastQueueStats pointer
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `c_ulonglong` - The number of requests in flight, 0 if stats is null
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn broadcast_queue_stats_get_in_flight(
+    stats: *mut TariBroadcastQueueStats,
+    error_out: *mut c_int,
+) -> c_ulonglong {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if stats.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("stats".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return 0;
+    }
+
+    (*stats).in_flight as c_ulonglong
+}
+
+/// Gets the number of broadcast batches that are being sent, or backing off after a failed attempt
+///
+/// ## Arguments
+/// `stats` - The TariBroadcastQueueStats pointer
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `c_ulonglong` - The number of batches in flight, 0 if stats is null
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn broadcast_queue_stats_get_batches_in_flight(
+    stats: *mut TariBroadcastQueueStats,
+    error_out: *mut c_int,
+) -> c_ulonglong {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+    if stats.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("stats".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return 0;
+    }
+
+    (*stats).batches_in_flight as c_ulonglong
+}
+
+/// Frees memory for a TariBroadcastQueueStats
+///
+/// ## Arguments
+/// `stats` - The pointer to a TariBroadcastQueueStats
+///
+/// ## Returns
+/// `()` - Does not return a value, equivalent to void in C
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn broadcast_queue_stats_destroy(stats: *mut TariBroadcastQueueStats) {
+    if !stats.is_null() {
+        drop(Box::from_raw(stats))
+    }
+}
+
 /// Gets the seed words representing the seed private key of the provided `TariWallet`.
 ///
 /// ## Arguments
@@ -8623,8 +10938,169 @@ pub unsafe extern "C" fn wallet_start_recovery(
         return false;
     }
 
-    let shutdown_signal = (*wallet).shutdown.to_signal();
     let peer_public_keys: Vec<TariPublicKey> = vec![(*base_node_public_key).clone()];
+    start_recovery(
+        wallet,
+        peer_public_keys,
+        None,
+        recovery_progress_callback,
+        recovered_output_message,
+        error_out,
+    )
+}
+
+/// Starts the Wallet recovery process using several base nodes at once. The height range to be scanned is split into
+/// segments that are downloaded concurrently from the different base nodes. A segment that fails or is too slow is
+/// reassigned to another base node, and segments are always processed in height order.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer.
+/// `base_node_public_keys` - A `TariVector` of "strings", tagged as `TariTypeTag::Text`, containing the hex public keys
+/// of the Base Nodes the recovery process will use. The first one is used to determine the chain tip.
+/// `recovery_progress_callback` - The callback function pointer that will be used to asynchronously communicate
+/// progress to the client, see `wallet_start_recovery` for the events.
+/// `recovered_output_message` - A string that will be used as the message for any recovered outputs. If Null the
+/// default message will be used
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `bool` - Return a boolean value indicating whether the process started successfully or not, the process will
+/// continue to run asynchronously and communicate it progress via the callback. An error will also produce a false
+/// result.
+///
+/// # Safety
+/// `base_node_public_keys` remains owned by the caller and must be freed with `destroy_tari_vector()` after use
+#[no_mangle]
+pub unsafe extern "C" fn wallet_start_recovery_from_peers(
+    wallet: *mut TariWallet,
+    base_node_public_keys: *mut TariVector,
+    recovery_progress_callback: unsafe extern "C" fn(u8, u64, u64),
+    recovered_output_message: *const c_char,
+    error_out: *mut c_int,
+) -> bool {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+    if base_node_public_keys.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("base_node_public_keys".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+
+    let peer_public_keys = match (*base_node_public_keys).to_public_key_vec() {
+        Ok(keys) if !keys.is_empty() => keys,
+        Ok(_) => {
+            error = LibWalletError::from(InterfaceError::InvalidArgument(
+                "base_node_public_keys is empty".to_string(),
+            ))
+            .code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return false;
+        },
+        Err(e) => {
+            error = LibWalletError::from(e).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return false;
+        },
+    };
+    start_recovery(
+        wallet,
+        peer_public_keys,
+        None,
+        recovery_progress_callback,
+        recovered_output_message,
+        error_out,
+    )
+}
+
+/// Starts the Wallet recovery process from a local block output snapshot file instead of a base node, so that no
+/// network connection is needed. The snapshot holds the outputs of every block of a chain, is read from the wallet
+/// birthday onwards, and must have been taken from the chain the wallet will be used on: a snapshot of another
+/// network, or with another genesis block than the base node when one is set, fails the recovery. Outputs that were
+/// already recovered are skipped, so the recovery can be repeated against the same snapshot.
+///
+/// ## Arguments
+/// `wallet` - The TariWallet pointer.
+/// `snapshot_path` - The path of the block output snapshot file.
+/// `recovery_progress_callback` - The callback function pointer that will be used to asynchronously communicate
+/// progress to the client, see `wallet_start_recovery` for the events. No connection events are sent.
+/// `recovered_output_message` - A string that will be used as the message for any recovered outputs. If Null the
+/// default message will be used
+/// `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+/// as an out parameter.
+///
+/// ## Returns
+/// `bool` - Return a boolean value indicating whether the process started successfully or not, the process will
+/// continue to run asynchronously and communicate it progress via the callback. An error will also produce a false
+/// result.
+///
+/// # Safety
+/// None
+#[no_mangle]
+pub unsafe extern "C" fn wallet_start_recovery_from_snapshot(
+    wallet: *mut TariWallet,
+    snapshot_path: *const c_char,
+    recovery_progress_callback: unsafe extern "C" fn(u8, u64, u64),
+    recovered_output_message: *const c_char,
+    error_out: *mut c_int,
+) -> bool {
+    let mut error = 0;
+    ptr::swap(error_out, &mut error as *mut c_int);
+
+    if wallet.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+    if snapshot_path.is_null() {
+        error = LibWalletError::from(InterfaceError::NullError("snapshot_path".to_string())).code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+    let snapshot_path = match CStr::from_ptr(snapshot_path).to_str() {
+        Ok(v) => PathBuf::from(v),
+        _ => {
+            error = LibWalletError::from(InterfaceError::PointerError("snapshot_path".to_string())).code;
+            ptr::swap(error_out, &mut error as *mut c_int);
+            return false;
+        },
+    };
+    if !snapshot_path.is_file() {
+        error = LibWalletError::from(InterfaceError::InvalidArgument(format!(
+            "snapshot_path '{}' is not a file",
+            snapshot_path.display()
+        )))
+        .code;
+        ptr::swap(error_out, &mut error as *mut c_int);
+        return false;
+    }
+
+    start_recovery(
+        wallet,
+        vec![],
+        Some(snapshot_path),
+        recovery_progress_callback,
+        recovered_output_message,
+        error_out,
+    )
+}
+
+unsafe fn start_recovery(
+    wallet: *mut TariWallet,
+    peer_public_keys: Vec<TariPublicKey>,
+    snapshot_path: Option<PathBuf>,
+    recovery_progress_callback: unsafe extern "C" fn(u8, u64, u64),
+    recovered_output_message: *const c_char,
+    error_out: *mut c_int,
+) -> bool {
+    let mut error = 0;
+    let shutdown_signal = (*wallet).shutdown.to_signal();
     let mut recovery_task_builder = UtxoScannerService::<WalletSqliteDatabase, WalletConnectivityHandle>::builder();
 
     if !recovered_output_message.is_null() {
@@ -8638,6 +11114,9 @@ pub unsafe extern "C" fn wallet_start_recovery(
         };
         recovery_task_builder.with_recovery_message(message_str);
     }
+    if let Some(path) = snapshot_path {
+        recovery_task_builder.with_block_output_snapshot(path);
+    }
     let runtime = match Runtime::new() {
         Ok(r) => r,
         Err(e) => {
@@ -8831,7 +11310,8 @@ pub unsafe extern "C" fn emoji_set_destroy(emoji_set: *mut EmojiSet) {
     }
 }
 
-/// Frees memory for a TariWallet
+/// Frees memory for a TariWallet, blocking until the wallet has shut down. A wallet of a TariWalletHost leaves the
+/// shared comms node running, so only its own services and callback handler are waited for.
 ///
 /// ## Arguments
 /// `wallet` - The TariWallet pointer
@@ -8847,8 +11327,21 @@ pub unsafe extern "C" fn wallet_destroy(wallet: *mut TariWallet) {
     if !wallet.is_null() {
         debug!(target: LOG_TARGET, "Wallet pointer not yet destroyed, shutting down now");
         let mut w = Box::from_raw(wallet);
-        let wallet_comms = w.wallet.comms.clone();
         w.shutdown.trigger();
+        if w.hosted {
+            // The comms node belongs to the host and keeps running for its other wallets, so only the services and the
+            // callback handler of this wallet are waited for
+            let wallet = w.wallet;
+            let callback_handler = w.callback_handler;
+            w.runtime.block_on(async move {
+                wallet.wait_until_services_complete().await;
+                if let Err(e) = callback_handler.await {
+                    warn!(target: LOG_TARGET, "Callback handler of a hosted wallet did not finish cleanly: {}", e);
+                }
+            });
+            return;
+        }
+        let wallet_comms = w.wallet.comms.clone();
         w.runtime.block_on(w.wallet.wait_until_shutdown());
         // The wallet should be shutdown by now; these are just additional confirmations
         loop {
@@ -9445,77 +11938,474 @@ mod test {
         completed_transaction_destroy(tx);
     }
 
-    unsafe extern "C" fn txo_validation_complete_callback(_tx_id: c_ulonglong, _result: u64) {
-        // assert!(true); //optimized out by compiler
+    unsafe extern "C" fn txo_validation_complete_callback(_tx_id: c_ulonglong, _result: u64) {
+        // assert!(true); //optimized out by compiler
+    }
+
+    unsafe extern "C" fn contacts_liveness_data_updated_callback(_balance: *mut TariContactsLivenessData) {
+        // assert!(true); //optimized out by compiler
+    }
+
+    unsafe extern "C" fn balance_updated_callback(_balance: *mut TariBalance) {
+        // assert!(true); //optimized out by compiler
+    }
+
+    unsafe extern "C" fn transaction_validation_complete_callback(_tx_id: c_ulonglong, _result: u64) {
+        // assert!(true); //optimized out by compiler
+    }
+
+    unsafe extern "C" fn saf_messages_received_callback() {
+        // assert!(true); //optimized out by compiler
+    }
+
+    unsafe extern "C" fn connectivity_status_callback(_status: u64) {
+        // assert!(true); //optimized out by compiler
+    }
+
+    unsafe extern "C" fn base_node_state_callback(_state: *mut TariBaseNodeState) {
+        // assert!(true); //optimized out by compiler
+    }
+
+    #[cfg(tari_target_network_mainnet)]
+    const NETWORK_STRING: &str = "stagenet";
+    #[cfg(tari_target_network_nextnet)]
+    const NETWORK_STRING: &str = "nextnet";
+    #[cfg(not(any(tari_target_network_mainnet, tari_target_network_nextnet)))]
+    const NETWORK_STRING: &str = "localnet";
+
+    #[test]
+    // casting is okay in tests
+    #[allow(clippy::cast_possible_truncation)]
+    fn test_bytevector() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let bytes: [c_uchar; 4] = [2, 114, 34, 255];
+            let bytes_ptr = byte_vector_create(bytes.as_ptr(), bytes.len() as c_uint, error_ptr);
+            assert_eq!(error, 0);
+            let length = byte_vector_get_length(bytes_ptr, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(length, bytes.len() as c_uint);
+            let byte = byte_vector_get_at(bytes_ptr, 2, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(byte, bytes[2]);
+            byte_vector_destroy(bytes_ptr);
+        }
+    }
+
+    #[test]
+    fn test_bytevector_dont_panic() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let bytes_ptr = byte_vector_create(ptr::null_mut(), 20u32, error_ptr);
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("bytes_ptr".to_string())).code
+            );
+            assert_eq!(byte_vector_get_length(bytes_ptr, error_ptr), 0);
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("bytes_ptr".to_string())).code
+            );
+            byte_vector_destroy(bytes_ptr);
+        }
+    }
+
+    #[test]
+    fn test_sqlite_profile() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let profile = sqlite_profile_create(3, error_ptr);
+            assert!(profile.is_null());
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::InvalidArgument("preset".to_string())).code
+            );
+
+            let profile = sqlite_profile_create(1, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(*profile, SqlitePerformanceProfile::mobile());
+
+            sqlite_profile_set_pool_size(profile, 8, error_ptr);
+            assert_eq!(error, 0);
+            sqlite_profile_set_mmap_size(profile, 1024 * 1024, error_ptr);
+            assert_eq!(error, 0);
+            sqlite_profile_set_cache_size(profile, 0, error_ptr);
+            assert_eq!(error, 0);
+            sqlite_profile_set_synchronous(profile, 2, error_ptr);
+            assert_eq!(error, 0);
+            sqlite_profile_set_temp_store(profile, 2, error_ptr);
+            assert_eq!(error, 0);
+            sqlite_profile_set_wal_autocheckpoint(profile, 0, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(*profile, SqlitePerformanceProfile {
+                pool_size: 8,
+                mmap_size: Some(1024 * 1024),
+                cache_size_kib: None,
+                synchronous: SqliteSynchronous::Full,
+                temp_store: SqliteTempStore::Memory,
+                wal_autocheckpoint_pages: Some(0),
+            });
+
+            sqlite_profile_set_pool_size(profile, 0, error_ptr);
+            assert_ne!(error, 0);
+            sqlite_profile_set_synchronous(profile, 4, error_ptr);
+            assert_ne!(error, 0);
+            assert_eq!((*profile).pool_size, 8);
+            assert_eq!((*profile).synchronous, SqliteSynchronous::Full);
+
+            sqlite_profile_destroy(profile);
+        }
+    }
+
+    #[test]
+    fn test_utxo_compaction_policy() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let policy = utxo_compaction_policy_create(error_ptr);
+            assert_eq!(error, 0);
+            assert!((*policy).enabled);
+
+            utxo_compaction_policy_set_dust(policy, 5_000, 20, 100, error_ptr);
+            assert_eq!(error, 0);
+            utxo_compaction_policy_set_fee_limits(policy, 2, 50_000, 3600, 300, error_ptr);
+            assert_eq!(error, 0);
+            utxo_compaction_policy_set_split_target(policy, 10, 1_000_000, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(*policy, UtxoCompactionPolicy {
+                enabled: true,
+                dust_threshold: 5_000,
+                min_dust_outputs: 20,
+                max_inputs_per_join: 100,
+                max_fee_per_gram: 2,
+                fee_budget: 50_000,
+                budget_period_secs: 3600,
+                min_interval_secs: 300,
+                target_split_count: 10,
+                target_split_value: 1_000_000,
+            });
+            assert!((*policy).validate().is_ok());
+
+            utxo_compaction_policy_set_split_target(ptr::null_mut(), 10, 1_000_000, error_ptr);
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("policy".to_string())).code
+            );
+            assert!(!wallet_set_utxo_compaction_policy(ptr::null_mut(), policy, error_ptr));
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code
+            );
+
+            utxo_compaction_policy_destroy(policy);
+        }
+    }
+
+    #[test]
+    fn test_wallet_import_external_utxos_arguments() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let mut outputs = TariUnblindedOutputs(Vec::new());
+            let results = wallet_import_external_utxos_as_non_rewindable(
+                ptr::null_mut(),
+                &mut outputs,
+                ptr::null_mut(),
+                ptr::null(),
+                error_ptr,
+            );
+            assert!(results.is_null());
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code
+            );
+
+            let results = Box::into_raw(Box::new(TariUtxoImportResults {
+                tx_ids: Box::into_raw(Box::new(TariVector::from(vec![7u64, 0]))),
+                error_codes: Box::into_raw(Box::new(TariVector::from(vec![0i64, 1]))),
+            }));
+            destroy_tari_utxo_import_results(results);
+            destroy_tari_utxo_import_results(ptr::null_mut());
+        }
     }
 
-    unsafe extern "C" fn contacts_liveness_data_updated_callback(_balance: *mut TariContactsLivenessData) {
+    unsafe extern "C" fn export_progress_callback(_written: c_ulonglong) {
         // assert!(true); //optimized out by compiler
     }
 
-    unsafe extern "C" fn balance_updated_callback(_balance: *mut TariBalance) {
-        // assert!(true); //optimized out by compiler
+    #[test]
+    fn test_wallet_export_history_arguments() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let path = CString::new("history.csv").unwrap();
+            let written = wallet_export_history(
+                ptr::null_mut(),
+                path.as_ptr(),
+                0,
+                0,
+                0,
+                export_progress_callback,
+                error_ptr,
+            );
+            assert_eq!(written, 0);
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code
+            );
+        }
     }
 
-    unsafe extern "C" fn transaction_validation_complete_callback(_tx_id: c_ulonglong, _result: u64) {
-        // assert!(true); //optimized out by compiler
-    }
+    #[test]
+    fn test_wallet_host_arguments() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let passphrase = CString::new("passphrase").unwrap();
+            let host = wallet_host_create(
+                ptr::null_mut(),
+                ptr::null(),
+                0,
+                0,
+                0,
+                passphrase.as_ptr(),
+                ptr::null(),
+                ptr::null(),
+                false,
+                ptr::null_mut(),
+                ptr::null(),
+                error_ptr,
+            );
+            assert!(host.is_null());
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("config".to_string())).code
+            );
 
-    unsafe extern "C" fn saf_messages_received_callback() {
-        // assert!(true); //optimized out by compiler
-    }
+            let public_key = public_key_from_private_key(private_key_generate(), error_ptr);
+            assert!(!wallet_host_set_base_node_peer(
+                ptr::null_mut(),
+                public_key,
+                ptr::null(),
+                error_ptr
+            ));
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("host".to_string())).code
+            );
+            public_key_destroy(public_key);
 
-    unsafe extern "C" fn connectivity_status_callback(_status: u64) {
-        // assert!(true); //optimized out by compiler
+            // Destroying a null host is a no-op
+            wallet_host_destroy(ptr::null_mut());
+        }
     }
 
-    unsafe extern "C" fn base_node_state_callback(_state: *mut TariBaseNodeState) {
-        // assert!(true); //optimized out by compiler
+    /// Creates a comms config on the memory transport with a random database name in `dir`
+    unsafe fn create_memory_comms_config(dir: &Path, error_ptr: *mut c_int) -> *mut TariCommsConfig {
+        let db_name = CString::new(random::string(8).as_str()).unwrap();
+        let db_path = CString::new(dir.to_str().unwrap()).unwrap();
+        let transport = transport_memory_create();
+        let address = transport_memory_get_address(transport, error_ptr);
+        let config = comms_config_create(
+            address,
+            transport,
+            db_name.as_ptr(),
+            db_path.as_ptr(),
+            20,
+            10800,
+            error_ptr,
+        );
+        string_destroy(address);
+        transport_config_destroy(transport);
+        config
     }
 
-    #[cfg(tari_target_network_mainnet)]
-    const NETWORK_STRING: &str = "stagenet";
-    #[cfg(tari_target_network_nextnet)]
-    const NETWORK_STRING: &str = "nextnet";
-    #[cfg(not(any(tari_target_network_mainnet, tari_target_network_nextnet)))]
-    const NETWORK_STRING: &str = "localnet";
-
     #[test]
-    // casting is okay in tests
-    #[allow(clippy::cast_possible_truncation)]
-    fn test_bytevector() {
+    #[allow(clippy::too_many_lines)]
+    fn test_wallet_host_with_two_wallets() {
         unsafe {
             let mut error = 0;
             let error_ptr = &mut error as *mut c_int;
-            let bytes: [c_uchar; 4] = [2, 114, 34, 255];
-            let bytes_ptr = byte_vector_create(bytes.as_ptr(), bytes.len() as c_uint, error_ptr);
-            assert_eq!(error, 0);
-            let length = byte_vector_get_length(bytes_ptr, error_ptr);
+            let mut recovery_in_progress = true;
+            let recovery_in_progress_ptr = &mut recovery_in_progress as *mut bool;
+            let passphrase = CString::new("Satoshi Nakamoto").unwrap();
+            let network = CString::new(NETWORK_STRING).unwrap();
+            let dns_string = CString::new("").unwrap();
+
+            let host_dir = tempdir().unwrap();
+            let host_config = create_memory_comms_config(host_dir.path(), error_ptr);
+            let host = wallet_host_create(
+                host_config,
+                ptr::null(),
+                0,
+                0,
+                0,
+                passphrase.as_ptr(),
+                network.as_ptr(),
+                dns_string.as_ptr(),
+                false,
+                ptr::null_mut(),
+                ptr::null(),
+                error_ptr,
+            );
             assert_eq!(error, 0);
-            assert_eq!(length, bytes.len() as c_uint);
-            let byte = byte_vector_get_at(bytes_ptr, 2, error_ptr);
+            assert!(!host.is_null());
+
+            // Each wallet has a database of its own
+            let wallet_dirs = [tempdir().unwrap(), tempdir().unwrap()];
+            let mut wallets = Vec::with_capacity(wallet_dirs.len());
+            for dir in &wallet_dirs {
+                let config = create_memory_comms_config(dir.path(), error_ptr);
+                let wallet = wallet_host_add_wallet(
+                    host,
+                    config,
+                    passphrase.as_ptr(),
+                    ptr::null(),
+                    ptr::null(),
+                    received_tx_callback,
+                    received_tx_reply_callback,
+                    received_tx_finalized_callback,
+                    broadcast_callback,
+                    mined_callback,
+                    mined_unconfirmed_callback,
+                    scanned_callback,
+                    scanned_unconfirmed_callback,
+                    transaction_send_result_callback,
+                    tx_cancellation_callback,
+                    txo_validation_complete_callback,
+                    contacts_liveness_data_updated_callback,
+                    balance_updated_callback,
+                    transaction_validation_complete_callback,
+                    saf_messages_received_callback,
+                    connectivity_status_callback,
+                    base_node_state_callback,
+                    recovery_in_progress_ptr,
+                    error_ptr,
+                );
+                assert_eq!(error, 0);
+                assert!(!wallet.is_null());
+                comms_config_destroy(config);
+                wallets.push(wallet);
+            }
+            let (wallet_a, wallet_b) = (wallets[0], wallets[1]);
+
+            let runtime = (*host).runtime.clone();
+            let address_a = runtime
+                .block_on((*wallet_a).wallet.get_wallet_one_sided_address())
+                .unwrap();
+            let address_b = runtime
+                .block_on((*wallet_b).wallet.get_wallet_one_sided_address())
+                .unwrap();
+            assert_ne!(address_a, address_b);
+
+            // Only the first wallet receives funds
+            let key_manager = &(*wallet_a).wallet.key_manager_service;
+            let output = runtime.block_on(create_test_input(MicroMinotari(10_000), 0, key_manager, vec![]));
+            runtime
+                .block_on(
+                    (*wallet_a)
+                        .wallet
+                        .output_manager_service
+                        .clone()
+                        .add_output(output, None),
+                )
+                .unwrap();
+            let balance_a = wallet_get_balance(wallet_a, error_ptr);
+            assert_eq!(balance_get_available(balance_a, error_ptr), 10_000);
+            let balance_b = wallet_get_balance(wallet_b, error_ptr);
+            assert_eq!(balance_get_available(balance_b, error_ptr), 0);
+            balance_destroy(balance_a);
+            balance_destroy(balance_b);
+
+            // Setting the base node of the host sets it for every wallet
+            let node_identity =
+                NodeIdentity::random(&mut OsRng, get_next_memory_address(), PeerFeatures::COMMUNICATION_NODE);
+            let base_node_public_key = Box::into_raw(Box::new(node_identity.public_key().clone()));
+            let base_node_address = CString::new(node_identity.first_public_address().unwrap().to_string()).unwrap();
+            assert!(wallet_host_set_base_node_peer(
+                host,
+                base_node_public_key,
+                base_node_address.as_ptr(),
+                error_ptr
+            ));
             assert_eq!(error, 0);
-            assert_eq!(byte, bytes[2]);
-            byte_vector_destroy(bytes_ptr);
+            for wallet in &wallets {
+                assert_eq!(
+                    (**wallet)
+                        .wallet
+                        .wallet_connectivity
+                        .get_current_base_node_peer_public_key()
+                        .as_ref(),
+                    Some(node_identity.public_key())
+                );
+            }
+            public_key_destroy(base_node_public_key);
+
+            // The wallets are destroyed first, leaving the shared network stack to be shut down with the host
+            for wallet in wallets {
+                wallet_destroy(wallet);
+            }
+            wallet_host_destroy(host);
+            comms_config_destroy(host_config);
         }
     }
 
     #[test]
-    fn test_bytevector_dont_panic() {
+    fn test_wallet_set_state_callback_throttle_arguments() {
         unsafe {
             let mut error = 0;
             let error_ptr = &mut error as *mut c_int;
-            let bytes_ptr = byte_vector_create(ptr::null_mut(), 20u32, error_ptr);
+            assert!(!wallet_set_state_callback_throttle(
+                ptr::null_mut(),
+                1000,
+                100,
+                error_ptr
+            ));
             assert_eq!(
                 error,
-                LibWalletError::from(InterfaceError::NullError("bytes_ptr".to_string())).code
+                LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code
             );
-            assert_eq!(byte_vector_get_length(bytes_ptr, error_ptr), 0);
+        }
+    }
+
+    #[test]
+    fn test_broadcast_queue_stats() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            assert!(wallet_get_broadcast_queue_stats(ptr::null_mut(), error_ptr).is_null());
             assert_eq!(
                 error,
-                LibWalletError::from(InterfaceError::NullError("bytes_ptr".to_string())).code
+                LibWalletError::from(InterfaceError::NullError("wallet".to_string())).code
             );
-            byte_vector_destroy(bytes_ptr);
+
+            let stats = Box::into_raw(Box::new(TariBroadcastQueueStats {
+                queued: 3,
+                in_flight: 2,
+                batches_in_flight: 1,
+            }));
+            assert_eq!(broadcast_queue_stats_get_queued(stats, error_ptr), 3);
+            assert_eq!(broadcast_queue_stats_get_in_flight(stats, error_ptr), 2);
+            assert_eq!(broadcast_queue_stats_get_batches_in_flight(stats, error_ptr), 1);
+            assert_eq!(error, 0);
+            broadcast_queue_stats_destroy(stats);
+        }
+    }
+
+    #[test]
+    fn test_runtime_is_shared() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let runtime = tari_runtime_create(2, 0, error_ptr);
+            assert_eq!(error, 0);
+            let shared = (*runtime).clone();
+            tari_runtime_destroy(runtime);
+            // Anything holding on to the runtime can keep using it after the handle is destroyed
+            assert_eq!(shared.block_on(async { 21 * 2 }), 42);
         }
     }
 
@@ -10139,6 +13029,8 @@ mod test {
                 alice_network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -10185,6 +13077,8 @@ mod test {
                 alice_network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -10254,6 +13148,126 @@ mod test {
         }
     }
 
+    #[test]
+    #[allow(clippy::too_many_lines)]
+    fn test_wallet_open_readonly() {
+        unsafe {
+            let mut error = 0;
+            let error_ptr = &mut error as *mut c_int;
+            let mut recovery_in_progress = true;
+            let recovery_in_progress_ptr = &mut recovery_in_progress as *mut bool;
+
+            let db_name = CString::new(random::string(8).as_str()).unwrap();
+            let db_name_str: *const c_char = CString::into_raw(db_name) as *const c_char;
+            let temp_dir = tempdir().unwrap();
+            let db_path = CString::new(temp_dir.path().to_str().unwrap()).unwrap();
+            let db_path_str: *const c_char = CString::into_raw(db_path) as *const c_char;
+            let transport_type = transport_memory_create();
+            let address = transport_memory_get_address(transport_type, error_ptr);
+            let address_str = CStr::from_ptr(address).to_str().unwrap().to_owned();
+            let address_str = CString::new(address_str).unwrap().into_raw() as *const c_char;
+            let network = CString::new(NETWORK_STRING).unwrap();
+            let network_str: *const c_char = CString::into_raw(network) as *const c_char;
+
+            let config = comms_config_create(
+                address_str,
+                transport_type,
+                db_name_str,
+                db_path_str,
+                20,
+                10800,
+                error_ptr,
+            );
+            let passphrase: *const c_char =
+                CString::into_raw(CString::new("a reader of ledgers").unwrap()) as *const c_char;
+
+            // There is no wallet database to read yet
+            let reader = wallet_open_readonly(config, passphrase, ptr::null(), error_ptr);
+            assert!(reader.is_null());
+            assert_eq!(
+                error,
+                LibWalletError::from(WalletError::WalletStorageError(WalletStorageError::DbPathDoesNotExist)).code
+            );
+
+            let dns_string: *const c_char = CString::into_raw(CString::new("").unwrap()) as *const c_char;
+            let wallet = wallet_create(
+                config,
+                ptr::null(),
+                0,
+                0,
+                0,
+                passphrase,
+                ptr::null(),
+                network_str,
+                dns_string,
+                false,
+                ptr::null_mut(),
+                ptr::null(),
+                received_tx_callback,
+                received_tx_reply_callback,
+                received_tx_finalized_callback,
+                broadcast_callback,
+                mined_callback,
+                mined_unconfirmed_callback,
+                scanned_callback,
+                scanned_unconfirmed_callback,
+                transaction_send_result_callback,
+                tx_cancellation_callback,
+                txo_validation_complete_callback,
+                contacts_liveness_data_updated_callback,
+                balance_updated_callback,
+                transaction_validation_complete_callback,
+                saf_messages_received_callback,
+                connectivity_status_callback,
+                base_node_state_callback,
+                recovery_in_progress_ptr,
+                error_ptr,
+            );
+            assert_eq!(error, 0);
+
+            // The database can be read while the wallet is running
+            let reader = wallet_open_readonly(config, passphrase, ptr::null(), error_ptr);
+            assert_eq!(error, 0);
+            assert!(!reader.is_null());
+
+            let balance = wallet_reader_get_balance(reader, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(balance_get_available(balance, error_ptr), 0);
+            balance_destroy(balance);
+
+            let utxos = wallet_reader_get_utxos(reader, 0, 20, TariUtxoSort::ValueAsc, ptr::null_mut(), 0, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!((*utxos).len, 0);
+            destroy_tari_vector(utxos);
+
+            let completed_transactions = wallet_reader_get_completed_transactions(reader, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(completed_transactions_get_length(completed_transactions, error_ptr), 0);
+            completed_transactions_destroy(completed_transactions);
+            wallet_reader_destroy(reader);
+
+            let wrong_passphrase: *const c_char =
+                CString::into_raw(CString::new("a writer of ledgers").unwrap()) as *const c_char;
+            let reader = wallet_open_readonly(config, wrong_passphrase, ptr::null(), error_ptr);
+            assert!(reader.is_null());
+            assert_eq!(
+                error,
+                LibWalletError::from(WalletError::WalletStorageError(WalletStorageError::InvalidPassphrase)).code
+            );
+
+            wallet_destroy(wallet);
+            string_destroy(network_str as *mut c_char);
+            string_destroy(db_name_str as *mut c_char);
+            string_destroy(db_path_str as *mut c_char);
+            string_destroy(address_str as *mut c_char);
+            string_destroy(passphrase as *mut c_char);
+            string_destroy(wrong_passphrase as *mut c_char);
+            string_destroy(dns_string as *mut c_char);
+            transport_config_destroy(transport_type);
+            comms_config_destroy(config);
+        }
+    }
+
     #[test]
     #[allow(clippy::too_many_lines)]
     fn test_wallet_client_key_value_store() {
@@ -10300,6 +13314,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -10526,6 +13542,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -10592,6 +13610,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -10670,6 +13690,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -10846,6 +13868,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -10983,6 +14007,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -11200,6 +14226,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -11425,6 +14453,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -11684,6 +14714,8 @@ mod test {
                 network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -12001,9 +15033,22 @@ mod test {
             let tari_utxo2 = create_tari_unblinded_output_from_json(json_string, error_ptr);
             assert_eq!(error, 0);
             assert_eq!(*tari_utxo, *tari_utxo2);
+            let utxo_bytes = tari_unblinded_output_to_bytes(tari_utxo, error_ptr);
+            assert_eq!(error, 0);
+            let tari_utxo3 = create_tari_unblinded_output_from_bytes(utxo_bytes, error_ptr);
+            assert_eq!(error, 0);
+            assert_eq!(*tari_utxo, *tari_utxo3);
+            let tari_utxo4 = create_tari_unblinded_output_from_bytes(ptr::null(), error_ptr);
+            assert!(tari_utxo4.is_null());
+            assert_eq!(
+                error,
+                LibWalletError::from(InterfaceError::NullError("bytes".to_string())).code
+            );
             // Cleanup
             tari_unblinded_output_destroy(tari_utxo);
             tari_unblinded_output_destroy(tari_utxo2);
+            tari_unblinded_output_destroy(tari_utxo3);
+            byte_vector_destroy(utxo_bytes);
             string_destroy(message_ptr as *mut c_char);
             string_destroy(script_ptr as *mut c_char);
             string_destroy(input_data_ptr as *mut c_char);
@@ -12061,6 +15106,8 @@ mod test {
                 alice_network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
@@ -12124,6 +15171,8 @@ mod test {
                 bob_network_str,
                 dns_string,
                 false,
+                ptr::null_mut(),
+                ptr::null(),
                 received_tx_callback,
                 received_tx_reply_callback,
                 received_tx_finalized_callback,
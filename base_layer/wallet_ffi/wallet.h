@@ -28,11 +28,18 @@ enum TariUtxoSort {
   MinedHeightDesc = 3,
 };
 
+struct Arc_Runtime;
+
 /**
  * This struct holds the detailed balance of the Output Manager Service.
  */
 struct Balance;
 
+/**
+ * A snapshot of the work of the broadcast scheduler
+ */
+struct BroadcastQueueStats;
+
 struct BulletRangeProof;
 
 struct ByteVector;
@@ -158,6 +165,11 @@ struct RistrettoPublicKey;
  */
 struct RistrettoSecretKey;
 
+/**
+ * Tuning for an SQLite connection pool. The default matches the settings used before the profile was configurable.
+ */
+struct SqlitePerformanceProfile;
+
 struct TariAddress;
 
 struct TariBaseNodeState;
@@ -176,8 +188,17 @@ struct TariSeedWords;
 
 struct TariUnblindedOutputs;
 
+/**
+ * Keyset pagination position for `wallet_get_utxos_after`, `None` until the first page has been fetched
+ */
+struct TariUtxoCursor;
+
 struct TariWallet;
 
+struct TariWalletHost;
+
+struct TariWalletReader;
+
 /**
  * The transaction kernel tracks the excess for a given transaction. For an explanation of what the excess is, and
  * why it is necessary, refer to the
@@ -198,6 +219,14 @@ struct TransportConfig;
  */
 struct UnblindedOutput;
 
+/**
+ * Controls the background UTXO compaction performed by the wallet. When enabled, dust outputs are joined while the
+ * mempool fee for the next block is at or below `max_fee_per_gram`, and large outputs are split to keep
+ * `target_split_count` outputs of roughly `target_split_value` available for parallel sends. Every compaction
+ * transaction is paid for out of `fee_budget`, which is replenished every `budget_period_secs`.
+ */
+struct UtxoCompactionPolicy;
+
 /**
  * -------------------------------- Vector ------------------------------------------------ ///
  */
@@ -213,6 +242,11 @@ struct TariCoinPreview {
   uint64_t fee;
 };
 
+struct TariUtxoImportResults {
+  struct TariVector *tx_ids;
+  struct TariVector *error_codes;
+};
+
 typedef struct TransactionKernel TariTransactionKernel;
 
 /**
@@ -314,6 +348,15 @@ typedef ComAndPubSignature TariComAndPubSignature;
 
 typedef struct UnblindedOutput TariUnblindedOutput;
 
+/**
+ * A tokio runtime that can be shared by several wallets and chat clients
+ */
+typedef struct Arc_Runtime TariRuntime;
+
+typedef struct SqlitePerformanceProfile TariSqliteProfile;
+
+typedef struct UtxoCompactionPolicy TariUtxoCompactionPolicy;
+
 typedef struct OutputFeatures TariOutputFeatures;
 
 typedef struct Covenant TariCovenant;
@@ -345,6 +388,8 @@ typedef struct P2pConfig TariCommsConfig;
 
 typedef struct Balance TariBalance;
 
+typedef struct BroadcastQueueStats TariBroadcastQueueStats;
+
 typedef struct FeePerGramStatsResponse TariFeePerGramStats;
 
 typedef struct FeePerGramStat TariFeePerGramStat;
@@ -420,6 +465,20 @@ void destroy_tari_vector(struct TariVector *v);
  */
 void destroy_tari_coin_preview(struct TariCoinPreview *p);
 
+/**
+ * Frees memory allocated for `TariUtxoImportResults`.
+ *
+ * ## Arguments
+ * `r` - The pointer to `TariUtxoImportResults`
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void destroy_tari_utxo_import_results(struct TariUtxoImportResults *r);
+
 /**
  * -------------------------------- Strings ------------------------------------------------ ///
  * Frees memory for a char array
@@ -1069,6 +1128,44 @@ char *tari_unblinded_output_to_json(TariUnblindedOutput *output,
 TariUnblindedOutput *create_tari_unblinded_output_from_json(const char *output_json,
                                                             int *error_out);
 
+/**
+ * Serializes a TariUnblindedOutput into the compact binary format, a smaller and faster alternative to
+ * `tari_unblinded_output_to_json`. The buffer starts with a versioned header and is read back with
+ * `create_tari_unblinded_output_from_bytes`, which rejects buffers of another format version.
+ *
+ * ## Arguments
+ * `output` - The pointer to a TariUnblindedOutput
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut ByteVector` - Returns a pointer to a ByteVector, note that it returns ptr::null_mut() if output is null or
+ * cannot be serialized
+ *
+ * # Safety
+ * The ```byte_vector_destroy``` function must be called when finished with the ByteVector to prevent a memory leak
+ */
+struct ByteVector *tari_unblinded_output_to_bytes(TariUnblindedOutput *output, int *error_out);
+
+/**
+ * Creates a TariUnblindedOutput from a buffer written by `tari_unblinded_output_to_bytes`
+ *
+ * ## Arguments
+ * `bytes` - The pointer to a ByteVector holding the binary encoded TariUnblindedOutput
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariUnblindedOutput` - Returns a pointer to a TariUnblindedOutput. Note that it returns ptr::null_mut() if
+ * bytes is null, or is not a supported version of the binary encoding of a TariUnblindedOutput
+ *
+ * # Safety
+ * The ```tari_unblinded_output_destroy``` function must be called when finished with a TariUnblindedOutput to prevent
+ * a memory leak
+ */
+TariUnblindedOutput *create_tari_unblinded_output_from_bytes(const struct ByteVector *bytes,
+                                                             int *error_out);
+
 /**
  * -------------------------------------------------------------------------------------------- ///
  * ----------------------------------- TariUnblindedOutputs ------------------------------------///
@@ -1168,6 +1265,36 @@ unsigned long long wallet_import_external_utxo_as_non_rewindable(struct TariWall
                                                                  const char *message,
                                                                  int *error_out);
 
+/**
+ * Import a batch of external UTXOs into the wallet as non-rewindable (i.e. non-recoverable) outputs, as
+ * `wallet_import_external_utxo_as_non_rewindable` does for one. The metadata signature and range proof of every output
+ * are verified in parallel first, then all the outputs and their faux completed transactions are written in one
+ * database transaction per service.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer
+ * `outputs` - The pointer to a TariUnblindedOutputs
+ * `source_address` - The tari address of the source of the transactions, may be null
+ * `message` - The message that the transactions will have, "Imported UTXO" is used if it is null
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariUtxoImportResults` - Returns, for each output in order, the TransactionID of the generated transaction and
+ * an error code. The TransactionID is zero and the error code is set for an output that was not imported, such as an
+ * invalid output or one the wallet already has. Note that it returns ptr::null_mut() if the batch could not be
+ * imported at all.
+ *
+ * # Safety
+ * The ```destroy_tari_utxo_import_results``` method must be called when finished with the result to prevent a memory
+ * leak
+ */
+struct TariUtxoImportResults *wallet_import_external_utxos_as_non_rewindable(struct TariWallet *wallet,
+                                                                              struct TariUnblindedOutputs *outputs,
+                                                                              TariWalletAddress *source_address,
+                                                                              const char *message,
+                                                                              int *error_out);
+
 /**
  * -------------------------------------------------------------------------------------------- ///
  * -------------------------------- Private Key ----------------------------------------------- ///
@@ -1898,6 +2025,46 @@ TariCompletedTransaction *completed_transactions_get_at(struct TariCompletedTran
                                                         unsigned int position,
                                                         int *error_out);
 
+/**
+ * Serializes a TariCompletedTransactions into the compact binary format, a smaller and faster alternative to
+ * serializing each transaction with `tari_completed_transaction_to_json`. The buffer starts with a versioned header
+ * and is read back with `completed_transactions_from_bytes`, which rejects buffers of another format version.
+ *
+ * ## Arguments
+ * `transactions` - The pointer to a TariCompletedTransactions
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut ByteVector` - Returns a pointer to a ByteVector, note that it returns ptr::null_mut() if transactions is null
+ * or cannot be serialized
+ *
+ * # Safety
+ * The ```byte_vector_destroy``` function must be called when finished with the ByteVector to prevent a memory leak
+ */
+struct ByteVector *completed_transactions_to_bytes(struct TariCompletedTransactions *transactions,
+                                                   int *error_out);
+
+/**
+ * Creates a TariCompletedTransactions from a buffer written by `completed_transactions_to_bytes`
+ *
+ * ## Arguments
+ * `bytes` - The pointer to a ByteVector holding the binary encoded TariCompletedTransactions
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariCompletedTransactions` - Returns a pointer to a TariCompletedTransactions. Note that it returns
+ * ptr::null_mut() if bytes is null, or is not a supported version of the binary encoding of a
+ * TariCompletedTransactions
+ *
+ * # Safety
+ * The ```completed_transactions_destroy``` function must be called when finished with a TariCompletedTransactions to
+ * prevent a memory leak
+ */
+struct TariCompletedTransactions *completed_transactions_from_bytes(const struct ByteVector *bytes,
+                                                                     int *error_out);
+
 /**
  * Frees memory for a TariCompletedTransactions
  *
@@ -2289,6 +2456,44 @@ char *tari_completed_transaction_to_json(TariCompletedTransaction *tx,
 TariCompletedTransaction *create_tari_completed_transaction_from_json(const char *tx_json,
                                                                       int *error_out);
 
+/**
+ * Serializes a TariCompletedTransaction into the compact binary format, a smaller and faster alternative to
+ * `tari_completed_transaction_to_json`. The buffer starts with a versioned header and is read back with
+ * `create_tari_completed_transaction_from_bytes`, which rejects buffers of another format version.
+ *
+ * ## Arguments
+ * `tx` - The pointer to a TariCompletedTransaction
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut ByteVector` - Returns a pointer to a ByteVector, note that it returns ptr::null_mut() if tx is null or
+ * cannot be serialized
+ *
+ * # Safety
+ * The ```byte_vector_destroy``` function must be called when finished with the ByteVector to prevent a memory leak
+ */
+struct ByteVector *tari_completed_transaction_to_bytes(TariCompletedTransaction *tx, int *error_out);
+
+/**
+ * Creates a TariCompletedTransaction from a buffer written by `tari_completed_transaction_to_bytes`
+ *
+ * ## Arguments
+ * `bytes` - The pointer to a ByteVector holding the binary encoded TariCompletedTransaction
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariCompletedTransaction` - Returns a pointer to a TariCompletedTransaction. Note that it returns
+ * ptr::null_mut() if bytes is null, or is not a supported version of the binary encoding of a TariCompletedTransaction
+ *
+ * # Safety
+ * The ```completed_transaction_destroy``` function must be called when finished with a TariCompletedTransaction to
+ * prevent a memory leak
+ */
+TariCompletedTransaction *create_tari_completed_transaction_from_bytes(const struct ByteVector *bytes,
+                                                                       int *error_out);
+
 /**
  * Frees memory for a TariCompletedTransaction
  *
@@ -2823,6 +3028,196 @@ TariPublicKey *public_keys_get_at(const struct TariPublicKeys *public_keys,
                                   unsigned int position,
                                   int *error_out);
 
+/**
+ * Creates a runtime that can be passed to `wallet_create` and to the chat client constructors, so that they share
+ * one set of threads instead of each starting a runtime with a worker per CPU core.
+ *
+ * ## Arguments
+ * `worker_threads` - The number of threads that run async tasks, 0 for the default of one per CPU core up to 4
+ * `blocking_threads` - The maximum number of threads for blocking work such as database access, 0 for the default
+ * of 64
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariRuntime` - Returns a pointer to a TariRuntime, note that it returns ptr::null_mut() if the runtime could
+ * not be created
+ *
+ * # Safety
+ * The ```tari_runtime_destroy``` method must be called when finished with a TariRuntime to prevent a memory leak. The
+ * runtime keeps running until it has been destroyed and every wallet and chat client using it has been destroyed.
+ */
+TariRuntime *tari_runtime_create(unsigned int worker_threads, unsigned int blocking_threads, int *error_out);
+
+/**
+ * Frees memory for a TariRuntime
+ *
+ * ## Arguments
+ * `runtime` - The TariRuntime pointer
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void tari_runtime_destroy(TariRuntime *runtime);
+
+/**
+ * Creates a TariSqliteProfile, which tunes the wallet database for the device it runs on. It can be adjusted with
+ * the `sqlite_profile_set_*` functions and passed to `wallet_create`.
+ *
+ * ## Arguments
+ * `preset` - The starting point for the profile:
+ *     0 => Default, the settings used when no profile is given
+ *     1 => Mobile, a small page cache and write-ahead log to keep memory and storage use down
+ *     2 => Server, a large page cache, memory mapped I/O and more pooled connections for throughput
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariSqliteProfile` - Returns a pointer to a TariSqliteProfile, note that it returns ptr::null_mut() if the
+ * preset is not valid
+ *
+ * # Safety
+ * The ```sqlite_profile_destroy``` method must be called when finished with a TariSqliteProfile to prevent a memory
+ * leak
+ */
+TariSqliteProfile *sqlite_profile_create(unsigned int preset, int *error_out);
+
+/**
+ * Sets the maximum number of pooled database connections
+ *
+ * ## Arguments
+ * `profile` - The TariSqliteProfile pointer
+ * `pool_size` - The number of connections, must be at least 1
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void sqlite_profile_set_pool_size(TariSqliteProfile *profile, unsigned int pool_size, int *error_out);
+
+/**
+ * Sets the size of the memory mapped region of the database file
+ *
+ * ## Arguments
+ * `profile` - The TariSqliteProfile pointer
+ * `mmap_size` - The size in bytes, 0 to not memory map the database (the sqlite default)
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void sqlite_profile_set_mmap_size(TariSqliteProfile *profile,
+                                  unsigned long long mmap_size,
+                                  int *error_out);
+
+/**
+ * Sets the size of the page cache of each pooled connection
+ *
+ * ## Arguments
+ * `profile` - The TariSqliteProfile pointer
+ * `cache_size_kib` - The size in KiB, 0 for the sqlite default of 2 MiB
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void sqlite_profile_set_cache_size(TariSqliteProfile *profile,
+                                   unsigned long long cache_size_kib,
+                                   int *error_out);
+
+/**
+ * Sets how often the database waits for writes to reach the disk
+ *
+ * ## Arguments
+ * `profile` - The TariSqliteProfile pointer
+ * `synchronous` - The sqlite synchronous level:
+ *     0 => Off
+ *     1 => Normal
+ *     2 => Full
+ *     3 => Extra
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void sqlite_profile_set_synchronous(TariSqliteProfile *profile,
+                                    unsigned int synchronous,
+                                    int *error_out);
+
+/**
+ * Sets where temporary tables and indices are kept
+ *
+ * ## Arguments
+ * `profile` - The TariSqliteProfile pointer
+ * `temp_store` - The location:
+ *     0 => Default, as sqlite was compiled
+ *     1 => File
+ *     2 => Memory
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void sqlite_profile_set_temp_store(TariSqliteProfile *profile,
+                                   unsigned int temp_store,
+                                   int *error_out);
+
+/**
+ * Sets when the write-ahead log is checkpointed into the database file
+ *
+ * ## Arguments
+ * `profile` - The TariSqliteProfile pointer
+ * `pages` - Checkpoint once the write-ahead log holds this many pages, 0 disables automatic checkpoints
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void sqlite_profile_set_wal_autocheckpoint(TariSqliteProfile *profile,
+                                           unsigned int pages,
+                                           int *error_out);
+
+/**
+ * Frees memory for a TariSqliteProfile
+ *
+ * ## Arguments
+ * `profile` - The TariSqliteProfile pointer
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void sqlite_profile_destroy(TariSqliteProfile *profile);
+
 /**
  * Creates a TariWallet
  *
@@ -2846,6 +3241,10 @@ TariPublicKey *public_keys_get_at(const struct TariPublicKeys *public_keys,
  * encrypted then the correct passphrase is required or this function will fail.
  * `seed_words` - An optional instance of TariSeedWords, used to create a wallet for recovery purposes.
  * If this is null, then a new master key is created for the wallet.
+ * `runtime` - An optional TariRuntime, created with `tari_runtime_create`, for the wallet to run on. Wallets given the
+ * same runtime share its threads. If this is null the wallet creates a runtime of its own.
+ * `sqlite_profile` - An optional TariSqliteProfile, created with `sqlite_profile_create`, to tune the wallet database
+ * with. If this is null the default profile is used.
  * `callback_received_transaction` - The callback function pointer matching the function signature. This will be
  * called when an inbound transaction is received.
  * `callback_received_transaction_reply` - The callback function
@@ -2934,6 +3333,8 @@ struct TariWallet *wallet_create(TariCommsConfig *config,
                                  const char *network_str,
                                  const char *peer_seed_str,
                                  bool dns_sec,
+                                 TariRuntime *runtime,
+                                 const TariSqliteProfile *sqlite_profile,
                                  void (*callback_received_transaction)(TariPendingInboundTransaction*),
                                  void (*callback_received_transaction_reply)(TariCompletedTransaction*),
                                  void (*callback_received_finalized_transaction)(TariCompletedTransaction*),
@@ -2959,7 +3360,151 @@ struct TariWallet *wallet_create(TariCommsConfig *config,
                                  int *error_out);
 
 /**
- * Retrieves the version of an app that last accessed the wallet database
+ * Creates a TariWalletHost, the network stack shared by the wallets added to it with `wallet_host_add_wallet`. The
+ * host runs one comms node, one connection to the base node and one feed of base node events for all of them, so that
+ * a process hosting many wallets does not run a network stack per wallet.
+ *
+ * The hosted wallets share the network identity of the host, so they do not receive interactive transactions and
+ * should transact with one-sided payments.
+ *
+ * ## Arguments
+ * `config` - The TariCommsConfig pointer of the host. Its datastore holds the peer database and the host's own
+ * database, which must not be the database of a hosted wallet.
+ * `log_path` - An optional file path to the file where the logs will be written. If no log is required pass *null*
+ * pointer.
+ * `log_verbosity` - how verbose should logging be as a c_int 0-5, or 11, see `wallet_create`
+ * `num_rolling_log_files` - Specifies how many rolling log files to produce, if no rolling files are wanted then set
+ * this to 0
+ * `size_per_log_file_bytes` - Specifies the size, in bytes, at which the logs files will roll over, if no
+ * rolling files are wanted then set this to 0
+ * `passphrase` - The passphrase used to encrypt/decrypt the host's database
+ * `network_str` - The network the hosted wallets run on
+ * `peer_seed_str` - The DNS name to fetch seed peers from
+ * `dns_sec` - Whether DNSSEC is used when fetching seed peers
+ * `runtime` - An optional TariRuntime, created with `tari_runtime_create`, for the host and its wallets to run on. If
+ * this is null the host creates a runtime of its own.
+ * `sqlite_profile` - An optional TariSqliteProfile, created with `sqlite_profile_create`, to tune the host database
+ * with. If this is null the default profile is used.
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariWalletHost` - Returns a pointer to a TariWalletHost, note that it returns ptr::null_mut() if an argument is
+ * invalid or the network stack could not be started
+ *
+ * # Safety
+ * The ```wallet_host_destroy``` method must be called when finished with a TariWalletHost to prevent a memory leak
+ */
+struct TariWalletHost *wallet_host_create(TariCommsConfig *config,
+                                          const char *log_path,
+                                          int log_verbosity,
+                                          unsigned int num_rolling_log_files,
+                                          unsigned int size_per_log_file_bytes,
+                                          const char *passphrase,
+                                          const char *network_str,
+                                          const char *peer_seed_str,
+                                          bool dns_sec,
+                                          TariRuntime *runtime,
+                                          const TariSqliteProfile *sqlite_profile,
+                                          int *error_out);
+
+/**
+ * Creates a TariWallet that runs on the network stack of a TariWalletHost. The wallet has its own database, keys and
+ * services, and behaves like a wallet created with `wallet_create`, except that it shares the comms node, base node
+ * and network identity of the host. It therefore does not take part in interactive transactions: sends to other
+ * wallets fail unless they are one-sided, and setting its base node sets the base node of every wallet of the host.
+ *
+ * ## Arguments
+ * `host` - The TariWalletHost pointer
+ * `config` - A TariCommsConfig pointer, configures the wallet as in `wallet_create`, with its datastore path and
+ * database name locating the database of this wallet. The comms node of the host is used instead of one started from
+ * it.
+ * `passphrase` - The passphrase used to encrypt/decrypt the database of this wallet
+ * `seed_words` - An optional instance of TariSeedWords, used to create a wallet for recovery purposes.
+ * If this is null, then a new master key is created for the wallet.
+ * `sqlite_profile` - An optional TariSqliteProfile to tune the wallet database with. If this is null the default
+ * profile is used.
+ * `callback_*` - The callback function pointers, see `wallet_create`. The base node state, connectivity status and SAF
+ * callbacks report on the shared network stack of the host.
+ * `recovery_in_progress` - Pointer to an bool which will be modified to indicate if there is an outstanding recovery
+ * that should be completed or not, may not be null. Functions as an out parameter.
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariWallet` - Returns a pointer to a TariWallet, note that it returns ptr::null_mut() if an argument is
+ * invalid or the wallet could not be started
+ *
+ * # Safety
+ * The ```wallet_destroy``` method must be called when finished with the TariWallet, before the TariWalletHost is
+ * destroyed
+ */
+struct TariWallet *wallet_host_add_wallet(struct TariWalletHost *host,
+                                          TariCommsConfig *config,
+                                          const char *passphrase,
+                                          const struct TariSeedWords *seed_words,
+                                          const TariSqliteProfile *sqlite_profile,
+                                          void (*callback_received_transaction)(TariPendingInboundTransaction*),
+                                          void (*callback_received_transaction_reply)(TariCompletedTransaction*),
+                                          void (*callback_received_finalized_transaction)(TariCompletedTransaction*),
+                                          void (*callback_transaction_broadcast)(TariCompletedTransaction*),
+                                          void (*callback_transaction_mined)(TariCompletedTransaction*),
+                                          void (*callback_transaction_mined_unconfirmed)(TariCompletedTransaction*,
+                                                                                         uint64_t),
+                                          void (*callback_faux_transaction_confirmed)(TariCompletedTransaction*),
+                                          void (*callback_faux_transaction_unconfirmed)(TariCompletedTransaction*,
+                                                                                        uint64_t),
+                                          void (*callback_transaction_send_result)(unsigned long long,
+                                                                                   TariTransactionSendStatus*),
+                                          void (*callback_transaction_cancellation)(TariCompletedTransaction*,
+                                                                                    uint64_t),
+                                          void (*callback_txo_validation_complete)(uint64_t, uint64_t),
+                                          void (*callback_contacts_liveness_data_updated)(TariContactsLivenessData*),
+                                          void (*callback_balance_updated)(TariBalance*),
+                                          void (*callback_transaction_validation_complete)(uint64_t, uint64_t),
+                                          void (*callback_saf_messages_received)(void),
+                                          void (*callback_connectivity_status)(uint64_t),
+                                          void (*callback_base_node_state)(struct TariBaseNodeState*),
+                                          bool *recovery_in_progress,
+                                          int *error_out);
+
+/**
+ * Sets the base node used by all the wallets of a TariWalletHost
+ *
+ * ## Arguments
+ * `host` - The TariWalletHost pointer
+ * `public_key` - The TariPublicKey pointer of the base node
+ * `address` - The address of the base node, may be null if the base node is already known to the host
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `bool` - Returns if successful or not
+ *
+ * # Safety
+ * None
+ */
+bool wallet_host_set_base_node_peer(struct TariWalletHost *host,
+                                    TariPublicKey *public_key,
+                                    const char *address,
+                                    int *error_out);
+
+/**
+ * Frees memory for a TariWalletHost, shutting down its network stack
+ *
+ * ## Arguments
+ * `host` - The TariWalletHost pointer
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * Every wallet added with `wallet_host_add_wallet` must be destroyed with `wallet_destroy` first
+ */
+void wallet_host_destroy(struct TariWalletHost *host);
+
+/**
+ * Retrieves the version of an app that last accessed the wallet database
  *
  * ## Arguments
  * `config` - The TariCommsConfig pointer
@@ -2990,6 +3535,112 @@ char *wallet_get_last_version(TariCommsConfig *config,
 char *wallet_get_last_network(TariCommsConfig *config,
                               int *error_out);
 
+/**
+ * Opens a wallet database for reading only, without starting comms or any of the wallet services. This is much faster
+ * than `wallet_create` and suits callers that only query the balance, UTXOs or transaction history of the wallet.
+ * The database is read as it was last written, nothing is refreshed from the network. The database is not locked, so
+ * a TariWallet can be created for the same database while the TariWalletReader is open.
+ *
+ * ## Arguments
+ * `config` - The TariCommsConfig pointer, only its datastore path and database name are used
+ * `passphrase` - The passphrase used to encrypt/decrypt the databases for this wallet
+ * `sqlite_profile` - An optional pointer to a TariSqliteProfile, the defaults are used if null
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariWalletReader` - Returns a pointer to a TariWalletReader, note that it returns ptr::null_mut() if the
+ * database does not exist, has not been migrated to this version by `wallet_create` or the passphrase is wrong
+ *
+ * # Safety
+ * The ```wallet_reader_destroy``` method must be called when finished with a TariWalletReader to prevent a memory leak
+ */
+struct TariWalletReader *wallet_open_readonly(TariCommsConfig *config,
+                                             const char *passphrase,
+                                             const TariSqliteProfile *sqlite_profile,
+                                             int *error_out);
+
+/**
+ * Retrieves the balance from a TariWalletReader. Time locked outputs are determined at the chain tip the wallet last
+ * knew of.
+ *
+ * ## Arguments
+ * `reader` - The TariWalletReader pointer.
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ * ## Returns
+ * `*mut Balance` - Returns the pointer to the TariBalance or null if error occurs
+ *
+ * # Safety
+ * The ```balance_destroy``` method must be called when finished with a TariBalance to prevent a memory leak
+ */
+TariBalance *wallet_reader_get_balance(struct TariWalletReader *reader,
+                                       int *error_out);
+
+/**
+ * This function returns a list of unspent UTXO values and commitments from a TariWalletReader, as `wallet_get_utxos`
+ * does for a TariWallet.
+ *
+ * ## Arguments
+ * * `reader` - The TariWalletReader pointer,
+ * * `page` - Page offset,
+ * * `page_size` - A number of items per page,
+ * * `sorting` - An enum representing desired sorting,
+ * * `states` - A `TariVector` of UTXO states to filter on, all states are included if null,
+ * * `dust_threshold` - A value filtering threshold. Outputs whose values are <= `dust_threshold` are not listed in the
+ *   result.
+ * * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null.
+ *   Functions as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariVector` - Returns a struct with an array pointer, length and capacity (needed for proper destruction
+ * after use).
+ *
+ * # Safety
+ * `destroy_tari_vector()` must be called after use.
+ */
+struct TariVector *wallet_reader_get_utxos(struct TariWalletReader *reader,
+                                           uintptr_t page,
+                                           uintptr_t page_size,
+                                           enum TariUtxoSort sorting,
+                                           struct TariVector *states,
+                                           uint64_t dust_threshold,
+                                           int32_t *error_ptr);
+
+/**
+ * Get the TariCompletedTransactions from a TariWalletReader, as `wallet_get_completed_transactions` does for a
+ * TariWallet
+ *
+ * ## Arguments
+ * `reader` - The TariWalletReader pointer
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariCompletedTransactions` - returns the transactions, note that it returns ptr::null_mut() if
+ * reader is null or an error is encountered
+ *
+ * # Safety
+ * The ```completed_transactions_destroy``` method must be called when finished with a TariCompletedTransactions to
+ * prevent a memory leak
+ */
+struct TariCompletedTransactions *wallet_reader_get_completed_transactions(struct TariWalletReader *reader,
+                                                                          int *error_out);
+
+/**
+ * Frees memory for a TariWalletReader
+ *
+ * ## Arguments
+ * `reader` - The TariWalletReader pointer
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void wallet_reader_destroy(struct TariWalletReader *reader);
+
 /**
  * Retrieves the balance from a wallet
  *
@@ -3036,6 +3687,65 @@ struct TariVector *wallet_get_utxos(struct TariWallet *wallet,
                                     uint64_t dust_threshold,
                                     int32_t *error_ptr);
 
+/**
+ * Creates a new, empty cursor for use with `wallet_get_utxos_after`. An empty cursor starts at the first UTXO.
+ *
+ * ## Arguments
+ * `()` - Does not take any arguments
+ *
+ * ## Returns
+ * `*mut TariUtxoCursor` - Returns a pointer to a TariUtxoCursor
+ *
+ * # Safety
+ * The ```utxo_cursor_destroy``` method must be called when finished with a TariUtxoCursor to prevent a memory leak
+ */
+struct TariUtxoCursor *utxo_cursor_create(void);
+
+/**
+ * Frees memory for a TariUtxoCursor
+ *
+ * ## Arguments
+ * `cursor` - The pointer to a TariUtxoCursor
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void utxo_cursor_destroy(struct TariUtxoCursor *cursor);
+
+/**
+ * This function returns the next page of UTXOs after the position held by `cursor` and advances the cursor to the
+ * last UTXO returned. Unlike `wallet_get_utxos`, the cost of a page does not grow with the depth of the page.
+ *
+ * ## Arguments
+ * * `wallet` - The TariWallet pointer,
+ * * `cursor` - The TariUtxoCursor pointer, created with `utxo_cursor_create()`. The same `sorting`, `states` and
+ *   `dust_threshold` must be used for every call with the same cursor,
+ * * `page_size` - A number of items per page,
+ * * `sorting` - An enum representing desired sorting,
+ * * `states` - A `TariVector` of UTXO states to filter on, all states are included if null,
+ * * `dust_threshold` - A value filtering threshold. Outputs whose values are <= `dust_threshold` are not listed in the
+ *   result.
+ * * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null.
+ *   Functions as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariVector` - Returns a struct with an array pointer, length and capacity (needed for proper destruction
+ * after use). An empty vector means there are no more UTXOs after the cursor, in which case the cursor is unchanged.
+ *
+ * # Safety
+ * `destroy_tari_vector()` must be called after use.
+ */
+struct TariVector *wallet_get_utxos_after(struct TariWallet *wallet,
+                                          struct TariUtxoCursor *cursor,
+                                          uintptr_t page_size,
+                                          enum TariUtxoSort sorting,
+                                          struct TariVector *states,
+                                          uint64_t dust_threshold,
+                                          int32_t *error_ptr);
+
 /**
  * This function returns a list of all UTXO values, commitment's hex values and states.
  *
@@ -3163,6 +3873,127 @@ struct TariCoinPreview *wallet_preview_coin_split(struct TariWallet *wallet,
                                                   uint64_t fee_per_gram,
                                                   int32_t *error_ptr);
 
+/**
+ * Creates an enabled TariUtxoCompactionPolicy with the default dust, fee and split settings. It can be adjusted with
+ * the `utxo_compaction_policy_set_*` functions and applied with `wallet_set_utxo_compaction_policy`.
+ *
+ * ## Arguments
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariUtxoCompactionPolicy` - Returns a pointer to a TariUtxoCompactionPolicy
+ *
+ * # Safety
+ * The ```utxo_compaction_policy_destroy``` method must be called when finished with a TariUtxoCompactionPolicy to
+ * prevent a memory leak
+ */
+TariUtxoCompactionPolicy *utxo_compaction_policy_create(int *error_out);
+
+/**
+ * Sets which outputs are dust and how they are joined
+ *
+ * ## Arguments
+ * `policy` - The TariUtxoCompactionPolicy pointer
+ * `dust_threshold` - Outputs with a value below this, in micro MinoTari, are dust
+ * `min_dust_outputs` - The number of dust outputs that must be present before they are joined, at least 2
+ * `max_inputs_per_join` - The maximum number of dust outputs joined in a single transaction, at least 2
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void utxo_compaction_policy_set_dust(TariUtxoCompactionPolicy *policy,
+                                     unsigned long long dust_threshold,
+                                     unsigned int min_dust_outputs,
+                                     unsigned int max_inputs_per_join,
+                                     int *error_out);
+
+/**
+ * Sets when compaction may happen and how much it may spend on fees
+ *
+ * ## Arguments
+ * `policy` - The TariUtxoCompactionPolicy pointer
+ * `max_fee_per_gram` - Compaction only happens while the next block's minimum mempool fee per gram is at or below this
+ * `fee_budget` - The total fee, in micro MinoTari, that compaction may spend in each budget period
+ * `budget_period_secs` - The length of the fee budget period in seconds, must be greater than 0
+ * `min_interval_secs` - The minimum number of seconds between two compaction transactions
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void utxo_compaction_policy_set_fee_limits(TariUtxoCompactionPolicy *policy,
+                                           unsigned long long max_fee_per_gram,
+                                           unsigned long long fee_budget,
+                                           unsigned long long budget_period_secs,
+                                           unsigned long long min_interval_secs,
+                                           int *error_out);
+
+/**
+ * Sets the pool of evenly split outputs that is kept available for parallel sends
+ *
+ * ## Arguments
+ * `policy` - The TariUtxoCompactionPolicy pointer
+ * `target_split_count` - The number of outputs of roughly `target_split_value` to keep available, 0 disables
+ * splitting
+ * `target_split_value` - The value of the pooled outputs in micro MinoTari, more than twice the dust threshold
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void utxo_compaction_policy_set_split_target(TariUtxoCompactionPolicy *policy,
+                                             unsigned int target_split_count,
+                                             unsigned long long target_split_value,
+                                             int *error_out);
+
+/**
+ * Frees memory for a TariUtxoCompactionPolicy
+ *
+ * ## Arguments
+ * `policy` - The TariUtxoCompactionPolicy pointer
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void utxo_compaction_policy_destroy(TariUtxoCompactionPolicy *policy);
+
+/**
+ * Applies a UTXO compaction policy to the wallet's background compaction task, which joins dust outputs while fees are
+ * low and keeps a pool of evenly split outputs. The policy is copied, so it can be destroyed after this call.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer
+ * `policy` - The TariUtxoCompactionPolicy pointer, or null to disable compaction
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `bool` - Returns true if the policy was applied, false if the wallet is null or an enabled policy is not valid
+ *
+ * # Safety
+ * None
+ */
+bool wallet_set_utxo_compaction_policy(struct TariWallet *wallet,
+                                       const TariUtxoCompactionPolicy *policy,
+                                       int *error_out);
+
 /**
  * Signs a message using the public key of the TariWallet
  *
@@ -3205,6 +4036,32 @@ bool wallet_verify_message_signature(struct TariWallet *wallet,
                                      const char *msg,
                                      int *error_out);
 
+/**
+ * Limits how often the base node state and connectivity status callbacks fire. Either callback only fires when its
+ * state has changed, and at most once per `min_interval_ms`; a change within the interval is held back and the
+ * latest state is delivered when the interval ends. The base node state counts as changed when the base node, its
+ * height, its synced flag or its latency bucket changes.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer
+ * `min_interval_ms` - The minimum number of milliseconds between two callbacks of the same kind, 0 to deliver every
+ * change as it happens (the default)
+ * `latency_bucket_ms` - The width, in milliseconds, of the buckets base node latencies are compared in, 0 to compare
+ * them exactly. The default is 100.
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `bool` - Returns if successful or not
+ *
+ * # Safety
+ * None
+ */
+bool wallet_set_state_callback_throttle(struct TariWallet *wallet,
+                                        unsigned long long min_interval_ms,
+                                        unsigned long long latency_bucket_ms,
+                                        int *error_out);
+
 /**
  * Adds a base node peer to the TariWallet
  *
@@ -3394,6 +4251,45 @@ unsigned long long wallet_send_transaction(struct TariWallet *wallet,
                                            const char *payment_id_string,
                                            int *error_out);
 
+/**
+ * Sends one-sided payments to several recipients in as few transactions as possible. Recipients share the input
+ * selection, kernel and change output of their transaction instead of each paying for their own, which makes this
+ * much cheaper than calling `wallet_send_transaction` once per recipient for payout runs.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer
+ * `destinations` - An array of `count` TariWalletAddress pointers
+ * `amounts` - An array of `count` amounts, one per destination
+ * `payment_ids` - An array of `count` char pointers holding the payment id for each destination, which is encrypted
+ * into the recipient's output. The array, or any entry in it, may be null for no payment id
+ * `count` - The number of recipients
+ * `commitments` - A `TariVector` of "strings", tagged as `TariTypeTag::String`, containing commitment's hex values
+ *   (see `Commitment::to_hex()`) to spend, may be null to let the wallet select the inputs
+ * `fee_per_gram` - The transaction fee
+ * `message` - The pointer to a char array holding the message stored with the transactions
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariVector` - Returns a `TariVector` tagged as `TariTypeTag::U64` holding the TxIds of the sent
+ * transactions, or null if unsuccessful. All transactions are funded before any is sent, so a failure normally
+ * sends nothing. If some were already sent when a later one failed, `error_out` is set to 213 and the returned
+ * vector holds the TxIds of the transactions that were sent
+ *
+ * # Safety
+ * The `destinations`, `amounts` and `payment_ids` arrays must hold at least `count` elements. The returned
+ * `TariVector` must be freed after use with `destroy_tari_vector()`
+ */
+struct TariVector *wallet_send_transaction_batch(struct TariWallet *wallet,
+                                                TariWalletAddress *const *destinations,
+                                                const unsigned long long *amounts,
+                                                const char *const *payment_ids,
+                                                uintptr_t count,
+                                                struct TariVector *commitments,
+                                                unsigned long long fee_per_gram,
+                                                const char *message,
+                                                int *error_out);
+
 /**
  * Gets a fee estimate for an amount
  *
@@ -3495,6 +4391,39 @@ struct TariContacts *wallet_get_contacts(struct TariWallet *wallet,
 struct TariCompletedTransactions *wallet_get_completed_transactions(struct TariWallet *wallet,
                                                                     int *error_out);
 
+/**
+ * Exports the completed transaction history of a TariWallet to a file, cancelled transactions included. The history is
+ * read, decrypted and written a page at a time, so memory use does not grow with the size of the wallet. The file is
+ * written next to `path` and only renamed to `path` once the export is complete.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer
+ * `path` - The path of the file to write, an existing file is replaced
+ * `format` - The file format:
+ *     0 => CSV, one row per transaction with a header row, amounts in micro MinoTari and timestamps in UTC
+ *     1 => Binary, a sequence of records that are each the little endian 32 bit length of a
+ *          `tari_completed_transaction_to_bytes` buffer followed by the buffer
+ * `from_time` - Only transactions at or after this unix timestamp in seconds are exported, 0 for no lower bound
+ * `to_time` - Only transactions before this unix timestamp in seconds are exported, 0 for no upper bound
+ * `callback_progress` - The callback function pointer which is called with the number of transactions written so far
+ * after every page
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `c_ulonglong` - Returns the number of transactions exported, 0 if an error occurred
+ *
+ * # Safety
+ * None
+ */
+unsigned long long wallet_export_history(struct TariWallet *wallet,
+                                         const char *path,
+                                         unsigned int format,
+                                         unsigned long long from_time,
+                                         unsigned long long to_time,
+                                         void (*callback_progress)(unsigned long long),
+                                         int *error_out);
+
 /**
  * Get the TariPendingInboundTransactions from a TariWallet
  *
@@ -3734,6 +4663,91 @@ unsigned long long wallet_start_transaction_validation(struct TariWallet *wallet
 bool wallet_restart_transaction_broadcast(struct TariWallet *wallet,
                                           int *error_out);
 
+/**
+ * Gets how much broadcast work the wallet has queued and in flight. The broadcast protocols of all completed
+ * transactions share one scheduler, which submits transactions to the base node and queries their status in batches.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `*mut TariBroadcastQueueStats` - Returns a pointer to a TariBroadcastQueueStats, or null if an error occurred
+ *
+ * # Safety
+ * The ```broadcast_queue_stats_destroy``` method must be called when finished with a TariBroadcastQueueStats to
+ * prevent a memory leak
+ */
+TariBroadcastQueueStats *wallet_get_broadcast_queue_stats(struct TariWallet *wallet,
+                                                          int *error_out);
+
+/**
+ * Gets the number of transaction submissions and status queries waiting for a broadcast batch
+ *
+ * ## Arguments
+ * `stats` - The TariBroadcastQueueStats pointer
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `c_ulonglong` - The number of queued requests, 0 if stats is null
+ *
+ * # Safety
+ * None
+ */
+unsigned long long broadcast_queue_stats_get_queued(TariBroadcastQueueStats *stats,
+                                                    int *error_out);
+
+/**
+ * Gets the number of transaction submissions and status queries in broadcast batches that are being sent, or backing
+ * off after a failed attempt
+ *
+ * ## Arguments
+ * `stats` - The TariBroadcastQueueStats pointer
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `c_ulonglong` - The number of requests in flight, 0 if stats is null
+ *
+ * # Safety
+ * None
+ */
+unsigned long long broadcast_queue_stats_get_in_flight(TariBroadcastQueueStats *stats,
+                                                       int *error_out);
+
+/**
+ * Gets the number of broadcast batches that are being sent, or backing off after a failed attempt
+ *
+ * ## Arguments
+ * `stats` - The TariBroadcastQueueStats pointer
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `c_ulonglong` - The number of batches in flight, 0 if stats is null
+ *
+ * # Safety
+ * None
+ */
+unsigned long long broadcast_queue_stats_get_batches_in_flight(TariBroadcastQueueStats *stats,
+                                                              int *error_out);
+
+/**
+ * Frees memory for a TariBroadcastQueueStats
+ *
+ * ## Arguments
+ * `stats` - The pointer to a TariBroadcastQueueStats
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void broadcast_queue_stats_destroy(TariBroadcastQueueStats *stats);
+
 /**
  * Gets the seed words representing the seed private key of the provided `TariWallet`.
  *
@@ -3922,6 +4936,67 @@ bool wallet_start_recovery(struct TariWallet *wallet,
                            const char *recovered_output_message,
                            int *error_out);
 
+/**
+ * Starts the Wallet recovery process using several base nodes at once. The height range to be scanned is split into
+ * segments that are downloaded concurrently from the different base nodes. A segment that fails or is too slow is
+ * reassigned to another base node, and segments are always processed in height order.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer.
+ * `base_node_public_keys` - A `TariVector` of "strings", tagged as `TariTypeTag::Text`, containing the hex public keys
+ * of the Base Nodes the recovery process will use. The first one is used to determine the chain tip.
+ * `recovery_progress_callback` - The callback function pointer that will be used to asynchronously communicate
+ * progress to the client, see `wallet_start_recovery` for the events.
+ * `recovered_output_message` - A string that will be used as the message for any recovered outputs. If Null the
+ * default message will be used
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `bool` - Return a boolean value indicating whether the process started successfully or not, the process will
+ * continue to run asynchronously and communicate it progress via the callback. An error will also produce a false
+ * result.
+ *
+ * # Safety
+ * `base_node_public_keys` remains owned by the caller and must be freed with `destroy_tari_vector()` after use
+ */
+bool wallet_start_recovery_from_peers(struct TariWallet *wallet,
+                                      struct TariVector *base_node_public_keys,
+                                      void (*recovery_progress_callback)(uint8_t, uint64_t, uint64_t),
+                                      const char *recovered_output_message,
+                                      int *error_out);
+
+/**
+ * Starts the Wallet recovery process from a local block output snapshot file instead of a base node, so that no
+ * network connection is needed. The snapshot holds the outputs of every block of a chain, is read from the wallet
+ * birthday onwards, and must have been taken from the chain the wallet will be used on: a snapshot of another
+ * network, or with another genesis block than the base node when one is set, fails the recovery. Outputs that were
+ * already recovered are skipped, so the recovery can be repeated against the same snapshot.
+ *
+ * ## Arguments
+ * `wallet` - The TariWallet pointer.
+ * `snapshot_path` - The path of the block output snapshot file.
+ * `recovery_progress_callback` - The callback function pointer that will be used to asynchronously communicate
+ * progress to the client, see `wallet_start_recovery` for the events. No connection events are sent.
+ * `recovered_output_message` - A string that will be used as the message for any recovered outputs. If Null the
+ * default message will be used
+ * `error_out` - Pointer to an int which will be modified to an error code should one occur, may not be null. Functions
+ * as an out parameter.
+ *
+ * ## Returns
+ * `bool` - Return a boolean value indicating whether the process started successfully or not, the process will
+ * continue to run asynchronously and communicate it progress via the callback. An error will also produce a false
+ * result.
+ *
+ * # Safety
+ * None
+ */
+bool wallet_start_recovery_from_snapshot(struct TariWallet *wallet,
+                                         const char *snapshot_path,
+                                         void (*recovery_progress_callback)(uint8_t, uint64_t, uint64_t),
+                                         const char *recovered_output_message,
+                                         int *error_out);
+
 /**
  * Set the text message that is applied to a detected One-Side payment transaction when it is scanned from the
  * blockchain
@@ -4006,7 +5081,8 @@ struct ByteVector *emoji_set_get_at(const struct EmojiSet *emoji_set,
 void emoji_set_destroy(struct EmojiSet *emoji_set);
 
 /**
- * Frees memory for a TariWallet
+ * Frees memory for a TariWallet, blocking until the wallet has shut down. A wallet of a TariWalletHost leaves the
+ * shared comms node running, so only its own services and callback handler are waited for.
  *
  * ## Arguments
  * `wallet` - The TariWallet pointer
@@ -4382,6 +5458,20 @@ unsigned long long basenode_state_get_node_updated_at(struct TariBaseNodeState *
 unsigned long long basenode_state_get_latency(struct TariBaseNodeState *ptr,
                                               int *error_out);
 
+/**
+ * Frees memory for a `TariBaseNodeState`
+ *
+ * ## Arguments
+ * `ptr` - The pointer to a `TariBaseNodeState`
+ *
+ * ## Returns
+ * `()` - Does not return a value, equivalent to void in C
+ *
+ * # Safety
+ * None
+ */
+void basenode_state_destroy(struct TariBaseNodeState *ptr);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
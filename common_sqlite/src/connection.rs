@@ -35,12 +35,12 @@ use log::*;
 use serde::{Deserialize, Serialize};
 
 use crate::{
+    connection_options::SqlitePerformanceProfile,
     error::{SqliteStorageError, StorageError},
     sqlite_connection_pool::{PooledDbConnection, SqliteConnectionPool},
 };
 
 const LOG_TARGET: &str = "common_sqlite::connection";
-const SQLITE_POOL_SIZE: usize = 16;
 
 /// Describes how to connect to the database (currently, SQLite).
 #[derive(Clone, Debug, Serialize, Deserialize)]
@@ -115,15 +115,24 @@ impl DbConnection {
 
     /// Connect using the given [DbConnectionUrl](self::DbConnectionUrl).
     pub fn connect_url(db_url: &DbConnectionUrl) -> Result<Self, StorageError> {
+        Self::connect_url_with_profile(db_url, SqlitePerformanceProfile::default())
+    }
+
+    /// Connect using the given [DbConnectionUrl](self::DbConnectionUrl), tuned with the given performance profile.
+    pub fn connect_url_with_profile(
+        db_url: &DbConnectionUrl,
+        profile: SqlitePerformanceProfile,
+    ) -> Result<Self, StorageError> {
         debug!(target: LOG_TARGET, "Connecting to database using '{:?}'", db_url);
 
         let mut pool = SqliteConnectionPool::new(
             db_url.to_url_string(),
-            SQLITE_POOL_SIZE,
+            profile.pool_size,
             true,
             true,
             Duration::from_secs(60),
-        );
+        )
+        .with_performance_profile(profile);
         pool.create_pool()?;
 
         Ok(Self::new(pool))
@@ -21,14 +21,138 @@
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 use core::time::Duration;
+use std::fmt;
 
 use diesel::{connection::SimpleConnection, SqliteConnection};
+use serde::{Deserialize, Serialize};
+
+/// The default number of pooled connections
+pub const DEFAULT_SQLITE_POOL_SIZE: usize = 16;
+
+/// The value of `PRAGMA synchronous`
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(rename_all = "snake_case")]
+pub enum SqliteSynchronous {
+    Off,
+    Normal,
+    Full,
+    Extra,
+}
+
+impl fmt::Display for SqliteSynchronous {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            SqliteSynchronous::Off => write!(f, "OFF"),
+            SqliteSynchronous::Normal => write!(f, "NORMAL"),
+            SqliteSynchronous::Full => write!(f, "FULL"),
+            SqliteSynchronous::Extra => write!(f, "EXTRA"),
+        }
+    }
+}
+
+/// The value of `PRAGMA temp_store`, i.e. where temporary tables and indices are kept
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(rename_all = "snake_case")]
+pub enum SqliteTempStore {
+    Default,
+    File,
+    Memory,
+}
+
+impl fmt::Display for SqliteTempStore {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            SqliteTempStore::Default => write!(f, "DEFAULT"),
+            SqliteTempStore::File => write!(f, "FILE"),
+            SqliteTempStore::Memory => write!(f, "MEMORY"),
+        }
+    }
+}
+
+/// Tuning for an SQLite connection pool. The default matches the settings used before the profile was configurable.
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(default, deny_unknown_fields)]
+pub struct SqlitePerformanceProfile {
+    /// The maximum number of pooled connections. This is configured separately from the pragmas, so it is not
+    /// (de)serialized.
+    #[serde(skip)]
+    pub pool_size: usize,
+    /// `PRAGMA mmap_size` in bytes. `None` keeps the SQLite default of not memory mapping the database.
+    pub mmap_size: Option<u64>,
+    /// `PRAGMA cache_size` in KiB, per connection. `None` keeps the SQLite default of 2 MiB.
+    pub cache_size_kib: Option<u64>,
+    /// `PRAGMA synchronous`
+    pub synchronous: SqliteSynchronous,
+    /// `PRAGMA temp_store`
+    pub temp_store: SqliteTempStore,
+    /// `PRAGMA wal_autocheckpoint`: checkpoint the write-ahead log once it holds this many pages, 0 disables
+    /// automatic checkpoints. `None` keeps the SQLite default of 1000 pages.
+    pub wal_autocheckpoint_pages: Option<u32>,
+}
+
+impl SqlitePerformanceProfile {
+    /// Keeps memory use and the size of the write-ahead log small, for phones and other constrained devices
+    pub fn mobile() -> Self {
+        Self {
+            pool_size: DEFAULT_SQLITE_POOL_SIZE,
+            mmap_size: None,
+            cache_size_kib: Some(512),
+            synchronous: SqliteSynchronous::Normal,
+            temp_store: SqliteTempStore::File,
+            wal_autocheckpoint_pages: Some(250),
+        }
+    }
+
+    /// Trades memory for throughput, for servers handling large wallets or many requests
+    pub fn server() -> Self {
+        Self {
+            pool_size: 32,
+            mmap_size: Some(256 * 1024 * 1024),
+            cache_size_kib: Some(64 * 1024),
+            synchronous: SqliteSynchronous::Normal,
+            temp_store: SqliteTempStore::Memory,
+            wal_autocheckpoint_pages: Some(4000),
+        }
+    }
+
+    fn to_pragmas(&self) -> String {
+        let mut pragmas = format!(
+            "PRAGMA synchronous = {}; PRAGMA temp_store = {};",
+            self.synchronous, self.temp_store
+        );
+        if let Some(mmap_size) = self.mmap_size {
+            pragmas.push_str(&format!(" PRAGMA mmap_size = {};", mmap_size));
+        }
+        if let Some(cache_size_kib) = self.cache_size_kib {
+            // A negative cache size is in KiB rather than pages
+            pragmas.push_str(&format!(" PRAGMA cache_size = -{};", cache_size_kib));
+        }
+        if let Some(pages) = self.wal_autocheckpoint_pages {
+            pragmas.push_str(&format!(" PRAGMA wal_autocheckpoint = {};", pages));
+        }
+        pragmas
+    }
+}
+
+impl Default for SqlitePerformanceProfile {
+    fn default() -> Self {
+        Self {
+            pool_size: DEFAULT_SQLITE_POOL_SIZE,
+            mmap_size: None,
+            cache_size_kib: None,
+            synchronous: SqliteSynchronous::Normal,
+            temp_store: SqliteTempStore::Default,
+            wal_autocheckpoint_pages: None,
+        }
+    }
+}
 
 #[derive(Debug, Clone)]
 pub struct ConnectionOptions {
     enable_wal: bool,
     enable_foreign_keys: bool,
     busy_timeout: Option<Duration>,
+    performance_profile: Option<SqlitePerformanceProfile>,
 }
 
 impl ConnectionOptions {
@@ -37,8 +161,14 @@ impl ConnectionOptions {
             enable_wal,
             enable_foreign_keys,
             busy_timeout: Some(busy_timeout),
+            performance_profile: None,
         }
     }
+
+    pub fn with_performance_profile(mut self, profile: SqlitePerformanceProfile) -> Self {
+        self.performance_profile = Some(profile);
+        self
+    }
 }
 
 impl diesel::r2d2::CustomizeConnection<SqliteConnection, diesel::r2d2::Error> for ConnectionOptions {
@@ -53,8 +183,33 @@ impl diesel::r2d2::CustomizeConnection<SqliteConnection, diesel::r2d2::Error> fo
             if self.enable_foreign_keys {
                 conn.batch_execute("PRAGMA foreign_keys = ON;")?;
             }
+            if let Some(profile) = &self.performance_profile {
+                conn.batch_execute(&profile.to_pragmas())?;
+            }
             Ok(())
         })()
         .map_err(diesel::r2d2::Error::QueryError)
     }
 }
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn default_profile_only_sets_synchronous_and_temp_store() {
+        assert_eq!(
+            SqlitePerformanceProfile::default().to_pragmas(),
+            "PRAGMA synchronous = NORMAL; PRAGMA temp_store = DEFAULT;"
+        );
+    }
+
+    #[test]
+    fn server_profile_pragmas() {
+        assert_eq!(
+            SqlitePerformanceProfile::server().to_pragmas(),
+            "PRAGMA synchronous = NORMAL; PRAGMA temp_store = MEMORY; PRAGMA mmap_size = 268435456; PRAGMA cache_size \
+             = -65536; PRAGMA wal_autocheckpoint = 4000;"
+        );
+    }
+}
@@ -21,7 +21,7 @@
 // USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 pub mod connection;
-mod connection_options;
+pub mod connection_options;
 pub mod error;
 pub mod sqlite_connection_pool;
 pub mod util;
@@ -29,7 +29,10 @@ use diesel::{
 };
 use log::*;
 
-use crate::{connection_options::ConnectionOptions, error::SqliteStorageError};
+use crate::{
+    connection_options::{ConnectionOptions, SqlitePerformanceProfile},
+    error::SqliteStorageError,
+};
 
 const LOG_TARGET: &str = "common_sqlite::sqlite_connection_pool";
 
@@ -57,6 +60,13 @@ impl SqliteConnectionPool {
         }
     }
 
+    /// Use the pool size and pragmas of the given profile. This must be called before the pool is created.
+    pub fn with_performance_profile(mut self, profile: SqlitePerformanceProfile) -> Self {
+        self.pool_size = profile.pool_size;
+        self.connection_options = self.connection_options.with_performance_profile(profile);
+        self
+    }
+
     /// Create an sqlite connection pool managed by the pool connection manager
     pub fn create_pool(&mut self) -> Result<(), SqliteStorageError> {
         if self.pool.is_none() {
@@ -232,6 +232,12 @@ impl<T> RpcClientLease<T> {
     pub(super) fn lease_count(&self) -> usize {
         Arc::strong_count(&self.rc) - 1
     }
+
+    /// Returns true if both leases are of the same client session. A pool that cannot open further sessions leases
+    /// out the ones it has again.
+    pub fn is_same_session(&self, other: &Self) -> bool {
+        Arc::ptr_eq(&self.rc, &other.rc)
+    }
 }
 
 impl<T> Deref for RpcClientLease<T> {
@@ -143,6 +143,19 @@ mod lazy_pool {
         assert_eq!(mock_state.num_open_substreams(), 1);
         assert_eq!(conn1.lease_count(), 2);
         assert_eq!(conn2.lease_count(), 2);
+        assert!(conn1.is_same_session(&conn2));
+    }
+
+    #[tokio::test]
+    async fn it_identifies_leases_of_the_same_session() {
+        let (conn, _, _shutdown) = setup(2).await;
+        let mut pool = LazyPool::<GreetingClient>::new(conn, 2, Default::default());
+        let conn1 = pool.get_least_used_or_connect().await.unwrap();
+        let conn2 = pool.get_least_used_or_connect().await.unwrap();
+        assert!(!conn1.is_same_session(&conn2));
+        assert!(conn1.is_same_session(&conn1.clone()));
+        let conn3 = pool.get_least_used_or_connect().await.unwrap();
+        assert!(conn3.is_same_session(&conn1) ^ conn3.is_same_session(&conn2));
     }
 
     #[tokio::test]
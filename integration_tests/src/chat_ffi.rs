@@ -24,6 +24,7 @@ use std::{
     convert::TryFrom,
     ffi::{c_void, CString},
     path::PathBuf,
+    ptr,
     str::FromStr,
     sync::{Arc, Mutex, Once},
 };
@@ -75,6 +76,7 @@ extern "C" {
         callback_delivery_confirmation_received: unsafe extern "C" fn(*mut c_void),
         callback_read_confirmation_received: unsafe extern "C" fn(*mut c_void),
         tari_address: *mut c_void,
+        runtime: *mut c_void,
         error_out: *const c_int,
     ) -> *mut ClientFFI;
     pub fn sideload_chat_client(
@@ -85,6 +87,7 @@ extern "C" {
         callback_delivery_confirmation_received: unsafe extern "C" fn(*mut c_void),
         callback_read_confirmation_received: unsafe extern "C" fn(*mut c_void),
         tari_address: *mut c_void,
+        runtime: *mut c_void,
         error_out: *const c_int,
     ) -> *mut ClientFFI;
     pub fn create_chat_message(
@@ -325,6 +328,7 @@ pub async fn spawn_ffi_chat_client(name: &str, seed_peers: Vec<Peer>, base_dir:
             callback_delivery_confirmation_received,
             callback_read_confirmation_received,
             address_ptr,
+            ptr::null_mut(),
             error_out,
         );
     }
@@ -359,6 +363,7 @@ pub async fn sideload_ffi_chat_client(
             callback_delivery_confirmation_received,
             callback_read_confirmation_received,
             adress_ptr,
+            ptr::null_mut(),
             error_out,
         );
     }
@@ -31,6 +31,8 @@ pub type TariTransactionSendStatus = c_void;
 pub type TariContactsLivenessData = c_void;
 pub type TariBalance = c_void;
 pub type TariWallet = c_void;
+pub type TariRuntime = c_void;
+pub type TariSqliteProfile = c_void;
 pub type TariWalletAddress = c_void;
 pub type ByteVector = c_void;
 #[allow(dead_code)]
@@ -388,6 +390,8 @@ extern "C" {
         network_str: *const c_char,
         peer_seed_str: *const c_char,
         dns_sec: bool,
+        runtime: *mut TariRuntime,
+        sqlite_profile: *const TariSqliteProfile,
         callback_received_transaction: unsafe extern "C" fn(*mut TariPendingInboundTransaction),
         callback_received_transaction_reply: unsafe extern "C" fn(*mut TariCompletedTransaction),
         callback_received_finalized_transaction: unsafe extern "C" fn(*mut TariCompletedTransaction),
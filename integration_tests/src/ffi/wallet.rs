@@ -22,7 +22,7 @@
 
 use std::{
     ffi::CString,
-    ptr::null_mut,
+    ptr::{null, null_mut},
     sync::{Arc, Mutex},
 };
 
@@ -181,6 +181,8 @@ impl Wallet {
                 CString::new("localnet").unwrap().into_raw(),
                 CString::new("").unwrap().into_raw(),
                 false,
+                null_mut(),
+                null(),
                 callback_received_transaction,
                 callback_received_transaction_reply,
                 callback_received_finalized_transaction,